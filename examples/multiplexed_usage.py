@@ -1,5 +1,8 @@
 """
 Example showing how to read all four tyres via a TCA9548A I2C multiplexer.
+
+MuxScheduler interleaves subpage reads across the sensors, so frames arrive
+as each sensor completes rather than one sensor at a time.
 """
 
 from datetime import datetime
@@ -7,7 +10,7 @@ from datetime import datetime
 import board
 import busio
 
-from thermal_tyre_driver import SensorConfig, TyreThermalSensor
+from thermal_tyre_driver import MuxScheduler, SensorConfig, TyreThermalSensor
 
 
 def main() -> None:
@@ -50,21 +53,21 @@ def main() -> None:
         ),
     }
 
-    for position, sensor in sensors.items():
-        try:
-            data = sensor.read()
-        except Exception as exc:
-            print(f"[{datetime.now().isoformat()}] {position} read failed: {exc}")
-            continue
+    scheduler = MuxScheduler(sensors.values())
 
-        print(
-            f"{position}: span={data.detection.span_start}-{data.detection.span_end} "
-            f"confidence={data.detection.confidence:.0%} "
-            f"temps(L/C/R)=("
-            f"{data.analysis.left.avg:.1f}/"
-            f"{data.analysis.centre.avg:.1f}/"
-            f"{data.analysis.right.avg:.1f}°C)"
-        )
+    try:
+        for data in scheduler:
+            print(
+                f"{data.sensor_id}: span={data.detection.span_start}-{data.detection.span_end} "
+                f"confidence={data.detection.confidence:.0%} "
+                f"temps(L/C/R)=("
+                f"{data.analysis.left.avg:.1f}/"
+                f"{data.analysis.centre.avg:.1f}/"
+                f"{data.analysis.right.avg:.1f}°C)"
+            )
+    except KeyboardInterrupt:
+        stats = scheduler.get_stats()
+        print(f"\nAggregate: {stats['aggregate_fps']:.1f} fps")
 
 
 if __name__ == "__main__":
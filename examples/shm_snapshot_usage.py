@@ -0,0 +1,53 @@
+"""
+Example following every Pico's latest records through the host daemon.
+
+Start the daemon first, for example:
+
+    thermal_tyre_daemon FL=/dev/ttyACM0 FR=/dev/ttyACM1
+
+This script only maps the daemon's shared memory, so any number of copies
+can run alongside dashboards and loggers without opening a serial port.
+"""
+
+from datetime import datetime
+
+from thermal_tyre_driver import SnapshotReader
+
+
+def main() -> None:
+    try:
+        snap = SnapshotReader()
+    except FileNotFoundError:
+        print("No snapshot segment found - is thermal_tyre_daemon running?")
+        return
+
+    with snap:
+        print(f"Devices: {', '.join(snap.names)}")
+        last_seq = [0] * len(snap.names)
+        generation = snap.generation
+
+        try:
+            while snap.live:
+                generation = snap.wait(generation, timeout=1.0)
+                for i, name in enumerate(snap.names):
+                    seq, record = snap.latest(i)
+                    if record is None or seq == last_seq[i]:
+                        continue
+                    last_seq[i] = seq
+                    print(
+                        f"[{datetime.now().strftime('%H:%M:%S.%f')[:-3]}] {name:>4} "
+                        f"frame {int(record['frame_number']):6d}  "
+                        f"L {float(record['left']['median']):5.1f}  "
+                        f"C {float(record['centre']['median']):5.1f}  "
+                        f"R {float(record['right']['median']):5.1f}  "
+                        f"{'tyre' if record['detected'] else 'no tyre'}"
+                    )
+        except KeyboardInterrupt:
+            pass
+
+        if not snap.live:
+            print("Daemon stopped")
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,191 @@
+/**
+ * column_classifier.c
+ * Constant-cost tyre detection with a quantised per-column classifier
+ */
+
+#include "column_classifier.h"
+#include "column_mask.h"
+#include <math.h>
+
+_Static_assert(SENSOR_WIDTH == 32, "the sorting network is for 32 columns");
+
+// Temperatures are clamped to ±409.5°C so the feature products fit 32 bits
+#define TENTHS_LIMIT 4095
+
+// Columns either side for the local contrast feature
+#define CONTRAST_REACH 3
+
+static inline int32_t clamp_tenths(int32_t x) {
+    if (x > TENTHS_LIMIT) return TENTHS_LIMIT;
+    if (x < -TENTHS_LIMIT) return -TENTHS_LIMIT;
+    return x;
+}
+
+static inline int8_t saturate_int8(int32_t x) {
+    if (x > 127) return 127;
+    if (x < -127) return -127;
+    return (int8_t)x;
+}
+
+// Branch-free compare-exchange: afterwards *a <= *b
+static inline void sort_pair(int32_t *a, int32_t *b) {
+    int32_t d = *b - *a;
+    int32_t m = d >> 31;
+    *a += d & m;
+    *b -= d & m;
+}
+
+// Batcher odd-even merge sort of 32 values as a list of compare-exchange
+// pairs. The pairs depend only on the indices, so the cost is the same
+// for any data.
+#define SORT_PAIRS 191
+
+static const uint8_t sort_pairs[SORT_PAIRS][2] = {
+    {0, 1}, {2, 3}, {4, 5}, {6, 7}, {8, 9}, {10, 11}, {12, 13}, {14, 15},
+    {16, 17}, {18, 19}, {20, 21}, {22, 23}, {24, 25}, {26, 27}, {28, 29}, {30, 31},
+    {0, 2}, {1, 3}, {4, 6}, {5, 7}, {8, 10}, {9, 11}, {12, 14}, {13, 15},
+    {16, 18}, {17, 19}, {20, 22}, {21, 23}, {24, 26}, {25, 27}, {28, 30}, {29, 31},
+    {1, 2}, {5, 6}, {9, 10}, {13, 14}, {17, 18}, {21, 22}, {25, 26}, {29, 30},
+    {0, 4}, {1, 5}, {2, 6}, {3, 7}, {8, 12}, {9, 13}, {10, 14}, {11, 15},
+    {16, 20}, {17, 21}, {18, 22}, {19, 23}, {24, 28}, {25, 29}, {26, 30}, {27, 31},
+    {2, 4}, {3, 5}, {10, 12}, {11, 13}, {18, 20}, {19, 21}, {26, 28}, {27, 29},
+    {1, 2}, {3, 4}, {5, 6}, {9, 10}, {11, 12}, {13, 14}, {17, 18}, {19, 20},
+    {21, 22}, {25, 26}, {27, 28}, {29, 30}, {0, 8}, {1, 9}, {2, 10}, {3, 11},
+    {4, 12}, {5, 13}, {6, 14}, {7, 15}, {16, 24}, {17, 25}, {18, 26}, {19, 27},
+    {20, 28}, {21, 29}, {22, 30}, {23, 31}, {4, 8}, {5, 9}, {6, 10}, {7, 11},
+    {20, 24}, {21, 25}, {22, 26}, {23, 27}, {2, 4}, {3, 5}, {6, 8}, {7, 9},
+    {10, 12}, {11, 13}, {18, 20}, {19, 21}, {22, 24}, {23, 25}, {26, 28}, {27, 29},
+    {1, 2}, {3, 4}, {5, 6}, {7, 8}, {9, 10}, {11, 12}, {13, 14}, {17, 18},
+    {19, 20}, {21, 22}, {23, 24}, {25, 26}, {27, 28}, {29, 30}, {0, 16}, {1, 17},
+    {2, 18}, {3, 19}, {4, 20}, {5, 21}, {6, 22}, {7, 23}, {8, 24}, {9, 25},
+    {10, 26}, {11, 27}, {12, 28}, {13, 29}, {14, 30}, {15, 31}, {8, 16}, {9, 17},
+    {10, 18}, {11, 19}, {12, 20}, {13, 21}, {14, 22}, {15, 23}, {4, 8}, {5, 9},
+    {6, 10}, {7, 11}, {12, 16}, {13, 17}, {14, 18}, {15, 19}, {20, 24}, {21, 25},
+    {22, 26}, {23, 27}, {2, 4}, {3, 5}, {6, 8}, {7, 9}, {10, 12}, {11, 13},
+    {14, 16}, {15, 17}, {18, 20}, {19, 21}, {22, 24}, {23, 25}, {26, 28}, {27, 29},
+    {1, 2}, {3, 4}, {5, 6}, {7, 8}, {9, 10}, {11, 12}, {13, 14}, {15, 16},
+    {17, 18}, {19, 20}, {21, 22}, {23, 24}, {25, 26}, {27, 28}, {29, 30},
+};
+
+static void sort_network(int32_t *v) {
+    for (int i = 0; i < SORT_PAIRS; i++) {
+        sort_pair(&v[sort_pairs[i][0]], &v[sort_pairs[i][1]]);
+    }
+}
+
+void column_classifier_features(const float *profile, ColumnFeatures *features) {
+    int32_t q[SENSOR_WIDTH];
+    int32_t sorted[SENSOR_WIDTH];
+    uint32_t valid = 0;
+
+    for (int i = 0; i < SENSOR_WIDTH; i++) {
+        float t = profile[i];
+        bool ok = isfinite(t);
+        valid |= (uint32_t)ok << i;
+        q[i] = ok ? clamp_tenths((int32_t)lrintf(fmaxf(fminf(t, 1000.0f), -1000.0f) * 10.0f)) : 0;
+        sorted[i] = q[i];
+    }
+
+    // Median and MAD (scaled by 1.4826 ~ 95/64 like fast_mad)
+    sort_network(sorted);
+    int32_t median = (sorted[SENSOR_WIDTH / 2 - 1] + sorted[SENSOR_WIDTH / 2]) / 2;
+    int32_t hottest = sorted[SENSOR_WIDTH - 1];
+    for (int i = 0; i < SENSOR_WIDTH; i++) {
+        int32_t d = q[i] - median;
+        sorted[i] = d < 0 ? -d : d;
+    }
+    sort_network(sorted);
+    int32_t mad = ((sorted[SENSOR_WIDTH / 2 - 1] + sorted[SENSOR_WIDTH / 2]) * 95) >> 7;
+
+    features->valid = valid;
+    features->median = (int16_t)median;
+    features->mad = (int16_t)mad;
+
+    // (x * inv) >> 16 = x * CLASSIFIER_FEATURE_SCALE / mad
+    int32_t inv = (CLASSIFIER_FEATURE_SCALE << 16) / (mad > CLASSIFIER_MIN_MAD ? mad : CLASSIFIER_MIN_MAD);
+
+    // Edge columns repeated for the neighbour features
+    int32_t padded[SENSOR_WIDTH + 2 * CONTRAST_REACH];
+    for (int i = 0; i < SENSOR_WIDTH + 2 * CONTRAST_REACH; i++) {
+        int c = i - CONTRAST_REACH;
+        padded[i] = q[c < 0 ? 0 : (c >= SENSOR_WIDTH ? SENSOR_WIDTH - 1 : c)];
+    }
+
+    for (int i = 0; i < SENSOR_WIDTH; i++) {
+        const int32_t *p = &padded[i + CONTRAST_REACH];
+        int32_t contrast = p[0] - (p[-CONTRAST_REACH] + p[CONTRAST_REACH]) / 2;
+        int32_t gradient = p[1] - p[-1];
+        gradient = (gradient < 0 ? -gradient : gradient) / 2;
+
+        int8_t *f = features->f[i];
+        f[0] = saturate_int8((clamp_tenths(q[i] - median) * inv) >> 16);
+        f[1] = saturate_int8((clamp_tenths(contrast) * inv) >> 16);
+        f[2] = saturate_int8((clamp_tenths(gradient) * inv) >> 16);
+        f[3] = saturate_int8((clamp_tenths(q[i] - hottest) * inv) >> 16);
+    }
+}
+
+uint32_t column_classifier_mask(const ColumnFeatures *features, const ColumnClassifierModel *model,
+                                int32_t *scores, int *seed) {
+    uint32_t mask = 0;
+    int32_t best = INT32_MIN;
+    int best_col = SENSOR_WIDTH / 2;
+
+    for (int i = 0; i < SENSOR_WIDTH; i++) {
+        const int8_t *f = features->f[i];
+        int32_t out = model->b2;
+        for (int j = 0; j < CLASSIFIER_HIDDEN; j++) {
+            int32_t acc = model->b1[j];
+            for (int k = 0; k < CLASSIFIER_FEATURES; k++) {
+                acc += model->w1[j][k] * f[k];
+            }
+            out += model->w2[j] * (acc > 0 ? acc : 0);
+        }
+
+        if (!(features->valid >> i & 1)) out = INT32_MIN;
+        mask |= (uint32_t)(out > 0) << i;
+        if (out > best) {
+            best = out;
+            best_col = i;
+        }
+        if (scores) scores[i] = out;
+    }
+
+    *seed = best_col;
+    return mask;
+}
+
+void column_classifier_detect(const float *profile, TyreDetection *detection,
+                              const ThermalConfig *config, const ColumnClassifierModel *model) {
+    ColumnFeatures features;
+    column_classifier_features(profile, &features);
+
+    int seed;
+    uint32_t mask = column_classifier_mask(&features, model, NULL, &seed);
+
+    int start;
+    int end;
+    column_mask_span(mask, seed, model->max_gap, &start, &end);
+    int width = end - start + 1;
+
+    detection->detected = ((mask >> seed) & 1) &&
+                          width >= config->min_tyre_width &&
+                          width <= config->max_tyre_width &&
+                          features.mad > CLASSIFIER_MIN_MAD;
+
+    if (detection->detected) {
+        detection->span_start = start;
+        detection->span_end = end;
+        detection->tyre_width = width;
+
+        // Same confidence as the region grower
+        float width_score = (width >= 8 && width <= 24) ? 1.0f : 0.7f;
+        float mad_score = fminf(features.mad / 30.0f, 1.0f);
+        detection->confidence = width_score * mad_score;
+    } else {
+        detection->span_start = 0;
+        detection->span_end = SENSOR_WIDTH - 1;
+        detection->tyre_width = SENSOR_WIDTH;
+        detection->confidence = 0.0f;
+    }
+}
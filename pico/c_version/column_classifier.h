@@ -0,0 +1,70 @@
+/**
+ * column_classifier.h
+ * Constant-cost tyre detection with a quantised per-column classifier
+ *
+ * An alternative to region growing (DETECT_ENGINE_CLASSIFIER). The
+ * profile is converted to integer tenths of a degree once. Every column
+ * then gets four int8 features in units of MAD/16:
+ *
+ *   0  deviation from the profile median
+ *   1  local contrast: the column less the mean of the columns 3 either side
+ *   2  gradient: half the difference of its two neighbours
+ *   3  distance below the hottest column
+ *
+ * A 4-8-1 int8 network with a ReLU hidden layer scores each column, and
+ * columns scoring above zero form a 32-bit mask (column_mask.h). The span
+ * grows from the best-scoring column across gaps of up to max_gap columns.
+ * Median and MAD come from a sorting network, so every loop has a fixed
+ * trip count and no step depends on the data beyond a compare. The cost
+ * is the same on every frame, unlike the region grower's sort and walk.
+ *
+ * Weights are trained on the host (host/train_column_classifier) and
+ * written to column_classifier_model.c.
+ */
+
+#ifndef COLUMN_CLASSIFIER_H
+#define COLUMN_CLASSIFIER_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "thermal_algorithm.h"
+
+#define CLASSIFIER_FEATURES 4
+#define CLASSIFIER_HIDDEN 8
+
+// Feature units per MAD, and the MAD floor in tenths of a degree (the
+// region grower also needs a 0.5°C MAD to detect)
+#define CLASSIFIER_FEATURE_SCALE 16
+#define CLASSIFIER_MIN_MAD 5
+
+typedef struct {
+    int8_t w1[CLASSIFIER_HIDDEN][CLASSIFIER_FEATURES];
+    int32_t b1[CLASSIFIER_HIDDEN];
+    int8_t w2[CLASSIFIER_HIDDEN];
+    int32_t b2;
+    uint8_t max_gap;            // Unclassified columns bridged inside a span
+} ColumnClassifierModel;
+
+// Trained weights (column_classifier_model.c)
+extern const ColumnClassifierModel column_classifier_default_model;
+
+typedef struct {
+    int8_t f[SENSOR_WIDTH][CLASSIFIER_FEATURES];
+    uint32_t valid;             // Columns with a finite temperature
+    int16_t median;             // Tenths °C
+    int16_t mad;                // Tenths °C, before the floor
+} ColumnFeatures;
+
+// Features of every column
+void column_classifier_features(const float *profile, ColumnFeatures *features);
+
+// Score every column; bit i of the result is set when column i scores
+// above zero. *seed is the best-scoring column. scores may be NULL.
+uint32_t column_classifier_mask(const ColumnFeatures *features, const ColumnClassifierModel *model,
+                                int32_t *scores, int *seed);
+
+// Detection with the same validation and confidence as the region grower
+void column_classifier_detect(const float *profile, TyreDetection *detection,
+                              const ThermalConfig *config, const ColumnClassifierModel *model);
+
+#endif // COLUMN_CLASSIFIER_H
@@ -0,0 +1,26 @@
+/**
+ * column_classifier_model.c
+ * Column classifier weights, generated by host/train_column_classifier
+ *
+ * Trained on 20000 synthetic profiles (seed 1).
+ * Held out: 78.4% detection agreement, span IoU 0.899.
+ */
+
+#include "column_classifier.h"
+
+const ColumnClassifierModel column_classifier_default_model = {
+    .w1 = {
+        {-127, 6, -5, -8},
+        {-40, -19, -8, -16},
+        {-34, 28, -1, -5},
+        {44, -80, 41, 16},
+        {-123, 8, -7, 67},
+        {-24, -20, 5, -51},
+        {61, -81, 19, -23},
+        {-1, -1, -10, 18},
+    },
+    .b1 = {-1652, -668, 1206, 2, 749, -627, -1702, -61},
+    .w2 = {111, -42, -33, -40, -127, -63, 54, -25},
+    .b2 = 129282,
+    .max_gap = 3,
+};
@@ -0,0 +1,135 @@
+/**
+ * column_mask.h
+ * 32-bit column masks for span detection
+ *
+ * The profile is 32 columns wide, so a per-column test fits in one word:
+ * bit i is set when column i passes. Growing a region from a seed then
+ * becomes a few shifts and a clz/ctz on each side instead of a loop with
+ * a branch per column. A comparison with NaN is false, so a NaN column
+ * never passes, as it didn't in the loops.
+ *
+ * On the RP2040 (Cortex-M0+, no CLZ instruction) the SDK's bit ops
+ * supply __builtin_clz/ctz from ROM-accelerated helpers.
+ */
+
+#ifndef COLUMN_MASK_H
+#define COLUMN_MASK_H
+
+#include <stdint.h>
+#include <math.h>
+
+#define COLUMN_MASK_BITS 32
+
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define COLUMN_MASK_SSE2 1
+#endif
+
+#if defined(COLUMN_MASK_SSE2)
+// Host builds: four columns per compare, movemask packs the lanes into
+// bits. Same IEEE comparisons as the scalar loops, NaN lanes included.
+static inline uint32_t column_mask_lanes(__m128 pass, int i) {
+    return (uint32_t)_mm_movemask_ps(pass) << i;
+}
+#endif
+
+// Columns with profile[i] > threshold
+static inline uint32_t column_mask_above(const float *profile, float threshold) {
+    uint32_t mask = 0;
+#if defined(COLUMN_MASK_SSE2)
+    __m128 t = _mm_set1_ps(threshold);
+    for (int i = 0; i < COLUMN_MASK_BITS; i += 4) {
+        mask |= column_mask_lanes(_mm_cmpgt_ps(_mm_loadu_ps(profile + i), t), i);
+    }
+#else
+    for (int i = 0; i < COLUMN_MASK_BITS; i++) {
+        mask |= (uint32_t)(profile[i] > threshold) << i;
+    }
+#endif
+    return mask;
+}
+
+// Columns with profile[i] >= threshold
+static inline uint32_t column_mask_at_least(const float *profile, float threshold) {
+    uint32_t mask = 0;
+#if defined(COLUMN_MASK_SSE2)
+    __m128 t = _mm_set1_ps(threshold);
+    for (int i = 0; i < COLUMN_MASK_BITS; i += 4) {
+        mask |= column_mask_lanes(_mm_cmpge_ps(_mm_loadu_ps(profile + i), t), i);
+    }
+#else
+    for (int i = 0; i < COLUMN_MASK_BITS; i++) {
+        mask |= (uint32_t)(profile[i] >= threshold) << i;
+    }
+#endif
+    return mask;
+}
+
+// Columns with profile[i] <= threshold
+static inline uint32_t column_mask_at_most(const float *profile, float threshold) {
+    uint32_t mask = 0;
+#if defined(COLUMN_MASK_SSE2)
+    __m128 t = _mm_set1_ps(threshold);
+    for (int i = 0; i < COLUMN_MASK_BITS; i += 4) {
+        mask |= column_mask_lanes(_mm_cmple_ps(_mm_loadu_ps(profile + i), t), i);
+    }
+#else
+    for (int i = 0; i < COLUMN_MASK_BITS; i++) {
+        mask |= (uint32_t)(profile[i] <= threshold) << i;
+    }
+#endif
+    return mask;
+}
+
+// Columns with |profile[i] - centre| <= k
+static inline uint32_t column_mask_within(const float *profile, float centre, float k) {
+    uint32_t mask = 0;
+#if defined(COLUMN_MASK_SSE2)
+    __m128 c = _mm_set1_ps(centre);
+    __m128 kk = _mm_set1_ps(k);
+    __m128 sign = _mm_set1_ps(-0.0f);
+    for (int i = 0; i < COLUMN_MASK_BITS; i += 4) {
+        __m128 dist = _mm_andnot_ps(sign, _mm_sub_ps(_mm_loadu_ps(profile + i), c));
+        mask |= column_mask_lanes(_mm_cmple_ps(dist, kk), i);
+    }
+#else
+    for (int i = 0; i < COLUMN_MASK_BITS; i++) {
+        mask |= (uint32_t)(fabsf(profile[i] - centre) <= k) << i;
+    }
+#endif
+    return mask;
+}
+
+// Span [*start, *end] grown from seed over set columns. The seed itself
+// always counts. Runs of up to max_gap clear columns are bridged when a
+// set column follows; max_gap + 1 clear columns in a row end the span.
+// Same result as walking out from the seed with a fail counter that
+// breaks when it exceeds max_gap.
+static inline void column_mask_span(uint32_t mask, int seed, int max_gap, int *start, int *end) {
+    uint32_t set = mask | (1u << seed);
+    uint32_t clear = ~set;
+
+    // Bit i of gap_up: columns i..i+max_gap all clear. Bit i of
+    // gap_down: columns i-max_gap..i all clear. Columns past either edge
+    // shift in as set, so a gap running off the edge never ends the span
+    // early (nothing beyond it could be added anyway).
+    uint32_t gap_up = clear;
+    uint32_t gap_down = clear;
+    for (int k = 1; k <= max_gap; k++) {
+        gap_up &= clear >> k;
+        gap_down &= clear << k;
+    }
+
+    // Right: the nearest gap starting above the seed ends the span, which
+    // runs to the last set column before it
+    uint32_t breaks = gap_up & ~((2u << seed) - 1);
+    uint32_t keep = breaks ? (1u << __builtin_ctz(breaks)) - 1 : ~0u;
+    *end = 31 - __builtin_clz(set & keep);
+
+    // Left: mirror image, from the nearest gap ending below the seed
+    breaks = gap_down & ((1u << seed) - 1);
+    keep = breaks ? ~((2u << (31 - __builtin_clz(breaks))) - 1) : ~0u;
+    *start = __builtin_ctz(set & keep);
+}
+
+#endif // COLUMN_MASK_H
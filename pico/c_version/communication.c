@@ -8,6 +8,8 @@
 #include <string.h>
 #include <math.h>
 #include "pico/stdlib.h"
+#include "frame_codec.h"
+#include "serial_mux.h"
 
 // I2C peripheral register storage (for future I2C slave implementation)
 static uint8_t i2c_registers[16];
@@ -70,7 +72,16 @@ void send_serial_compact(const FrameData *data, float fps) {
     fflush(stdout);
 }
 
-void send_serial_json(const FrameData *data, float fps, const float *temperature_profile) {
+static void print_histogram_counts(const char *zone, const uint16_t *counts, int bins, bool last) {
+    printf("\"%s\": [", zone);
+    for (int b = 0; b < bins; b++) {
+        printf(b + 1 < bins ? "%u, " : "%u", counts[b]);
+    }
+    printf(last ? "]" : "], ");
+}
+
+void send_serial_json(const FrameData *data, float fps, const float *temperature_profile,
+                      const ZoneHistograms *histograms) {
     // Full JSON output matching visualizer expectations
     printf("{\n");
     printf("  \"frame_number\": %lu,\n", data->frame_number);
@@ -122,11 +133,78 @@ void send_serial_json(const FrameData *data, float fps, const float *temperature
         printf("  \"temperature_profile\": [],\n");
     }
 
-    printf("  \"warnings\": []\n");
+    if (histograms != NULL && histograms->config.bins > 0) {
+        const ZoneHistogramConfig *hc = &histograms->config;
+        printf("  \"warnings\": [],\n");
+        printf("  \"histograms\": {\"min\": %.1f, \"bin_width\": %.1f, ",
+               hc->min_tenths / 10.0f, hc->bin_width_tenths / 10.0f);
+        print_histogram_counts("left", histograms->counts[0], hc->bins, false);
+        print_histogram_counts("centre", histograms->counts[1], hc->bins, false);
+        print_histogram_counts("right", histograms->counts[2], hc->bins, true);
+        printf("}\n");
+    } else {
+        printf("  \"warnings\": []\n");
+    }
     printf("}\n");
     fflush(stdout);
 }
 
+// Print prefix and base64 of packet as one line. Returns bytes written.
+static uint16_t send_base64_line(const char *prefix, const uint8_t *packet, uint16_t len) {
+    static const char alphabet[] =
+        "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+    static char line[4 + ((FRAME_CODEC_MAX_BYTES + 2) / 3) * 4 + 2];
+
+    if (len > FRAME_CODEC_MAX_BYTES) return 0;
+
+    uint16_t n = (uint16_t)strlen(prefix);
+    memcpy(line, prefix, n);
+    for (uint16_t i = 0; i < len; i += 3) {
+        uint32_t v = (uint32_t)packet[i] << 16;
+        if (i + 1 < len) v |= (uint32_t)packet[i + 1] << 8;
+        if (i + 2 < len) v |= packet[i + 2];
+        line[n++] = alphabet[(v >> 18) & 0x3F];
+        line[n++] = alphabet[(v >> 12) & 0x3F];
+        line[n++] = (i + 1 < len) ? alphabet[(v >> 6) & 0x3F] : '=';
+        line[n++] = (i + 2 < len) ? alphabet[v & 0x3F] : '=';
+    }
+    line[n++] = '\n';
+
+    fwrite(line, 1, n, stdout);
+    fflush(stdout);
+    return n;
+}
+
+uint16_t send_serial_image(const uint8_t *packet, uint16_t len) {
+    return send_base64_line("IMG:", packet, len);
+}
+
+uint16_t send_serial_histograms(const ZoneHistograms *histograms) {
+    static uint8_t packet[ZONE_HIST_MAX_BYTES];
+
+    uint16_t len = zone_histogram_pack(histograms, packet, sizeof(packet));
+    return (len > 0) ? send_base64_line("HST:", packet, len) : 0;
+}
+
+void send_binary_frame(const FrameData *data, float fps) {
+    uint8_t payload[MUX_FRAME_BYTES];
+    mux_pack_frame(data, fps, payload);
+    serial_mux_send(MUX_CHANNEL_DATA, MUX_DATA_FRAME, payload, sizeof(payload));
+}
+
+uint16_t send_binary_image(const uint8_t *packet, uint16_t len) {
+    if (!serial_mux_send(MUX_CHANNEL_DATA, MUX_DATA_IMAGE, packet, len)) return 0;
+    return len + MUX_OVERHEAD;
+}
+
+uint16_t send_binary_histograms(const ZoneHistograms *histograms) {
+    static uint8_t packet[ZONE_HIST_MAX_BYTES];
+
+    uint16_t len = zone_histogram_pack(histograms, packet, sizeof(packet));
+    if (len == 0 || !serial_mux_send(MUX_CHANNEL_DATA, MUX_DATA_HISTOGRAMS, packet, len)) return 0;
+    return len + MUX_OVERHEAD;
+}
+
 void update_i2c_registers(const FrameData *data) {
     // Pack data into I2C registers (int16 tenths of degree C)
     // Register map (same as CircuitPython version):
@@ -7,6 +7,7 @@
 #define COMMUNICATION_H
 
 #include "thermal_algorithm.h"
+#include "zone_histogram.h"
 #include <stdint.h>
 #include <stdbool.h>
 
@@ -17,8 +18,25 @@ void communication_init(void);
 // CSV format: Frame,FPS,L_avg,L_med,C_avg,C_med,R_avg,R_med,Width,Conf,Det
 void send_serial_compact(const FrameData *data, float fps);
 
-// Send frame data over serial (full JSON format)
-void send_serial_json(const FrameData *data, float fps, const float *temperature_profile);
+// Send frame data over serial (full JSON format). histograms may be NULL
+// (or have no bins) to leave out the "histograms" object.
+void send_serial_json(const FrameData *data, float fps, const float *temperature_profile,
+                      const ZoneHistograms *histograms);
+
+// Send an encoded image packet (frame_codec) over serial as one line:
+// IMG:<base64>. Returns the number of bytes written, including the newline.
+uint16_t send_serial_image(const uint8_t *packet, uint16_t len);
+
+// Send packed zone histograms (zone_histogram_pack) as one line:
+// HST:<base64>. Returns the number of bytes written, including the newline.
+uint16_t send_serial_histograms(const ZoneHistograms *histograms);
+
+// Binary output (OUTPUT_MODE_USB_BINARY): queue the same data on the
+// serial_mux data channel. The image and histogram senders return the
+// bytes queued, including framing, or 0 if the queue was full.
+void send_binary_frame(const FrameData *data, float fps);
+uint16_t send_binary_image(const uint8_t *packet, uint16_t len);
+uint16_t send_binary_histograms(const ZoneHistograms *histograms);
 
 // Update I2C peripheral registers with latest data
 void update_i2c_registers(const FrameData *data);
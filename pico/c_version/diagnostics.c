@@ -0,0 +1,161 @@
+/**
+ * diagnostics.c
+ * Runtime diagnostics: text lines or binary events on the serial link
+ */
+
+#include "diagnostics.h"
+#include <stdio.h>
+#include "rate_controller.h"
+#include "serial_mux.h"
+
+// Largest trace payload: the stage table with short names
+#define TRACE_BYTES 256
+
+static uint8_t percent(float fraction) {
+    if (!(fraction > 0.0f)) return 0;
+    if (fraction >= 1.0f) return 100;
+    return (uint8_t)(fraction * 100.0f + 0.5f);
+}
+
+static uint16_t tenths(float value) {
+    if (!(value > 0.0f)) return 0;
+    if (value >= 6553.5f) return UINT16_MAX;
+    return (uint16_t)(value * 10.0f + 0.5f);
+}
+
+void diag_frame_timing(uint32_t frame, uint32_t total_us, uint32_t sensor_us, uint32_t calc_us,
+                       uint32_t algo_us, uint32_t comm_us) {
+    if (serial_mux_active()) {
+        uint8_t p[24];
+        mux_put_u32(p, frame);
+        mux_put_u32(p + 4, total_us);
+        mux_put_u32(p + 8, sensor_us);
+        mux_put_u32(p + 12, calc_us);
+        mux_put_u32(p + 16, algo_us);
+        mux_put_u32(p + 20, comm_us);
+        serial_mux_send(MUX_CHANNEL_DIAG, MUX_DIAG_FRAME_TIMING, p, sizeof(p));
+        return;
+    }
+
+    printf("[Frame %lu] Total: %.1fms (%.1f fps) | "
+           "Sensor: %.1fms | Calc: %.1fms | Algo: %.1fms | Comm: %.1fms\n",
+           (unsigned long)frame, total_us / 1000.0f, total_us ? 1000000.0f / total_us : 0.0f,
+           sensor_us / 1000.0f, calc_us / 1000.0f, algo_us / 1000.0f, comm_us / 1000.0f);
+}
+
+void diag_error(MuxError code, int32_t value) {
+    if (serial_mux_active()) {
+        uint8_t p[5];
+        p[0] = (uint8_t)code;
+        mux_put_u32(p + 1, (uint32_t)value);
+        serial_mux_send(MUX_CHANNEL_DIAG, MUX_DIAG_ERROR, p, sizeof(p));
+        return;
+    }
+
+    switch (code) {
+        case MUX_ERROR_FRAME_READ:
+            printf("ERROR: Frame read failed (code %ld)\n", (long)value);
+            break;
+        case MUX_ERROR_FRAME_POOL:
+            printf("ERROR: Frame pool exhausted (%lu total)\n", (unsigned long)value);
+            break;
+        case MUX_ERROR_CONTROL_WRITE:
+            printf("ERROR: Control register write failed\n");
+            break;
+    }
+    fflush(stdout);
+}
+
+void diag_rate_change(uint8_t old_rate, uint8_t new_rate) {
+    if (serial_mux_active()) {
+        uint8_t p[2] = {old_rate, new_rate};
+        serial_mux_send(MUX_CHANNEL_DIAG, MUX_DIAG_RATE_CHANGE, p, sizeof(p));
+        return;
+    }
+
+    printf("Refresh rate: %gHz -> %gHz\n", rate_controller_rate_hz(old_rate),
+           rate_controller_rate_hz(new_rate));
+}
+
+void diag_pixel_health(const PixelHealthStats *stats) {
+    if (serial_mux_active()) {
+        uint8_t p[8];
+        mux_put_u16(p, stats->flagged);
+        mux_put_u16(p + 2, stats->stuck);
+        mux_put_u16(p + 4, stats->noisy);
+        mux_put_u16(p + 6, stats->dead);
+        serial_mux_send(MUX_CHANNEL_DIAG, MUX_DIAG_PIXEL_HEALTH, p, sizeof(p));
+        return;
+    }
+
+    printf("Pixel health: %u flagged (stuck %u, noisy %u, dead %u)\n",
+           stats->flagged, stats->stuck, stats->noisy, stats->dead);
+}
+
+void diag_detect_cycles(uint8_t engine, uint32_t last, uint32_t min, uint32_t max) {
+    if (serial_mux_active()) {
+        uint8_t p[13];
+        p[0] = engine;
+        mux_put_u32(p + 1, last);
+        mux_put_u32(p + 5, min);
+        mux_put_u32(p + 9, max);
+        serial_mux_send(MUX_CHANNEL_DIAG, MUX_DIAG_DETECT_CYCLES, p, sizeof(p));
+        return;
+    }
+
+    printf("[Detect] %s: %lu cycles (min %lu, max %lu)\n",
+           engine == DETECT_ENGINE_CLASSIFIER ? "classifier" : "region",
+           (unsigned long)last, (unsigned long)min, (unsigned long)max);
+}
+
+void diag_shadow(const ShadowStats *s) {
+    if (serial_mux_active()) {
+        uint8_t p[MUX_SHADOW_BYTES];
+        mux_put_u16(p, s->compared > UINT16_MAX ? UINT16_MAX : (uint16_t)s->compared);
+        mux_put_u16(p + 2, s->dropped > UINT16_MAX ? UINT16_MAX : (uint16_t)s->dropped);
+        p[4] = percent(s->detection_agreement);
+        p[5] = percent(s->mean_iou);
+        mux_put_u16(p + 6, s->production_only > UINT16_MAX ? UINT16_MAX : (uint16_t)s->production_only);
+        mux_put_u16(p + 8, s->candidate_only > UINT16_MAX ? UINT16_MAX : (uint16_t)s->candidate_only);
+        for (int z = 0; z < 3; z++) {
+            mux_put_u16(p + 10 + 2 * z, tenths(s->zone_delta_mean[z]));
+        }
+        mux_put_u16(p + 16, tenths(s->zone_delta_max));
+        p[18] = percent(s->production_confidence);
+        p[19] = percent(s->candidate_confidence);
+        mux_put_u32(p + 20, s->last_us);
+        mux_put_u32(p + 24, s->max_us);
+        serial_mux_send(MUX_CHANNEL_DIAG, MUX_DIAG_SHADOW, p, sizeof(p));
+        return;
+    }
+
+    printf("[Shadow] compared %lu (dropped %lu) | agree %.0f%% (prod only %lu, cand only %lu) | "
+           "IoU %.2f | zone delta %.1f/%.1f/%.1f max %.1fC | conf %.2f/%.2f | core1 %.2f/%.2fms\n",
+           (unsigned long)s->compared, (unsigned long)s->dropped, s->detection_agreement * 100.0f,
+           (unsigned long)s->production_only, (unsigned long)s->candidate_only, s->mean_iou,
+           s->zone_delta_mean[0], s->zone_delta_mean[1], s->zone_delta_mean[2], s->zone_delta_max,
+           s->production_confidence, s->candidate_confidence, s->last_us / 1000.0f, s->max_us / 1000.0f);
+}
+
+void diag_pipeline(Pipeline *pipe) {
+    if (serial_mux_active()) {
+        static uint8_t p[TRACE_BYTES];
+        uint16_t len = pipeline_pack_stats(pipe, p, sizeof(p));
+        if (len > 0) serial_mux_send(MUX_CHANNEL_TRACE, MUX_TRACE_PIPELINE, p, len);
+        return;
+    }
+
+    pipeline_print_stats(pipe);
+}
+
+void diag_drops(void) {
+    if (!serial_mux_active()) return;
+
+    uint32_t drops[MUX_CHANNELS];
+    uint8_t p[4 * MUX_CHANNELS];
+    serial_mux_get_drops(drops);
+    for (int i = 0; i < MUX_CHANNELS; i++) {
+        mux_put_u32(p + 4 * i, drops[i]);
+    }
+    serial_mux_send(MUX_CHANNEL_DIAG, MUX_DIAG_DROPS, p, sizeof(p));
+}
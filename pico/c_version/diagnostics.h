@@ -0,0 +1,42 @@
+/**
+ * diagnostics.h
+ * Runtime diagnostics: text lines or binary events on the serial link
+ *
+ * Each report prints its usual text line, or in OUTPUT_MODE_USB_BINARY
+ * queues a binary event (mux_protocol.h) on the diagnostics or trace
+ * channel instead; the host tools format those back into the same text.
+ */
+
+#ifndef DIAGNOSTICS_H
+#define DIAGNOSTICS_H
+
+#include <stdint.h>
+#include "mux_protocol.h"
+#include "pipeline.h"
+#include "pixel_health.h"
+#include "shadow_eval.h"
+
+// [Frame N] timing breakdown, all in µs
+void diag_frame_timing(uint32_t frame, uint32_t total_us, uint32_t sensor_us, uint32_t calc_us,
+                       uint32_t algo_us, uint32_t comm_us);
+
+// ERROR: lines (MuxError), value as documented there
+void diag_error(MuxError code, int32_t value);
+
+// Sensor refresh rate change (MLX rate codes)
+void diag_rate_change(uint8_t old_rate, uint8_t new_rate);
+
+void diag_pixel_health(const PixelHealthStats *stats);
+
+// Span detection cost in CPU cycles for the engine (DETECT_ENGINE_*)
+void diag_detect_cycles(uint8_t engine, uint32_t last, uint32_t min, uint32_t max);
+
+void diag_shadow(const ShadowStats *stats);
+
+// Per-stage pipeline statistics; resets the stage max times
+void diag_pipeline(Pipeline *pipe);
+
+// Messages dropped per channel (binary mode only, nothing in text mode)
+void diag_drops(void);
+
+#endif // DIAGNOSTICS_H
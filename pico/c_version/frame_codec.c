@@ -0,0 +1,367 @@
+/**
+ * frame_codec.c
+ * Lossy full-frame codec for low-bitrate telemetry links
+ */
+
+#include "frame_codec.h"
+#include <string.h>
+
+#define LEVELS 3
+#define TENTHS_MIN -400
+#define TENTHS_MAX 3000
+
+// Detail quantiser step (tenths) per quality index; the LL band uses half
+// and the tyre span half again. The road behind the tyre is smooth, so
+// steps beyond these save next to nothing; the rate controller sends
+// fewer frames instead.
+static const uint8_t quality_step[FRAME_CODEC_QUALITY_LEVELS] = {
+    3, 4, 6, 8, 11, 16
+};
+
+// Largest step over the tyre span for detail levels 1-3, then the LL band.
+// A pixel sums one coefficient of every band, and errors from the coarse
+// bands add up fastest, so they stay near lossless; with these the span
+// keeps within 0.5°C at every quality.
+static const uint8_t roi_max_step[LEVELS + 1] = {3, 3, 1, 1};
+
+// Packet header: version, frame number (LE), quality, roi start, roi end
+
+//------------------------------------------------------------------------------
+// Integer Haar (S-transform) lifting. s = floor((a + b) / 2), d = a - b.
+
+static void haar_forward(int16_t *data, int count, int stride) {
+    int16_t tmp[SENSOR_WIDTH];
+    int half = count / 2;
+    for (int i = 0; i < half; i++) {
+        int a = data[(2 * i) * stride];
+        int b = data[(2 * i + 1) * stride];
+        int d = a - b;
+        tmp[i] = (int16_t)(b + (d >> 1));
+        tmp[half + i] = (int16_t)d;
+    }
+    for (int i = 0; i < count; i++) {
+        data[i * stride] = tmp[i];
+    }
+}
+
+static void haar_inverse(int16_t *data, int count, int stride) {
+    int16_t tmp[SENSOR_WIDTH];
+    int half = count / 2;
+    for (int i = 0; i < half; i++) {
+        int s = data[i * stride];
+        int d = data[(half + i) * stride];
+        int b = s - (d >> 1);
+        tmp[2 * i] = (int16_t)(d + b);
+        tmp[2 * i + 1] = (int16_t)b;
+    }
+    for (int i = 0; i < count; i++) {
+        data[i * stride] = tmp[i];
+    }
+}
+
+static void wavelet_forward(int16_t *img) {
+    int w = SENSOR_WIDTH;
+    int h = SENSOR_HEIGHT;
+    for (int level = 0; level < LEVELS; level++) {
+        for (int y = 0; y < h; y++) haar_forward(&img[y * SENSOR_WIDTH], w, 1);
+        for (int x = 0; x < w; x++) haar_forward(&img[x], h, SENSOR_WIDTH);
+        w /= 2;
+        h /= 2;
+    }
+}
+
+static void wavelet_inverse(int16_t *img) {
+    for (int level = LEVELS - 1; level >= 0; level--) {
+        int w = SENSOR_WIDTH >> level;
+        int h = SENSOR_HEIGHT >> level;
+        for (int x = 0; x < w; x++) haar_inverse(&img[x], h, SENSOR_WIDTH);
+        for (int y = 0; y < h; y++) haar_inverse(&img[y * SENSOR_WIDTH], w, 1);
+    }
+}
+
+//------------------------------------------------------------------------------
+// Coefficient scan: LL band, then detail bands coarsest first. Each entry
+// is a rectangle of the in-place wavelet layout.
+
+typedef struct {
+    uint8_t x, y, w, h;
+    uint8_t level;              // Support is 2^level columns per coefficient
+} Band;
+
+static int build_bands(Band *bands) {
+    int n = 0;
+    int w = SENSOR_WIDTH >> LEVELS;
+    int h = SENSOR_HEIGHT >> LEVELS;
+    bands[n++] = (Band){0, 0, w, h, LEVELS};
+    for (int level = LEVELS; level >= 1; level--) {
+        w = SENSOR_WIDTH >> level;
+        h = SENSOR_HEIGHT >> level;
+        bands[n++] = (Band){w, 0, w, h, level};   // Horizontal detail
+        bands[n++] = (Band){0, h, w, h, level};   // Vertical detail
+        bands[n++] = (Band){w, h, w, h, level};   // Diagonal
+    }
+    return n;
+}
+
+static int coefficient_step(int band, const Band *b, int x, uint8_t quality,
+                            uint8_t roi_start, uint8_t roi_end) {
+    int step = quality_step[quality];
+    if (band == 0) step /= 2;
+
+    if (roi_start != FRAME_CODEC_NO_ROI) {
+        int col0 = (x - b->x) << b->level;
+        int col1 = col0 + (1 << b->level) - 1;
+        if (col1 >= roi_start && col0 <= roi_end) {
+            int cap = roi_max_step[band == 0 ? LEVELS : b->level - 1];
+            step /= 2;
+            if (step > cap) step = cap;
+        }
+    }
+    return step > 0 ? step : 1;
+}
+
+//------------------------------------------------------------------------------
+// Bit I/O
+
+typedef struct {
+    uint8_t *data;
+    uint16_t max;
+    uint32_t bit;
+    bool overflow;
+} BitWriter;
+
+static void put_bits(BitWriter *bw, uint32_t value, int count) {
+    for (int i = count - 1; i >= 0; i--) {
+        uint32_t byte = bw->bit >> 3;
+        if (byte >= bw->max) {
+            bw->overflow = true;
+            return;
+        }
+        if ((bw->bit & 7) == 0) bw->data[byte] = 0;
+        if (value & (1u << i)) bw->data[byte] |= (uint8_t)(0x80 >> (bw->bit & 7));
+        bw->bit++;
+    }
+}
+
+// Exp-Golomb order 0
+static void put_ueg(BitWriter *bw, uint32_t value) {
+    uint32_t v = value + 1;
+    int bits = 32 - __builtin_clz(v);
+    put_bits(bw, 0, bits - 1);
+    put_bits(bw, v, bits);
+}
+
+typedef struct {
+    const uint8_t *data;
+    uint32_t len_bits;
+    uint32_t bit;
+    bool error;
+} BitReader;
+
+static uint32_t get_bits(BitReader *br, int count) {
+    uint32_t value = 0;
+    for (int i = 0; i < count; i++) {
+        if (br->bit >= br->len_bits) {
+            br->error = true;
+            return 0;
+        }
+        value = (value << 1) | ((br->data[br->bit >> 3] >> (7 - (br->bit & 7))) & 1);
+        br->bit++;
+    }
+    return value;
+}
+
+static uint32_t get_ueg(BitReader *br) {
+    int zeros = 0;
+    while (get_bits(br, 1) == 0) {
+        if (br->error || ++zeros > 24) {
+            br->error = true;
+            return 0;
+        }
+    }
+    return ((1u << zeros) | get_bits(br, zeros)) - 1;
+}
+
+static inline uint32_t zigzag(int32_t v) {
+    return (v >= 0) ? (uint32_t)v << 1 : ((uint32_t)(-v) << 1) - 1;
+}
+
+static inline int32_t unzigzag(uint32_t v) {
+    return (v & 1) ? -(int32_t)((v + 1) >> 1) : (int32_t)(v >> 1);
+}
+
+//------------------------------------------------------------------------------
+
+uint16_t frame_codec_encode(const float *pixels, uint32_t frame_number, uint8_t quality,
+                            const TyreDetection *detection, uint8_t *out, uint16_t max_len) {
+    static int16_t img[SENSOR_PIXELS];
+    Band bands[1 + 3 * LEVELS];
+    int band_count = build_bands(bands);
+
+    if (max_len < FRAME_CODEC_HEADER_BYTES) return 0;
+    if (quality >= FRAME_CODEC_QUALITY_LEVELS) quality = FRAME_CODEC_QUALITY_LEVELS - 1;
+
+    uint8_t roi_start = FRAME_CODEC_NO_ROI;
+    uint8_t roi_end = FRAME_CODEC_NO_ROI;
+    if (detection && detection->detected) {
+        roi_start = detection->span_start;
+        roi_end = detection->span_end;
+    }
+
+    for (int i = 0; i < SENSOR_PIXELS; i++) {
+        float t = pixels[i] * 10.0f;
+        int32_t v = (t >= 0.0f) ? (int32_t)(t + 0.5f) : (int32_t)(t - 0.5f);
+        if (!(t == t)) v = 0;  // NaN
+        if (v < TENTHS_MIN) v = TENTHS_MIN;
+        if (v > TENTHS_MAX) v = TENTHS_MAX;
+        img[i] = (int16_t)v;
+    }
+    wavelet_forward(img);
+
+    out[0] = FRAME_CODEC_VERSION;
+    out[1] = frame_number & 0xFF;
+    out[2] = (frame_number >> 8) & 0xFF;
+    out[3] = quality;
+    out[4] = roi_start;
+    out[5] = roi_end;
+
+    BitWriter bw = {out + FRAME_CODEC_HEADER_BYTES, max_len - FRAME_CODEC_HEADER_BYTES, 0, false};
+
+    for (int band = 0; band < band_count && !bw.overflow; band++) {
+        const Band *b = &bands[band];
+        int32_t prev = 0;
+        uint32_t run = 0;
+
+        for (int y = b->y; y < b->y + b->h; y++) {
+            for (int x = b->x; x < b->x + b->w; x++) {
+                int step = coefficient_step(band, b, x, quality, roi_start, roi_end);
+                int32_t c = img[y * SENSOR_WIDTH + x];
+                int32_t q = (c >= 0) ? (c + step / 2) / step : -((-c + step / 2) / step);
+
+                if (band == 0) {
+                    // LL: DPCM in raster order
+                    put_ueg(&bw, zigzag(q - prev));
+                    prev = q;
+                } else if (q == 0) {
+                    run++;
+                } else {
+                    put_ueg(&bw, run);
+                    put_ueg(&bw, (uint32_t)((q < 0 ? -q : q) - 1));
+                    put_bits(&bw, q < 0, 1);
+                    run = 0;
+                }
+            }
+        }
+        if (band > 0 && run > 0) put_ueg(&bw, run);  // Trailing zeros
+    }
+
+    if (bw.overflow) return 0;
+    return FRAME_CODEC_HEADER_BYTES + (uint16_t)((bw.bit + 7) / 8);
+}
+
+bool frame_codec_decode(const uint8_t *data, uint16_t len, float *pixels, FrameCodecHeader *header) {
+    static int16_t img[SENSOR_PIXELS];
+    Band bands[1 + 3 * LEVELS];
+    int band_count = build_bands(bands);
+
+    if (len < FRAME_CODEC_HEADER_BYTES || data[0] != FRAME_CODEC_VERSION) return false;
+
+    uint8_t quality = data[3];
+    uint8_t roi_start = data[4];
+    uint8_t roi_end = data[5];
+    if (quality >= FRAME_CODEC_QUALITY_LEVELS) return false;
+
+    if (header) {
+        header->frame_number = data[1] | (data[2] << 8);
+        header->quality = quality;
+        header->roi_start = roi_start;
+        header->roi_end = roi_end;
+    }
+
+    BitReader br = {data + FRAME_CODEC_HEADER_BYTES, (uint32_t)(len - FRAME_CODEC_HEADER_BYTES) * 8, 0, false};
+    memset(img, 0, sizeof(img));
+
+    for (int band = 0; band < band_count && !br.error; band++) {
+        const Band *b = &bands[band];
+        int count = b->w * b->h;
+        int32_t prev = 0;
+
+        if (band == 0) {
+            for (int i = 0; i < count; i++) {
+                int x = b->x + i % b->w;
+                int y = b->y + i / b->w;
+                prev += unzigzag(get_ueg(&br));
+                img[y * SENSOR_WIDTH + x] = (int16_t)(prev * coefficient_step(band, b, x, quality, roi_start, roi_end));
+            }
+            continue;
+        }
+
+        int i = 0;
+        while (i < count && !br.error) {
+            i += get_ueg(&br);
+            if (i >= count) break;
+            int32_t q = (int32_t)get_ueg(&br) + 1;
+            if (get_bits(&br, 1)) q = -q;
+
+            int x = b->x + i % b->w;
+            int y = b->y + i / b->w;
+            img[y * SENSOR_WIDTH + x] = (int16_t)(q * coefficient_step(band, b, x, quality, roi_start, roi_end));
+            i++;
+        }
+    }
+    if (br.error) return false;
+
+    wavelet_inverse(img);
+    for (int i = 0; i < SENSOR_PIXELS; i++) {
+        pixels[i] = img[i] / 10.0f;
+    }
+    return true;
+}
+
+//------------------------------------------------------------------------------
+// Rate control
+
+void frame_codec_rate_init(FrameCodecRate *rc, uint32_t bitrate, uint8_t max_fps) {
+    memset(rc, 0, sizeof(*rc));
+    if (max_fps == 0) max_fps = 1;
+    rc->bitrate = bitrate;
+    rc->frame_bits = bitrate / max_fps;
+    rc->min_interval_us = 1000000u / max_fps;
+    rc->quality = FRAME_CODEC_QUALITY_LEVELS / 2;
+}
+
+bool frame_codec_rate_ready(FrameCodecRate *rc, uint64_t now_us) {
+    if (rc->bitrate == 0) return false;
+
+    if (rc->last_us == 0) rc->last_us = now_us;
+    uint64_t elapsed = now_us - rc->last_us;
+    rc->last_us = now_us;
+
+    // Bank at most one second of link time
+    int64_t credit = rc->credit + (int64_t)(elapsed * rc->bitrate / 1000000u);
+    if (credit > (int64_t)rc->bitrate) credit = rc->bitrate;
+    rc->credit = (int32_t)credit;
+
+    if (rc->frames_sent > 0 && now_us - rc->last_sent_us < rc->min_interval_us) return false;
+    return rc->credit >= 0;
+}
+
+void frame_codec_rate_sent(FrameCodecRate *rc, uint32_t bits, uint64_t now_us) {
+    if (bits == 0) {
+        // Did not fit in a packet at all
+        if (rc->quality < FRAME_CODEC_QUALITY_LEVELS - 1) rc->quality++;
+        return;
+    }
+
+    rc->credit -= (int32_t)bits;
+    rc->last_sent_us = now_us;
+    rc->frames_sent++;
+    rc->bits_sent += bits;
+
+    // Coarser when over the per-frame target, finer when well under
+    if (bits > rc->frame_bits + rc->frame_bits / 8) {
+        if (rc->quality < FRAME_CODEC_QUALITY_LEVELS - 1) rc->quality++;
+    } else if (bits < rc->frame_bits - rc->frame_bits / 4) {
+        if (rc->quality > 0) rc->quality--;
+    }
+}
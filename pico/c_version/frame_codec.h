@@ -0,0 +1,74 @@
+/**
+ * frame_codec.h
+ * Lossy full-frame codec for low-bitrate telemetry links
+ *
+ * Frames are converted to int16 tenths of a degree, run through a 3-level
+ * integer Haar wavelet (lossless lifting), quantised, and entropy coded
+ * with zero runs and Exp-Golomb codes. Coefficients covering the tyre
+ * span are quantised with half the step of the rest of the image, capped
+ * so span pixels stay within 0.5°C. The same file builds on the host for
+ * decoding.
+ *
+ * The rate controller is a token bucket sized by the link bitrate: it
+ * decides when the next frame may be sent and moves the quality index so
+ * frames land near the per-frame budget. When even the coarsest quality
+ * is over budget, images are sent less often instead.
+ */
+
+#ifndef FRAME_CODEC_H
+#define FRAME_CODEC_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "thermal_algorithm.h"
+
+#define FRAME_CODEC_VERSION 2
+#define FRAME_CODEC_HEADER_BYTES 6
+#define FRAME_CODEC_MAX_BYTES 1200
+
+// Quantiser scale indices, 0 = finest. Only the image outside the tyre
+// span gets coarser: at the coarsest its RMS error is about 0.3°C and its
+// maximum 1.5°C.
+#define FRAME_CODEC_QUALITY_LEVELS 6
+
+#define FRAME_CODEC_NO_ROI 0xFF
+
+typedef struct {
+    uint16_t frame_number;      // Low 16 bits of the firmware frame counter
+    uint8_t quality;            // Quantiser scale index (0 = finest)
+    uint8_t roi_start;          // Tyre span columns, FRAME_CODEC_NO_ROI if none
+    uint8_t roi_end;
+} FrameCodecHeader;
+
+// Encode a frame of temperatures. detection may be NULL (no ROI).
+// Returns the packet length in bytes, or 0 if it exceeds max_len.
+uint16_t frame_codec_encode(const float *pixels, uint32_t frame_number, uint8_t quality,
+                            const TyreDetection *detection, uint8_t *out, uint16_t max_len);
+
+// Decode a packet into temperatures. header may be NULL.
+// Returns false if the packet is malformed.
+bool frame_codec_decode(const uint8_t *data, uint16_t len, float *pixels, FrameCodecHeader *header);
+
+typedef struct {
+    uint32_t bitrate;           // Link budget (bits/s)
+    uint32_t frame_bits;        // Per-frame target at the maximum image rate
+    uint32_t min_interval_us;   // 1 / maximum image rate
+    int32_t credit;             // Token bucket (bits), may go negative
+    uint64_t last_us;           // Last credit update
+    uint64_t last_sent_us;
+    uint8_t quality;            // Quality index for the next frame
+    uint32_t frames_sent;
+    uint32_t bits_sent;
+} FrameCodecRate;
+
+// Target bitrate (bits/s) and maximum images per second
+void frame_codec_rate_init(FrameCodecRate *rc, uint32_t bitrate, uint8_t max_fps);
+
+// True if a frame may be sent now
+bool frame_codec_rate_ready(FrameCodecRate *rc, uint64_t now_us);
+
+// Account for a frame that used bits on the link (including framing) and
+// adapt the quality index. bits = 0 records a frame that did not fit.
+void frame_codec_rate_sent(FrameCodecRate *rc, uint32_t bits, uint64_t now_us);
+
+#endif // FRAME_CODEC_H
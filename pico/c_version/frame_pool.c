@@ -0,0 +1,74 @@
+/**
+ * frame_pool.c
+ * Reference-counted frame buffers for zero-copy fan-out to sinks
+ */
+
+#include "frame_pool.h"
+#include "pico/critical_section.h"
+#include <string.h>
+
+static FrameBuffer pool[FRAME_POOL_SIZE];
+static FramePoolStats stats;
+static critical_section_t pool_lock;
+
+void frame_pool_init(void) {
+    if (!critical_section_is_initialized(&pool_lock)) {
+        critical_section_init(&pool_lock);
+    }
+
+    critical_section_enter_blocking(&pool_lock);
+    for (int i = 0; i < FRAME_POOL_SIZE; i++) {
+        pool[i].refs = 0;
+    }
+    memset(&stats, 0, sizeof(stats));
+    critical_section_exit(&pool_lock);
+}
+
+FrameBuffer *frame_pool_acquire(void) {
+    FrameBuffer *frame = NULL;
+
+    critical_section_enter_blocking(&pool_lock);
+    for (int i = 0; i < FRAME_POOL_SIZE; i++) {
+        if (pool[i].refs == 0) {
+            frame = &pool[i];
+            frame->refs = 1;
+            break;
+        }
+    }
+
+    if (frame) {
+        stats.acquired++;
+        stats.in_use++;
+        if (stats.in_use > stats.high_water) stats.high_water = stats.in_use;
+    } else {
+        stats.exhausted++;
+    }
+    critical_section_exit(&pool_lock);
+
+    return frame;
+}
+
+void frame_buffer_retain(FrameBuffer *frame) {
+    if (!frame) return;
+
+    critical_section_enter_blocking(&pool_lock);
+    frame->refs++;
+    critical_section_exit(&pool_lock);
+}
+
+void frame_buffer_release(FrameBuffer *frame) {
+    if (!frame) return;
+
+    critical_section_enter_blocking(&pool_lock);
+    if (frame->refs > 0) {
+        frame->refs--;
+        if (frame->refs == 0) stats.in_use--;
+    }
+    critical_section_exit(&pool_lock);
+}
+
+void frame_pool_get_stats(FramePoolStats *out) {
+    critical_section_enter_blocking(&pool_lock);
+    *out = stats;
+    critical_section_exit(&pool_lock);
+}
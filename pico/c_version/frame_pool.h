@@ -0,0 +1,55 @@
+/**
+ * frame_pool.h
+ * Reference-counted frame buffers for zero-copy fan-out to sinks
+ *
+ * The pipeline acquires a buffer per frame, fills it, and hands it to
+ * each sink that wants the pixels (I2C frame window, USB encoder, logger,
+ * black box). A sink that keeps the frame past the call retains it and
+ * releases it when done; the buffer returns to the pool on the last
+ * release. Reference counts are updated under a critical section so
+ * sinks may release from IRQ handlers or the other core.
+ */
+
+#ifndef FRAME_POOL_H
+#define FRAME_POOL_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "thermal_algorithm.h"
+
+// Pipeline (1-2) + I2C current frame + I2C stream in progress + spare for
+// a logger/black box holding one frame
+#define FRAME_POOL_SIZE 6
+
+typedef struct {
+    float pixels[SENSOR_PIXELS];   // Temperatures, row-major
+    uint32_t frame_number;
+    uint64_t timestamp_us;         // When the subpage was read
+    uint8_t refs;                  // Owned by frame_pool.c
+} FrameBuffer;
+
+typedef struct {
+    uint32_t acquired;             // Successful acquires
+    uint32_t exhausted;            // Acquires that found every buffer in use
+    uint8_t in_use;                // Buffers currently referenced
+    uint8_t high_water;            // Most buffers ever in use at once
+} FramePoolStats;
+
+// Initialize the pool (all buffers free)
+void frame_pool_init(void);
+
+// Take a free buffer with one reference held by the caller.
+// Returns NULL (and counts it) if every buffer is in use.
+FrameBuffer *frame_pool_acquire(void);
+
+// Add a reference for a sink that keeps the buffer
+void frame_buffer_retain(FrameBuffer *frame);
+
+// Drop a reference; the buffer returns to the pool on the last release.
+// NULL is ignored.
+void frame_buffer_release(FrameBuffer *frame);
+
+// Snapshot of pool counters
+void frame_pool_get_stats(FramePoolStats *stats);
+
+#endif // FRAME_POOL_H
@@ -0,0 +1,185 @@
+/**
+ * bench_calibration_catalog.cpp
+ * Tool startup time with and without a calibration catalog
+ *
+ * Writes synthetic EEPROM dumps for a set of sensors to a temporary
+ * directory and times what a host tool does before it can convert the
+ * first frame of each: read the dump, MLX90640_ExtractParameters() and
+ * compile the per-pixel coefficients into a BatchProcessor, against
+ * opening the catalog, looking the sensor up and pointing a
+ * BatchProcessor at the mapped entry. Both processors then convert the
+ * same subpage to check the results are identical.
+ *
+ * Usage: bench_calibration_catalog [sensors]
+ */
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <string>
+#include <unistd.h>
+#include <vector>
+
+#include "calibration_catalog.h"
+
+#define ROUNDS 20
+#define SMOOTHING 0.25f
+#define EMISSIVITY 0.95f
+#define REFLECTED_TEMP 23.15f
+
+// Random words with the scale fields pinned to plausible values: the
+// Melexis extraction loops until a scale is found, which never happens
+// for an all-zero or negative coefficient set
+static void make_eeprom(uint16_t *ee, uint32_t serial, std::mt19937 &rng) {
+    std::uniform_int_distribution<int> word(0, 0xFFFF);
+    for (int i = 0; i < CALIBRATION_EEPROM_WORDS; i++) {
+        ee[i] = static_cast<uint16_t>(word(rng));
+    }
+    ee[7] = 0x1234;
+    ee[8] = static_cast<uint16_t>(serial >> 16);
+    ee[9] = static_cast<uint16_t>(serial);
+    ee[32] = 0x4210;                                // Alpha scales
+    ee[33] = static_cast<uint16_t>(0x2F00 + (word(rng) & 0xFF));   // Alpha reference
+    ee[48] = 0x1800;                                // Gain
+    ee[52] = 0x3333;                                // Kv per row/column split
+    ee[54] = 0x3C3C;                                // Kta per row/column split
+    ee[55] = 0x3C3C;
+    ee[60] &= 0xFF00;                               // TGC = 0
+    // Pixel words: nonzero (not broken), bit 0 clear (not an outlier)
+    for (int i = 64; i < CALIBRATION_EEPROM_WORDS; i++) {
+        ee[i] = static_cast<uint16_t>((ee[i] & 0xFFFE) | 0x0100);
+    }
+}
+
+static std::vector<uint16_t> make_subpage(std::mt19937 &rng) {
+    std::normal_distribution<float> noise(0.0f, 4.0f);
+    std::vector<uint16_t> fd(FRAME_BATCH_WORDS, 0);
+    for (int p = 0; p < SENSOR_PIXELS; p++) {
+        fd[p] = static_cast<uint16_t>(static_cast<int16_t>(400 + noise(rng)));
+    }
+    fd[768] = 19500;
+    fd[776] = static_cast<uint16_t>(-58);
+    fd[778] = 5500;
+    fd[800] = 1711;
+    fd[808] = static_cast<uint16_t>(-60);
+    fd[810] = static_cast<uint16_t>(-13056);
+    fd[832] = 0x1A81;
+    return fd;
+}
+
+static double seconds_since(std::chrono::steady_clock::time_point t0) {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+}
+
+int main(int argc, char **argv) {
+    int sensors = (argc > 1) ? std::atoi(argv[1]) : 32;
+    if (sensors < 1) sensors = 1;
+
+    char dir_template[] = "/tmp/calib_bench.XXXXXX";
+    if (!mkdtemp(dir_template)) {
+        perror("mkdtemp");
+        return 1;
+    }
+    std::string dir = dir_template;
+    std::string catalog_path = dir + "/sensors.ttcal";
+
+    // Dumps on disk, as a tool would find them next to a recording
+    std::mt19937 rng(1);
+    std::vector<std::string> dumps;
+    std::vector<uint64_t> serials;
+    for (int s = 0; s < sensors; s++) {
+        uint16_t ee[CALIBRATION_EEPROM_WORDS];
+        make_eeprom(ee, 0x10000 + s, rng);
+        std::string path = dir + "/sensor" + std::to_string(s) + ".bin";
+        FILE *f = fopen(path.c_str(), "wb");
+        if (!f || fwrite(ee, sizeof(ee), 1, f) != 1) {
+            perror(path.c_str());
+            return 1;
+        }
+        fclose(f);
+        dumps.push_back(path);
+        serials.push_back(calibration_serial(ee));
+    }
+
+    auto t0 = std::chrono::steady_clock::now();
+    CalibrationCatalogWriter writer;
+    for (const std::string &path : dumps) {
+        uint16_t ee[CALIBRATION_EEPROM_WORDS];
+        if (!calibration_read_eeprom(path, ee) || !writer.add(ee)) return 1;
+    }
+    if (!writer.write(catalog_path)) return 1;
+    double build_s = seconds_since(t0);
+
+    std::vector<uint16_t> subpage = make_subpage(rng);
+    RawFrameBatch batch(1);
+    batch.push(subpage.data());
+
+    // Without the catalog
+    std::vector<float> reference(static_cast<size_t>(sensors) * SENSOR_PIXELS);
+    double extract_s = 0.0;
+    for (int r = 0; r < ROUNDS; r++) {
+        for (int s = 0; s < sensors; s++) {
+            t0 = std::chrono::steady_clock::now();
+            uint16_t ee[CALIBRATION_EEPROM_WORDS];
+            static paramsMLX90640 params;
+            if (!calibration_read_eeprom(dumps[s], ee) || MLX90640_ExtractParameters(ee, &params) != 0) return 1;
+            BatchProcessor processor(params, SMOOTHING, EMISSIVITY, REFLECTED_TEMP);
+            extract_s += seconds_since(t0);
+
+            if (r == 0) {
+                BatchOutput out;
+                processor.process(batch, out);
+                out.frame(0, &reference[static_cast<size_t>(s) * SENSOR_PIXELS]);
+            }
+        }
+    }
+
+    // With the catalog: one open per tool start, one lookup per sensor
+    double open_s = 0.0, lookup_s = 0.0;
+    uint64_t diffs = 0;
+    for (int r = 0; r < ROUNDS; r++) {
+        t0 = std::chrono::steady_clock::now();
+        CalibrationCatalog catalog;
+        if (!catalog.open(catalog_path)) return 1;
+        open_s += seconds_since(t0);
+
+        for (int s = 0; s < sensors; s++) {
+            t0 = std::chrono::steady_clock::now();
+            const CalibrationEntry *e = catalog.find_serial(serials[s]);
+            if (!e) return 1;
+            BatchProcessor processor(e->params, e->coefficients, SMOOTHING, EMISSIVITY, REFLECTED_TEMP);
+            lookup_s += seconds_since(t0);
+
+            if (r == 0) {
+                BatchOutput out;
+                float pixels[SENSOR_PIXELS];
+                processor.process(batch, out);
+                out.frame(0, pixels);
+                diffs += std::memcmp(pixels, &reference[static_cast<size_t>(s) * SENSOR_PIXELS], sizeof(pixels)) != 0;
+            }
+        }
+    }
+
+    double per_extract_us = extract_s / (ROUNDS * sensors) * 1e6;
+    double per_lookup_us = lookup_s / (ROUNDS * sensors) * 1e6;
+    double per_open_us = open_s / ROUNDS * 1e6;
+
+    printf("%d sensors, catalog %zu KB per sensor, built in %.1f ms\n\n", sensors,
+           sizeof(CalibrationEntry) / 1024, build_s * 1e3);
+    printf("%-28s %14s %18s\n", "", "per sensor", "startup (all)");
+    printf("%-28s %11.1f us %15.2f ms\n", "EEPROM dump + extraction", per_extract_us,
+           per_extract_us * sensors / 1e3);
+    printf("%-28s %11.1f us %15.2f ms\n", "catalog open + lookup", per_lookup_us,
+           (per_open_us + per_lookup_us * sensors) / 1e3);
+    printf("%-28s %11.1f us\n", "  (catalog open)", per_open_us);
+    printf("\nspeedup %.0fx, sensors with differing output: %llu\n",
+           (per_extract_us * sensors) / (per_open_us + per_lookup_us * sensors),
+           static_cast<unsigned long long>(diffs));
+
+    for (const std::string &path : dumps) unlink(path.c_str());
+    unlink(catalog_path.c_str());
+    rmdir(dir.c_str());
+    return diffs ? 1 : 0;
+}
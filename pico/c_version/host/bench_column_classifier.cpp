@@ -0,0 +1,181 @@
+/**
+ * bench_column_classifier.cpp
+ * Column classifier (column_classifier.h) against the region grower
+ *
+ * Runs both span detection engines over synthetic profiles
+ * (synthetic_profiles.h) with the built-in model. It reports how often
+ * they agree and the spread of the per-profile cost. The region
+ * grower's qsort and walk vary with the profile, while the classifier
+ * does the same work every time.
+ *
+ * Wall time on a desktop drifts by more than either engine varies, so
+ * on Linux the cost is also counted in user-space instructions retired
+ * (perf_event_open), which doesn't drift. Containers often block the
+ * counter; then only times are shown. On the Pico the firmware prints
+ * cycle counts ([Detect] lines).
+ *
+ * Usage: bench_column_classifier [profiles]
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <vector>
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+extern "C" {
+#include "column_classifier.h"
+#include "thermal_algorithm.h"
+}
+
+#include "synthetic_profiles.h"
+
+#define CALLS_PER_TIMING 16
+#define TIMING_RUNS 16
+
+static double iou(const TyreDetection &a, const TyreDetection &b) {
+    int lo = std::max(a.span_start, b.span_start), hi = std::min(a.span_end, b.span_end);
+    int inter = std::max(0, hi - lo + 1);
+    int uni = a.tyre_width + b.tyre_width - inter;
+    return static_cast<double>(inter) / uni;
+}
+
+static void detect_repeated(const float *profile, ThermalConfig *config) {
+    TyreDetection d;
+    for (int r = 0; r < CALLS_PER_TIMING; r++) {
+        thermal_algorithm_detect(profile, &d, config);
+        asm volatile("" : : "r"(&d) : "memory");
+    }
+}
+
+// ns per call for one profile, best of TIMING_RUNS to drop interruptions
+static double time_profile(const float *profile, ThermalConfig *config) {
+    double best = 1e30;
+    for (int run = 0; run < TIMING_RUNS; run++) {
+        auto t0 = std::chrono::steady_clock::now();
+        detect_repeated(profile, config);
+        auto t1 = std::chrono::steady_clock::now();
+        best = std::min(best, std::chrono::duration<double, std::nano>(t1 - t0).count() / CALLS_PER_TIMING);
+    }
+    return best;
+}
+
+// User-space instruction counter, -1 when unavailable
+static int open_instruction_counter() {
+#ifdef __linux__
+    struct perf_event_attr attr;
+    memset(&attr, 0, sizeof(attr));
+    attr.type = PERF_TYPE_HARDWARE;
+    attr.size = sizeof(attr);
+    attr.config = PERF_COUNT_HW_INSTRUCTIONS;
+    attr.disabled = 1;
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+    return static_cast<int>(syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0));
+#else
+    return -1;
+#endif
+}
+
+// Instructions per call for one profile
+static double count_profile(int counter, const float *profile, ThermalConfig *config) {
+#ifdef __linux__
+    uint64_t count = 0;
+    ioctl(counter, PERF_EVENT_IOC_RESET, 0);
+    ioctl(counter, PERF_EVENT_IOC_ENABLE, 0);
+    detect_repeated(profile, config);
+    ioctl(counter, PERF_EVENT_IOC_DISABLE, 0);
+    if (read(counter, &count, sizeof(count)) != sizeof(count)) return 0.0;
+    return static_cast<double>(count) / CALLS_PER_TIMING;
+#else
+    (void)counter;
+    (void)profile;
+    (void)config;
+    return 0.0;
+#endif
+}
+
+static void print_header(const char *unit) {
+    printf("%-12s %10s %10s %10s %10s %10s   (%s per detection)\n", "", "min", "median", "p99", "max",
+           "max/min", unit);
+}
+
+static void print_spread(const char *name, std::vector<double> &v) {
+    std::sort(v.begin(), v.end());
+    auto at = [&](double q) { return v[static_cast<size_t>(q * (v.size() - 1))]; };
+    printf("%-12s %10.1f %10.1f %10.1f %10.1f %10.2f\n", name, at(0.0), at(0.5), at(0.99), at(1.0),
+           at(1.0) / at(0.0));
+}
+
+int main(int argc, char **argv) {
+    int count = (argc > 1) ? std::atoi(argv[1]) : 20000;
+    if (count < 1) count = 1;
+
+    std::mt19937 rng(7);
+    std::vector<SyntheticProfile> corpus = make_synthetic_profiles(count, rng);
+
+    ThermalConfig region, classifier;
+    thermal_algorithm_init(&region);
+    classifier = region;
+    classifier.engine = DETECT_ENGINE_CLASSIFIER;
+
+    // Agreement with the region grower
+    int agree = 0, both = 0, region_only = 0, classifier_only = 0;
+    double iou_sum = 0;
+    for (const SyntheticProfile &p : corpus) {
+        TyreDetection a, b;
+        thermal_algorithm_detect(p.t, &a, &region);
+        thermal_algorithm_detect(p.t, &b, &classifier);
+        agree += a.detected == b.detected;
+        region_only += a.detected && !b.detected;
+        classifier_only += !a.detected && b.detected;
+        if (a.detected && b.detected) {
+            both++;
+            iou_sum += iou(a, b);
+        }
+    }
+    printf("%d profiles: agree %.1f%% (region only %d, classifier only %d), span IoU %.3f\n\n", count,
+           100.0 * agree / count, region_only, classifier_only, both ? iou_sum / both : 0.0);
+
+    // Per-profile cost, warmed up first
+    for (int i = 0; i < std::min(count, 1000); i++) {
+        time_profile(corpus[i].t, &region);
+        time_profile(corpus[i].t, &classifier);
+    }
+    std::vector<double> region_ns(count), classifier_ns(count);
+    for (int i = 0; i < count; i++) {
+        region_ns[i] = time_profile(corpus[i].t, &region);
+        classifier_ns[i] = time_profile(corpus[i].t, &classifier);
+    }
+    print_header("ns");
+    print_spread("region", region_ns);
+    print_spread("classifier", classifier_ns);
+
+    int counter = open_instruction_counter();
+    if (counter < 0) {
+        printf("\nInstruction counter unavailable (perf_event_open)\n");
+        return 0;
+    }
+    std::vector<double> region_ins(count), classifier_ins(count);
+    for (int i = 0; i < count; i++) {
+        region_ins[i] = count_profile(counter, corpus[i].t, &region);
+        classifier_ins[i] = count_profile(counter, corpus[i].t, &classifier);
+    }
+    printf("\n");
+    print_header("instructions");
+    print_spread("region", region_ins);
+    print_spread("classifier", classifier_ins);
+#ifdef __linux__
+    close(counter);
+#endif
+    return 0;
+}
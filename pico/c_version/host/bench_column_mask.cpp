@@ -0,0 +1,282 @@
+/**
+ * bench_column_mask.cpp
+ * Mask-based span growing (column_mask.h) against the column loops
+ *
+ * The corpus is synthetic profiles (synthetic_profiles.h). The
+ * references are the loops the masks replaced. One is
+ * detect_tyre_span's grow above the median + k * MAD threshold. The
+ * other is the detection test's dual-criteria grow with a fail counter.
+ * Every profile is checked with every seed and gap limits 0-4, and
+ * random bit patterns are checked against a loop over the bits, before
+ * anything is timed.
+ *
+ * Usage: bench_column_mask [profiles]
+ */
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <vector>
+
+extern "C" {
+#include "column_mask.h"
+#include "thermal_algorithm.h"
+}
+
+#include "synthetic_profiles.h"
+
+#define MAX_GAP_TESTED 4
+
+// detect_tyre_span's original grow
+static void loop_above(const float *profile, float threshold, int seed, int *start, int *end) {
+    *start = seed;
+    *end = seed;
+    for (int i = seed - 1; i >= 0; i--) {
+        if (profile[i] > threshold) {
+            *start = i;
+        } else {
+            break;
+        }
+    }
+    for (int i = seed + 1; i < SENSOR_WIDTH; i++) {
+        if (profile[i] > threshold) {
+            *end = i;
+        } else {
+            break;
+        }
+    }
+}
+
+// The detection test's grow_region loops
+struct DualCriteria {
+    float centre_temp;
+    float k;
+    float median;
+    float delta;
+    bool inverted;
+};
+
+static bool dual_ok(const DualCriteria &d, float temp) {
+    int within_k = fabsf(temp - d.centre_temp) <= d.k;
+    int global_ok = d.inverted ? (temp <= d.median - d.delta) : (temp >= d.median + d.delta);
+    return within_k || global_ok;
+}
+
+static void loop_dual(const float *profile, const DualCriteria &d, int seed, int max_fail, int *start, int *end) {
+    int left = seed;
+    int fail_count = 0;
+    for (int i = seed - 1; i >= 0; i--) {
+        if (dual_ok(d, profile[i])) {
+            left = i;
+            fail_count = 0;
+        } else if (++fail_count > max_fail) {
+            break;
+        }
+    }
+    int right = seed;
+    fail_count = 0;
+    for (int i = seed + 1; i < SENSOR_WIDTH; i++) {
+        if (dual_ok(d, profile[i])) {
+            right = i;
+            fail_count = 0;
+        } else if (++fail_count > max_fail) {
+            break;
+        }
+    }
+    *start = left;
+    *end = right;
+}
+
+static uint32_t mask_dual(const float *profile, const DualCriteria &d) {
+    uint32_t global_ok = d.inverted ? column_mask_at_most(profile, d.median - d.delta)
+                                    : column_mask_at_least(profile, d.median + d.delta);
+    return column_mask_within(profile, d.centre_temp, d.k) | global_ok;
+}
+
+// Same fail-counter walk over the bits of a mask
+static void loop_bits(uint32_t mask, int seed, int max_fail, int *start, int *end) {
+    int left = seed, right = seed, fail_count = 0;
+    for (int i = seed - 1; i >= 0; i--) {
+        if (mask >> i & 1) {
+            left = i;
+            fail_count = 0;
+        } else if (++fail_count > max_fail) {
+            break;
+        }
+    }
+    fail_count = 0;
+    for (int i = seed + 1; i < SENSOR_WIDTH; i++) {
+        if (mask >> i & 1) {
+            right = i;
+            fail_count = 0;
+        } else if (++fail_count > max_fail) {
+            break;
+        }
+    }
+    *start = left;
+    *end = right;
+}
+
+struct Thresholds {
+    float above;            // detect_tyre_span threshold
+    int seed;               // Hottest column
+    DualCriteria dual;
+};
+
+static Thresholds thresholds_for(const SyntheticProfile &p) {
+    float scratch[SENSOR_WIDTH];
+    for (int i = 0; i < SENSOR_WIDTH; i++) scratch[i] = p.t[i];
+    float median = fast_median(scratch, SENSOR_WIDTH);
+    float mad = fast_mad(p.t, SENSOR_WIDTH, median);
+
+    Thresholds th;
+    th.above = median + 3.0f * mad;
+    th.seed = SENSOR_WIDTH / 2;
+    float max_temp = -300.0f;
+    for (int i = 0; i < SENSOR_WIDTH; i++) {
+        if (p.t[i] > max_temp) {
+            max_temp = p.t[i];
+            th.seed = i;
+        }
+    }
+    th.dual.centre_temp = p.t[SENSOR_WIDTH / 2];
+    th.dual.k = fmaxf(5.0f, 2.0f * mad);
+    th.dual.median = median;
+    th.dual.delta = fmaxf(3.0f, 1.8f * mad);
+    th.dual.inverted = th.dual.centre_temp < median - th.dual.delta;
+    return th;
+}
+
+static double seconds_since(std::chrono::steady_clock::time_point t0) {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+}
+
+int main(int argc, char **argv) {
+    int count = (argc > 1) ? std::atoi(argv[1]) : 20000;
+    if (count < 1) count = 1;
+
+    std::mt19937 rng(1);
+    std::vector<SyntheticProfile> corpus = make_synthetic_profiles(count, rng);
+    std::vector<Thresholds> th(count);
+    for (int i = 0; i < count; i++) th[i] = thresholds_for(corpus[i]);
+
+    // Exactness: every profile, every seed, gap limits 0..MAX_GAP_TESTED
+    uint64_t checks = 0, diffs = 0;
+    for (int i = 0; i < count; i++) {
+        const float *t = corpus[i].t;
+        uint32_t above = column_mask_above(t, th[i].above);
+        uint32_t dual = mask_dual(t, th[i].dual);
+        for (int seed = 0; seed < SENSOR_WIDTH; seed++) {
+            int s0, e0, s1, e1;
+            loop_above(t, th[i].above, seed, &s0, &e0);
+            column_mask_span(above, seed, 0, &s1, &e1);
+            diffs += (s0 != s1 || e0 != e1);
+            checks++;
+            for (int gap = 0; gap <= MAX_GAP_TESTED; gap++) {
+                loop_dual(t, th[i].dual, seed, gap, &s0, &e0);
+                column_mask_span(dual, seed, gap, &s1, &e1);
+                diffs += (s0 != s1 || e0 != e1);
+                checks++;
+            }
+        }
+    }
+
+    // Random bit patterns of every density
+    std::uniform_int_distribution<uint32_t> word;
+    for (int n = 0; n < 200000; n++) {
+        uint32_t mask = word(rng);
+        switch (n % 4) {
+            case 1: mask &= word(rng); break;
+            case 2: mask |= word(rng); break;
+            case 3: mask &= word(rng) & word(rng); break;
+        }
+        int seed = n % SENSOR_WIDTH;
+        for (int gap = 0; gap <= MAX_GAP_TESTED; gap++) {
+            int s0, e0, s1, e1;
+            loop_bits(mask, seed, gap, &s0, &e0);
+            column_mask_span(mask, seed, gap, &s1, &e1);
+            diffs += (s0 != s1 || e0 != e1);
+            checks++;
+        }
+    }
+
+    printf("%d profiles, %llu span checks, %llu differences\n\n", count,
+           static_cast<unsigned long long>(checks), static_cast<unsigned long long>(diffs));
+
+    // Throughput: one span per profile as the detectors use them (the
+    // masks include the threshold tests)
+    const int reps = 50;
+    volatile int sink = 0;
+    printf("%-30s %12s %12s %9s\n", "", "loops", "masks", "speedup");
+
+    auto t0 = std::chrono::steady_clock::now();
+    for (int r = 0; r < reps; r++) {
+        for (int i = 0; i < count; i++) {
+            int s, e;
+            loop_above(corpus[i].t, th[i].above, th[i].seed, &s, &e);
+            sink += e - s;
+        }
+    }
+    double loop_s = seconds_since(t0);
+    t0 = std::chrono::steady_clock::now();
+    for (int r = 0; r < reps; r++) {
+        for (int i = 0; i < count; i++) {
+            int s, e;
+            column_mask_span(column_mask_above(corpus[i].t, th[i].above), th[i].seed, 0, &s, &e);
+            sink += e - s;
+        }
+    }
+    double mask_s = seconds_since(t0);
+    double n = static_cast<double>(reps) * count;
+    printf("%-30s %9.1f ns %9.1f ns %8.2fx\n", "detect span (above threshold)", loop_s / n * 1e9,
+           mask_s / n * 1e9, loop_s / mask_s);
+
+    t0 = std::chrono::steady_clock::now();
+    for (int r = 0; r < reps; r++) {
+        for (int i = 0; i < count; i++) {
+            int s, e;
+            loop_dual(corpus[i].t, th[i].dual, SENSOR_WIDTH / 2, 2, &s, &e);
+            sink += e - s;
+        }
+    }
+    loop_s = seconds_since(t0);
+    t0 = std::chrono::steady_clock::now();
+    for (int r = 0; r < reps; r++) {
+        for (int i = 0; i < count; i++) {
+            int s, e;
+            column_mask_span(mask_dual(corpus[i].t, th[i].dual), SENSOR_WIDTH / 2, 2, &s, &e);
+            sink += e - s;
+        }
+    }
+    mask_s = seconds_since(t0);
+    printf("%-30s %9.1f ns %9.1f ns %8.2fx\n", "grow region (dual, 2 fails)", loop_s / n * 1e9,
+           mask_s / n * 1e9, loop_s / mask_s);
+
+    // The span search alone, masks already built
+    std::vector<uint32_t> masks(count);
+    for (int i = 0; i < count; i++) masks[i] = mask_dual(corpus[i].t, th[i].dual);
+    t0 = std::chrono::steady_clock::now();
+    for (int r = 0; r < reps; r++) {
+        for (int i = 0; i < count; i++) {
+            int s, e;
+            loop_bits(masks[i], SENSOR_WIDTH / 2, 2, &s, &e);
+            sink += e - s;
+        }
+    }
+    loop_s = seconds_since(t0);
+    t0 = std::chrono::steady_clock::now();
+    for (int r = 0; r < reps; r++) {
+        for (int i = 0; i < count; i++) {
+            int s, e;
+            column_mask_span(masks[i], SENSOR_WIDTH / 2, 2, &s, &e);
+            sink += e - s;
+        }
+    }
+    mask_s = seconds_since(t0);
+    printf("%-30s %9.1f ns %9.1f ns %8.2fx\n", "span from mask (2 fails)", loop_s / n * 1e9,
+           mask_s / n * 1e9, loop_s / mask_s);
+
+    return diffs ? 1 : 0;
+}
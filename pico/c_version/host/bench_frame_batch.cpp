@@ -0,0 +1,134 @@
+/**
+ * bench_frame_batch.cpp
+ * Frames/s of BatchProcessor against per-frame conversion and analysis
+ *
+ * Synthesises raw subpages (tyre hotter than the road, sensor noise,
+ * jittering auxiliary words, a switch from chess to interleaved mode
+ * half way) for a made-up but plausible calibration. The reference is
+ * the firmware's per-frame path: MLX90640_UpdateEnvironment,
+ * MLX90640_CalculateToEnv and thermal_algorithm_process. Each batch size
+ * is checked for identical pixels and results before it is timed.
+ *
+ * Usage: bench_frame_batch [frames]
+ */
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <vector>
+
+#include "frame_batch.h"
+#include "synthetic_sensor.h"
+
+#define SMOOTHING 0.25f
+#define EMISSIVITY 0.95f
+#define REFLECTED_TEMP 23.15f
+
+static std::vector<uint16_t> make_frames(int frames, std::mt19937 &rng) {
+    std::normal_distribution<float> noise(0.0f, 1.0f);
+    std::vector<uint16_t> data(static_cast<size_t>(frames) * FRAME_BATCH_WORDS);
+
+    for (int f = 0; f < frames; f++) {
+        uint16_t *fd = &data[static_cast<size_t>(f) * FRAME_BATCH_WORDS];
+        float phase = f * 0.01f;
+        int start = 8 + static_cast<int>(3.0f * std::sin(phase * 0.7f));
+        float tread = 1400.0f + 300.0f * std::sin(phase);
+
+        for (int p = 0; p < SENSOR_PIXELS; p++) {
+            int c = p % SENSOR_WIDTH;
+            int r = p / SENSOR_WIDTH;
+            float counts = 350.0f + 3.0f * r;
+            if (c >= start && c < start + 15) {
+                counts = tread + 20.0f * (c - start) - ((c - start) % 5 == 2 ? 150.0f : 0.0f);
+            }
+            fd[p] = static_cast<uint16_t>(static_cast<int16_t>(-50 + (p % 11) + counts + 4.0f * noise(rng)));
+        }
+
+        set_synthetic_aux(fd, f < frames / 2, f, rng);   // Chess, then interleaved
+    }
+    return data;
+}
+
+static bool same_result(const FrameData &a, const FrameData &b) {
+    return a.frame_number == b.frame_number &&
+           a.detection.detected == b.detection.detected &&
+           a.detection.span_start == b.detection.span_start &&
+           a.detection.span_end == b.detection.span_end &&
+           a.left.avg == b.left.avg && a.left.median == b.left.median &&
+           a.centre.avg == b.centre.avg && a.centre.median == b.centre.median &&
+           a.right.avg == b.right.avg && a.right.median == b.right.median &&
+           a.lateral_gradient == b.lateral_gradient && a.warnings == b.warnings;
+}
+
+static double seconds_since(std::chrono::steady_clock::time_point t0) {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+}
+
+int main(int argc, char **argv) {
+    int frames = (argc > 1) ? std::atoi(argv[1]) : 4096;
+    if (frames < 1) frames = 1;
+
+    paramsMLX90640 params;
+    make_synthetic_params(params);
+    std::mt19937 rng(1);
+    std::vector<uint16_t> raw = make_frames(frames, rng);
+
+    // Reference: one frame per call, as the firmware does
+    std::vector<float> ref_pixels(static_cast<size_t>(frames) * SENSOR_PIXELS);
+    std::vector<FrameData> ref_results(frames);
+    double ref_s;
+    {
+        envMLX90640 env;
+        ThermalConfig config;
+        static float pixels[SENSOR_PIXELS];
+        MLX90640_InitEnvironment(&env, SMOOTHING);
+        thermal_algorithm_init(&config);
+
+        auto t0 = std::chrono::steady_clock::now();
+        for (int f = 0; f < frames; f++) {
+            uint16_t *fd = &raw[static_cast<size_t>(f) * FRAME_BATCH_WORDS];
+            MLX90640_UpdateEnvironment(fd, &params, &env);
+            MLX90640_CalculateToEnv(fd, &params, &env, EMISSIVITY, REFLECTED_TEMP, pixels);
+            thermal_algorithm_process(pixels, &ref_results[f], &config);
+            std::memcpy(&ref_pixels[static_cast<size_t>(f) * SENSOR_PIXELS], pixels, sizeof(pixels));
+        }
+        ref_s = seconds_since(t0);
+    }
+
+    printf("%d subpages, per-frame calls: %.0f frames/s\n\n", frames, frames / ref_s);
+    printf("%-8s %12s %9s %14s %12s\n", "batch", "frames/s", "speedup", "pixel diffs", "result diffs");
+
+    for (size_t batch_size : {1u, 4u, 16u, 64u, 256u, 1024u}) {
+        BatchProcessor processor(params, SMOOTHING, EMISSIVITY, REFLECTED_TEMP);
+        RawFrameBatch batch(batch_size);
+        BatchOutput out;
+        uint64_t pixel_diffs = 0, result_diffs = 0;
+        float frame[SENSOR_PIXELS];
+        double batch_s = 0.0;
+
+        for (int first = 0; first < frames; first += static_cast<int>(batch_size)) {
+            auto t0 = std::chrono::steady_clock::now();
+            batch.clear();
+            for (int f = first; f < frames && !batch.full(); f++) {
+                batch.push(&raw[static_cast<size_t>(f) * FRAME_BATCH_WORDS]);
+            }
+            processor.process(batch, out);
+            batch_s += seconds_since(t0);
+
+            for (size_t i = 0; i < out.size(); i++) {
+                size_t f = first + i;
+                out.frame(i, frame);
+                pixel_diffs += std::memcmp(frame, &ref_pixels[f * SENSOR_PIXELS], sizeof(frame)) != 0;
+                result_diffs += !same_result(out.result(i), ref_results[f]);
+            }
+        }
+
+        printf("%-8zu %12.0f %8.2fx %14llu %12llu\n", batch_size, frames / batch_s, ref_s / batch_s,
+               static_cast<unsigned long long>(pixel_diffs), static_cast<unsigned long long>(result_diffs));
+    }
+
+    return 0;
+}
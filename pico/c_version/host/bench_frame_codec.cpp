@@ -0,0 +1,194 @@
+/**
+ * bench_frame_codec.cpp
+ * Size, error and speed of the firmware's lossy image codec
+ *
+ * Synthesises tyre scenes (hot tread with a lateral gradient and grooves
+ * over a cooler road, plus sensor noise), sends them through the same
+ * IMG:<base64> lines the firmware prints and ImageLineDecoder, and
+ * reports bits per frame and error against the original frame for every
+ * quality index. Then runs the firmware rate controller against a set of
+ * link bitrates. Exits non-zero if any tyre span pixel is off by more
+ * than MAX_SPAN_ERROR, at a fixed quality or under rate control.
+ *
+ * Usage: bench_frame_codec [frames]
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "image_decoder.h"
+
+// Largest error allowed over the tyre span (°C)
+#define MAX_SPAN_ERROR 0.5
+
+struct Scene {
+    std::vector<float> pixels = std::vector<float>(SENSOR_PIXELS);
+    TyreDetection detection{};
+};
+
+static Scene make_scene(int frame, std::mt19937 &rng) {
+    std::normal_distribution<float> noise(0.0f, 0.15f);
+    Scene s;
+
+    // Tyre drifts slowly across the sensor and heats/cools over time
+    float phase = frame * 0.01f;
+    int start = 8 + static_cast<int>(3.0f * std::sin(phase * 0.7f));
+    int width = 15;
+    float tread = 65.0f + 15.0f * std::sin(phase);
+    float gradient = 6.0f * std::sin(phase * 1.3f);
+    float road = 28.0f;
+
+    for (int r = 0; r < SENSOR_HEIGHT; r++) {
+        for (int c = 0; c < SENSOR_WIDTH; c++) {
+            float t;
+            if (c >= start && c < start + width) {
+                float x = (c - start) / static_cast<float>(width - 1) - 0.5f;
+                t = tread + gradient * x - 0.02f * (r - 12) * (r - 12);
+                if ((c - start) % 5 == 2) t -= 4.0f;  // Groove
+            } else {
+                t = road + 0.15f * r + 0.05f * c;
+            }
+            s.pixels[r * SENSOR_WIDTH + c] = t + noise(rng);
+        }
+    }
+
+    s.detection.detected = true;
+    s.detection.span_start = static_cast<uint8_t>(start);
+    s.detection.span_end = static_cast<uint8_t>(start + width - 1);
+    s.detection.tyre_width = static_cast<uint8_t>(width);
+    return s;
+}
+
+static std::string to_line(const uint8_t *packet, uint16_t len) {
+    static const char alphabet[] =
+        "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+    std::string line = "IMG:";
+    for (uint16_t i = 0; i < len; i += 3) {
+        uint32_t v = static_cast<uint32_t>(packet[i]) << 16;
+        if (i + 1 < len) v |= static_cast<uint32_t>(packet[i + 1]) << 8;
+        if (i + 2 < len) v |= packet[i + 2];
+        line += alphabet[(v >> 18) & 0x3F];
+        line += alphabet[(v >> 12) & 0x3F];
+        line += (i + 1 < len) ? alphabet[(v >> 6) & 0x3F] : '=';
+        line += (i + 2 < len) ? alphabet[v & 0x3F] : '=';
+    }
+    return line;
+}
+
+struct ErrorStats {
+    double sum_sq = 0.0, roi_sum_sq = 0.0;
+    double max = 0.0, roi_max = 0.0;
+    uint64_t n = 0, roi_n = 0;
+
+    void add(const Scene &s, const float *decoded) {
+        for (int i = 0; i < SENSOR_PIXELS; i++) {
+            double e = std::fabs(decoded[i] - s.pixels[i]);
+            int c = i % SENSOR_WIDTH;
+            sum_sq += e * e;
+            max = std::max(max, e);
+            n++;
+            if (c >= s.detection.span_start && c <= s.detection.span_end) {
+                roi_sum_sq += e * e;
+                roi_max = std::max(roi_max, e);
+                roi_n++;
+            }
+        }
+    }
+    double rms() const { return n ? std::sqrt(sum_sq / n) : 0.0; }
+    double roi_rms() const { return roi_n ? std::sqrt(roi_sum_sq / roi_n) : 0.0; }
+};
+
+int main(int argc, char **argv) {
+    int frames = (argc > 1) ? std::atoi(argv[1]) : 2000;
+    int failures = 0;
+
+    std::mt19937 rng(1);
+    std::vector<Scene> scenes;
+    scenes.reserve(frames);
+    for (int i = 0; i < frames; i++) scenes.push_back(make_scene(i, rng));
+
+    ImageLineDecoder decoder;
+    ImageFrame decoded;
+    uint8_t packet[FRAME_CODEC_MAX_BYTES];
+
+    printf("Fixed quality (%d frames, link bits include IMG:/base64/newline)\n", frames);
+    printf("%-8s %10s %10s %9s %9s %9s %9s %10s\n",
+           "quality", "bits/frm", "link bits", "rms C", "max C", "roi rms", "roi max", "enc us");
+
+    for (uint8_t q = 0; q < FRAME_CODEC_QUALITY_LEVELS; q++) {
+        ErrorStats err;
+        uint64_t bits = 0, link_bits = 0;
+        double enc_s = 0.0;
+
+        for (int i = 0; i < frames; i++) {
+            auto t0 = std::chrono::steady_clock::now();
+            uint16_t len = frame_codec_encode(scenes[i].pixels.data(), i, q,
+                                              &scenes[i].detection, packet, sizeof(packet));
+            enc_s += std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+
+            std::string line = to_line(packet, len);
+            if (len == 0 || !decoder.decode(line, decoded)) {
+                fprintf(stderr, "decode failed at frame %d, quality %u\n", i, q);
+                return 1;
+            }
+            bits += len * 8u;
+            link_bits += decoded.line_bytes * 8u;
+            err.add(scenes[i], decoded.pixels);
+        }
+
+        bool ok = err.roi_max <= MAX_SPAN_ERROR;
+        failures += !ok;
+        printf("%-8u %10.0f %10.0f %9.3f %9.3f %9.3f %9.3f %10.2f  %s\n", q,
+               double(bits) / frames, double(link_bits) / frames, err.rms(), err.max,
+               err.roi_rms(), err.roi_max, enc_s / frames * 1e6, ok ? "ok" : "FAIL");
+    }
+
+    // Rate control: subpages arrive at 16Hz, the controller decides what to send
+    printf("\nRate control (16Hz subpages, at most 4 images/s)\n");
+    printf("%-10s %10s %10s %9s %9s %9s %9s\n", "target", "achieved", "images/s", "quality", "rms C", "roi rms",
+           "roi max");
+
+    for (uint32_t bitrate : {1000u, 2000u, 4000u, 8000u, 16000u}) {
+        FrameCodecRate rc;
+        frame_codec_rate_init(&rc, bitrate, 4);
+        ErrorStats err;
+        double quality_sum = 0.0;
+        uint64_t now_us = 0;
+
+        for (int i = 0; i < frames; i++) {
+            now_us += 62500;
+            if (!frame_codec_rate_ready(&rc, now_us)) continue;
+
+            uint16_t len = frame_codec_encode(scenes[i].pixels.data(), i, rc.quality,
+                                              &scenes[i].detection, packet, sizeof(packet));
+            uint32_t line_bits = 0;
+            if (len > 0) {
+                quality_sum += rc.quality;
+                if (decoder.decode(to_line(packet, len), decoded)) {
+                    line_bits = decoded.line_bytes * 8u;
+                    err.add(scenes[i], decoded.pixels);
+                }
+            }
+            frame_codec_rate_sent(&rc, line_bits, now_us);
+        }
+
+        double seconds = now_us / 1e6;
+        bool ok = err.roi_max <= MAX_SPAN_ERROR;
+        failures += !ok;
+        printf("%-10u %10.0f %10.2f %9.2f %9.3f %9.3f %9.3f  %s\n", bitrate, rc.bits_sent / seconds,
+               rc.frames_sent / seconds, rc.frames_sent ? quality_sum / rc.frames_sent : 0.0,
+               err.rms(), err.roi_rms(), err.roi_max, ok ? "ok" : "FAIL");
+    }
+
+    if (failures > 0) {
+        printf("%d run(s) over %.1fC on the span: FAILED\n", failures, MAX_SPAN_ERROR);
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,189 @@
+/**
+ * bench_pixel_health.cpp
+ * Pixel health false-positive check on moving scenes
+ *
+ * Replays synthetic scenes through pixel_health_update() subpage by
+ * subpage, in chess and interleaved mode: a static tyre, a tyre heating
+ * from 30°C to 100°C and cooling again, and a tyre whose edges sweep
+ * three columns either way. Every pixel is healthy, with 0.15°C of sensor
+ * noise, so nothing may be flagged. The same scenes are then replayed
+ * with a stuck and a noisy pixel, which must both be flagged and nothing
+ * else. Exits non-zero on any failure. Finally the update is timed alone
+ * over a ring of pre-rendered shifting-edge frames.
+ *
+ * Usage: bench_pixel_health [subpages]
+ */
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <vector>
+
+extern "C" {
+#include "pixel_health.h"
+}
+
+#define NOISE_SIGMA 0.15f
+#define ROAD_TEMP 25.0f
+
+// Injected faults for the positive controls
+#define STUCK_PIXEL (10 * SENSOR_WIDTH + 14)
+#define STUCK_VALUE 41.5f
+#define NOISY_PIXEL (15 * SENSOR_WIDTH + 9)
+#define NOISY_SIGMA 2.0f
+
+enum Scene { SCENE_STATIC, SCENE_HEATING, SCENE_SHIFTING, SCENE_COUNT };
+
+static const char *const scene_names[SCENE_COUNT] = {"static", "heating ramp", "shifting edge"};
+
+// Tyre temperature across the tread for subpage t: cooler shoulders, a
+// one-column blend into the road at each edge
+static void render(Scene scene, int t, int subpages, float *frame) {
+    float peak = 60.0f;
+    int start = 8, end = 23;
+
+    if (scene == SCENE_HEATING) {
+        // Up in the first half, back down in the second
+        float phase = 2.0f * t / subpages;
+        peak = 30.0f + 70.0f * (phase < 1.0f ? phase : 2.0f - phase);
+    } else if (scene == SCENE_SHIFTING) {
+        int shift = (int)lrintf(3.0f * sinf(t * 0.15f));
+        start += shift;
+        end += shift;
+    }
+
+    float centre = 0.5f * (start + end);
+    float half = 0.5f * (end - start);
+    for (int col = 0; col < SENSOR_WIDTH; col++) {
+        float v = ROAD_TEMP;
+        if (col >= start && col <= end) {
+            float x = (col - centre) / half;
+            v = peak - 0.15f * (peak - ROAD_TEMP) * x * x;
+        } else if (col == start - 1 || col == end + 1) {
+            v = 0.5f * (ROAD_TEMP + peak * 0.85f + ROAD_TEMP * 0.15f);
+        }
+        for (int row = 0; row < SENSOR_HEIGHT; row++) frame[row * SENSOR_WIDTH + col] = v;
+    }
+}
+
+struct RunResult {
+    int flagged;
+    int stuck;
+    int noisy;
+    int dead;
+    bool stuck_found;
+    bool noisy_found;
+    uint32_t median_var;
+    double us_per_update;
+};
+
+static RunResult run(Scene scene, bool chess_mode, bool faults, int subpages, uint32_t seed) {
+    paramsMLX90640 params;
+    memset(&params, 0, sizeof(params));
+    for (int i = 0; i < 5; i++) {
+        params.brokenPixels[i] = 0xFFFF;
+        params.outlierPixels[i] = 0xFFFF;
+    }
+    pixel_health_init(&params);
+
+    std::mt19937 rng(seed);
+    std::normal_distribution<float> noise(0.0f, NOISE_SIGMA);
+    std::normal_distribution<float> bad_noise(0.0f, NOISY_SIGMA);
+    std::vector<float> frame(SENSOR_PIXELS);
+
+    double update_ns = 0.0;
+    for (int t = 0; t < subpages; t++) {
+        render(scene, t, subpages, frame.data());
+        for (float &v : frame) v += noise(rng);
+        if (faults) {
+            frame[STUCK_PIXEL] = STUCK_VALUE;
+            frame[NOISY_PIXEL] += bad_noise(rng);
+        }
+
+        auto t0 = std::chrono::steady_clock::now();
+        pixel_health_update(frame.data(), t & 1, chess_mode);
+        auto t1 = std::chrono::steady_clock::now();
+        update_ns += std::chrono::duration<double, std::nano>(t1 - t0).count();
+    }
+
+    PixelHealthStats stats;
+    pixel_health_get_stats(&stats);
+
+    RunResult r;
+    r.flagged = stats.flagged;
+    r.stuck = stats.stuck;
+    r.noisy = stats.noisy;
+    r.dead = stats.dead;
+    r.stuck_found = (pixel_health_flags(STUCK_PIXEL) & PIXEL_FLAG_STUCK) != 0;
+    r.noisy_found = (pixel_health_flags(NOISY_PIXEL) & PIXEL_FLAG_NOISY) != 0;
+    r.median_var = stats.median_var;
+    r.us_per_update = update_ns / subpages / 1000.0;
+    return r;
+}
+
+// ns per pixel_health_update() with nothing else in the loop
+static double time_updates(bool chess_mode) {
+    const int ring = 64;
+    const int rounds = 200;
+
+    paramsMLX90640 params;
+    memset(&params, 0, sizeof(params));
+    for (int i = 0; i < 5; i++) {
+        params.brokenPixels[i] = 0xFFFF;
+        params.outlierPixels[i] = 0xFFFF;
+    }
+    pixel_health_init(&params);
+
+    std::mt19937 rng(7);
+    std::normal_distribution<float> noise(0.0f, NOISE_SIGMA);
+    std::vector<float> frames(static_cast<size_t>(ring) * SENSOR_PIXELS);
+    for (int t = 0; t < ring; t++) {
+        float *frame = &frames[static_cast<size_t>(t) * SENSOR_PIXELS];
+        render(SCENE_SHIFTING, t, ring, frame);
+        for (int i = 0; i < SENSOR_PIXELS; i++) frame[i] += noise(rng);
+    }
+
+    auto t0 = std::chrono::steady_clock::now();
+    for (int r = 0; r < rounds; r++) {
+        for (int t = 0; t < ring; t++) {
+            pixel_health_update(&frames[static_cast<size_t>(t) * SENSOR_PIXELS], t & 1, chess_mode);
+        }
+    }
+    auto t1 = std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::nano>(t1 - t0).count() / (rounds * ring);
+}
+
+int main(int argc, char **argv) {
+    int subpages = (argc > 1) ? std::atoi(argv[1]) : 2048;
+    if (subpages < 4 * PIXEL_HEALTH_EVAL_INTERVAL) subpages = 4 * PIXEL_HEALTH_EVAL_INTERVAL;
+
+    printf("%d subpages per run, noise %.2fC\n\n", subpages, NOISE_SIGMA);
+    printf("%-14s %-12s %-7s %8s %6s %6s %5s %10s %10s  %s\n", "scene", "mode", "faults", "flagged", "stuck",
+           "noisy", "dead", "median", "us/update", "result");
+
+    int failures = 0;
+    for (int s = 0; s < SCENE_COUNT; s++) {
+        for (int chess = 1; chess >= 0; chess--) {
+            for (int faults = 0; faults <= 1; faults++) {
+                RunResult r = run(static_cast<Scene>(s), chess != 0, faults != 0, subpages, 1 + s);
+                bool ok = faults ? (r.flagged == 2 && r.stuck_found && r.noisy_found) : (r.flagged == 0);
+                failures += !ok;
+                printf("%-14s %-12s %-7s %8d %6d %6d %5d %10.4f %10.2f  %s\n", scene_names[s],
+                       chess ? "chess" : "interleaved", faults ? "yes" : "no", r.flagged, r.stuck, r.noisy,
+                       r.dead, r.median_var / 16.0 / 10000.0, r.us_per_update, ok ? "ok" : "FAIL");
+            }
+        }
+    }
+
+    printf("\nmedian is the median residual variance (C^2)\n");
+    printf("update alone: %.2f us (chess), %.2f us (interleaved)\n", time_updates(true) / 1000.0,
+           time_updates(false) / 1000.0);
+    if (failures > 0) {
+        printf("%d run(s) FAILED\n", failures);
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,139 @@
+/**
+ * bench_text_parser.cpp
+ * Throughput benchmark for TextStreamParser
+ *
+ * Synthesises a stream in the exact formats printed by send_serial_compact
+ * and send_serial_json (with timing lines mixed in), checks that every
+ * record decodes, then reports MB/s for each format.
+ *
+ * Usage: bench_text_parser [megabytes] [chunk_bytes]
+ */
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+
+#include "text_parser.h"
+
+class CountingSink : public RecordSink {
+public:
+    void on_record(const FrameRecord &record) override {
+        records++;
+        checksum += record.data.frame_number + record.data.centre.avg;
+    }
+    void on_text(std::string_view line) override {
+        (void)line;
+        text_lines++;
+    }
+
+    uint64_t records = 0;
+    uint64_t text_lines = 0;
+    double checksum = 0.0;
+};
+
+static void append_csv(std::string &out, uint32_t frame) {
+    char buf[128];
+    float base = 40.0f + (frame % 50) * 0.1f;
+    int len = snprintf(buf, sizeof(buf),
+                       "%lu,%.1f,%.1f,%.1f,%.1f,%.1f,%.1f,%.1f,%u,%.2f,%u\n",
+                       (unsigned long)frame, 7.2f, base, base + 0.1f, base + 2.5f,
+                       base + 2.4f, base - 1.0f, base - 1.1f, 18u, 0.85f, 1u);
+    out.append(buf, len);
+}
+
+static void append_json(std::string &out, uint32_t frame) {
+    char buf[2048];
+    int len = 0;
+    float t = 40.0f + (frame % 50) * 0.1f;
+
+    len += snprintf(buf + len, sizeof(buf) - len, "{\n");
+    len += snprintf(buf + len, sizeof(buf) - len, "  \"frame_number\": %lu,\n", (unsigned long)frame);
+    len += snprintf(buf + len, sizeof(buf) - len, "  \"fps\": %.1f,\n", 7.2f);
+    len += snprintf(buf + len, sizeof(buf) - len, "  \"analysis\": {\n");
+    const char *zones[] = {"left", "centre", "right"};
+    for (int z = 0; z < 3; z++) {
+        len += snprintf(buf + len, sizeof(buf) - len,
+                        "    \"%s\": {\"avg\": %.1f, \"median\": %.1f, \"mad\": %.2f, "
+                        "\"min\": %.1f, \"max\": %.1f, \"range\": %.1f},\n",
+                        zones[z], t + z, t + z, 0.42f, t - 2, t + 3, 5.0f);
+    }
+    len += snprintf(buf + len, sizeof(buf) - len, "    \"lateral_gradient\": %.1f\n", -1.5f);
+    len += snprintf(buf + len, sizeof(buf) - len, "  },\n");
+    len += snprintf(buf + len, sizeof(buf) - len, "  \"detection\": {\n");
+    len += snprintf(buf + len, sizeof(buf) - len, "    \"detected\": %u,\n", 1u);
+    len += snprintf(buf + len, sizeof(buf) - len, "    \"span_start\": %u,\n", 7u);
+    len += snprintf(buf + len, sizeof(buf) - len, "    \"span_end\": %u,\n", 24u);
+    len += snprintf(buf + len, sizeof(buf) - len, "    \"tyre_width\": %u,\n", 18u);
+    len += snprintf(buf + len, sizeof(buf) - len, "    \"confidence\": %.2f\n", 0.85f);
+    len += snprintf(buf + len, sizeof(buf) - len, "  },\n");
+    len += snprintf(buf + len, sizeof(buf) - len, "  \"temperature_profile\": [");
+    for (int i = 0; i < 32; i++) {
+        len += snprintf(buf + len, sizeof(buf) - len, "%.1f", t + i * 0.1f);
+        if (i < 31) len += snprintf(buf + len, sizeof(buf) - len, ", ");
+    }
+    len += snprintf(buf + len, sizeof(buf) - len, "],\n");
+    len += snprintf(buf + len, sizeof(buf) - len, "  \"warnings\": []\n");
+    len += snprintf(buf + len, sizeof(buf) - len, "}\n");
+    out.append(buf, len);
+}
+
+static void append_timing(std::string &out, uint32_t frame) {
+    char buf[160];
+    int len = snprintf(buf, sizeof(buf),
+                       "[Frame %lu] Total: %.1fms (%.1f fps) | "
+                       "Sensor: %.1fms | Calc: %.1fms | Algo: %.1fms | Comm: %.1fms\n",
+                       (unsigned long)frame, 138.2f, 7.2f, 125.3f, 8.1f, 3.2f, 1.6f);
+    out.append(buf, len);
+}
+
+static void run(const char *name, const std::string &stream, uint64_t expected,
+                size_t chunk) {
+    TextStreamParser parser;
+    CountingSink sink;
+
+    auto t0 = std::chrono::steady_clock::now();
+    for (size_t off = 0; off < stream.size(); off += chunk) {
+        size_t n = std::min(chunk, stream.size() - off);
+        parser.feed(stream.data() + off, n, sink);
+    }
+    auto t1 = std::chrono::steady_clock::now();
+
+    double secs = std::chrono::duration<double>(t1 - t0).count();
+    double mb = stream.size() / 1e6;
+    const TextParserStats &st = parser.stats();
+
+    printf("%-5s %8.1f MB in %7.3f s = %7.1f MB/s | records %llu/%llu text %llu malformed %llu\n",
+           name, mb, secs, mb / secs,
+           (unsigned long long)sink.records, (unsigned long long)expected,
+           (unsigned long long)st.text_lines, (unsigned long long)st.malformed);
+
+    if (sink.records != expected || st.malformed != 0) {
+        printf("ERROR: %s stream did not decode cleanly\n", name);
+        exit(1);
+    }
+}
+
+int main(int argc, char **argv) {
+    size_t megabytes = (argc > 1) ? strtoul(argv[1], nullptr, 10) : 64;
+    size_t chunk = (argc > 2) ? strtoul(argv[2], nullptr, 10) : 65536;
+    size_t target = megabytes * 1000000;
+
+    std::string csv, json;
+    uint64_t csv_frames = 0, json_frames = 0;
+
+    while (csv.size() < target) {
+        append_csv(csv, (uint32_t)++csv_frames);
+        if (csv_frames % 10 == 0) append_timing(csv, (uint32_t)csv_frames);
+    }
+    while (json.size() < target) {
+        append_json(json, (uint32_t)++json_frames);
+        if (json_frames % 10 == 0) append_timing(json, (uint32_t)json_frames);
+    }
+
+    printf("Chunk size: %zu bytes\n", chunk);
+    run("CSV", csv, csv_frames, chunk);
+    run("JSON", json, json_frames, chunk);
+    return 0;
+}
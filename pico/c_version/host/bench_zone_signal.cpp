@@ -0,0 +1,213 @@
+/**
+ * bench_zone_signal.cpp
+ * Span detection on the IR signal profile against the temperature profile
+ *
+ * In zone conversion mode the firmware detects the span on the profile
+ * rows' compensated IR signal (MLX90640_GetSignalRegion), averaged per
+ * column without the bad pixels and converted with
+ * MLX90640_SignalToTemperature. This replays random synthetic tyre scenes
+ * (synthetic_sensor.h) through both that path and the full one
+ * (MLX90640_CalculateToEnv, MLX90640_BadPixelsCorrection,
+ * thermal_algorithm_profile) and compares the span decisions of
+ * thermal_algorithm_detect. Half the scenes have up to three bad pixels
+ * in the profile rows; the signal path is also run without skipping them
+ * to show what that costs. There the two paths differ by design: the full
+ * path interpolates a bad pixel from its neighbours, the signal path
+ * averages the column without it, and detections close to a threshold
+ * can go either way. Exits non-zero if scenes without bad pixels agree
+ * on under MIN_AGREEMENT of spans, or if skipping bad pixels agrees less
+ * often than not skipping them.
+ *
+ * Usage: bench_zone_signal [scenes]
+ */
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <vector>
+
+#include "synthetic_sensor.h"
+
+#define EMISSIVITY 0.95f
+#define REFLECTED_TEMP 23.15f
+#define MAX_BAD 3
+
+// Identical spans required on scenes without bad pixels
+#define MIN_AGREEMENT 0.995
+
+struct Scene {
+    uint16_t frames[2][834];
+    uint16_t bad[MAX_BAD + 1];  // 0xFFFF-terminated
+    bool chess;
+};
+
+static void make_scene(Scene &s, int index, std::mt19937 &rng) {
+    std::uniform_real_distribution<float> uni(0.0f, 1.0f);
+    std::normal_distribution<float> noise(0.0f, 1.0f);
+
+    s.chess = (index & 1) == 0;
+    float road = 300.0f + 150.0f * uni(rng);
+    float tread = road + 150.0f + 2000.0f * uni(rng);
+    float shoulder = 0.3f * uni(rng);             // Fraction of the band lost at the edges
+    float vertical = 30.0f * (uni(rng) - 0.5f);   // Counts per row across the tread
+    float sigma = 2.0f + 6.0f * uni(rng);
+    int width = 6 + static_cast<int>(uni(rng) * 17.0f);
+    int start = static_cast<int>(uni(rng) * (SENSOR_WIDTH - width + 1));
+
+    // Bad pixels in distinct profile-row columns, away from the borders
+    int bad = (uni(rng) < 0.5f) ? 1 + static_cast<int>(uni(rng) * MAX_BAD) : 0;
+    int used = 0;
+    for (int i = 0; i < bad; i++) {
+        int col = 2 + static_cast<int>(uni(rng) * (SENSOR_WIDTH - 4));
+        int row = PROFILE_FIRST_ROW + static_cast<int>(uni(rng) * (PROFILE_LAST_ROW - PROFILE_FIRST_ROW + 1));
+        bool clash = false;
+        for (int j = 0; j < used; j++) clash |= std::abs(s.bad[j] % SENSOR_WIDTH - col) < 2;
+        if (!clash) s.bad[used++] = static_cast<uint16_t>(row * SENSOR_WIDTH + col);
+    }
+    s.bad[used] = 0xFFFF;
+
+    for (int sub = 0; sub < 2; sub++) {
+        uint16_t *fd = s.frames[sub];
+        for (int p = 0; p < SENSOR_PIXELS; p++) {
+            int c = p % SENSOR_WIDTH;
+            int r = p / SENSOR_WIDTH;
+            float counts = road + 3.0f * r;
+            if (c >= start && c < start + width) {
+                float x = (c - start + 0.5f) / width * 2.0f - 1.0f;
+                counts = road + (tread - road) * (1.0f - shoulder * x * x) + vertical * (r - 12);
+            }
+            counts += -50 + (p % 11) + sigma * noise(rng);
+            fd[p] = static_cast<uint16_t>(static_cast<int16_t>(counts));
+        }
+        for (int i = 0; i < used; i++) {
+            fd[s.bad[i]] = static_cast<uint16_t>(static_cast<int16_t>((i & 1) ? -3000 : 6000));
+        }
+        set_synthetic_aux(fd, s.chess, sub, rng);
+    }
+}
+
+struct Tally {
+    int scenes = 0;
+    int same_span = 0;
+    int same_detected = 0;
+    int off_by_one = 0;
+
+    void add(const TyreDetection &ref, const TyreDetection &d) {
+        scenes++;
+        if (ref.detected != d.detected) return;
+        same_detected++;
+        if (!ref.detected) {
+            same_span++;
+            return;
+        }
+        int delta = std::max(std::abs(ref.span_start - d.span_start), std::abs(ref.span_end - d.span_end));
+        if (delta == 0) same_span++;
+        else if (delta == 1) off_by_one++;
+    }
+
+    double agreement() const { return scenes ? static_cast<double>(same_span) / scenes : 1.0; }
+
+    void print(const char *name) const {
+        printf("%-26s %7d %9.2f%% %9.2f%% %9.2f%%\n", name, scenes,
+               100.0 * same_detected / (scenes ? scenes : 1), 100.0 * agreement(),
+               100.0 * off_by_one / (scenes ? scenes : 1));
+    }
+};
+
+int main(int argc, char **argv) {
+    int count = (argc > 1) ? std::atoi(argv[1]) : 5000;
+    if (count < 1) count = 1;
+
+    paramsMLX90640 params;
+    make_synthetic_params(params);
+    ThermalConfig config;
+    thermal_algorithm_init(&config);
+
+    std::mt19937 rng(1);
+    static const uint16_t no_bad[1] = {0xFFFF};
+    std::vector<float> temps(SENSOR_PIXELS), signal(SENSOR_PIXELS);
+    float profile[SENSOR_WIDTH], signal_profile[SENSOR_WIDTH];
+
+    Tally clean, with_bad, with_bad_unskipped;
+    double full_ns = 0.0, zone_ns = 0.0;
+    int hot_min = 1000, hot_max = -1000;
+
+    for (int i = 0; i < count; i++) {
+        Scene scene;
+        make_scene(scene, i, rng);
+
+        envMLX90640 env;
+        MLX90640_InitEnvironment(&env, 1.0f);
+        for (int sub = 0; sub < 2; sub++) {
+            uint16_t *fd = scene.frames[sub];
+            MLX90640_UpdateEnvironment(fd, &params, &env);
+
+            auto t0 = std::chrono::steady_clock::now();
+            MLX90640_CalculateToEnv(fd, &params, &env, EMISSIVITY, REFLECTED_TEMP, temps.data());
+            auto t1 = std::chrono::steady_clock::now();
+            MLX90640_GetSignalRegion(fd, &params, &env, EMISSIVITY, PROFILE_FIRST_ROW, PROFILE_LAST_ROW,
+                                     signal.data());
+            auto t2 = std::chrono::steady_clock::now();
+            full_ns += std::chrono::duration<double, std::nano>(t1 - t0).count();
+            zone_ns += std::chrono::duration<double, std::nano>(t2 - t1).count();
+        }
+
+        // Full path, as the firmware outside zone mode
+        MLX90640_BadPixelsCorrection(scene.bad, temps.data(), scene.chess ? 1 : 0, &params);
+        thermal_algorithm_profile(temps.data(), profile);
+        TyreDetection ref;
+        thermal_algorithm_detect(profile, &ref, &config);
+        for (int c = 0; c < SENSOR_WIDTH; c++) {
+            hot_min = std::min(hot_min, static_cast<int>(profile[c]));
+            hot_max = std::max(hot_max, static_cast<int>(profile[c]));
+        }
+
+        // Signal path, with and without leaving the bad pixels out
+        const uint16_t *lists[2] = {scene.bad, no_bad};
+        for (int skip = 0; skip < 2; skip++) {
+            thermal_algorithm_profile_skip(signal.data(), lists[skip], signal_profile);
+            for (int c = 0; c < SENSOR_WIDTH; c++) {
+                signal_profile[c] = MLX90640_SignalToTemperature(signal_profile[c], &params, &env, EMISSIVITY,
+                                                                 REFLECTED_TEMP);
+            }
+            TyreDetection d;
+            thermal_algorithm_detect(signal_profile, &d, &config);
+
+            if (scene.bad[0] == 0xFFFF) {
+                if (skip == 0) clean.add(ref, d);
+            } else if (skip == 0) {
+                with_bad.add(ref, d);
+            } else {
+                with_bad_unskipped.add(ref, d);
+            }
+        }
+    }
+
+    Tally all = clean;
+    all.scenes += with_bad.scenes;
+    all.same_span += with_bad.same_span;
+    all.same_detected += with_bad.same_detected;
+    all.off_by_one += with_bad.off_by_one;
+
+    printf("%d scenes, profile %d..%dC\n\n", count, hot_min, hot_max);
+    printf("%-26s %7s %10s %10s %10s\n", "signal path", "scenes", "detected", "span", "off by 1");
+    clean.print("no bad pixels");
+    with_bad.print("bad pixels, skipped");
+    with_bad_unskipped.print("bad pixels, not skipped");
+    all.print("firmware path, all");
+    printf("\nper subpage: full conversion %.2f us, profile-row signal %.2f us\n", full_ns / (2.0 * count) / 1000.0,
+           zone_ns / (2.0 * count) / 1000.0);
+
+    int failures = 0;
+    if (clean.agreement() < MIN_AGREEMENT) {
+        printf("span agreement %.2f%% under %.1f%%: FAIL\n", 100.0 * clean.agreement(), 100.0 * MIN_AGREEMENT);
+        failures++;
+    }
+    if (with_bad.agreement() < with_bad_unskipped.agreement()) {
+        printf("skipping bad pixels agrees less than not skipping them: FAIL\n");
+        failures++;
+    }
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,231 @@
+/**
+ * calibration_catalog.cpp
+ * Memory-mapped catalog of MLX90640 calibrations for host tools
+ */
+
+#include "calibration_catalog.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+// Device ID words in the EEPROM dump (0x2407-0x2409)
+#define EEPROM_ID_WORD 7
+
+uint64_t calibration_serial(const uint16_t *eeprom) {
+    return ((uint64_t)eeprom[EEPROM_ID_WORD] << 32) | ((uint64_t)eeprom[EEPROM_ID_WORD + 1] << 16) |
+           eeprom[EEPROM_ID_WORD + 2];
+}
+
+uint64_t calibration_eeprom_hash(const uint16_t *eeprom) {
+    uint64_t h = 0xCBF29CE484222325ull;
+    for (int i = 0; i < CALIBRATION_EEPROM_WORDS; i++) {
+        h = (h ^ (eeprom[i] & 0xFF)) * 0x100000001B3ull;
+        h = (h ^ (eeprom[i] >> 8)) * 0x100000001B3ull;
+    }
+    return h;
+}
+
+bool calibration_read_eeprom(const std::string &path, uint16_t *eeprom) {
+    FILE *f = fopen(path.c_str(), "rb");
+    if (!f) {
+        fprintf(stderr, "%s: %s\n", path.c_str(), strerror(errno));
+        return false;
+    }
+    uint8_t bytes[CALIBRATION_EEPROM_WORDS * 2];
+    size_t n = fread(bytes, 1, sizeof(bytes), f);
+    bool extra = fgetc(f) != EOF;
+    fclose(f);
+    if (n != sizeof(bytes) || extra) {
+        fprintf(stderr, "%s: expected a %zu-byte EEPROM dump\n", path.c_str(), sizeof(bytes));
+        return false;
+    }
+    for (int i = 0; i < CALIBRATION_EEPROM_WORDS; i++) {
+        eeprom[i] = (uint16_t)(bytes[2 * i] | (bytes[2 * i + 1] << 8));
+    }
+    return true;
+}
+
+//------------------------------------------------------------------------------
+// Reader
+
+bool CalibrationCatalog::open(const std::string &path) {
+    close();
+
+    int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        fprintf(stderr, "%s: %s\n", path.c_str(), strerror(errno));
+        return false;
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0 || (size_t)st.st_size < sizeof(CalibrationCatalogHeader)) {
+        fprintf(stderr, "%s: not a calibration catalog\n", path.c_str());
+        ::close(fd);
+        return false;
+    }
+    size_t size = (size_t)st.st_size;
+    void *map = mmap(nullptr, size, PROT_READ, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (map == MAP_FAILED) {
+        fprintf(stderr, "mmap %s: %s\n", path.c_str(), strerror(errno));
+        return false;
+    }
+
+    const auto *h = static_cast<const CalibrationCatalogHeader *>(map);
+    const char *reason = nullptr;
+    uint64_t n = h->entry_count;
+    if (h->magic != CALIBRATION_CATALOG_MAGIC) {
+        reason = "not a calibration catalog";
+    } else if (h->version != CALIBRATION_CATALOG_VERSION) {
+        reason = "unsupported catalog version";
+    } else if (h->header_size != sizeof(CalibrationCatalogHeader) || h->entry_size != sizeof(CalibrationEntry) ||
+               h->params_size != sizeof(paramsMLX90640) || h->coefficients_size != sizeof(PixelCoefficients)) {
+        reason = "catalog written for a different struct layout";
+    } else if (h->serial_index_offset + n * sizeof(CalibrationIndex) > size ||
+               h->hash_index_offset + n * sizeof(CalibrationIndex) > size ||
+               h->entries_offset % alignof(CalibrationEntry) != 0 ||
+               h->entries_offset + n * sizeof(CalibrationEntry) > size) {
+        reason = "truncated catalog";
+    }
+    if (reason) {
+        fprintf(stderr, "%s: %s\n", path.c_str(), reason);
+        munmap(map, size);
+        return false;
+    }
+
+    const char *base = static_cast<const char *>(map);
+    header_ = h;
+    by_serial_ = reinterpret_cast<const CalibrationIndex *>(base + h->serial_index_offset);
+    by_hash_ = reinterpret_cast<const CalibrationIndex *>(base + h->hash_index_offset);
+    entries_ = reinterpret_cast<const CalibrationEntry *>(base + h->entries_offset);
+    map_size_ = size;
+    return true;
+}
+
+void CalibrationCatalog::close() {
+    if (!header_) return;
+    munmap(const_cast<CalibrationCatalogHeader *>(header_), map_size_);
+    header_ = nullptr;
+    by_serial_ = by_hash_ = nullptr;
+    entries_ = nullptr;
+    map_size_ = 0;
+}
+
+const CalibrationEntry *CalibrationCatalog::find(const CalibrationIndex *index, uint64_t key) const {
+    if (!header_) return nullptr;
+    const CalibrationIndex *end = index + header_->entry_count;
+    const CalibrationIndex *it = std::lower_bound(index, end, key,
+                                                  [](const CalibrationIndex &a, uint64_t k) { return a.key < k; });
+    if (it == end || it->key != key || it->entry >= header_->entry_count) return nullptr;
+    return &entries_[it->entry];
+}
+
+const CalibrationEntry *CalibrationCatalog::find_serial(uint64_t serial) const {
+    return find(by_serial_, serial);
+}
+
+const CalibrationEntry *CalibrationCatalog::find_hash(uint64_t eeprom_hash) const {
+    return find(by_hash_, eeprom_hash);
+}
+
+const CalibrationEntry *CalibrationCatalog::find_eeprom(const uint16_t *eeprom) const {
+    const CalibrationEntry *e = find_hash(calibration_eeprom_hash(eeprom));
+    if (e && memcmp(e->eeprom, eeprom, sizeof(e->eeprom)) != 0) return nullptr;
+    return e;
+}
+
+//------------------------------------------------------------------------------
+// Writer
+
+bool CalibrationCatalogWriter::load(const CalibrationCatalog &catalog) {
+    if (!catalog.is_open()) return false;
+    entries_.clear();
+    if (catalog.size() == 0) return true;
+    entries_.assign(&catalog.entry(0), &catalog.entry(0) + catalog.size());
+    return true;
+}
+
+bool CalibrationCatalogWriter::add(const uint16_t *eeprom) {
+    CalibrationEntry entry;
+    memset(&entry, 0, sizeof(entry));
+    entry.serial = calibration_serial(eeprom);
+    entry.eeprom_hash = calibration_eeprom_hash(eeprom);
+    memcpy(entry.eeprom, eeprom, sizeof(entry.eeprom));
+
+    uint16_t scratch[CALIBRATION_EEPROM_WORDS];
+    memcpy(scratch, eeprom, sizeof(scratch));
+    int status = MLX90640_ExtractParameters(scratch, &entry.params);
+    if (status != 0) {
+        fprintf(stderr, "sensor %012llx: parameter extraction failed (code %d)\n",
+                (unsigned long long)entry.serial, status);
+        return false;
+    }
+    pixel_coefficients_compile(entry.params, entry.coefficients);
+
+    for (CalibrationEntry &e : entries_) {
+        if (e.serial == entry.serial) {
+            e = entry;
+            return true;
+        }
+    }
+    entries_.push_back(entry);
+    return true;
+}
+
+bool CalibrationCatalogWriter::write(const std::string &path) const {
+    uint32_t n = (uint32_t)entries_.size();
+
+    std::vector<CalibrationIndex> by_serial(n), by_hash(n);
+    for (uint32_t i = 0; i < n; i++) {
+        by_serial[i] = {entries_[i].serial, i, 0};
+        by_hash[i] = {entries_[i].eeprom_hash, i, 0};
+    }
+    auto by_key = [](const CalibrationIndex &a, const CalibrationIndex &b) { return a.key < b.key; };
+    std::sort(by_serial.begin(), by_serial.end(), by_key);
+    std::sort(by_hash.begin(), by_hash.end(), by_key);
+
+    CalibrationCatalogHeader h;
+    memset(&h, 0, sizeof(h));
+    h.magic = CALIBRATION_CATALOG_MAGIC;
+    h.version = CALIBRATION_CATALOG_VERSION;
+    h.header_size = sizeof(h);
+    h.entry_count = n;
+    h.entry_size = sizeof(CalibrationEntry);
+    h.params_size = sizeof(paramsMLX90640);
+    h.coefficients_size = sizeof(PixelCoefficients);
+    h.serial_index_offset = sizeof(h);
+    h.hash_index_offset = h.serial_index_offset + n * sizeof(CalibrationIndex);
+    // Entries start on a page so each sensor's tables share cleanly
+    h.entries_offset = (h.hash_index_offset + n * sizeof(CalibrationIndex) + 4095) & ~(uint64_t)4095;
+    h.created_unix_ns = (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(
+                            std::chrono::system_clock::now().time_since_epoch()).count();
+
+    std::string tmp = path + ".tmp";
+    FILE *f = fopen(tmp.c_str(), "wb");
+    if (!f) {
+        fprintf(stderr, "%s: %s\n", tmp.c_str(), strerror(errno));
+        return false;
+    }
+    static const char zeros[4096] = {};
+    size_t pad = h.entries_offset - (h.hash_index_offset + n * sizeof(CalibrationIndex));
+    bool ok = fwrite(&h, sizeof(h), 1, f) == 1 &&
+              fwrite(by_serial.data(), sizeof(CalibrationIndex), n, f) == n &&
+              fwrite(by_hash.data(), sizeof(CalibrationIndex), n, f) == n &&
+              fwrite(zeros, 1, pad, f) == pad &&
+              fwrite(entries_.data(), sizeof(CalibrationEntry), n, f) == n;
+    ok = (fflush(f) == 0) && ok;
+    ok = (fsync(fileno(f)) == 0) && ok;
+    ok = (fclose(f) == 0) && ok;
+    if (!ok || rename(tmp.c_str(), path.c_str()) != 0) {
+        fprintf(stderr, "%s: %s\n", path.c_str(), strerror(errno));
+        unlink(tmp.c_str());
+        return false;
+    }
+    return true;
+}
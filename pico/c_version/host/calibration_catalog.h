@@ -0,0 +1,126 @@
+/**
+ * calibration_catalog.h
+ * Memory-mapped catalog of MLX90640 calibrations for host tools
+ *
+ * MLX90640_ExtractParameters() and the per-pixel coefficient tables are
+ * the same every time a sensor's EEPROM is seen, so a catalog file stores
+ * them once per sensor, keyed by the sensor's device ID (EEPROM words
+ * 0x2407-0x2409) and by a hash of the whole EEPROM dump. Tools map the
+ * file read-only and use the entries in place: opening is one mmap and
+ * a lookup is a binary search, and processes reading the same catalog
+ * share its pages.
+ *
+ * The file holds the structs in native (little-endian x86-64/aarch64)
+ * layout. The header records the struct sizes and a reader rejects a
+ * catalog written for a different layout; bump CALIBRATION_CATALOG_VERSION
+ * on any change. Writers replace the file by rename, so readers that
+ * already have it mapped keep a consistent view.
+ */
+
+#ifndef CALIBRATION_CATALOG_H
+#define CALIBRATION_CATALOG_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "frame_batch.h"
+
+#define CALIBRATION_CATALOG_MAGIC 0x43435454u  // "TTCC"
+#define CALIBRATION_CATALOG_VERSION 2
+#define CALIBRATION_EEPROM_WORDS MLX90640_EEPROM_DUMP_NUM
+
+struct alignas(64) CalibrationEntry {
+    uint64_t serial;                            // Device ID, EEPROM words 7-9
+    uint64_t eeprom_hash;                       // FNV-1a 64 of the dump
+    uint16_t eeprom[CALIBRATION_EEPROM_WORDS];  // The dump itself
+    paramsMLX90640 params;                      // MLX90640_ExtractParameters()
+    PixelCoefficients coefficients;             // pixel_coefficients_compile()
+};
+
+// Sorted lookup table: key is serial or eeprom_hash
+struct CalibrationIndex {
+    uint64_t key;
+    uint32_t entry;
+    uint32_t reserved;
+};
+
+struct CalibrationCatalogHeader {
+    uint32_t magic;
+    uint16_t version;
+    uint16_t header_size;
+    uint32_t entry_count;
+    uint32_t entry_size;            // sizeof(CalibrationEntry)
+    uint32_t params_size;           // sizeof(paramsMLX90640)
+    uint32_t coefficients_size;     // sizeof(PixelCoefficients)
+    uint64_t serial_index_offset;   // entry_count CalibrationIndex by serial
+    uint64_t hash_index_offset;     // entry_count CalibrationIndex by hash
+    uint64_t entries_offset;        // entry_count CalibrationEntry (page aligned)
+    uint64_t created_unix_ns;
+    uint8_t reserved[8];
+};
+
+static_assert(sizeof(CalibrationCatalogHeader) == 64, "catalog header layout");
+static_assert(sizeof(CalibrationIndex) == 16, "catalog index layout");
+
+// Device ID and dump hash used as catalog keys
+uint64_t calibration_serial(const uint16_t *eeprom);
+uint64_t calibration_eeprom_hash(const uint16_t *eeprom);
+
+// Read a raw EEPROM dump: CALIBRATION_EEPROM_WORDS little-endian words
+bool calibration_read_eeprom(const std::string &path, uint16_t *eeprom);
+
+// Read-only view of a catalog file
+class CalibrationCatalog {
+public:
+    CalibrationCatalog() = default;
+    ~CalibrationCatalog() { close(); }
+    CalibrationCatalog(const CalibrationCatalog &) = delete;
+    CalibrationCatalog &operator=(const CalibrationCatalog &) = delete;
+
+    // Map the file and check its header. Prints the reason on failure.
+    bool open(const std::string &path);
+    void close();
+
+    bool is_open() const { return header_ != nullptr; }
+    size_t size() const { return header_ ? header_->entry_count : 0; }
+    const CalibrationEntry &entry(size_t i) const { return entries_[i]; }
+
+    // nullptr if the catalog has no such sensor
+    const CalibrationEntry *find_serial(uint64_t serial) const;
+    const CalibrationEntry *find_hash(uint64_t eeprom_hash) const;
+
+    // Entry whose dump matches eeprom word for word
+    const CalibrationEntry *find_eeprom(const uint16_t *eeprom) const;
+
+private:
+    const CalibrationEntry *find(const CalibrationIndex *index, uint64_t key) const;
+
+    const CalibrationCatalogHeader *header_ = nullptr;
+    const CalibrationIndex *by_serial_ = nullptr;
+    const CalibrationIndex *by_hash_ = nullptr;
+    const CalibrationEntry *entries_ = nullptr;
+    size_t map_size_ = 0;
+};
+
+// Builds a catalog file from EEPROM dumps
+class CalibrationCatalogWriter {
+public:
+    // Start from the entries of an existing catalog
+    bool load(const CalibrationCatalog &catalog);
+
+    // Extract and compile a dump. A sensor already present is replaced.
+    // Returns false (and prints why) if the EEPROM doesn't extract.
+    bool add(const uint16_t *eeprom);
+
+    size_t size() const { return entries_.size(); }
+
+    // Write path.tmp and rename it over path
+    bool write(const std::string &path) const;
+
+private:
+    std::vector<CalibrationEntry> entries_;
+};
+
+#endif // CALIBRATION_CATALOG_H
@@ -0,0 +1,255 @@
+/**
+ * frame_batch.cpp
+ * Batched MLX90640 conversion and tyre analysis for host tools
+ *
+ * process() runs three passes over a batch:
+ *   1. update_environment() steps the smoothed Ta/Vdd/gain/CP terms
+ *      through the frames in order and files each frame's terms under
+ *      the pixel classes it measured
+ *   2. convert() loads a pixel's calibration once and converts it for
+ *      every frame that measured it (the vectorised loop), then fills in
+ *      the other frames with the previous value
+ *   3. analyse() builds the column profiles across frames and runs
+ *      detection and zones frame by frame
+ *
+ * The arithmetic in convert() follows MLX90640_CalculateToRegion()
+ * operation for operation, in single precision like the firmware, so the
+ * output is identical as long as the compiler doesn't contract or
+ * reassociate floating point (no -ffast-math).
+ */
+
+#include "frame_batch.h"
+
+#include <cmath>
+#include <cstring>
+
+// First word of the auxiliary data read by MLX90640_UpdateEnvironment()
+#define AUX_FIRST_WORD 768
+
+RawFrameBatch::RawFrameBatch(size_t capacity)
+    : capacity_(capacity > 0 ? capacity : 1),
+      words_(FRAME_BATCH_WORDS * capacity_) {}
+
+bool RawFrameBatch::push(const uint16_t *frame_data) {
+    if (full()) return false;
+    for (size_t w = 0; w < FRAME_BATCH_WORDS; w++) {
+        words_[w * capacity_ + size_] = frame_data[w];
+    }
+    size_++;
+    return true;
+}
+
+void BatchOutput::resize(size_t capacity, size_t size) {
+    if (capacity_ != capacity) {
+        capacity_ = capacity;
+        pixels_.assign(SENSOR_PIXELS * capacity, 0.0f);
+        results_.assign(capacity, FrameData{});
+    }
+    size_ = size;
+}
+
+void BatchOutput::frame(size_t f, float *pixels) const {
+    for (int p = 0; p < SENSOR_PIXELS; p++) {
+        pixels[p] = pixels_[p * capacity_ + f];
+    }
+}
+
+void pixel_coefficients_compile(const paramsMLX90640 &params, PixelCoefficients &coeffs) {
+    // Same expressions as MLX90640_UpdateEnvironment() so results match
+    const float kta_scale = 1.0f / POW2F(params.ktaScale);
+    const float kv_scale = 1.0f / POW2F(params.kvScale);
+    const float alpha_scale = (float)SCALEALPHA * POW2F(params.alphaScale);
+
+    for (int p = 0; p < SENSOR_PIXELS; p++) {
+        int il_pattern = (p / SENSOR_WIDTH) & 1;
+        int conversion_pattern = ((p + 2) / 4 - (p + 3) / 4 + (p + 1) / 4 - p / 4) * (1 - 2 * il_pattern);
+
+        coeffs.kta[p] = MLX90640_GetPixelKta(&params, p) * kta_scale;
+        coeffs.kv[p] = MLX90640_GetPixelKv(&params, p) * kv_scale;
+        coeffs.alpha[p] = alpha_scale / params.alpha[p];
+        coeffs.offset[p] = MLX90640_GetPixelOffset(&params, p);
+        coeffs.il_add[p] = params.ilChessC[2] * (2 * il_pattern - 1);
+        coeffs.il_sub[p] = params.ilChessC[1] * conversion_pattern;
+    }
+}
+
+BatchProcessor::BatchProcessor(const paramsMLX90640 &params, float smoothing, float emissivity, float tr)
+    : params_(params), owned_coeffs_(new PixelCoefficients), emissivity_(emissivity), tr_(tr) {
+    pixel_coefficients_compile(params_, *owned_coeffs_);
+    coeffs_ = owned_coeffs_.get();
+    MLX90640_InitEnvironment(&env_, smoothing);
+    thermal_algorithm_init(&config_);
+}
+
+BatchProcessor::BatchProcessor(const paramsMLX90640 &params, const PixelCoefficients &coeffs,
+                               float smoothing, float emissivity, float tr)
+    : params_(params), coeffs_(&coeffs), emissivity_(emissivity), tr_(tr) {
+    MLX90640_InitEnvironment(&env_, smoothing);
+    thermal_algorithm_init(&config_);
+}
+
+void BatchProcessor::process(const RawFrameBatch &batch, BatchOutput &out) {
+    size_t n = batch.size();
+    out.resize(batch.capacity(), n);
+    if (n == 0) return;
+
+    if (raw_.size() < n) {
+        for (auto *v : {&raw_, &converted_, &sum_, &count_}) v->resize(n);
+        profiles_.resize(n * SENSOR_WIDTH);
+    }
+
+    update_environment(batch, n);
+    convert(batch, n, out);
+    analyse(n, out);
+}
+
+void BatchProcessor::update_environment(const RawFrameBatch &batch, size_t n) {
+    uint16_t frame_data[FRAME_BATCH_WORDS] = {};
+
+    float tr4 = tr_ + 273.15f;
+    tr4 = tr4 * tr4;
+    tr4 = tr4 * tr4;
+
+    for (PixelClass &cls : classes_) {
+        for (auto *v : {&cls.gain, &cls.ta_delta, &cls.vdd_delta, &cls.ks_ta, &cls.ta_tr, &cls.cp, &cls.il_chess}) {
+            v->clear();
+        }
+        cls.frames.clear();
+    }
+
+    for (size_t f = 0; f < n; f++) {
+        for (size_t w = AUX_FIRST_WORD; w < FRAME_BATCH_WORDS; w++) {
+            frame_data[w] = batch.word(w)[f];
+        }
+        MLX90640_UpdateEnvironment(frame_data, &params_, &env_);
+
+        int subpage = frame_data[833];
+        float ta_tr = tr4 - (tr4 - env_.ta4) / emissivity_;
+        float cp = params_.tgc * env_.irDataCP[subpage];
+        float il_chess = (env_.mode != params_.calibrationModeEE) ? 1.0f : 0.0f;
+
+        // Class k has interleave pattern k & 1 and chess pattern k >> 1
+        for (int k = 0; k < 4; k++) {
+            int pattern = (env_.mode == 0) ? (k & 1) : (k >> 1);
+            if (pattern != subpage) continue;
+
+            PixelClass &cls = classes_[k];
+            cls.frames.push_back(static_cast<uint32_t>(f));
+            cls.gain.push_back(env_.gain);
+            cls.ta_delta.push_back(env_.taDelta);
+            cls.vdd_delta.push_back(env_.vddDelta);
+            cls.ks_ta.push_back(env_.ksTaFactor);
+            cls.ta_tr.push_back(ta_tr);
+            cls.cp.push_back(cp);
+            cls.il_chess.push_back(il_chess);
+        }
+    }
+}
+
+void BatchProcessor::convert(const RawFrameBatch &batch, size_t n, BatchOutput &out) {
+    const float emissivity = emissivity_;
+    const float ks_to1 = params_.ksTo[1];
+    const float alpha_ks_to1 = 1 - params_.ksTo[1] * 273.15f;
+    const float corr0 = env_.alphaCorrR[0], corr1 = env_.alphaCorrR[1];
+    const float corr2 = env_.alphaCorrR[2], corr3 = env_.alphaCorrR[3];
+    const float ks_to0 = params_.ksTo[0], ks_to2 = params_.ksTo[2], ks_to3 = params_.ksTo[3];
+    const float ct0 = params_.ct[0], ct1 = params_.ct[1], ct2 = params_.ct[2], ct3 = params_.ct[3];
+
+    float *__restrict raw_measured = raw_.data();
+    float *__restrict converted = converted_.data();
+
+    const PixelCoefficients &coeffs = *coeffs_;
+
+    for (int p = 0; p < SENSOR_PIXELS; p++) {
+        int line = p / SENSOR_WIDTH;
+        int column = p % SENSOR_WIDTH;
+        int il_pattern = line & 1;
+        int chess_pattern = il_pattern ^ (column & 1);
+
+        const PixelClass &cls = classes_[il_pattern | (chess_pattern << 1)];
+        const uint32_t *frames = cls.frames.data();
+        const size_t m = cls.frames.size();
+        const float *__restrict gain = cls.gain.data();
+        const float *__restrict ta_delta = cls.ta_delta.data();
+        const float *__restrict vdd_delta = cls.vdd_delta.data();
+        const float *__restrict ks_ta = cls.ks_ta.data();
+        const float *__restrict ta_tr = cls.ta_tr.data();
+        const float *__restrict cp = cls.cp.data();
+        const float *__restrict il_chess = cls.il_chess.data();
+
+        // Calibration terms, loaded once for the whole batch
+        float kta = coeffs.kta[p];
+        float kv = coeffs.kv[p];
+        float offset = coeffs.offset[p];
+        float il_add = coeffs.il_add[p];
+        float il_sub = coeffs.il_sub[p];
+        float alpha = coeffs.alpha[p];
+
+        const uint16_t *raw = batch.word(p);
+        for (size_t j = 0; j < m; j++) {
+            raw_measured[j] = static_cast<int16_t>(raw[frames[j]]);
+        }
+
+        for (size_t j = 0; j < m; j++) {
+            float ir_data = raw_measured[j] * gain[j];
+            ir_data = ir_data - offset * (1 + kta * ta_delta[j]) * (1 + kv * vdd_delta[j]);
+            // Multiplying by the 0/1 flag rather than selecting keeps the
+            // loop branch-free; adding and subtracting zero is exact
+            ir_data = ir_data + il_chess[j] * il_add - il_chess[j] * il_sub;
+            ir_data = ir_data - cp[j];
+            ir_data = ir_data / emissivity;
+
+            float alpha_comp = alpha * ks_ta[j];
+            float sx = alpha_comp * alpha_comp * alpha_comp * (ir_data + alpha_comp * ta_tr[j]);
+            sx = std::sqrt(std::sqrt(sx)) * ks_to1;
+            float t = std::sqrt(std::sqrt(ir_data / (alpha_comp * alpha_ks_to1 + sx) + ta_tr[j])) - 273.15f;
+
+            float corr = t < ct1 ? corr0 : t < ct2 ? corr1 : t < ct3 ? corr2 : corr3;
+            float ks_to = t < ct1 ? ks_to0 : t < ct2 ? ks_to1 : t < ct3 ? ks_to2 : ks_to3;
+            float ct = t < ct1 ? ct0 : t < ct2 ? ct1 : t < ct3 ? ct2 : ct3;
+
+            converted[j] = std::sqrt(std::sqrt(ir_data / (alpha_comp * corr * (1 + ks_to * (t - ct))) + ta_tr[j])) - 273.15f;
+        }
+
+        // Frames that measured the other subpage keep the previous value,
+        // in frame order
+        float *to = &out.pixels_[p * out.capacity_];
+        float prev = last_[p];
+        size_t j = 0;
+        for (size_t f = 0; f < n; f++) {
+            if (j < m && frames[j] == f) prev = converted[j++];
+            to[f] = prev;
+        }
+        last_[p] = prev;
+    }
+}
+
+void BatchProcessor::analyse(size_t n, BatchOutput &out) {
+    float *__restrict sum = sum_.data();
+    float *__restrict count = count_.data();
+
+    // Column profiles as thermal_algorithm_profile() builds them
+    for (int col = 0; col < SENSOR_WIDTH; col++) {
+        std::memset(sum, 0, n * sizeof(float));
+        std::memset(count, 0, n * sizeof(float));
+        for (int row = PROFILE_FIRST_ROW; row <= PROFILE_LAST_ROW; row++) {
+            const float *__restrict to = out.pixel(row * SENSOR_WIDTH + col);
+            for (size_t f = 0; f < n; f++) {
+                float t = to[f];
+                bool valid = t > -270.0f;
+                sum[f] += valid ? t : 0.0f;
+                count[f] += valid ? 1.0f : 0.0f;
+            }
+        }
+        for (size_t f = 0; f < n; f++) {
+            profiles_[f * SENSOR_WIDTH + col] = (count[f] > 0) ? (sum[f] / count[f]) : 0.0f;
+        }
+    }
+
+    // Detection and zones keep per-frame state (frame counter), so in order
+    for (size_t f = 0; f < n; f++) {
+        const float *profile = &profiles_[f * SENSOR_WIDTH];
+        thermal_algorithm_detect(profile, &out.results_[f].detection, &config_);
+        thermal_algorithm_zones(profile, &out.results_[f]);
+    }
+}
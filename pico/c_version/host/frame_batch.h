@@ -0,0 +1,141 @@
+/**
+ * frame_batch.h
+ * Batched MLX90640 conversion and tyre analysis for host tools
+ *
+ * Reprocessing recorded subpages one at a time through
+ * MLX90640_UpdateEnvironment/CalculateToEnv and thermal_algorithm_process
+ * reloads every pixel's calibration terms per frame and can't vectorise.
+ * BatchProcessor instead takes N subpages of one sensor in
+ * structure-of-arrays order (each word's values for all N frames are
+ * contiguous) and converts pixel by pixel with the frame as the inner,
+ * vectorised loop.
+ *
+ * Anything with temporal state still runs in frame order: environment
+ * smoothing, pixels carried over from the other subpage, and the
+ * algorithm's frame counter. Results match the per-frame calls exactly.
+ * Use one BatchProcessor per sensor.
+ */
+
+#ifndef FRAME_BATCH_H
+#define FRAME_BATCH_H
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+extern "C" {
+#include "thermal_algorithm.h"
+#include "MLX90640_API.h"
+}
+
+// Words per subpage as returned by MLX90640_GetFrameData()
+#define FRAME_BATCH_WORDS 834
+
+// Per-pixel calibration terms in the form the converter uses, derived
+// from paramsMLX90640 alone (the scales folded in as
+// MLX90640_UpdateEnvironment() computes them)
+struct PixelCoefficients {
+    float kta[SENSOR_PIXELS];           // kta / 2^ktaScale
+    float kv[SENSOR_PIXELS];            // kv / 2^kvScale
+    float alpha[SENSOR_PIXELS];         // SCALEALPHA * 2^alphaScale / alpha
+    float offset[SENSOR_PIXELS];
+    float il_add[SENSOR_PIXELS];        // Interleave/chess correction terms
+    float il_sub[SENSOR_PIXELS];
+};
+
+void pixel_coefficients_compile(const paramsMLX90640 &params, PixelCoefficients &coeffs);
+
+// Raw subpages in structure-of-arrays order: word w of frame f is at
+// word(w)[f]
+class RawFrameBatch {
+public:
+    explicit RawFrameBatch(size_t capacity);
+
+    // Append one subpage (FRAME_BATCH_WORDS words). False if full.
+    bool push(const uint16_t *frame_data);
+    void clear() { size_ = 0; }
+
+    size_t size() const { return size_; }
+    size_t capacity() const { return capacity_; }
+    bool full() const { return size_ == capacity_; }
+    const uint16_t *word(size_t w) const { return &words_[w * capacity_]; }
+
+private:
+    size_t capacity_;
+    size_t size_ = 0;
+    std::vector<uint16_t> words_;
+};
+
+// Batch results. Temperatures are pixel-major like the input: pixel p of
+// frame f is at pixel(p)[f].
+class BatchOutput {
+public:
+    size_t size() const { return size_; }
+    const float *pixel(int p) const { return &pixels_[p * capacity_]; }
+    const FrameData &result(size_t f) const { return results_[f]; }
+
+    // Copy one frame out in the firmware's row-major layout
+    void frame(size_t f, float *pixels) const;
+
+private:
+    friend class BatchProcessor;
+    void resize(size_t capacity, size_t size);
+
+    size_t capacity_ = 0;
+    size_t size_ = 0;
+    std::vector<float> pixels_;
+    std::vector<FrameData> results_;
+};
+
+class BatchProcessor {
+public:
+    // smoothing as for MLX90640_InitEnvironment(); emissivity and tr as for
+    // MLX90640_CalculateToEnv()
+    BatchProcessor(const paramsMLX90640 &params, float smoothing, float emissivity, float tr);
+
+    // With coefficients already compiled for params (e.g. from a
+    // CalibrationCatalog); they must outlive the processor
+    BatchProcessor(const paramsMLX90640 &params, const PixelCoefficients &coeffs,
+                   float smoothing, float emissivity, float tr);
+
+    // Convert and analyse every subpage in batch, continuing from the state
+    // left by the previous call
+    void process(const RawFrameBatch &batch, BatchOutput &out);
+
+    ThermalConfig &config() { return config_; }
+    const envMLX90640 &environment() const { return env_; }
+
+private:
+    void update_environment(const RawFrameBatch &batch, size_t n);
+    void convert(const RawFrameBatch &batch, size_t n, BatchOutput &out);
+    void analyse(size_t n, BatchOutput &out);
+
+    paramsMLX90640 params_;
+    const PixelCoefficients *coeffs_;
+    std::unique_ptr<PixelCoefficients> owned_coeffs_;
+    envMLX90640 env_;
+    ThermalConfig config_;
+    float emissivity_;
+    float tr_;
+
+    // Each pixel's last conversion, carried into the next batch
+    float last_[SENSOR_PIXELS] = {};
+
+    // A subpage measures the pixels whose interleave (line) or chess
+    // pattern, depending on the mode, matches its number. Pixels fall in
+    // four classes by their two patterns; each class keeps the frames that
+    // measured it and those frames' terms, so a pixel is only converted
+    // where it was measured.
+    struct PixelClass {
+        std::vector<uint32_t> frames;
+        std::vector<float> gain, ta_delta, vdd_delta, ks_ta, ta_tr, cp, il_chess;
+    };
+    PixelClass classes_[4];
+
+    // Scratch: one pixel's measured values, column profiles (frame-major)
+    std::vector<float> raw_, converted_, sum_, count_;
+    std::vector<float> profiles_;
+};
+
+#endif // FRAME_BATCH_H
@@ -0,0 +1,49 @@
+/**
+ * frame_record.h
+ * Typed frame record shared by the host-side stream decoders
+ *
+ * Wraps the firmware's own FrameData so that host tools see exactly the
+ * fields the Pico computes, whichever wire format carried them.
+ */
+
+#ifndef FRAME_RECORD_H
+#define FRAME_RECORD_H
+
+#include <cstdint>
+
+extern "C" {
+#include "thermal_algorithm.h"
+#include "zone_histogram.h"
+}
+
+// Wire format a record was decoded from
+enum class RecordSource : uint8_t {
+    Csv = 0,     // send_serial_compact
+    Json = 1,    // send_serial_json
+    Binary = 2,  // send_binary_frame (mux_decoder.h)
+};
+
+// Which FrameData fields the source actually carried
+enum RecordFields : uint16_t {
+    FIELD_ZONE_AVG     = 1 << 0,
+    FIELD_ZONE_MEDIAN  = 1 << 1,
+    FIELD_ZONE_SPREAD  = 1 << 2,  // mad/min/max/range
+    FIELD_GRADIENT     = 1 << 3,
+    FIELD_SPAN         = 1 << 4,  // span_start/span_end
+    FIELD_WIDTH        = 1 << 5,
+    FIELD_CONFIDENCE   = 1 << 6,
+    FIELD_DETECTED     = 1 << 7,
+    FIELD_PROFILE      = 1 << 8,
+    FIELD_HISTOGRAMS   = 1 << 9,  // JSON "histograms" object
+};
+
+struct FrameRecord {
+    FrameData data;                     // Firmware analysis result
+    float fps;                          // Device-reported frame rate
+    float profile[SENSOR_WIDTH];        // Column temperature profile (JSON only)
+    ZoneHistograms histograms;          // Zone histograms (JSON only, FIELD_HISTOGRAMS)
+    uint16_t fields;                    // RecordFields present in this record
+    RecordSource source;
+};
+
+#endif // FRAME_RECORD_H
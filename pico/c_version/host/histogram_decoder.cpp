@@ -0,0 +1,28 @@
+/**
+ * histogram_decoder.cpp
+ * Decoder for the firmware's zone histogram lines (HST:<base64>)
+ */
+
+#include "histogram_decoder.h"
+
+#include "image_decoder.h"
+
+static constexpr std::string_view kPrefix = "HST:";
+
+bool HistogramLineDecoder::decode(std::string_view line, ZoneHistograms &hist) {
+    if (line.substr(0, kPrefix.size()) != kPrefix) return false;
+
+    line.remove_prefix(kPrefix.size());
+    while (!line.empty() && (line.back() == '\r' || line.back() == '\n')) {
+        line.remove_suffix(1);
+    }
+
+    if (!base64_decode(line, packet_) || packet_.size() > ZONE_HIST_MAX_BYTES ||
+        !zone_histogram_unpack(packet_.data(), static_cast<uint16_t>(packet_.size()), &hist)) {
+        stats_.malformed++;
+        return false;
+    }
+
+    stats_.packets++;
+    return true;
+}
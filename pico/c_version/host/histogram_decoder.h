@@ -0,0 +1,40 @@
+/**
+ * histogram_decoder.h
+ * Decoder for the firmware's zone histogram lines (HST:<base64>)
+ *
+ * In compact (CSV) output mode send_serial_histograms() prints one
+ * zone_histogram packet per frame after the CSV record. Feed every
+ * non-record line from TextStreamParser (RecordSink::on_text) to
+ * HistogramLineDecoder::decode(); it ignores lines without the HST:
+ * prefix. Match histograms to records by frame_number.
+ */
+
+#ifndef HISTOGRAM_DECODER_H
+#define HISTOGRAM_DECODER_H
+
+#include <cstdint>
+#include <string_view>
+#include <vector>
+
+extern "C" {
+#include "zone_histogram.h"
+}
+
+struct HistogramDecoderStats {
+    uint64_t packets = 0;
+    uint64_t malformed = 0;
+};
+
+class HistogramLineDecoder {
+public:
+    // Returns true and fills hist if line is a valid histogram line
+    bool decode(std::string_view line, ZoneHistograms &hist);
+
+    const HistogramDecoderStats &stats() const { return stats_; }
+
+private:
+    std::vector<uint8_t> packet_;
+    HistogramDecoderStats stats_;
+};
+
+#endif // HISTOGRAM_DECODER_H
@@ -0,0 +1,63 @@
+/**
+ * image_decoder.cpp
+ * Decoder for the firmware's lossy image lines (IMG:<base64>)
+ */
+
+#include "image_decoder.h"
+
+static constexpr std::string_view kPrefix = "IMG:";
+
+static int base64_value(char c) {
+    if (c >= 'A' && c <= 'Z') return c - 'A';
+    if (c >= 'a' && c <= 'z') return c - 'a' + 26;
+    if (c >= '0' && c <= '9') return c - '0' + 52;
+    if (c == '+') return 62;
+    if (c == '/') return 63;
+    return -1;
+}
+
+bool base64_decode(std::string_view in, std::vector<uint8_t> &out) {
+    out.clear();
+    if (in.size() % 4 != 0) return false;
+
+    for (size_t i = 0; i < in.size(); i += 4) {
+        int v[4];
+        int pad = 0;
+        for (int k = 0; k < 4; k++) {
+            char c = in[i + k];
+            if (c == '=' && i + 4 == in.size() && k >= 2) {
+                v[k] = 0;
+                pad++;
+            } else if (pad > 0 || (v[k] = base64_value(c)) < 0) {
+                return false;
+            }
+        }
+        uint32_t word = (v[0] << 18) | (v[1] << 12) | (v[2] << 6) | v[3];
+        out.push_back(static_cast<uint8_t>(word >> 16));
+        if (pad < 2) out.push_back(static_cast<uint8_t>(word >> 8));
+        if (pad < 1) out.push_back(static_cast<uint8_t>(word));
+    }
+    return true;
+}
+
+bool ImageLineDecoder::decode(std::string_view line, ImageFrame &frame) {
+    if (line.substr(0, kPrefix.size()) != kPrefix) return false;
+
+    uint32_t line_bytes = static_cast<uint32_t>(line.size()) + 1;  // Newline
+    line.remove_prefix(kPrefix.size());
+    while (!line.empty() && (line.back() == '\r' || line.back() == '\n')) {
+        line.remove_suffix(1);
+    }
+
+    if (!base64_decode(line, packet_) || packet_.size() > FRAME_CODEC_MAX_BYTES ||
+        !frame_codec_decode(packet_.data(), static_cast<uint16_t>(packet_.size()),
+                            frame.pixels, &frame.header)) {
+        stats_.malformed++;
+        return false;
+    }
+
+    frame.line_bytes = line_bytes;
+    stats_.frames++;
+    stats_.bytes += line_bytes;
+    return true;
+}
@@ -0,0 +1,48 @@
+/**
+ * image_decoder.h
+ * Decoder for the firmware's lossy image lines (IMG:<base64>)
+ *
+ * send_serial_image() prints one frame_codec packet per line. Feed every
+ * non-record line from TextStreamParser (RecordSink::on_text) to
+ * ImageLineDecoder::decode(); it ignores lines without the IMG: prefix.
+ */
+
+#ifndef IMAGE_DECODER_H
+#define IMAGE_DECODER_H
+
+#include <cstdint>
+#include <string_view>
+#include <vector>
+
+extern "C" {
+#include "frame_codec.h"
+}
+
+struct ImageFrame {
+    FrameCodecHeader header;
+    float pixels[SENSOR_PIXELS];        // Decoded temperatures, row-major
+    uint32_t line_bytes;                // Size on the link, including framing
+};
+
+struct ImageDecoderStats {
+    uint64_t frames = 0;
+    uint64_t malformed = 0;
+    uint64_t bytes = 0;
+};
+
+class ImageLineDecoder {
+public:
+    // Returns true and fills frame if line is a valid image line
+    bool decode(std::string_view line, ImageFrame &frame);
+
+    const ImageDecoderStats &stats() const { return stats_; }
+
+private:
+    std::vector<uint8_t> packet_;
+    ImageDecoderStats stats_;
+};
+
+// Decode standard base64 (with padding). Returns false on invalid input.
+bool base64_decode(std::string_view in, std::vector<uint8_t> &out);
+
+#endif // IMAGE_DECODER_H
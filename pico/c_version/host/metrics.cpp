@@ -0,0 +1,170 @@
+/**
+ * metrics.cpp
+ * Lock-free device and daemon metrics with Prometheus text export
+ */
+
+#include "metrics.h"
+
+#include <cstdarg>
+#include <cstdio>
+#include <ctime>
+
+const float LatencyHistogram::kBoundsMs[LATENCY_BUCKETS] = {
+    0.5f, 1.0f, 2.0f, 5.0f, 10.0f, 20.0f, 50.0f, 100.0f,
+    150.0f, 200.0f, 300.0f, 500.0f, 1000.0f, 2000.0f, 5000.0f, 10000.0f,
+};
+
+int64_t monotonic_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (int64_t)ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+
+void LatencyHistogram::observe(float ms) {
+    int i = 0;
+    while (i < LATENCY_BUCKETS && ms > kBoundsMs[i]) i++;
+
+    // Single writer: load + store is enough, readers see whole values
+    buckets_[i].store(buckets_[i].load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    sum_us_.store(sum_us_.load(std::memory_order_relaxed) + (uint64_t)(ms * 1000.0f),
+                  std::memory_order_relaxed);
+    count_.store(count_.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+}
+
+float LatencyHistogram::percentile(float q) const {
+    uint64_t counts[LATENCY_BUCKETS + 1];
+    uint64_t total = 0;
+    for (int i = 0; i <= LATENCY_BUCKETS; i++) {
+        counts[i] = buckets_[i].load(std::memory_order_relaxed);
+        total += counts[i];
+    }
+    if (total == 0) return 0.0f;
+
+    double target = q * (double)total;
+    uint64_t cumulative = 0;
+
+    for (int i = 0; i <= LATENCY_BUCKETS; i++) {
+        if (counts[i] == 0) continue;
+        if (cumulative + counts[i] >= target) {
+            if (i == LATENCY_BUCKETS) return kBoundsMs[LATENCY_BUCKETS - 1];
+            float lower = (i == 0) ? 0.0f : kBoundsMs[i - 1];
+            float frac = (float)((target - cumulative) / counts[i]);
+            return lower + frac * (kBoundsMs[i] - lower);
+        }
+        cumulative += counts[i];
+    }
+    return kBoundsMs[LATENCY_BUCKETS - 1];
+}
+
+//------------------------------------------------------------------------------
+// Prometheus text format
+
+static void appendf(std::string &out, const char *fmt, ...) __attribute__((format(printf, 2, 3)));
+
+static void appendf(std::string &out, const char *fmt, ...) {
+    char buf[512];
+    va_list args;
+    va_start(args, fmt);
+    int len = vsnprintf(buf, sizeof(buf), fmt, args);
+    va_end(args);
+    if (len > 0) out.append(buf, len < (int)sizeof(buf) ? len : (int)sizeof(buf) - 1);
+}
+
+static void header(std::string &out, const char *name, const char *type, const char *help) {
+    appendf(out, "# HELP %s %s\n# TYPE %s %s\n", name, help, name, type);
+}
+
+static void histogram(std::string &out, const char *name, const char *help,
+                      const std::vector<DeviceMetrics *> &devices,
+                      LatencyHistogram DeviceMetrics::*member) {
+    header(out, name, "histogram", help);
+    for (const DeviceMetrics *d : devices) {
+        const LatencyHistogram &h = d->*member;
+        uint64_t cumulative = 0;
+        for (int i = 0; i < LATENCY_BUCKETS; i++) {
+            cumulative += h.bucket(i);
+            appendf(out, "%s_bucket{device=\"%s\",le=\"%g\"} %llu\n", name, d->name.c_str(),
+                    LatencyHistogram::kBoundsMs[i], (unsigned long long)cumulative);
+        }
+        cumulative += h.bucket(LATENCY_BUCKETS);
+        appendf(out, "%s_bucket{device=\"%s\",le=\"+Inf\"} %llu\n", name, d->name.c_str(),
+                (unsigned long long)cumulative);
+        appendf(out, "%s_sum{device=\"%s\"} %.3f\n", name, d->name.c_str(), h.sum_ms());
+        appendf(out, "%s_count{device=\"%s\"} %llu\n", name, d->name.c_str(),
+                (unsigned long long)h.count());
+    }
+
+    // Pre-computed percentiles for dashboards without histogram_quantile()
+    std::string pname = std::string(name) + "_percentile";
+    header(out, pname.c_str(), "gauge", "Interpolated percentiles of the histogram above");
+    for (const DeviceMetrics *d : devices) {
+        const LatencyHistogram &h = d->*member;
+        appendf(out, "%s{device=\"%s\",quantile=\"0.5\"} %.2f\n", pname.c_str(), d->name.c_str(), h.percentile(0.5f));
+        appendf(out, "%s{device=\"%s\",quantile=\"0.95\"} %.2f\n", pname.c_str(), d->name.c_str(), h.percentile(0.95f));
+        appendf(out, "%s{device=\"%s\",quantile=\"0.99\"} %.2f\n", pname.c_str(), d->name.c_str(), h.percentile(0.99f));
+    }
+}
+
+static void counter(std::string &out, const char *name, const char *help,
+                    const std::vector<DeviceMetrics *> &devices, Counter DeviceMetrics::*member) {
+    header(out, name, "counter", help);
+    for (const DeviceMetrics *d : devices) {
+        appendf(out, "%s{device=\"%s\"} %llu\n", name, d->name.c_str(),
+                (unsigned long long)(d->*member).get());
+    }
+}
+
+static void gauge(std::string &out, const char *name, const char *help,
+                  const std::vector<DeviceMetrics *> &devices, Gauge DeviceMetrics::*member) {
+    header(out, name, "gauge", help);
+    for (const DeviceMetrics *d : devices) {
+        appendf(out, "%s{device=\"%s\"} %g\n", name, d->name.c_str(), (d->*member).get());
+    }
+}
+
+void render_prometheus(std::string &out, const DaemonMetrics &daemon,
+                       const std::vector<DeviceMetrics *> &devices, int64_t now_ns) {
+    out.clear();
+
+    // Daemon
+    header(out, "thermal_daemon_uptime_seconds", "gauge", "Seconds since the daemon started");
+    appendf(out, "thermal_daemon_uptime_seconds %.1f\n", (now_ns - daemon.start_ns) / 1e9);
+    header(out, "thermal_daemon_devices", "gauge", "Configured devices");
+    appendf(out, "thermal_daemon_devices %zu\n", devices.size());
+    header(out, "thermal_daemon_poll_wakeups_total", "counter", "Ingest loop wakeups");
+    appendf(out, "thermal_daemon_poll_wakeups_total %llu\n", (unsigned long long)daemon.poll_wakeups.get());
+    header(out, "thermal_daemon_scrapes_total", "counter", "Metrics scrapes served");
+    appendf(out, "thermal_daemon_scrapes_total %llu\n", (unsigned long long)daemon.scrapes.get());
+    header(out, "thermal_daemon_ingest_ms_percentile", "gauge", "Time to parse one read of device data");
+    appendf(out, "thermal_daemon_ingest_ms_percentile{quantile=\"0.5\"} %.3f\n", daemon.ingest_ms.percentile(0.5f));
+    appendf(out, "thermal_daemon_ingest_ms_percentile{quantile=\"0.99\"} %.3f\n", daemon.ingest_ms.percentile(0.99f));
+
+    // Devices
+    gauge(out, "thermal_device_connected", "1 if the serial device is open", devices, &DeviceMetrics::connected);
+    counter(out, "thermal_device_bytes_read_total", "Bytes read from the device", devices, &DeviceMetrics::bytes_read);
+    counter(out, "thermal_device_frames_total", "Frame records decoded", devices, &DeviceMetrics::frames);
+    counter(out, "thermal_device_frames_dropped_total", "Frames missing from the device frame counter sequence", devices, &DeviceMetrics::frames_dropped);
+    counter(out, "thermal_device_i2c_errors_total", "Sensor frame read failures reported by the device", devices, &DeviceMetrics::i2c_errors);
+    counter(out, "thermal_device_error_lines_total", "Other ERROR lines reported by the device", devices, &DeviceMetrics::error_lines);
+    counter(out, "thermal_device_malformed_total", "Record-like input that failed to parse", devices, &DeviceMetrics::malformed);
+    counter(out, "thermal_device_reconnects_total", "Times the serial device was reopened", devices, &DeviceMetrics::reconnects);
+    gauge(out, "thermal_device_fps", "Device-reported frame rate", devices, &DeviceMetrics::fps);
+    gauge(out, "thermal_device_confidence", "Latest detection confidence (0-1)", devices, &DeviceMetrics::confidence);
+    gauge(out, "thermal_device_detected", "1 if the latest frame detected a tyre", devices, &DeviceMetrics::detected);
+    gauge(out, "thermal_device_centre_temp_celsius", "Latest centre zone average", devices, &DeviceMetrics::centre_temp);
+    gauge(out, "thermal_device_last_frame_number", "Latest device frame counter", devices, &DeviceMetrics::last_frame_number);
+
+    header(out, "thermal_device_last_frame_age_seconds", "gauge", "Seconds since the last frame record");
+    for (const DeviceMetrics *d : devices) {
+        int64_t last = d->last_frame_ns.load(std::memory_order_relaxed);
+        double age = last ? (now_ns - last) / 1e9 : -1.0;
+        appendf(out, "thermal_device_last_frame_age_seconds{device=\"%s\"} %.3f\n", d->name.c_str(), age);
+    }
+
+    histogram(out, "thermal_device_frame_ms", "Firmware total frame time", devices, &DeviceMetrics::frame_ms);
+    histogram(out, "thermal_device_sensor_ms", "Firmware sensor read time", devices, &DeviceMetrics::sensor_ms);
+    histogram(out, "thermal_device_calc_ms", "Firmware temperature conversion time", devices, &DeviceMetrics::calc_ms);
+    histogram(out, "thermal_device_algo_ms", "Firmware detection algorithm time", devices, &DeviceMetrics::algo_ms);
+    histogram(out, "thermal_device_comm_ms", "Firmware output time", devices, &DeviceMetrics::comm_ms);
+    histogram(out, "thermal_device_interarrival_ms", "Host-observed time between frame records", devices, &DeviceMetrics::interarrival_ms);
+}
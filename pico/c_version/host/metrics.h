@@ -0,0 +1,119 @@
+/**
+ * metrics.h
+ * Lock-free device and daemon metrics with Prometheus text export
+ *
+ * Each metric has a single writer (the ingest thread) and any number of
+ * readers (scrapes). Writers update relaxed atomics in place, so ingest
+ * never blocks, and a scrape renders the current values in O(metrics)
+ * without replaying or sorting samples.
+ */
+
+#ifndef METRICS_H
+#define METRICS_H
+
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <vector>
+
+// Monotonic counter
+class Counter {
+public:
+    void inc(uint64_t n = 1) {
+        value_.store(value_.load(std::memory_order_relaxed) + n, std::memory_order_relaxed);
+    }
+    uint64_t get() const { return value_.load(std::memory_order_relaxed); }
+
+private:
+    std::atomic<uint64_t> value_{0};
+};
+
+// Last-value gauge (stored as raw float bits so it stays lock-free)
+class Gauge {
+public:
+    void set(float v) {
+        uint32_t bits;
+        memcpy(&bits, &v, sizeof(bits));
+        bits_.store(bits, std::memory_order_relaxed);
+    }
+    float get() const {
+        uint32_t bits = bits_.load(std::memory_order_relaxed);
+        float v;
+        memcpy(&v, &bits, sizeof(v));
+        return v;
+    }
+
+private:
+    std::atomic<uint32_t> bits_{0};
+};
+
+// Fixed-bucket latency histogram in milliseconds. Percentiles are
+// interpolated from bucket counts at scrape time.
+#define LATENCY_BUCKETS 16
+
+class LatencyHistogram {
+public:
+    static const float kBoundsMs[LATENCY_BUCKETS];
+
+    void observe(float ms);
+    float percentile(float q) const;
+
+    uint64_t count() const { return count_.load(std::memory_order_relaxed); }
+    double sum_ms() const { return sum_us_.load(std::memory_order_relaxed) / 1000.0; }
+    uint64_t bucket(int i) const { return buckets_[i].load(std::memory_order_relaxed); }
+
+private:
+    std::atomic<uint64_t> buckets_[LATENCY_BUCKETS + 1] = {};  // Last = +Inf
+    std::atomic<uint64_t> count_{0};
+    std::atomic<uint64_t> sum_us_{0};
+};
+
+// Per-device metrics, written only by that device's ingest path
+struct DeviceMetrics {
+    std::string name;
+    std::string path;
+
+    Counter bytes_read;
+    Counter frames;
+    Counter frames_dropped;      // Gaps in the device frame counter
+    Counter i2c_errors;          // "ERROR: Frame read failed" from the sensor bus
+    Counter error_lines;         // Any other ERROR line
+    Counter malformed;           // Record-like input that failed to parse
+    Counter reconnects;
+
+    Gauge connected;
+    Gauge fps;                   // Device-reported
+    Gauge confidence;
+    Gauge detected;
+    Gauge centre_temp;
+    Gauge last_frame_number;
+
+    // Firmware timing lines ("[Frame N] Total: ... | Sensor: ...")
+    LatencyHistogram frame_ms;
+    LatencyHistogram sensor_ms;
+    LatencyHistogram calc_ms;
+    LatencyHistogram algo_ms;
+    LatencyHistogram comm_ms;
+
+    // Host-side: time between consecutive records
+    LatencyHistogram interarrival_ms;
+
+    std::atomic<int64_t> last_frame_ns{0};
+};
+
+struct DaemonMetrics {
+    int64_t start_ns = 0;
+    Counter poll_wakeups;
+    Counter scrapes;
+    LatencyHistogram ingest_ms;  // Time to parse one read() worth of data
+};
+
+// Render all metrics in Prometheus text exposition format
+void render_prometheus(std::string &out, const DaemonMetrics &daemon,
+                       const std::vector<DeviceMetrics *> &devices, int64_t now_ns);
+
+// Monotonic clock in nanoseconds
+int64_t monotonic_ns(void);
+
+#endif // METRICS_H
@@ -0,0 +1,186 @@
+/**
+ * metrics_server.cpp
+ * Minimal HTTP/1.0 endpoint serving Prometheus metrics
+ */
+
+#include "metrics_server.h"
+
+#include <arpa/inet.h>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#define REQUEST_MAX 2048
+#define CLIENT_TIMEOUT_MS 1000
+
+MetricsServer::MetricsServer(DaemonMetrics &daemon, std::vector<DeviceMetrics *> devices)
+    : daemon_(daemon), devices_(std::move(devices)) {}
+
+MetricsServer::~MetricsServer() {
+    stop();
+}
+
+static int listen_unix(const std::string &path) {
+    struct sockaddr_un addr;
+    if (path.size() >= sizeof(addr.sun_path)) {
+        fprintf(stderr, "metrics: socket path too long: %s\n", path.c_str());
+        return -1;
+    }
+
+    int fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (fd < 0) return -1;
+
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    memcpy(addr.sun_path, path.c_str(), path.size() + 1);
+
+    unlink(path.c_str());  // Stale socket from a previous run
+    if (bind(fd, (struct sockaddr *)&addr, sizeof(addr)) < 0 || listen(fd, 8) < 0) {
+        fprintf(stderr, "metrics: cannot listen on %s: %s\n", path.c_str(), strerror(errno));
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+static int listen_tcp(int port) {
+    int fd = socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (fd < 0) return -1;
+
+    int one = 1;
+    setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+
+    struct sockaddr_in addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons((uint16_t)port);
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);  // Local only
+
+    if (bind(fd, (struct sockaddr *)&addr, sizeof(addr)) < 0 || listen(fd, 8) < 0) {
+        fprintf(stderr, "metrics: cannot listen on 127.0.0.1:%d: %s\n", port, strerror(errno));
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+bool MetricsServer::start(const std::string &unix_path, int tcp_port) {
+    if (!unix_path.empty()) {
+        unix_fd_ = listen_unix(unix_path);
+        if (unix_fd_ < 0) return false;
+        unix_path_ = unix_path;
+    }
+    if (tcp_port > 0) {
+        tcp_fd_ = listen_tcp(tcp_port);
+        if (tcp_fd_ < 0) {
+            stop();
+            return false;
+        }
+    }
+    if (pipe(wake_pipe_) < 0) {
+        stop();
+        return false;
+    }
+
+    running_ = true;
+    thread_ = std::thread(&MetricsServer::serve_loop, this);
+    return true;
+}
+
+void MetricsServer::stop() {
+    if (running_.exchange(false)) {
+        char c = 0;
+        (void)!write(wake_pipe_[1], &c, 1);
+    }
+    if (thread_.joinable()) thread_.join();
+
+    for (int *fd : {&unix_fd_, &tcp_fd_, &wake_pipe_[0], &wake_pipe_[1]}) {
+        if (*fd >= 0) close(*fd);
+        *fd = -1;
+    }
+    if (!unix_path_.empty()) {
+        unlink(unix_path_.c_str());
+        unix_path_.clear();
+    }
+}
+
+void MetricsServer::serve_loop() {
+    while (running_) {
+        struct pollfd fds[3];
+        int n = 0;
+        fds[n++] = {wake_pipe_[0], POLLIN, 0};
+        if (unix_fd_ >= 0) fds[n++] = {unix_fd_, POLLIN, 0};
+        if (tcp_fd_ >= 0) fds[n++] = {tcp_fd_, POLLIN, 0};
+
+        if (poll(fds, n, -1) < 0) {
+            if (errno == EINTR) continue;
+            break;
+        }
+        if (fds[0].revents) break;
+
+        for (int i = 1; i < n; i++) {
+            if (!(fds[i].revents & POLLIN)) continue;
+            int client = accept4(fds[i].fd, nullptr, nullptr, SOCK_CLOEXEC);
+            if (client < 0) continue;
+            handle_client(client);
+            close(client);
+        }
+    }
+}
+
+static bool write_all(int fd, const char *data, size_t len) {
+    while (len > 0) {
+        ssize_t n = send(fd, data, len, MSG_NOSIGNAL);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            return false;
+        }
+        data += n;
+        len -= (size_t)n;
+    }
+    return true;
+}
+
+void MetricsServer::handle_client(int fd) {
+    // Read until the end of the request headers (or give up)
+    char req[REQUEST_MAX];
+    size_t used = 0;
+    while (used < sizeof(req) - 1) {
+        struct pollfd pfd = {fd, POLLIN, 0};
+        if (poll(&pfd, 1, CLIENT_TIMEOUT_MS) <= 0) return;
+        ssize_t n = recv(fd, req + used, sizeof(req) - 1 - used, 0);
+        if (n <= 0) return;
+        used += (size_t)n;
+        req[used] = '\0';
+        if (strstr(req, "\r\n\r\n") || strstr(req, "\n\n")) break;
+    }
+
+    const char *status;
+    const char *type = "text/plain; charset=utf-8";
+    if (strncmp(req, "GET /metrics", 12) == 0 || strncmp(req, "GET / ", 6) == 0) {
+        daemon_.scrapes.inc();
+        render_prometheus(body_, daemon_, devices_, monotonic_ns());
+        status = "200 OK";
+        type = "text/plain; version=0.0.4; charset=utf-8";
+    } else if (strncmp(req, "GET ", 4) == 0) {
+        body_ = "not found\n";
+        status = "404 Not Found";
+    } else {
+        body_ = "bad request\n";
+        status = "400 Bad Request";
+    }
+
+    char head[256];
+    int head_len = snprintf(head, sizeof(head),
+                            "HTTP/1.0 %s\r\nContent-Type: %s\r\nContent-Length: %zu\r\n"
+                            "Connection: close\r\n\r\n",
+                            status, type, body_.size());
+    if (write_all(fd, head, (size_t)head_len)) {
+        write_all(fd, body_.data(), body_.size());
+    }
+}
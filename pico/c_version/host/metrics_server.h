@@ -0,0 +1,47 @@
+/**
+ * metrics_server.h
+ * Minimal HTTP/1.0 endpoint serving Prometheus metrics
+ *
+ * Listens on a Unix socket and, optionally, a loopback TCP port. Scrapes
+ * are served from a dedicated thread and only read the metric atomics, so
+ * the ingest path never waits on a client.
+ */
+
+#ifndef METRICS_SERVER_H
+#define METRICS_SERVER_H
+
+#include <atomic>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "metrics.h"
+
+class MetricsServer {
+public:
+    MetricsServer(DaemonMetrics &daemon, std::vector<DeviceMetrics *> devices);
+    ~MetricsServer();
+
+    // Bind the endpoints and start serving. unix_path may be empty to
+    // skip the socket; tcp_port 0 disables TCP. Returns false on error.
+    bool start(const std::string &unix_path, int tcp_port);
+    void stop();
+
+private:
+    void serve_loop();
+    void handle_client(int fd);
+
+    DaemonMetrics &daemon_;
+    std::vector<DeviceMetrics *> devices_;
+
+    std::string unix_path_;
+    int unix_fd_ = -1;
+    int tcp_fd_ = -1;
+    int wake_pipe_[2] = {-1, -1};
+
+    std::atomic<bool> running_{false};
+    std::thread thread_;
+    std::string body_;  // Reused render buffer
+};
+
+#endif // METRICS_SERVER_H
@@ -0,0 +1,35 @@
+/**
+ * mlx90640_i2c_host.c
+ * I2C driver stubs for building the MLX90640 API on the host
+ *
+ * Host tools only use the calculation functions on recorded data. There
+ * is no sensor bus, so every transfer fails.
+ */
+
+#include "MLX90640_I2C_Driver.h"
+
+void MLX90640_I2CInit(void) {
+}
+
+int MLX90640_I2CRead(uint8_t slaveAddr, uint16_t startAddress, uint16_t nWordsRead, uint16_t *data) {
+    (void)slaveAddr;
+    (void)startAddress;
+    (void)nWordsRead;
+    (void)data;
+    return -1;
+}
+
+int MLX90640_I2CWrite(uint8_t slaveAddr, uint16_t writeAddress, uint16_t data) {
+    (void)slaveAddr;
+    (void)writeAddress;
+    (void)data;
+    return -1;
+}
+
+void MLX90640_I2CFreqSet(int freq) {
+    (void)freq;
+}
+
+int MLX90640_I2CGeneralReset(void) {
+    return -1;
+}
@@ -0,0 +1,229 @@
+/**
+ * mux_decoder.cpp
+ * Decoder for the firmware's binary multiplexed serial stream
+ */
+
+#include "mux_decoder.h"
+
+#include <cstdio>
+#include <cstring>
+
+void MuxSink::on_event(const MuxMessage &msg) {
+    std::string line;
+    if (mux_format_event(msg, line)) on_text(line);
+}
+
+void MuxStreamDecoder::reset() {
+    carry_.clear();
+    text_.reset();
+    for (int c = 0; c < MUX_CHANNELS; c++) have_seq_[c] = false;
+}
+
+void MuxStreamDecoder::feed(const char *data, size_t len, MuxSink &sink) {
+    carry_.insert(carry_.end(), data, data + len);
+    const uint8_t *buf = carry_.data();
+    size_t n = carry_.size();
+    size_t pos = 0;
+
+    while (pos < n) {
+        // Text up to the next sync byte
+        const void *sync = memchr(buf + pos, MUX_SYNC, n - pos);
+        size_t next = sync ? static_cast<const uint8_t *>(sync) - buf : n;
+        if (next > pos) {
+            text_.feed(reinterpret_cast<const char *>(buf + pos), next - pos, sink);
+            stats_.text_bytes += next - pos;
+            pos = next;
+            continue;
+        }
+
+        MuxMessage msg;
+        int32_t frame_len = mux_frame_check(buf + pos, static_cast<uint32_t>(n - pos), &msg);
+        if (frame_len == 0) break;
+        if (frame_len < 0) {
+            stats_.invalid++;
+            pos++;
+            continue;
+        }
+        dispatch(msg, static_cast<uint32_t>(frame_len), sink);
+        pos += frame_len;
+    }
+
+    carry_.erase(carry_.begin(), carry_.begin() + pos);
+}
+
+void MuxStreamDecoder::dispatch(const MuxMessage &msg, uint32_t frame_bytes, MuxSink &sink) {
+    MuxChannelStats &ch = stats_.channels[msg.channel];
+    ch.messages++;
+    ch.bytes += frame_bytes;
+
+    // Command replies echo the host's sequence numbers, so only count the
+    // device's own channels
+    if (msg.channel != MUX_CHANNEL_COMMAND) {
+        if (have_seq_[msg.channel]) ch.lost += static_cast<uint8_t>(msg.seq - next_seq_[msg.channel]);
+        have_seq_[msg.channel] = true;
+        next_seq_[msg.channel] = msg.seq + 1;
+    }
+
+    switch (msg.channel) {
+        case MUX_CHANNEL_DATA:
+            if (msg.type == MUX_DATA_FRAME) {
+                FrameRecord record;
+                memset(&record, 0, sizeof(record));
+                if (!mux_unpack_frame(msg.payload, msg.len, &record.data, &record.fps)) break;
+                record.fields = FIELD_ZONE_AVG | FIELD_ZONE_MEDIAN | FIELD_ZONE_SPREAD | FIELD_GRADIENT |
+                                FIELD_SPAN | FIELD_WIDTH | FIELD_CONFIDENCE | FIELD_DETECTED;
+                record.source = RecordSource::Binary;
+                sink.on_record(record);
+                return;
+            }
+            if (msg.type == MUX_DATA_IMAGE) {
+                if (!frame_codec_decode(msg.payload, msg.len, image_.pixels, &image_.header)) break;
+                image_.line_bytes = frame_bytes;
+                sink.on_image(image_);
+                return;
+            }
+            if (msg.type == MUX_DATA_HISTOGRAMS) {
+                ZoneHistograms hist;
+                if (!zone_histogram_unpack(msg.payload, msg.len, &hist)) break;
+                sink.on_histograms(hist);
+                return;
+            }
+            break;
+
+        case MUX_CHANNEL_DIAG:
+        case MUX_CHANNEL_TRACE:
+            sink.on_event(msg);
+            return;
+
+        case MUX_CHANNEL_COMMAND:
+            if (msg.type & MUX_RESPONSE) {
+                sink.on_response(msg);
+                return;
+            }
+            break;
+    }
+    stats_.malformed++;
+}
+
+//------------------------------------------------------------------------------
+// Event formatting, matching the firmware's text output
+
+static float rate_hz(uint8_t code) {
+    // MLX90640 rate codes: 0 = 0.5Hz, each step doubles
+    return 0.5f * static_cast<float>(1u << (code & 7));
+}
+
+static bool format_pipeline(const MuxMessage &msg, std::string &line) {
+    // [Pipeline] name: runs (1/divider) avg/max ms | ...
+    const uint8_t *p = msg.payload;
+    const uint8_t *end = p + msg.len;
+    if (p >= end) return false;
+    uint8_t stages = *p++;
+
+    line = "[Pipeline]";
+    char buf[96];
+    for (uint8_t i = 0; i < stages; i++) {
+        if (p >= end || end - p < 1 + p[0] + 14) return false;
+        std::string name(reinterpret_cast<const char *>(p + 1), p[0]);
+        p += 1 + p[0];
+        snprintf(buf, sizeof(buf), "%s %s: %lu (1/%u) %.2f/%.2fms", i ? " |" : "", name.c_str(),
+                 (unsigned long)mux_get_u32(p), mux_get_u16(p + 4), mux_get_u32(p + 6) / 1000.0f,
+                 mux_get_u32(p + 10) / 1000.0f);
+        line += buf;
+        p += 14;
+    }
+    return true;
+}
+
+bool mux_format_event(const MuxMessage &msg, std::string &line) {
+    const uint8_t *p = msg.payload;
+    char buf[256];
+    int n = -1;
+
+    if (msg.channel == MUX_CHANNEL_TRACE) {
+        return msg.type == MUX_TRACE_PIPELINE && format_pipeline(msg, line);
+    }
+    if (msg.channel != MUX_CHANNEL_DIAG) return false;
+
+    switch (msg.type) {
+        case MUX_DIAG_FRAME_TIMING: {
+            if (msg.len < 24) return false;
+            uint32_t total = mux_get_u32(p + 4);
+            n = snprintf(buf, sizeof(buf),
+                         "[Frame %lu] Total: %.1fms (%.1f fps) | "
+                         "Sensor: %.1fms | Calc: %.1fms | Algo: %.1fms | Comm: %.1fms",
+                         (unsigned long)mux_get_u32(p), total / 1000.0f, total ? 1000000.0f / total : 0.0f,
+                         mux_get_u32(p + 8) / 1000.0f, mux_get_u32(p + 12) / 1000.0f,
+                         mux_get_u32(p + 16) / 1000.0f, mux_get_u32(p + 20) / 1000.0f);
+            break;
+        }
+
+        case MUX_DIAG_ERROR: {
+            if (msg.len < 5) return false;
+            int32_t value = static_cast<int32_t>(mux_get_u32(p + 1));
+            if (p[0] == MUX_ERROR_FRAME_READ) {
+                n = snprintf(buf, sizeof(buf), "ERROR: Frame read failed (code %ld)", (long)value);
+            } else if (p[0] == MUX_ERROR_FRAME_POOL) {
+                n = snprintf(buf, sizeof(buf), "ERROR: Frame pool exhausted (%lu total)",
+                             (unsigned long)static_cast<uint32_t>(value));
+            } else if (p[0] == MUX_ERROR_CONTROL_WRITE) {
+                n = snprintf(buf, sizeof(buf), "ERROR: Control register write failed");
+            } else {
+                n = snprintf(buf, sizeof(buf), "ERROR: code %u (%ld)", p[0], (long)value);
+            }
+            break;
+        }
+
+        case MUX_DIAG_RATE_CHANGE:
+            if (msg.len < 2) return false;
+            n = snprintf(buf, sizeof(buf), "Refresh rate: %gHz -> %gHz", rate_hz(p[0]), rate_hz(p[1]));
+            break;
+
+        case MUX_DIAG_PIXEL_HEALTH:
+            if (msg.len < 8) return false;
+            n = snprintf(buf, sizeof(buf), "Pixel health: %u flagged (stuck %u, noisy %u, dead %u)",
+                         mux_get_u16(p), mux_get_u16(p + 2), mux_get_u16(p + 4), mux_get_u16(p + 6));
+            break;
+
+        case MUX_DIAG_DETECT_CYCLES:
+            if (msg.len < 13) return false;
+            n = snprintf(buf, sizeof(buf), "[Detect] %s: %lu cycles (min %lu, max %lu)",
+                         p[0] == DETECT_ENGINE_CLASSIFIER ? "classifier" : "region",
+                         (unsigned long)mux_get_u32(p + 1), (unsigned long)mux_get_u32(p + 5),
+                         (unsigned long)mux_get_u32(p + 9));
+            break;
+
+        case MUX_DIAG_SHADOW:
+            if (msg.len < MUX_SHADOW_BYTES) return false;
+            n = snprintf(buf, sizeof(buf),
+                         "[Shadow] compared %u (dropped %u) | agree %u%% (prod only %u, cand only %u) | "
+                         "IoU %.2f | zone delta %.1f/%.1f/%.1f max %.1fC | conf %.2f/%.2f | core1 %.2f/%.2fms",
+                         mux_get_u16(p), mux_get_u16(p + 2), p[4], mux_get_u16(p + 6), mux_get_u16(p + 8),
+                         p[5] / 100.0f, mux_get_u16(p + 10) / 10.0f, mux_get_u16(p + 12) / 10.0f,
+                         mux_get_u16(p + 14) / 10.0f, mux_get_u16(p + 16) / 10.0f, p[18] / 100.0f,
+                         p[19] / 100.0f, mux_get_u32(p + 20) / 1000.0f, mux_get_u32(p + 24) / 1000.0f);
+            break;
+
+        case MUX_DIAG_DROPS:
+            if (msg.len < 4 * MUX_CHANNELS) return false;
+            n = snprintf(buf, sizeof(buf), "[Drops] data %lu | diag %lu | trace %lu | command %lu",
+                         (unsigned long)mux_get_u32(p), (unsigned long)mux_get_u32(p + 4),
+                         (unsigned long)mux_get_u32(p + 8), (unsigned long)mux_get_u32(p + 12));
+            break;
+
+        default:
+            return false;
+    }
+
+    if (n < 0) return false;
+    line.assign(buf, static_cast<size_t>(n) < sizeof(buf) ? n : sizeof(buf) - 1);
+    return true;
+}
+
+std::vector<uint8_t> mux_encode_command(uint8_t type, uint8_t seq, const uint8_t *payload, uint16_t len) {
+    std::vector<uint8_t> frame(len + MUX_OVERHEAD);
+    uint16_t n = mux_frame_encode(MUX_CHANNEL_COMMAND, type, seq, payload, len, frame.data(),
+                                  static_cast<uint16_t>(frame.size()));
+    frame.resize(n);
+    return frame;
+}
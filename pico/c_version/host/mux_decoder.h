@@ -0,0 +1,87 @@
+/**
+ * mux_decoder.h
+ * Decoder for the firmware's binary multiplexed serial stream
+ *
+ * In OUTPUT_MODE_USB_BINARY the Pico sends framed messages on data,
+ * diagnostics, trace and command channels (firmware mux_protocol.h).
+ * MuxStreamDecoder splits the stream back into channels: data becomes
+ * FrameRecords, images and histograms, and diagnostics and trace events
+ * are formatted into the text lines the firmware prints in text mode.
+ * Bytes outside frames (the startup banner, or a device still in text
+ * mode) go through a TextStreamParser, so one decoder reads either mode.
+ */
+
+#ifndef MUX_DECODER_H
+#define MUX_DECODER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "image_decoder.h"
+#include "text_parser.h"
+
+extern "C" {
+#include "mux_protocol.h"
+}
+
+// Receives decoder output. Records and text lines arrive as from
+// TextStreamParser.
+class MuxSink : public RecordSink {
+public:
+    virtual void on_image(const ImageFrame &frame) { (void)frame; }
+    virtual void on_histograms(const ZoneHistograms &hist) { (void)hist; }
+
+    // A diagnostics or trace event. By default it is formatted as the
+    // firmware's text line (mux_format_event) and passed to on_text().
+    virtual void on_event(const MuxMessage &msg);
+
+    // A reply on the command channel (type has MUX_RESPONSE set)
+    virtual void on_response(const MuxMessage &msg) { (void)msg; }
+};
+
+struct MuxChannelStats {
+    uint64_t messages = 0;
+    uint64_t bytes = 0;         // Including framing
+    uint64_t lost = 0;          // Sequence gaps: dropped on the device or lost on the link
+};
+
+struct MuxDecoderStats {
+    MuxChannelStats channels[MUX_CHANNELS];
+    uint64_t invalid = 0;       // Sync bytes that didn't start a valid frame (CRC, length)
+    uint64_t malformed = 0;     // Valid frames with a payload that didn't decode
+    uint64_t text_bytes = 0;
+};
+
+class MuxStreamDecoder {
+public:
+    // Decode a chunk of stream data. Partial frames and lines are carried
+    // over, so chunks may split anywhere.
+    void feed(const char *data, size_t len, MuxSink &sink);
+
+    // Drop carried-over input and sequence state (e.g. after a reconnect)
+    void reset();
+
+    const MuxDecoderStats &stats() const { return stats_; }
+    const TextParserStats &text_stats() const { return text_.stats(); }
+
+private:
+    void dispatch(const MuxMessage &msg, uint32_t frame_bytes, MuxSink &sink);
+
+    std::vector<uint8_t> carry_;
+    TextStreamParser text_;
+    MuxDecoderStats stats_;
+    bool have_seq_[MUX_CHANNELS] = {};
+    uint8_t next_seq_[MUX_CHANNELS] = {};
+    ImageFrame image_;
+};
+
+// Format a diagnostics or trace event as the line the firmware prints in
+// text mode (no newline). Returns false for unknown events.
+bool mux_format_event(const MuxMessage &msg, std::string &line);
+
+// Frame a command for the device (MUX_CHANNEL_COMMAND)
+std::vector<uint8_t> mux_encode_command(uint8_t type, uint8_t seq, const uint8_t *payload, uint16_t len);
+
+#endif // MUX_DECODER_H
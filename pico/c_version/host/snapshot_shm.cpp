@@ -0,0 +1,151 @@
+/**
+ * snapshot_shm.cpp
+ * Shared-memory snapshot of each device's latest frame records
+ */
+
+#include "snapshot_shm.h"
+
+#include <cerrno>
+#include <climits>
+#include <cstdio>
+#include <cstring>
+#include <fcntl.h>
+#include <linux/futex.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include "metrics.h"
+
+static void futex_wake_all(std::atomic<uint32_t> *word) {
+    // Shared (not FUTEX_PRIVATE) so waiters in other processes are woken
+    syscall(SYS_futex, reinterpret_cast<uint32_t *>(word), FUTEX_WAKE, INT_MAX, nullptr, nullptr, 0);
+}
+
+static void copy_zone(ShmZone &dst, const ZoneAnalysis &src) {
+    dst.avg = src.avg;
+    dst.median = src.median;
+    dst.mad = src.mad;
+    dst.min = src.min;
+    dst.max = src.max;
+    dst.range = src.range;
+    dst.count = src.count;
+}
+
+bool SnapshotPublisher::open(const std::string &name, const std::vector<std::string> &devices) {
+    close();
+
+    size_t size = sizeof(ShmHeader) + devices.size() * sizeof(ShmDevice);
+
+    // A segment left by a crashed daemon may have a different device list
+    shm_unlink(name.c_str());
+    int fd = shm_open(name.c_str(), O_CREAT | O_EXCL | O_RDWR | O_CLOEXEC, 0644);
+    if (fd < 0) {
+        fprintf(stderr, "shm_open %s: %s\n", name.c_str(), strerror(errno));
+        return false;
+    }
+    if (ftruncate(fd, (off_t)size) != 0) {
+        fprintf(stderr, "ftruncate %s: %s\n", name.c_str(), strerror(errno));
+        ::close(fd);
+        shm_unlink(name.c_str());
+        return false;
+    }
+
+    void *map = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (map == MAP_FAILED) {
+        fprintf(stderr, "mmap %s: %s\n", name.c_str(), strerror(errno));
+        shm_unlink(name.c_str());
+        return false;
+    }
+
+    // ftruncate zero-fills, which is a valid initial state for every field
+    name_ = name;
+    size_ = size;
+    device_count_ = devices.size();
+    header_ = static_cast<ShmHeader *>(map);
+
+    for (size_t i = 0; i < devices.size(); i++) {
+        strncpy(device(i)->name, devices[i].c_str(), SHM_NAME_LEN - 1);
+    }
+
+    header_->version = SHM_SNAPSHOT_VERSION;
+    header_->header_size = sizeof(ShmHeader);
+    header_->device_count = (uint32_t)devices.size();
+    header_->ring_depth = SHM_RING_DEPTH;
+    header_->device_size = sizeof(ShmDevice);
+    header_->record_size = sizeof(ShmRecord);
+    header_->start_ns = (uint64_t)monotonic_ns();
+    header_->daemon_pid = (uint32_t)getpid();
+    header_->live.store(1, std::memory_order_relaxed);
+
+    // Readers check the magic last: everything above is visible once it is
+    std::atomic_thread_fence(std::memory_order_release);
+    header_->magic = SHM_SNAPSHOT_MAGIC;
+    return true;
+}
+
+void SnapshotPublisher::close() {
+    if (!header_) return;
+
+    header_->live.store(0, std::memory_order_release);
+    header_->generation.fetch_add(1, std::memory_order_release);
+    futex_wake_all(&header_->generation);
+
+    munmap(header_, size_);
+    shm_unlink(name_.c_str());
+    header_ = nullptr;
+}
+
+ShmDevice *SnapshotPublisher::device(size_t i) const {
+    char *base = reinterpret_cast<char *>(header_) + sizeof(ShmHeader);
+    return reinterpret_cast<ShmDevice *>(base + i * sizeof(ShmDevice));
+}
+
+void SnapshotPublisher::publish(size_t index, const FrameRecord &record, int64_t now_ns) {
+    if (!header_ || index >= device_count_) return;
+
+    ShmDevice *dev = device(index);
+    uint64_t k = dev->head.load(std::memory_order_relaxed);
+    ShmRecord &r = dev->ring[k % SHM_RING_DEPTH];
+    uint32_t seq = (uint32_t)(2 * k);
+
+    // Odd while writing; the fence orders it before the payload stores
+    r.seq.store(seq + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    const FrameData &d = record.data;
+    r.fields = record.fields;
+    r.host_ns = (uint64_t)now_ns;
+    r.frame_number = d.frame_number;
+    r.fps = record.fps;
+    r.confidence = d.detection.confidence;
+    r.lateral_gradient = d.lateral_gradient;
+    r.detected = d.detection.detected ? 1 : 0;
+    r.span_start = d.detection.span_start;
+    r.span_end = d.detection.span_end;
+    r.tyre_width = d.detection.tyre_width;
+    r.warnings = d.warnings;
+    copy_zone(r.left, d.left);
+    copy_zone(r.centre, d.centre);
+    copy_zone(r.right, d.right);
+    memcpy(r.profile, record.profile, sizeof(r.profile));
+
+    r.seq.store(seq + 2, std::memory_order_release);
+    dev->head.store(k + 1, std::memory_order_release);
+    pending_ = true;
+}
+
+void SnapshotPublisher::set_connected(size_t index, bool connected) {
+    if (!header_ || index >= device_count_) return;
+    device(index)->connected.store(connected ? 1 : 0, std::memory_order_relaxed);
+    pending_ = true;
+}
+
+void SnapshotPublisher::notify() {
+    if (!header_ || !pending_) return;
+    pending_ = false;
+    header_->generation.fetch_add(1, std::memory_order_release);
+    futex_wake_all(&header_->generation);
+}
@@ -0,0 +1,129 @@
+/**
+ * snapshot_shm.h
+ * Shared-memory snapshot of each device's latest frame records
+ *
+ * The daemon publishes every decoded record into a POSIX shared memory
+ * segment (/dev/shm/thermal_tyre by default) that any number of local
+ * readers map read-only. Each device has a small ring of records guarded
+ * by per-record sequence numbers (seqlock): the writer makes a record's
+ * sequence odd while filling it and even when done, so readers can tell
+ * a complete record from a torn one without any locking. Readers never
+ * write to the segment, so attaching more of them costs the daemon
+ * nothing.
+ *
+ * After each batch of records the header's generation counter is bumped
+ * and waiters on it are woken with one FUTEX_WAKE, however many there are.
+ *
+ * The layout is fixed and little-endian; thermal_tyre_driver/shm_snapshot.py
+ * mirrors it as numpy dtypes. Bump SHM_SNAPSHOT_VERSION on any change.
+ */
+
+#ifndef SNAPSHOT_SHM_H
+#define SNAPSHOT_SHM_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "frame_record.h"
+
+#define SHM_SNAPSHOT_NAME "/thermal_tyre"
+#define SHM_SNAPSHOT_MAGIC 0x4D535454u   // "TTSM"
+#define SHM_SNAPSHOT_VERSION 1
+#define SHM_RING_DEPTH 8
+#define SHM_NAME_LEN 32
+
+struct ShmZone {
+    float avg;
+    float median;
+    float mad;
+    float min;
+    float max;
+    float range;
+    uint32_t count;
+};
+
+struct ShmRecord {
+    std::atomic<uint32_t> seq;   // 2k+1 while record k is written, 2k+2 when complete
+    uint32_t fields;             // RecordFields the source carried
+    uint64_t host_ns;            // Daemon CLOCK_MONOTONIC at decode
+    uint32_t frame_number;
+    float fps;
+    float confidence;
+    float lateral_gradient;
+    uint8_t detected;
+    uint8_t span_start;
+    uint8_t span_end;
+    uint8_t tyre_width;
+    uint8_t warnings;
+    uint8_t reserved[3];
+    ShmZone left;
+    ShmZone centre;
+    ShmZone right;
+    float profile[SENSOR_WIDTH];
+    uint8_t pad[4];
+};
+
+struct ShmDevice {
+    char name[SHM_NAME_LEN];             // NUL-terminated
+    std::atomic<uint64_t> head;          // Records published; newest is ring[(head - 1) % depth]
+    std::atomic<uint32_t> connected;
+    uint8_t reserved[20];
+    ShmRecord ring[SHM_RING_DEPTH];
+};
+
+struct ShmHeader {
+    uint32_t magic;
+    uint16_t version;
+    uint16_t header_size;
+    uint32_t device_count;
+    uint32_t ring_depth;
+    uint32_t device_size;
+    uint32_t record_size;
+    std::atomic<uint32_t> generation;    // Futex word, bumped after each batch
+    std::atomic<uint32_t> live;          // 0 once the daemon has shut down
+    uint64_t start_ns;
+    uint32_t daemon_pid;
+    uint8_t reserved[20];
+};
+
+static_assert(sizeof(ShmRecord) == 256, "ShmRecord layout is shared with Python");
+static_assert(sizeof(ShmDevice) == 64 + SHM_RING_DEPTH * sizeof(ShmRecord), "ShmDevice layout is shared with Python");
+static_assert(sizeof(ShmHeader) == 64, "ShmHeader layout is shared with Python");
+static_assert(std::atomic<uint64_t>::is_always_lock_free, "shared atomics must be lock-free");
+
+class SnapshotPublisher {
+public:
+    SnapshotPublisher() = default;
+    ~SnapshotPublisher() { close(); }
+    SnapshotPublisher(const SnapshotPublisher &) = delete;
+    SnapshotPublisher &operator=(const SnapshotPublisher &) = delete;
+
+    // Create (replacing any stale segment) and map the segment
+    bool open(const std::string &name, const std::vector<std::string> &devices);
+
+    // Mark the segment dead, wake waiters and unlink it
+    void close();
+
+    bool is_open() const { return header_ != nullptr; }
+
+    // Write a record into the device's ring (single writer per segment)
+    void publish(size_t device, const FrameRecord &record, int64_t now_ns);
+    void set_connected(size_t device, bool connected);
+
+    // Bump the generation and wake waiters if anything was published
+    void notify();
+
+private:
+    ShmDevice *device(size_t i) const;
+
+    std::string name_;
+    ShmHeader *header_ = nullptr;
+    size_t size_ = 0;
+    size_t device_count_ = 0;
+    bool pending_ = false;
+};
+
+#endif // SNAPSHOT_SHM_H
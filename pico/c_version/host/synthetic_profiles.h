@@ -0,0 +1,61 @@
+/**
+ * synthetic_profiles.h
+ * Synthetic detection profiles for the host benches and trainer
+ *
+ * Each profile is a road baseline and a hotter (or, for some, colder)
+ * tyre band of random position and width, noise of random size, cold
+ * dropout columns that make gaps, the odd NaN column, and some flat
+ * profiles with no tyre. The band is kept as the ground truth.
+ */
+
+#ifndef SYNTHETIC_PROFILES_H
+#define SYNTHETIC_PROFILES_H
+
+#include <cmath>
+#include <random>
+#include <vector>
+
+extern "C" {
+#include "thermal_algorithm.h"
+}
+
+struct SyntheticProfile {
+    float t[SENSOR_WIDTH];
+    int start;              // Tyre band [start, end]
+    int end;
+    bool tyre;              // False for flat profiles
+    bool hot;               // Band above the road
+};
+
+inline std::vector<SyntheticProfile> make_synthetic_profiles(int count, std::mt19937 &rng) {
+    std::uniform_real_distribution<float> uni(0.0f, 1.0f);
+    std::normal_distribution<float> noise(0.0f, 1.0f);
+    std::vector<SyntheticProfile> corpus(count);
+
+    for (SyntheticProfile &p : corpus) {
+        float road = 20.0f + 25.0f * uni(rng);
+        float sigma = 0.2f + 3.0f * uni(rng);
+        int width = 4 + static_cast<int>(uni(rng) * 26.0f);
+        int start = static_cast<int>(uni(rng) * (SENSOR_WIDTH - width + 1));
+        float band = (uni(rng) < 0.15f ? -1.0f : 1.0f) * (2.0f + 60.0f * uni(rng));
+        bool flat = uni(rng) < 0.05f;
+        float slope = 6.0f * (uni(rng) - 0.5f);
+
+        for (int c = 0; c < SENSOR_WIDTH; c++) {
+            float t = road;
+            if (!flat && c >= start && c < start + width) {
+                t += band + slope * (c - start);
+                if (uni(rng) < 0.08f) t -= band * uni(rng);     // Dropout / groove
+            }
+            p.t[c] = t + sigma * noise(rng);
+            if (uni(rng) < 0.003f) p.t[c] = NAN;
+        }
+        p.start = start;
+        p.end = start + width - 1;
+        p.tyre = !flat;
+        p.hot = band > 0.0f;
+    }
+    return corpus;
+}
+
+#endif // SYNTHETIC_PROFILES_H
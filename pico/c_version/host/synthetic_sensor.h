@@ -0,0 +1,81 @@
+/**
+ * synthetic_sensor.h
+ * Made-up but plausible MLX90640 calibration and auxiliary data for the
+ * host benches
+ *
+ * The calibration has uniform offsets, kta/kv and a small alpha spread.
+ * Raw pixel counts are up to the bench; with this calibration about 350
+ * counts reads near 50°C and 2500 near 135°C.
+ */
+
+#ifndef SYNTHETIC_SENSOR_H
+#define SYNTHETIC_SENSOR_H
+
+#include <cstring>
+#include <random>
+
+extern "C" {
+#include "MLX90640_API.h"
+#include "thermal_algorithm.h"
+}
+
+// Control register values (frame word 832)
+#define SYNTHETIC_CONTROL_CHESS 0x1A81
+#define SYNTHETIC_CONTROL_INTERLEAVED 0x0A81
+
+inline void make_synthetic_params(paramsMLX90640 &p) {
+    std::memset(&p, 0, sizeof(p));
+    p.kVdd = -3200;
+    p.vdd25 = -13056;
+    p.KvPTAT = 0.0053f;
+    p.KtPTAT = 42.0f;
+    p.vPTAT25 = 12273;
+    p.alphaPTAT = 9;
+    p.gainEE = 5500;
+    p.tgc = 0.5f;
+    p.cpKv = 0.3f;
+    p.cpKta = 0.004f;
+    p.resolutionEE = 2;
+    p.calibrationModeEE = 1;
+    p.KsTa = -0.002f;
+    for (int i = 0; i < 5; i++) p.ksTo[i] = -0.0008f;
+    p.ct[0] = -40;
+    p.ct[1] = 0;
+    p.ct[2] = 160;
+    p.ct[3] = 320;
+    p.alphaScale = 11;
+    p.ktaScale = 13;
+    p.kvScale = 7;
+    p.cpAlpha[0] = p.cpAlpha[1] = 4e-9f;
+    p.cpOffset[0] = -60;
+    p.cpOffset[1] = -62;
+    p.ilChessC[0] = 0.1f;
+    p.ilChessC[1] = 2;
+    p.ilChessC[2] = 1;
+    for (int r = 0; r < SENSOR_HEIGHT; r++) p.offsetRow[r] = -50;
+    for (int c = 0; c < SENSOR_WIDTH; c++) p.offsetColumn[c] = 0;
+    for (int s = 0; s < 4; s++) {
+        for (int code = 0; code < 8; code++) p.ktaTable[s][code] = 40;
+        p.kv[s] = 40;
+    }
+    for (int i = 0; i < SENSOR_PIXELS; i++) {
+        p.alpha[i] = static_cast<uint16_t>(12000 + (i % 37) * 10);
+        p.offsetDelta[i] = static_cast<int8_t>(i % 11);
+    }
+}
+
+// Auxiliary words (Ta, Vdd, gain, CP) with a little jitter, the control
+// register and the subpage number
+inline void set_synthetic_aux(uint16_t *fd, bool chess, int subpage, std::mt19937 &rng) {
+    std::normal_distribution<float> noise(0.0f, 1.0f);
+    fd[768] = static_cast<uint16_t>(19500 + noise(rng) * 3.0f);
+    fd[776] = static_cast<uint16_t>(static_cast<int16_t>(-58 + noise(rng) * 1.5f));
+    fd[778] = static_cast<uint16_t>(5500 + noise(rng) * 2.0f);
+    fd[800] = static_cast<uint16_t>(1711 + noise(rng));
+    fd[808] = static_cast<uint16_t>(static_cast<int16_t>(-60 + noise(rng) * 1.5f));
+    fd[810] = static_cast<uint16_t>(static_cast<int16_t>(-13056 + noise(rng) * 2.0f));
+    fd[832] = chess ? SYNTHETIC_CONTROL_CHESS : SYNTHETIC_CONTROL_INTERLEAVED;
+    fd[833] = static_cast<uint16_t>(subpage & 1);
+}
+
+#endif // SYNTHETIC_SENSOR_H
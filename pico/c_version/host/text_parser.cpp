@@ -0,0 +1,597 @@
+/**
+ * text_parser.cpp
+ * High-throughput parser for the firmware's legacy text output
+ *
+ * Two stages, in the style of simdjson:
+ *   1. index_structurals() builds a list of '\n' ',' ':' positions using
+ *      64-byte SIMD compares and a bitmask walk
+ *   2. parse_buffer() walks that list line by line, dispatching CSV
+ *      records, JSON objects and plain text without rescanning bytes
+ */
+
+#include "text_parser.h"
+
+#include <cstddef>
+#include <cstring>
+
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define TEXT_PARSER_SSE2 1
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+#include <arm_neon.h>
+#define TEXT_PARSER_NEON 1
+#endif
+
+// Fields in a send_serial_compact line
+#define CSV_FIELDS 11
+
+// Largest JSON object we will wait for before declaring it malformed
+#define MAX_PENDING_BYTES 65536
+
+static const double kPow10[] = {
+    1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9,
+    1e10, 1e11, 1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18,
+};
+
+static inline bool is_digit(char c) {
+    return (unsigned)(c - '0') < 10;
+}
+
+static inline bool is_structural(char c) {
+    return c == '\n' || c == ',' || c == ':';
+}
+
+//------------------------------------------------------------------------------
+// Stage 1: structural index
+
+#if defined(TEXT_PARSER_SSE2)
+
+static inline uint64_t structural_mask64(const char *p) {
+    const __m128i nl = _mm_set1_epi8('\n');
+    const __m128i comma = _mm_set1_epi8(',');
+    const __m128i colon = _mm_set1_epi8(':');
+    uint64_t mask = 0;
+
+    for (int k = 0; k < 4; k++) {
+        __m128i v = _mm_loadu_si128((const __m128i *)(p + 16 * k));
+        __m128i m = _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(v, nl),
+                                              _mm_cmpeq_epi8(v, comma)),
+                                 _mm_cmpeq_epi8(v, colon));
+        mask |= (uint64_t)(uint32_t)_mm_movemask_epi8(m) << (16 * k);
+    }
+    return mask;
+}
+
+#elif defined(TEXT_PARSER_NEON)
+
+static inline uint64_t structural_mask64(const char *p) {
+    static const uint8_t bit_weights[16] = {
+        1, 2, 4, 8, 16, 32, 64, 128, 1, 2, 4, 8, 16, 32, 64, 128,
+    };
+    const uint8x16_t weights = vld1q_u8(bit_weights);
+    const uint8x16_t nl = vdupq_n_u8('\n');
+    const uint8x16_t comma = vdupq_n_u8(',');
+    const uint8x16_t colon = vdupq_n_u8(':');
+    uint8x16_t m[4];
+
+    for (int k = 0; k < 4; k++) {
+        uint8x16_t v = vld1q_u8((const uint8_t *)(p + 16 * k));
+        uint8x16_t hit = vorrq_u8(vorrq_u8(vceqq_u8(v, nl), vceqq_u8(v, comma)),
+                                  vceqq_u8(v, colon));
+        m[k] = vandq_u8(hit, weights);
+    }
+
+    // Three pairwise-add levels collapse 64 weighted lanes into 8 mask bytes
+    uint8x16_t sum = vpaddq_u8(vpaddq_u8(m[0], m[1]), vpaddq_u8(m[2], m[3]));
+    sum = vpaddq_u8(sum, sum);
+    return vgetq_lane_u64(vreinterpretq_u64_u8(sum), 0);
+}
+
+#else
+
+static inline uint64_t structural_mask64(const char *p) {
+    uint64_t mask = 0;
+    for (int k = 0; k < 64; k++) {
+        if (is_structural(p[k])) {
+            mask |= (uint64_t)1 << k;
+        }
+    }
+    return mask;
+}
+
+#endif
+
+size_t index_structurals(const char *buf, size_t len, uint32_t *out) {
+    size_t n = 0;
+    size_t i = 0;
+
+    for (; i + 64 <= len; i += 64) {
+        uint64_t mask = structural_mask64(buf + i);
+        while (mask) {
+            out[n++] = (uint32_t)(i + __builtin_ctzll(mask));
+            mask &= mask - 1;
+        }
+    }
+
+    for (; i < len; i++) {
+        if (is_structural(buf[i])) {
+            out[n++] = (uint32_t)i;
+        }
+    }
+
+    return n;
+}
+
+//------------------------------------------------------------------------------
+// Number parsing
+
+const char *parse_fixed_decimal(const char *p, const char *end, float *value) {
+    bool negative = false;
+    uint64_t mantissa = 0;
+    int digits = 0;
+    int frac_digits = 0;
+
+    if (p < end && *p == '-') {
+        negative = true;
+        p++;
+    }
+
+    while (p < end && is_digit(*p)) {
+        mantissa = mantissa * 10 + (uint64_t)(*p - '0');
+        digits++;
+        p++;
+    }
+
+    if (p < end && *p == '.') {
+        p++;
+        while (p < end && is_digit(*p)) {
+            mantissa = mantissa * 10 + (uint64_t)(*p - '0');
+            digits++;
+            frac_digits++;
+            p++;
+        }
+    }
+
+    // Firmware prints %.1f/%.2f values; anything wider is not ours
+    if (digits == 0 || digits > 18) {
+        return nullptr;
+    }
+
+    double v = (double)mantissa / kPow10[frac_digits];
+    *value = (float)(negative ? -v : v);
+    return p;
+}
+
+static const char *parse_unsigned(const char *p, const char *end, uint32_t *value) {
+    uint64_t v = 0;
+    const char *start = p;
+
+    while (p < end && is_digit(*p)) {
+        v = v * 10 + (uint64_t)(*p - '0');
+        p++;
+    }
+
+    if (p == start || p - start > 10 || v > 0xFFFFFFFFull) {
+        return nullptr;
+    }
+
+    *value = (uint32_t)v;
+    return p;
+}
+
+//------------------------------------------------------------------------------
+// CSV: Frame,FPS,L_avg,L_med,C_avg,C_med,R_avg,R_med,Width,Conf,Det
+
+bool TextStreamParser::parse_csv_line(const char *buf, const char *line, const char *end,
+                                      const uint32_t *commas, size_t n_commas,
+                                      FrameRecord &record) {
+    if (n_commas != CSV_FIELDS - 1) {
+        return false;
+    }
+
+    const char *field_end[CSV_FIELDS];
+    for (size_t i = 0; i < n_commas; i++) {
+        if (buf[commas[i]] != ',') {
+            return false;
+        }
+        field_end[i] = buf + commas[i];
+    }
+    field_end[CSV_FIELDS - 1] = end;
+
+    memset(&record, 0, sizeof(record));
+    record.source = RecordSource::Csv;
+    record.fields = FIELD_ZONE_AVG | FIELD_ZONE_MEDIAN | FIELD_WIDTH |
+                    FIELD_CONFIDENCE | FIELD_DETECTED;
+
+    FrameData &d = record.data;
+    float *floats[] = {
+        &record.fps,
+        &d.left.avg, &d.left.median,
+        &d.centre.avg, &d.centre.median,
+        &d.right.avg, &d.right.median,
+    };
+
+    const char *p = line;
+    uint32_t u;
+
+    p = parse_unsigned(p, field_end[0], &u);
+    if (p != field_end[0]) return false;
+    d.frame_number = u;
+
+    for (int i = 0; i < 7; i++) {
+        p = parse_fixed_decimal(p + 1, field_end[i + 1], floats[i]);
+        if (p != field_end[i + 1]) return false;
+    }
+
+    p = parse_unsigned(p + 1, field_end[8], &u);
+    if (p != field_end[8] || u > 0xFF) return false;
+    d.detection.tyre_width = (uint8_t)u;
+
+    p = parse_fixed_decimal(p + 1, field_end[9], &d.detection.confidence);
+    if (p != field_end[9]) return false;
+
+    p = parse_unsigned(p + 1, field_end[10], &u);
+    if (p != field_end[10] || u > 1) return false;
+    d.detection.detected = (u != 0);
+
+    return true;
+}
+
+//------------------------------------------------------------------------------
+// JSON: fixed key sequence emitted by send_serial_json
+
+enum JsonKind : uint8_t {
+    JSON_FLOAT,
+    JSON_U32,
+    JSON_U8,
+    JSON_BOOL,
+    JSON_OPEN,     // Nested object - nothing to parse
+    JSON_PROFILE,  // Array of up to SENSOR_WIDTH floats
+    JSON_SKIP,     // Array we do not decode (warnings)
+    JSON_TENTHS,   // Float stored as int16 tenths
+    JSON_TENTHS_U8,
+    JSON_COUNTS,   // Array of up to ZONE_HIST_MAX_BINS uint16 histogram counts
+};
+
+struct JsonField {
+    const char *key;
+    uint8_t key_len;
+    JsonKind kind;
+    uint16_t offset;  // Byte offset into FrameRecord
+};
+
+#define JF(key, kind, member) { key, sizeof(key) - 1, kind, (uint16_t)offsetof(FrameRecord, member) }
+#define JF_NONE(key, kind) { key, sizeof(key) - 1, kind, 0 }
+
+static const JsonField kJsonSchema[] = {
+    JF("frame_number", JSON_U32, data.frame_number),
+    JF("fps", JSON_FLOAT, fps),
+    JF_NONE("analysis", JSON_OPEN),
+    JF_NONE("left", JSON_OPEN),
+    JF("avg", JSON_FLOAT, data.left.avg),
+    JF("median", JSON_FLOAT, data.left.median),
+    JF("mad", JSON_FLOAT, data.left.mad),
+    JF("min", JSON_FLOAT, data.left.min),
+    JF("max", JSON_FLOAT, data.left.max),
+    JF("range", JSON_FLOAT, data.left.range),
+    JF_NONE("centre", JSON_OPEN),
+    JF("avg", JSON_FLOAT, data.centre.avg),
+    JF("median", JSON_FLOAT, data.centre.median),
+    JF("mad", JSON_FLOAT, data.centre.mad),
+    JF("min", JSON_FLOAT, data.centre.min),
+    JF("max", JSON_FLOAT, data.centre.max),
+    JF("range", JSON_FLOAT, data.centre.range),
+    JF_NONE("right", JSON_OPEN),
+    JF("avg", JSON_FLOAT, data.right.avg),
+    JF("median", JSON_FLOAT, data.right.median),
+    JF("mad", JSON_FLOAT, data.right.mad),
+    JF("min", JSON_FLOAT, data.right.min),
+    JF("max", JSON_FLOAT, data.right.max),
+    JF("range", JSON_FLOAT, data.right.range),
+    JF("lateral_gradient", JSON_FLOAT, data.lateral_gradient),
+    JF_NONE("detection", JSON_OPEN),
+    JF("detected", JSON_BOOL, data.detection.detected),
+    JF("span_start", JSON_U8, data.detection.span_start),
+    JF("span_end", JSON_U8, data.detection.span_end),
+    JF("tyre_width", JSON_U8, data.detection.tyre_width),
+    JF("confidence", JSON_FLOAT, data.detection.confidence),
+    JF_NONE("temperature_profile", JSON_PROFILE),
+    JF_NONE("warnings", JSON_SKIP),
+    // Optional, present when the firmware has histograms enabled
+    JF_NONE("histograms", JSON_OPEN),
+    JF("min", JSON_TENTHS, histograms.config.min_tenths),
+    JF("bin_width", JSON_TENTHS_U8, histograms.config.bin_width_tenths),
+    JF("left", JSON_COUNTS, histograms.counts[0]),
+    JF("centre", JSON_COUNTS, histograms.counts[1]),
+    JF("right", JSON_COUNTS, histograms.counts[2]),
+};
+
+#define JSON_SCHEMA_LEN (sizeof(kJsonSchema) / sizeof(kJsonSchema[0]))
+#define JSON_HISTOGRAM_KEYS 6
+#define JSON_BASE_LEN (JSON_SCHEMA_LEN - JSON_HISTOGRAM_KEYS)
+
+bool TextStreamParser::parse_json_object(const char *buf, const char *obj_end,
+                                         const uint32_t *colons, size_t n_colons,
+                                         FrameRecord &record) {
+    if (n_colons != JSON_BASE_LEN && n_colons != JSON_SCHEMA_LEN) {
+        return false;
+    }
+    const size_t n_fields = n_colons;
+
+    memset(&record, 0, sizeof(record));
+    record.source = RecordSource::Json;
+    record.fields = FIELD_ZONE_AVG | FIELD_ZONE_MEDIAN | FIELD_ZONE_SPREAD |
+                    FIELD_GRADIENT | FIELD_SPAN | FIELD_WIDTH |
+                    FIELD_CONFIDENCE | FIELD_DETECTED;
+
+    uint8_t *base = (uint8_t *)&record;
+
+    for (size_t i = 0; i < n_fields; i++) {
+        const JsonField &f = kJsonSchema[i];
+        const char *colon = buf + colons[i];
+
+        // Key must be exactly "key" immediately before the colon
+        const char *key = colon - 1 - f.key_len;
+        if (key - 1 < buf || key[-1] != '"' || colon[-1] != '"' ||
+            memcmp(key, f.key, f.key_len) != 0) {
+            return false;
+        }
+
+        const char *p = colon + 1;
+        const char *end = (i + 1 < n_fields) ? buf + colons[i + 1] : obj_end;
+        while (p < end && *p == ' ') p++;
+
+        float fv;
+        uint32_t uv;
+
+        switch (f.kind) {
+        case JSON_FLOAT:
+            if (!parse_fixed_decimal(p, end, &fv)) return false;
+            memcpy(base + f.offset, &fv, sizeof(fv));
+            break;
+
+        case JSON_U32:
+            if (!parse_unsigned(p, end, &uv)) return false;
+            memcpy(base + f.offset, &uv, sizeof(uv));
+            break;
+
+        case JSON_U8:
+            if (!parse_unsigned(p, end, &uv) || uv > 0xFF) return false;
+            base[f.offset] = (uint8_t)uv;
+            break;
+
+        case JSON_BOOL:
+            if (!parse_unsigned(p, end, &uv) || uv > 1) return false;
+            *(bool *)(base + f.offset) = (uv != 0);
+            break;
+
+        case JSON_OPEN:
+            if (p >= end || *p != '{') return false;
+            break;
+
+        case JSON_PROFILE: {
+            if (p >= end || *p != '[') return false;
+            p++;
+            int n = 0;
+            while (p < end && *p != ']') {
+                if (n >= SENSOR_WIDTH) return false;
+                p = parse_fixed_decimal(p, end, &record.profile[n++]);
+                if (!p) return false;
+                while (p < end && (*p == ',' || *p == ' ')) p++;
+            }
+            if (n == SENSOR_WIDTH) {
+                record.fields |= FIELD_PROFILE;
+            }
+            break;
+        }
+
+        case JSON_SKIP:
+            break;
+
+        case JSON_TENTHS:
+        case JSON_TENTHS_U8: {
+            if (!parse_fixed_decimal(p, end, &fv)) return false;
+            float tenths = fv * 10.0f;
+            tenths += (tenths < 0.0f) ? -0.5f : 0.5f;
+            if (f.kind == JSON_TENTHS) {
+                if (tenths < INT16_MIN || tenths > INT16_MAX) return false;
+                int16_t v = (int16_t)tenths;
+                memcpy(base + f.offset, &v, sizeof(v));
+            } else {
+                if (tenths < 0.0f || tenths > 255.0f) return false;
+                base[f.offset] = (uint8_t)tenths;
+            }
+            break;
+        }
+
+        case JSON_COUNTS: {
+            if (p >= end || *p != '[') return false;
+            p++;
+            uint16_t *counts = (uint16_t *)(base + f.offset);
+            int n = 0;
+            while (p < end && *p != ']') {
+                if (n >= ZONE_HIST_MAX_BINS) return false;
+                const char *next = parse_unsigned(p, end, &uv);
+                if (!next || uv > 0xFFFF) return false;
+                counts[n++] = (uint16_t)uv;
+                p = next;
+                while (p < end && (*p == ',' || *p == ' ')) p++;
+            }
+            // Every zone has the same bin count
+            if (f.offset != offsetof(FrameRecord, histograms.counts[0]) &&
+                n != record.histograms.config.bins) {
+                return false;
+            }
+            record.histograms.config.bins = (uint8_t)n;
+            break;
+        }
+        }
+    }
+
+    if (n_fields == JSON_SCHEMA_LEN) {
+        record.histograms.frame_number = record.data.frame_number;
+        record.fields |= FIELD_HISTOGRAMS;
+    }
+
+    return true;
+}
+
+//------------------------------------------------------------------------------
+// Stage 2: walk the structural index
+
+static inline const char *trim_cr(const char *line, const char *end) {
+    return (end > line && end[-1] == '\r') ? end - 1 : end;
+}
+
+size_t TextStreamParser::parse_buffer(const char *buf, size_t len, RecordSink &sink) {
+    if (structurals_.size() < len) {
+        structurals_.resize(len);
+    }
+
+    uint32_t *idx = structurals_.data();
+    size_t n = index_structurals(buf, len, idx);
+
+    size_t pos = 0;  // Start of the current line
+    size_t i = 0;    // First structural belonging to the current line
+    FrameRecord record;
+
+    while (i < n) {
+        size_t j = i;
+        while (j < n && buf[idx[j]] != '\n') j++;
+        if (j == n) break;  // Incomplete line
+
+        const char *line = buf + pos;
+        const char *line_end = trim_cr(line, buf + idx[j]);
+
+        if (line < line_end && is_digit(line[0])) {
+            if (parse_csv_line(buf, line, line_end, idx + i, j - i, record)) {
+                stats_.csv_records++;
+                sink.on_record(record);
+            } else {
+                stats_.malformed++;
+            }
+        } else if (line_end - line == 1 && line[0] == '{') {
+            // Find the closing "}" line; abandon the object if a new record starts first
+            size_t k = j + 1;
+            size_t line_start = idx[j] + 1;
+            bool closed = false;
+            bool aborted = false;
+
+            while (k < n) {
+                if (buf[idx[k]] != '\n') {
+                    k++;
+                    continue;
+                }
+                const char *l = buf + line_start;
+                const char *le = trim_cr(l, buf + idx[k]);
+                if (le - l == 1 && l[0] == '}') {
+                    closed = true;
+                    break;
+                }
+                if (l < le && (l[0] == '{' || is_digit(l[0]))) {
+                    aborted = true;
+                    break;
+                }
+                line_start = idx[k] + 1;
+                k++;
+            }
+
+            if (aborted) {
+                stats_.malformed++;
+                pos = line_start;
+                i = k;
+                // Rewind i to the first structural of the interrupting line
+                while (i > 0 && idx[i - 1] >= line_start) i--;
+                continue;
+            }
+
+            if (!closed) {
+                break;  // Wait for the rest of the object
+            }
+
+            uint32_t colons[64];
+            size_t n_colons = 0;
+            for (size_t c = j + 1; c < k && n_colons < 64; c++) {
+                if (buf[idx[c]] == ':') {
+                    colons[n_colons++] = idx[c];
+                }
+            }
+
+            if (parse_json_object(buf, buf + idx[k], colons, n_colons, record)) {
+                stats_.json_records++;
+                sink.on_record(record);
+            } else {
+                stats_.malformed++;
+            }
+            j = k;
+        } else {
+            stats_.text_lines++;
+            sink.on_text(std::string_view(line, (size_t)(line_end - line)));
+        }
+
+        pos = idx[j] + 1;
+        i = j + 1;
+    }
+
+    return pos;
+}
+
+//------------------------------------------------------------------------------
+
+TextStreamParser::TextStreamParser() {
+    carry_.reserve(4096);
+}
+
+void TextStreamParser::reset() {
+    carry_.clear();
+}
+
+void TextStreamParser::feed(const char *data, size_t len, RecordSink &sink) {
+    stats_.bytes += len;
+
+    if (!carry_.empty()) {
+        // Complete the pending line/object with as little new data as possible
+        size_t take = len;
+        if (carry_[0] == '{') {
+            for (size_t k = 0; k + 1 < len; k++) {
+                if (data[k] == '}' && data[k + 1] == '\n' &&
+                    (k == 0 ? carry_.back() == '\n' : data[k - 1] == '\n')) {
+                    take = k + 2;
+                    break;
+                }
+            }
+        } else {
+            const void *nl = memchr(data, '\n', len);
+            if (nl) take = (size_t)((const char *)nl - data) + 1;
+        }
+
+        carry_.append(data, take);
+        size_t used = parse_buffer(carry_.data(), carry_.size(), sink);
+        carry_.erase(0, used);
+        data += take;
+        len -= take;
+
+        if (!carry_.empty()) {
+            if (carry_.size() > MAX_PENDING_BYTES) {
+                stats_.malformed++;
+                carry_.clear();
+            } else if (len == 0) {
+                return;
+            } else {
+                // Still pending (e.g. aborted object left a partial line);
+                // fall back to joining the remainder
+                carry_.append(data, len);
+                used = parse_buffer(carry_.data(), carry_.size(), sink);
+                carry_.erase(0, used);
+                return;
+            }
+        }
+    }
+
+    size_t used = parse_buffer(data, len, sink);
+    carry_.assign(data + used, len - used);
+    if (carry_.size() > MAX_PENDING_BYTES) {
+        stats_.malformed++;
+        carry_.clear();
+    }
+}
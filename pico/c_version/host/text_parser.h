@@ -0,0 +1,80 @@
+/**
+ * text_parser.h
+ * High-throughput parser for the firmware's legacy text output
+ *
+ * Understands exactly two schemas:
+ *   CSV  - send_serial_compact: Frame,FPS,L_avg,L_med,C_avg,C_med,R_avg,R_med,Width,Conf,Det
+ *   JSON - send_serial_json: the fixed multi-line object printed field by field
+ *
+ * Input is scanned 64 bytes at a time with SIMD compares to index the
+ * structural characters (newline, comma, colon), and numbers are parsed
+ * as fixed-decimal values without strtod. Any other line (timing output,
+ * error messages) is passed through to the sink as text.
+ */
+
+#ifndef TEXT_PARSER_H
+#define TEXT_PARSER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "frame_record.h"
+
+// Receives parser output
+class RecordSink {
+public:
+    virtual ~RecordSink() = default;
+
+    // A complete CSV or JSON frame record
+    virtual void on_record(const FrameRecord &record) = 0;
+
+    // A line that is not part of a record (diagnostics, errors)
+    virtual void on_text(std::string_view line) { (void)line; }
+};
+
+struct TextParserStats {
+    uint64_t bytes = 0;
+    uint64_t csv_records = 0;
+    uint64_t json_records = 0;
+    uint64_t text_lines = 0;
+    uint64_t malformed = 0;  // Lines/objects that looked like records but failed to parse
+};
+
+class TextStreamParser {
+public:
+    TextStreamParser();
+
+    // Parse a chunk of stream data. Partial lines and partial JSON objects
+    // are carried over to the next call, so chunks may split anywhere.
+    void feed(const char *data, size_t len, RecordSink &sink);
+
+    // Drop any carried-over partial input (e.g. after a port reconnect)
+    void reset();
+
+    const TextParserStats &stats() const { return stats_; }
+
+private:
+    size_t parse_buffer(const char *buf, size_t len, RecordSink &sink);
+    bool parse_csv_line(const char *buf, const char *line, const char *end,
+                        const uint32_t *commas, size_t n_commas, FrameRecord &record);
+    bool parse_json_object(const char *buf, const char *obj_end, const uint32_t *colons,
+                           size_t n_colons, FrameRecord &record);
+
+    std::string carry_;                 // Unconsumed tail of the previous chunk
+    std::vector<uint32_t> structurals_; // Stage 1 output, reused between calls
+    TextParserStats stats_;
+};
+
+// Index positions of '\n', ',' and ':' in buf (SIMD where available).
+// out must have room for len entries. Returns the number written.
+size_t index_structurals(const char *buf, size_t len, uint32_t *out);
+
+// Parse an optionally signed fixed-decimal number ("-12.34") starting at p.
+// Stops at the first character that is not part of the number.
+// Returns the position after the number, or nullptr if no digits were found.
+const char *parse_fixed_decimal(const char *p, const char *end, float *value);
+
+#endif // TEXT_PARSER_H
@@ -0,0 +1,72 @@
+/**
+ * thermal_tyre_calibration.cpp
+ * Build and inspect calibration catalogs (see calibration_catalog.h)
+ *
+ * Usage: thermal_tyre_calibration add CATALOG EEPROM.bin ...
+ *        thermal_tyre_calibration list CATALOG
+ *
+ * EEPROM.bin is a raw MLX90640_DumpEE() dump: 832 little-endian words.
+ * add creates the catalog if it doesn't exist and replaces sensors that
+ * are already in it.
+ */
+
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <unistd.h>
+
+#include "calibration_catalog.h"
+
+static void usage(const char *prog) {
+    fprintf(stderr,
+            "Usage: %s add CATALOG EEPROM.bin [EEPROM.bin ...]\n"
+            "       %s list CATALOG\n",
+            prog, prog);
+}
+
+static int cmd_add(const std::string &path, int count, char **dumps) {
+    CalibrationCatalogWriter writer;
+    if (access(path.c_str(), F_OK) == 0) {
+        CalibrationCatalog existing;
+        if (!existing.open(path) || !writer.load(existing)) return 1;
+    }
+
+    int failed = 0;
+    for (int i = 0; i < count; i++) {
+        uint16_t eeprom[CALIBRATION_EEPROM_WORDS];
+        if (!calibration_read_eeprom(dumps[i], eeprom) || !writer.add(eeprom)) {
+            failed++;
+            continue;
+        }
+        printf("%012llx  %s\n", (unsigned long long)calibration_serial(eeprom), dumps[i]);
+    }
+
+    if (!writer.write(path)) return 1;
+    printf("%zu sensors in %s\n", writer.size(), path.c_str());
+    return failed ? 1 : 0;
+}
+
+static int cmd_list(const std::string &path) {
+    CalibrationCatalog catalog;
+    if (!catalog.open(path)) return 1;
+
+    printf("%-14s %-18s %8s %8s\n", "serial", "eeprom hash", "vPTAT25", "vdd25");
+    for (size_t i = 0; i < catalog.size(); i++) {
+        const CalibrationEntry &e = catalog.entry(i);
+        printf("%012llx   %016llx %8u %8d\n", (unsigned long long)e.serial,
+               (unsigned long long)e.eeprom_hash, e.params.vPTAT25, e.params.vdd25);
+    }
+    printf("%zu sensors\n", catalog.size());
+    return 0;
+}
+
+int main(int argc, char **argv) {
+    if (argc >= 4 && strcmp(argv[1], "add") == 0) {
+        return cmd_add(argv[2], argc - 3, argv + 3);
+    }
+    if (argc == 3 && strcmp(argv[1], "list") == 0) {
+        return cmd_list(argv[2]);
+    }
+    usage(argv[0]);
+    return 1;
+}
@@ -0,0 +1,296 @@
+/**
+ * thermal_tyre_daemon.cpp
+ * Aggregation daemon for one or more thermal tyre Picos on USB serial
+ *
+ * Reads each device's serial stream (text or binary output mode),
+ * decodes frame records and firmware diagnostics, and exports per-device and daemon metrics in Prometheus
+ * text format on a local Unix socket (and optionally 127.0.0.1:PORT).
+ * The latest records of every device are also published to a shared
+ * memory segment for local readers (see snapshot_shm.h).
+ *
+ * Usage: thermal_tyre_daemon [--socket PATH] [--port N] [--shm NAME] NAME=/dev/ttyACM0 ...
+ *
+ *   curl --unix-socket /tmp/thermal_tyre.sock http://localhost/metrics
+ */
+
+#include <cerrno>
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fcntl.h>
+#include <memory>
+#include <poll.h>
+#include <string>
+#include <termios.h>
+#include <unistd.h>
+#include <vector>
+
+#include "metrics.h"
+#include "metrics_server.h"
+#include "mux_decoder.h"
+#include "snapshot_shm.h"
+
+#define DEFAULT_SOCKET "/tmp/thermal_tyre.sock"
+#define READ_CHUNK 4096
+#define RECONNECT_INTERVAL_NS 1000000000LL
+#define POLL_TIMEOUT_MS 250
+
+static volatile sig_atomic_t running = 1;
+
+static void on_signal(int sig) {
+    (void)sig;
+    running = 0;
+}
+
+//------------------------------------------------------------------------------
+// Per-device ingest
+
+// Updates a device's metrics and snapshot slot from decoder output. Binary
+// diagnostics arrive formatted as the text lines (MuxSink::on_event). Runs on
+// the ingest thread only, which makes it the single writer for both.
+class DeviceSink : public MuxSink {
+public:
+    DeviceSink(DeviceMetrics &m, SnapshotPublisher &snapshot, size_t index)
+        : m_(m), snapshot_(snapshot), index_(index) {}
+
+    void on_record(const FrameRecord &record) override {
+        int64_t now = monotonic_ns();
+        uint32_t frame = record.data.frame_number;
+
+        if (have_frame_) {
+            // Firmware counts every frame; gaps are frames lost on the way
+            if (frame > last_frame_ + 1) m_.frames_dropped.inc(frame - last_frame_ - 1);
+            int64_t last_ns = m_.last_frame_ns.load(std::memory_order_relaxed);
+            m_.interarrival_ms.observe((now - last_ns) / 1e6f);
+        }
+        have_frame_ = true;
+        last_frame_ = frame;
+
+        m_.frames.inc();
+        m_.last_frame_ns.store(now, std::memory_order_relaxed);
+        m_.last_frame_number.set((float)frame);
+        m_.fps.set(record.fps);
+        if (record.fields & FIELD_CONFIDENCE) m_.confidence.set(record.data.detection.confidence);
+        if (record.fields & FIELD_DETECTED) m_.detected.set(record.data.detection.detected ? 1.0f : 0.0f);
+        if (record.fields & FIELD_ZONE_AVG) m_.centre_temp.set(record.data.centre.avg);
+
+        snapshot_.publish(index_, record, now);
+    }
+
+    void on_text(std::string_view line) override {
+        if (line.compare(0, 7, "[Frame ") == 0) {
+            parse_timing(line);
+        } else if (line.compare(0, 24, "ERROR: Frame read failed") == 0) {
+            m_.i2c_errors.inc();
+        } else if (line.compare(0, 5, "ERROR") == 0) {
+            m_.error_lines.inc();
+        }
+    }
+
+    // Called after a reconnect: the device may have rebooted
+    void reset() { have_frame_ = false; }
+
+private:
+    // "[Frame N] Total: X.Xms (Y.Y fps) | Sensor: a.ams | Calc: b.bms | Algo: c.cms | Comm: d.dms"
+    void parse_timing(std::string_view line) {
+        static const char *const keys[] = {"Total: ", "Sensor: ", "Calc: ", "Algo: ", "Comm: "};
+        LatencyHistogram *const hists[] = {&m_.frame_ms, &m_.sensor_ms, &m_.calc_ms,
+                                           &m_.algo_ms, &m_.comm_ms};
+        float values[5];
+        size_t pos = 0;
+
+        for (int i = 0; i < 5; i++) {
+            pos = line.find(keys[i], pos);
+            if (pos == std::string_view::npos) return;
+            pos += strlen(keys[i]);
+            const char *end = parse_fixed_decimal(line.data() + pos, line.data() + line.size(), &values[i]);
+            if (!end) return;
+            pos = end - line.data();
+        }
+        for (int i = 0; i < 5; i++) hists[i]->observe(values[i]);
+    }
+
+    DeviceMetrics &m_;
+    SnapshotPublisher &snapshot_;
+    size_t index_;
+    bool have_frame_ = false;
+    uint32_t last_frame_ = 0;
+};
+
+static SnapshotPublisher snapshot;
+
+struct Device {
+    size_t index = 0;
+    DeviceMetrics metrics;
+    MuxStreamDecoder parser;
+    std::unique_ptr<DeviceSink> sink;
+    int fd = -1;
+    int64_t next_open_ns = 0;
+    uint64_t malformed_seen = 0;
+    bool opened_before = false;
+};
+
+static int open_serial(const char *path) {
+    int fd = open(path, O_RDONLY | O_NOCTTY | O_NONBLOCK | O_CLOEXEC);
+    if (fd < 0) return -1;
+
+    // Raw mode on ttys; plain files and FIFOs are read as-is
+    struct termios tio;
+    if (tcgetattr(fd, &tio) == 0) {
+        cfmakeraw(&tio);
+        cfsetispeed(&tio, B115200);  // Ignored by USB CDC, needed by real UARTs
+        tcsetattr(fd, TCSANOW, &tio);
+    }
+    return fd;
+}
+
+static void close_device(Device &dev, int64_t now) {
+    if (dev.fd >= 0) close(dev.fd);
+    dev.fd = -1;
+    dev.next_open_ns = now + RECONNECT_INTERVAL_NS;
+    dev.metrics.connected.set(0.0f);
+    snapshot.set_connected(dev.index, false);
+}
+
+static void try_open(Device &dev, int64_t now) {
+    if (dev.fd >= 0 || now < dev.next_open_ns) return;
+
+    dev.fd = open_serial(dev.metrics.path.c_str());
+    if (dev.fd < 0) {
+        dev.next_open_ns = now + RECONNECT_INTERVAL_NS;
+        return;
+    }
+
+    if (dev.opened_before) dev.metrics.reconnects.inc();
+    dev.opened_before = true;
+    dev.parser.reset();
+    dev.sink->reset();
+    dev.metrics.connected.set(1.0f);
+    snapshot.set_connected(dev.index, true);
+    fprintf(stderr, "%s: opened %s\n", dev.metrics.name.c_str(), dev.metrics.path.c_str());
+}
+
+static void ingest(Device &dev, DaemonMetrics &daemon) {
+    char buf[READ_CHUNK];
+
+    for (;;) {
+        ssize_t n = read(dev.fd, buf, sizeof(buf));
+        if (n > 0) {
+            int64_t t0 = monotonic_ns();
+            dev.parser.feed(buf, (size_t)n, *dev.sink);
+            daemon.ingest_ms.observe((monotonic_ns() - t0) / 1e6f);
+            dev.metrics.bytes_read.inc((uint64_t)n);
+            continue;
+        }
+        if (n < 0 && (errno == EAGAIN || errno == EINTR)) break;
+
+        // EOF or error: device unplugged (or end of a plain file)
+        fprintf(stderr, "%s: %s, reconnecting\n", dev.metrics.name.c_str(),
+                n == 0 ? "end of stream" : strerror(errno));
+        close_device(dev, monotonic_ns());
+        break;
+    }
+
+    // Mirror decoder stats into the metric (decoder owns the counts)
+    uint64_t malformed = dev.parser.text_stats().malformed + dev.parser.stats().invalid +
+                         dev.parser.stats().malformed;
+    if (malformed != dev.malformed_seen) {
+        dev.metrics.malformed.inc(malformed - dev.malformed_seen);
+        dev.malformed_seen = malformed;
+    }
+}
+
+//------------------------------------------------------------------------------
+
+static void usage(const char *prog) {
+    fprintf(stderr,
+            "Usage: %s [--socket PATH] [--port N] [--shm NAME] NAME=DEVICE [NAME=DEVICE ...]\n"
+            "  --socket PATH  Unix socket for /metrics (default " DEFAULT_SOCKET ", \"\" to disable)\n"
+            "  --port N       Also serve /metrics on 127.0.0.1:N\n"
+            "  --shm NAME     Shared memory snapshot (default " SHM_SNAPSHOT_NAME ", \"\" to disable)\n",
+            prog);
+}
+
+int main(int argc, char **argv) {
+    std::string socket_path = DEFAULT_SOCKET;
+    std::string shm_name = SHM_SNAPSHOT_NAME;
+    int port = 0;
+    std::vector<std::unique_ptr<Device>> devices;
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--socket") == 0 && i + 1 < argc) {
+            socket_path = argv[++i];
+        } else if (strcmp(argv[i], "--port") == 0 && i + 1 < argc) {
+            port = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--shm") == 0 && i + 1 < argc) {
+            shm_name = argv[++i];
+        } else if (const char *eq = strchr(argv[i], '=')) {
+            auto dev = std::make_unique<Device>();
+            dev->metrics.name.assign(argv[i], eq - argv[i]);
+            dev->metrics.path = eq + 1;
+            dev->index = devices.size();
+            dev->sink = std::make_unique<DeviceSink>(dev->metrics, snapshot, dev->index);
+            devices.push_back(std::move(dev));
+        } else {
+            usage(argv[0]);
+            return 1;
+        }
+    }
+    if (devices.empty()) {
+        usage(argv[0]);
+        return 1;
+    }
+
+    DaemonMetrics daemon;
+    daemon.start_ns = monotonic_ns();
+
+    std::vector<DeviceMetrics *> metric_list;
+    for (auto &dev : devices) metric_list.push_back(&dev->metrics);
+
+    MetricsServer server(daemon, metric_list);
+    if (!server.start(socket_path, port)) return 1;
+
+    if (!shm_name.empty()) {
+        std::vector<std::string> names;
+        for (auto &dev : devices) names.push_back(dev->metrics.name);
+        if (!snapshot.open(shm_name, names)) return 1;
+    }
+
+    signal(SIGINT, on_signal);
+    signal(SIGTERM, on_signal);
+
+    std::vector<struct pollfd> fds;
+    std::vector<Device *> polled;
+
+    while (running) {
+        int64_t now = monotonic_ns();
+        fds.clear();
+        polled.clear();
+        for (auto &dev : devices) {
+            try_open(*dev, now);
+            if (dev->fd >= 0) {
+                fds.push_back({dev->fd, POLLIN, 0});
+                polled.push_back(dev.get());
+            }
+        }
+
+        int ready = poll(fds.data(), fds.size(), POLL_TIMEOUT_MS);
+        if (ready < 0) {
+            if (errno == EINTR) continue;
+            perror("poll");
+            break;
+        }
+        daemon.poll_wakeups.inc();
+
+        for (size_t i = 0; i < fds.size(); i++) {
+            if (fds[i].revents) ingest(*polled[i], daemon);
+        }
+        snapshot.notify();
+    }
+
+    server.stop();
+    snapshot.close();
+    for (auto &dev : devices) close_device(*dev, 0);
+    return 0;
+}
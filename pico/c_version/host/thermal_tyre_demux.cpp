@@ -0,0 +1,186 @@
+/**
+ * thermal_tyre_demux.cpp
+ * Splits a Pico's serial stream into data and diagnostics
+ *
+ * Reads a device (or a recorded stream file) in either output mode and
+ * writes frame records to stdout as the firmware's compact CSV, and
+ * diagnostics, trace and other text to stderr. With --binary it first
+ * switches the device to OUTPUT_MODE_USB_BINARY over the command channel.
+ * Per-channel statistics are printed at exit.
+ *
+ * Usage: thermal_tyre_demux [--binary] [--ping] DEVICE|FILE
+ *
+ *   thermal_tyre_demux --binary /dev/ttyACM0 > frames.csv 2> diag.log
+ */
+
+#include <cerrno>
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fcntl.h>
+#include <termios.h>
+#include <unistd.h>
+
+#include "mux_decoder.h"
+
+extern "C" {
+#include "i2c_slave.h"
+}
+
+#define READ_CHUNK 4096
+
+static volatile sig_atomic_t running = 1;
+
+static void on_signal(int sig) {
+    (void)sig;
+    running = 0;
+}
+
+class DemuxSink : public MuxSink {
+public:
+    void on_record(const FrameRecord &r) override {
+        const FrameData &d = r.data;
+        printf("%lu,%.1f,%.1f,%.1f,%.1f,%.1f,%.1f,%.1f,%u,%.2f,%u\n", (unsigned long)d.frame_number,
+               r.fps, d.left.avg, d.left.median, d.centre.avg, d.centre.median, d.right.avg,
+               d.right.median, d.detection.tyre_width, d.detection.confidence,
+               d.detection.detected ? 1 : 0);
+    }
+
+    void on_text(std::string_view line) override {
+        fprintf(stderr, "%.*s\n", (int)line.size(), line.data());
+    }
+
+    void on_image(const ImageFrame &frame) override {
+        (void)frame;
+        images++;
+    }
+
+    void on_histograms(const ZoneHistograms &hist) override {
+        (void)hist;
+        histograms++;
+    }
+
+    void on_response(const MuxMessage &msg) override {
+        const uint8_t *p = msg.payload;
+        uint8_t type = msg.type & ~MUX_RESPONSE;
+        if (type == MUX_CMD_PING && msg.len >= 2) {
+            fprintf(stderr, "[Ping] firmware %u, protocol %u\n", p[0], p[1]);
+        } else if (type == MUX_CMD_WRITE_REG && msg.len >= 3) {
+            fprintf(stderr, "[Command] register 0x%02X = 0x%02X: %s\n", p[0], p[1],
+                    p[2] == 0 ? "ok" : "read-only");
+        } else if (type == MUX_CMD_READ_REGS && msg.len >= 1) {
+            fprintf(stderr, "[Command] registers from 0x%02X:", p[0]);
+            for (uint16_t i = 1; i < msg.len; i++) fprintf(stderr, " %02X", p[i]);
+            fprintf(stderr, "\n");
+        }
+    }
+
+    uint64_t images = 0;
+    uint64_t histograms = 0;
+};
+
+static int open_stream(const char *path, bool write) {
+    int fd = open(path, (write ? O_RDWR : O_RDONLY) | O_NOCTTY | O_CLOEXEC);
+    if (fd < 0) return -1;
+
+    struct termios tio;
+    if (tcgetattr(fd, &tio) == 0) {
+        cfmakeraw(&tio);
+        cfsetispeed(&tio, B115200);  // Ignored by USB CDC, needed by real UARTs
+        cfsetospeed(&tio, B115200);
+        tcsetattr(fd, TCSANOW, &tio);
+    }
+    return fd;
+}
+
+static bool send_command(int fd, uint8_t type, uint8_t seq, const uint8_t *payload, uint16_t len) {
+    std::vector<uint8_t> frame = mux_encode_command(type, seq, payload, len);
+    return write(fd, frame.data(), frame.size()) == static_cast<ssize_t>(frame.size());
+}
+
+static void print_stats(const MuxStreamDecoder &decoder, const DemuxSink &sink) {
+    static const char *const names[MUX_CHANNELS] = {"data", "diag", "trace", "command"};
+    const MuxDecoderStats &s = decoder.stats();
+
+    fprintf(stderr, "\n%-8s %10s %12s %8s\n", "channel", "messages", "bytes", "lost");
+    for (int c = 0; c < MUX_CHANNELS; c++) {
+        fprintf(stderr, "%-8s %10llu %12llu %8llu\n", names[c], (unsigned long long)s.channels[c].messages,
+                (unsigned long long)s.channels[c].bytes, (unsigned long long)s.channels[c].lost);
+    }
+    fprintf(stderr, "text %llu bytes (%llu CSV, %llu JSON records), %llu images, %llu histograms\n",
+            (unsigned long long)s.text_bytes, (unsigned long long)decoder.text_stats().csv_records,
+            (unsigned long long)decoder.text_stats().json_records, (unsigned long long)sink.images,
+            (unsigned long long)sink.histograms);
+    fprintf(stderr, "invalid frames %llu, malformed payloads %llu\n", (unsigned long long)s.invalid,
+            (unsigned long long)s.malformed);
+}
+
+static void usage(const char *prog) {
+    fprintf(stderr,
+            "Usage: %s [--binary] [--ping] DEVICE|FILE\n"
+            "  --binary  Switch the device to binary output (REG_OUTPUT_MODE = 0x%02X)\n"
+            "  --ping    Ask the device for its firmware and protocol versions\n",
+            prog, OUTPUT_MODE_USB_BINARY);
+}
+
+int main(int argc, char **argv) {
+    bool binary = false, ping = false;
+    const char *path = nullptr;
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--binary") == 0) {
+            binary = true;
+        } else if (strcmp(argv[i], "--ping") == 0) {
+            ping = true;
+        } else if (argv[i][0] != '-' && !path) {
+            path = argv[i];
+        } else {
+            usage(argv[0]);
+            return 1;
+        }
+    }
+    if (!path) {
+        usage(argv[0]);
+        return 1;
+    }
+
+    int fd = open_stream(path, binary || ping);
+    if (fd < 0) {
+        fprintf(stderr, "%s: %s\n", path, strerror(errno));
+        return 1;
+    }
+
+    uint8_t seq = 0;
+    if (ping && !send_command(fd, MUX_CMD_PING, seq++, nullptr, 0)) {
+        fprintf(stderr, "%s: can't send commands: %s\n", path, strerror(errno));
+    }
+    if (binary) {
+        uint8_t set_mode[2] = {REG_OUTPUT_MODE, OUTPUT_MODE_USB_BINARY};
+        if (!send_command(fd, MUX_CMD_WRITE_REG, seq++, set_mode, sizeof(set_mode))) {
+            fprintf(stderr, "%s: can't send commands: %s\n", path, strerror(errno));
+        }
+    }
+
+    signal(SIGINT, on_signal);
+    signal(SIGTERM, on_signal);
+
+    MuxStreamDecoder decoder;
+    DemuxSink sink;
+    char buf[READ_CHUNK];
+    while (running) {
+        ssize_t n = read(fd, buf, sizeof(buf));
+        if (n > 0) {
+            decoder.feed(buf, (size_t)n, sink);
+            continue;
+        }
+        if (n < 0 && errno == EINTR) continue;
+        if (n < 0) fprintf(stderr, "%s: %s\n", path, strerror(errno));
+        break;
+    }
+
+    fflush(stdout);
+    print_stats(decoder, sink);
+    close(fd);
+    return 0;
+}
@@ -0,0 +1,456 @@
+/**
+ * train_column_classifier.cpp
+ * Trains and evaluates the firmware's column classifier (column_classifier.h)
+ *
+ * Profiles come from recorded sessions (binary frame records, see
+ * thermal_tyre_driver/records.py) and/or synthetic profiles. Each
+ * session frame is reduced to the firmware's detection profile with
+ * thermal_algorithm_profile(). Labels, in order of preference:
+ *
+ * - a sidecar "<session>.labels" CSV of frame,start,end lines (end -1
+ *   for no tyre), for hand-checked sessions;
+ * - the synthetic band;
+ * - otherwise the region grower's detection (teacher labels), which
+ *   trains the classifier to reproduce it at a constant cost.
+ *
+ * Every 5th profile is held out. A float 4-8-1 network is trained on
+ * the firmware's own int8 features, quantised to the model layout, and
+ * max_gap is picked on the training set. Both engines are then replayed
+ * over the held-out profiles through the firmware detection code, so the
+ * figures are what the Pico would produce. --out writes the model as C
+ * for column_classifier_model.c.
+ *
+ * Usage: train_column_classifier [--synthetic N] [--epochs N] [--seed N]
+ *                                [--out model.c] [--eval-only] [session ...]
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <limits>
+#include <random>
+#include <string>
+#include <vector>
+
+extern "C" {
+#include "column_classifier.h"
+#include "thermal_algorithm.h"
+}
+
+#include "synthetic_profiles.h"
+
+// Binary frame record header (thermal_tyre_driver/records.py)
+#define RECORD_HEADER_SIZE 24
+#define RECORD_VERSION 1
+#define RECORD_RAW_FRAME 0x01
+
+#define HOLDOUT_EVERY 5
+#define MAX_GAP_TRIED 3
+
+struct Sample {
+    float profile[SENSOR_WIDTH];
+    TyreDetection label;
+};
+
+static uint16_t read_u16(const uint8_t *p) { return p[0] | (p[1] << 8); }
+static uint32_t read_u32(const uint8_t *p) { return read_u16(p) | ((uint32_t)read_u16(p + 2) << 16); }
+
+static void set_label(TyreDetection *label, bool tyre, int start, int end, const ThermalConfig &config) {
+    int width = end - start + 1;
+    // A span the detectors would reject on width counts as no tyre
+    label->detected = tyre && start >= 0 && end < SENSOR_WIDTH &&
+                      width >= config.min_tyre_width && width <= config.max_tyre_width;
+    label->span_start = label->detected ? start : 0;
+    label->span_end = label->detected ? end : SENSOR_WIDTH - 1;
+    label->tyre_width = label->span_end - label->span_start + 1;
+    label->confidence = label->detected ? 1.0f : 0.0f;
+}
+
+// Sidecar labels: frame,start,end per line
+static bool load_labels(const std::string &path, std::vector<std::pair<uint32_t, std::pair<int, int>>> &labels) {
+    FILE *f = fopen(path.c_str(), "r");
+    if (!f) return false;
+    char line[128];
+    while (fgets(line, sizeof(line), f)) {
+        unsigned long frame;
+        int start, end;
+        if (sscanf(line, "%lu,%d,%d", &frame, &start, &end) == 3) {
+            labels.push_back({static_cast<uint32_t>(frame), {start, end}});
+        }
+    }
+    fclose(f);
+    std::sort(labels.begin(), labels.end());
+    return true;
+}
+
+static bool load_session(const char *path, const ThermalConfig &config, std::vector<Sample> &samples,
+                         int *labelled) {
+    FILE *f = fopen(path, "rb");
+    if (!f) {
+        fprintf(stderr, "Cannot open %s\n", path);
+        return false;
+    }
+
+    std::vector<std::pair<uint32_t, std::pair<int, int>>> labels;
+    bool have_labels = load_labels(std::string(path) + ".labels", labels);
+
+    uint8_t header[RECORD_HEADER_SIZE];
+    std::vector<uint8_t> payload;
+    float frame[SENSOR_PIXELS];
+    int frames = 0;
+
+    while (fread(header, 1, sizeof(header), f) == sizeof(header)) {
+        if (header[0] != 'T' || header[1] != 'T' || header[2] != RECORD_VERSION) {
+            fprintf(stderr, "%s: bad record after %d frames\n", path, frames);
+            break;
+        }
+        uint32_t frame_number = read_u32(header + 4);
+        int width = header[16], height = header[17], id_len = header[18];
+        uint16_t payload_len = read_u16(header + 20);
+
+        payload.resize(id_len + payload_len);
+        if (fread(payload.data(), 1, payload.size(), f) != payload.size()) break;
+        if (header[3] != RECORD_RAW_FRAME || width != SENSOR_WIDTH || height != SENSOR_HEIGHT ||
+            payload_len != SENSOR_PIXELS * 2) {
+            continue;
+        }
+
+        const uint8_t *pixels = payload.data() + id_len;
+        for (int i = 0; i < SENSOR_PIXELS; i++) {
+            frame[i] = static_cast<int16_t>(read_u16(pixels + i * 2)) / 10.0f;
+        }
+
+        Sample s;
+        thermal_algorithm_profile(frame, s.profile);
+        if (have_labels) {
+            auto it = std::lower_bound(labels.begin(), labels.end(),
+                                       std::make_pair(frame_number, std::make_pair(std::numeric_limits<int>::min(), 0)));
+            if (it == labels.end() || it->first != frame_number) continue;
+            set_label(&s.label, it->second.second >= 0, it->second.first, it->second.second, config);
+            (*labelled)++;
+        } else {
+            ThermalConfig teacher = config;
+            teacher.engine = DETECT_ENGINE_REGION;
+            thermal_algorithm_detect(s.profile, &s.label, &teacher);
+        }
+        samples.push_back(s);
+        frames++;
+    }
+    fclose(f);
+    printf("%s: %d frames%s\n", path, frames, have_labels ? " (labelled)" : " (region grower labels)");
+    return true;
+}
+
+//------------------------------------------------------------------------------
+// Float network, the same shape as ColumnClassifierModel
+
+struct FloatModel {
+    float w1[CLASSIFIER_HIDDEN][CLASSIFIER_FEATURES];
+    float b1[CLASSIFIER_HIDDEN];
+    float w2[CLASSIFIER_HIDDEN];
+    float b2;
+};
+
+struct ColumnSample {
+    float f[CLASSIFIER_FEATURES];
+    float y;
+};
+
+static void column_samples(const std::vector<Sample> &samples, bool holdout, std::vector<ColumnSample> &out) {
+    for (size_t n = 0; n < samples.size(); n++) {
+        if ((n % HOLDOUT_EVERY == 0) != holdout) continue;
+        ColumnFeatures features;
+        column_classifier_features(samples[n].profile, &features);
+        const TyreDetection &label = samples[n].label;
+        for (int c = 0; c < SENSOR_WIDTH; c++) {
+            if (!(features.valid >> c & 1)) continue;
+            ColumnSample cs;
+            for (int k = 0; k < CLASSIFIER_FEATURES; k++) {
+                cs.f[k] = features.f[c][k] / static_cast<float>(CLASSIFIER_FEATURE_SCALE);
+            }
+            cs.y = (label.detected && c >= label.span_start && c <= label.span_end) ? 1.0f : 0.0f;
+            out.push_back(cs);
+        }
+    }
+}
+
+static float forward(const FloatModel &m, const float *f, float *hidden) {
+    float out = m.b2;
+    for (int j = 0; j < CLASSIFIER_HIDDEN; j++) {
+        float acc = m.b1[j];
+        for (int k = 0; k < CLASSIFIER_FEATURES; k++) acc += m.w1[j][k] * f[k];
+        hidden[j] = acc > 0.0f ? acc : 0.0f;
+        out += m.w2[j] * hidden[j];
+    }
+    return out;
+}
+
+// Class-weighted logistic loss, Adam, mini-batches of 256 columns
+static void train(FloatModel &m, std::vector<ColumnSample> &data, int epochs, std::mt19937 &rng) {
+    std::normal_distribution<float> init(0.0f, 0.5f);
+    for (int j = 0; j < CLASSIFIER_HIDDEN; j++) {
+        for (int k = 0; k < CLASSIFIER_FEATURES; k++) m.w1[j][k] = init(rng);
+        m.b1[j] = 0.1f;
+        m.w2[j] = init(rng);
+    }
+    m.b2 = 0.0f;
+
+    double positives = 0;
+    for (const ColumnSample &s : data) positives += s.y;
+    float pos_weight = positives > 0 ? static_cast<float>((data.size() - positives) / positives) : 1.0f;
+
+    const int params = sizeof(FloatModel) / sizeof(float);
+    std::vector<float> mom(params, 0.0f), var(params, 0.0f), grad(params);
+    const float lr = 0.01f, beta1 = 0.9f, beta2 = 0.999f, eps = 1e-8f;
+    const size_t batch = 256;
+    int step = 0;
+
+    for (int epoch = 0; epoch < epochs; epoch++) {
+        std::shuffle(data.begin(), data.end(), rng);
+        double loss = 0;
+        for (size_t b0 = 0; b0 < data.size(); b0 += batch) {
+            size_t b1 = std::min(data.size(), b0 + batch);
+            std::fill(grad.begin(), grad.end(), 0.0f);
+            FloatModel &g = *reinterpret_cast<FloatModel *>(grad.data());
+
+            for (size_t i = b0; i < b1; i++) {
+                const ColumnSample &s = data[i];
+                float hidden[CLASSIFIER_HIDDEN];
+                float z = forward(m, s.f, hidden);
+                float p = 1.0f / (1.0f + expf(-z));
+                float w = s.y > 0.5f ? pos_weight : 1.0f;
+                loss += w * (s.y > 0.5f ? -logf(p + 1e-7f) : -logf(1.0f - p + 1e-7f));
+
+                float dz = w * (p - s.y);
+                g.b2 += dz;
+                for (int j = 0; j < CLASSIFIER_HIDDEN; j++) {
+                    g.w2[j] += dz * hidden[j];
+                    if (hidden[j] <= 0.0f) continue;
+                    float dh = dz * m.w2[j];
+                    g.b1[j] += dh;
+                    for (int k = 0; k < CLASSIFIER_FEATURES; k++) g.w1[j][k] += dh * s.f[k];
+                }
+            }
+
+            step++;
+            float *w = reinterpret_cast<float *>(&m);
+            float scale = 1.0f / (b1 - b0);
+            float c1 = 1.0f - powf(beta1, step), c2 = 1.0f - powf(beta2, step);
+            for (int i = 0; i < params; i++) {
+                float gi = grad[i] * scale;
+                mom[i] = beta1 * mom[i] + (1.0f - beta1) * gi;
+                var[i] = beta2 * var[i] + (1.0f - beta2) * gi * gi;
+                w[i] -= lr * (mom[i] / c1) / (sqrtf(var[i] / c2) + eps);
+            }
+        }
+        if (epoch == 0 || (epoch + 1) % 10 == 0) {
+            printf("  epoch %3d  loss %.4f\n", epoch + 1, loss / data.size());
+        }
+    }
+}
+
+// Hidden accumulators are in units of s1 * CLASSIFIER_FEATURE_SCALE of
+// the float ones and the output in s1 * FEATURE_SCALE * s2; only the
+// sign of the output is used, so per-layer scales are enough
+static ColumnClassifierModel quantise(const FloatModel &m) {
+    float max1 = 1e-6f, max2 = 1e-6f;
+    for (int j = 0; j < CLASSIFIER_HIDDEN; j++) {
+        for (int k = 0; k < CLASSIFIER_FEATURES; k++) max1 = std::max(max1, fabsf(m.w1[j][k]));
+        max2 = std::max(max2, fabsf(m.w2[j]));
+    }
+    float s1 = 127.0f / max1, s2 = 127.0f / max2;
+
+    ColumnClassifierModel q;
+    memset(&q, 0, sizeof(q));
+    for (int j = 0; j < CLASSIFIER_HIDDEN; j++) {
+        for (int k = 0; k < CLASSIFIER_FEATURES; k++) q.w1[j][k] = static_cast<int8_t>(lrintf(m.w1[j][k] * s1));
+        q.b1[j] = static_cast<int32_t>(lrintf(m.b1[j] * s1 * CLASSIFIER_FEATURE_SCALE));
+        q.w2[j] = static_cast<int8_t>(lrintf(m.w2[j] * s2));
+    }
+    q.b2 = static_cast<int32_t>(lrint(static_cast<double>(m.b2) * s1 * CLASSIFIER_FEATURE_SCALE * s2));
+    return q;
+}
+
+//------------------------------------------------------------------------------
+// Evaluation through the firmware detection code
+
+struct Score {
+    int frames = 0;
+    int agree = 0;              // Both detected or both not
+    int both = 0;
+    double iou = 0;             // Summed where both detected
+    int missed = 0;             // Label only
+    int extra = 0;              // Engine only
+
+    double span_score() const { return frames ? (agree - both + iou) / frames : 0.0; }
+};
+
+static void score(Score &s, const TyreDetection &label, const TyreDetection &d) {
+    s.frames++;
+    if (label.detected == d.detected) s.agree++;
+    if (label.detected && !d.detected) s.missed++;
+    if (!label.detected && d.detected) s.extra++;
+    if (label.detected && d.detected) {
+        int lo = std::max(label.span_start, d.span_start), hi = std::min(label.span_end, d.span_end);
+        int inter = std::max(0, hi - lo + 1);
+        int uni = (label.span_end - label.span_start + 1) + (d.span_end - d.span_start + 1) - inter;
+        s.both++;
+        s.iou += static_cast<double>(inter) / uni;
+    }
+}
+
+static Score evaluate(const std::vector<Sample> &samples, int holdout, const ThermalConfig &config,
+                      const ColumnClassifierModel *model) {
+    Score s;
+    for (size_t n = 0; n < samples.size(); n++) {
+        if (holdout >= 0 && (n % HOLDOUT_EVERY == 0) != (holdout != 0)) continue;
+        TyreDetection d;
+        if (model) {
+            column_classifier_detect(samples[n].profile, &d, &config, model);
+        } else {
+            ThermalConfig region = config;
+            region.engine = DETECT_ENGINE_REGION;
+            thermal_algorithm_detect(samples[n].profile, &d, &region);
+        }
+        score(s, samples[n].label, d);
+    }
+    return s;
+}
+
+static void print_score(const char *name, const Score &s) {
+    printf("  %-12s agree %5.1f%%  missed %5d  extra %5d  IoU %.3f  span score %.3f\n", name,
+           s.frames ? 100.0 * s.agree / s.frames : 0.0, s.missed, s.extra, s.both ? s.iou / s.both : 0.0,
+           s.span_score());
+}
+
+static bool write_model(const char *path, const ColumnClassifierModel &q, const std::string &trained_on,
+                        const Score &held_out) {
+    FILE *f = fopen(path, "w");
+    if (!f) {
+        fprintf(stderr, "Cannot write %s\n", path);
+        return false;
+    }
+    fprintf(f, "/**\n * column_classifier_model.c\n"
+               " * Column classifier weights, generated by host/train_column_classifier\n *\n"
+               " * Trained on %s.\n"
+               " * Held out: %.1f%% detection agreement, span IoU %.3f.\n */\n\n",
+            trained_on.c_str(), held_out.frames ? 100.0 * held_out.agree / held_out.frames : 0.0,
+            held_out.both ? held_out.iou / held_out.both : 0.0);
+    fprintf(f, "#include \"column_classifier.h\"\n\n"
+               "const ColumnClassifierModel column_classifier_default_model = {\n    .w1 = {\n");
+    for (int j = 0; j < CLASSIFIER_HIDDEN; j++) {
+        fprintf(f, "        {%d, %d, %d, %d},\n", q.w1[j][0], q.w1[j][1], q.w1[j][2], q.w1[j][3]);
+    }
+    fprintf(f, "    },\n    .b1 = {");
+    for (int j = 0; j < CLASSIFIER_HIDDEN; j++) fprintf(f, "%s%ld", j ? ", " : "", (long)q.b1[j]);
+    fprintf(f, "},\n    .w2 = {");
+    for (int j = 0; j < CLASSIFIER_HIDDEN; j++) fprintf(f, "%s%d", j ? ", " : "", q.w2[j]);
+    fprintf(f, "},\n    .b2 = %ld,\n    .max_gap = %u,\n};\n", (long)q.b2, q.max_gap);
+    fclose(f);
+    return true;
+}
+
+int main(int argc, char **argv) {
+    int synthetic = 0, epochs = 30;
+    unsigned seed = 1;
+    const char *out = nullptr;
+    bool eval_only = false;
+    std::vector<const char *> sessions;
+
+    for (int i = 1; i < argc; i++) {
+        if (!strcmp(argv[i], "--synthetic") && i + 1 < argc) {
+            synthetic = atoi(argv[++i]);
+        } else if (!strcmp(argv[i], "--epochs") && i + 1 < argc) {
+            epochs = atoi(argv[++i]);
+        } else if (!strcmp(argv[i], "--seed") && i + 1 < argc) {
+            seed = static_cast<unsigned>(strtoul(argv[++i], nullptr, 10));
+        } else if (!strcmp(argv[i], "--out") && i + 1 < argc) {
+            out = argv[++i];
+        } else if (!strcmp(argv[i], "--eval-only")) {
+            eval_only = true;
+        } else if (argv[i][0] == '-') {
+            fprintf(stderr, "Usage: %s [--synthetic N] [--epochs N] [--seed N] [--out model.c] "
+                            "[--eval-only] [session ...]\n", argv[0]);
+            return 2;
+        } else {
+            sessions.push_back(argv[i]);
+        }
+    }
+
+    ThermalConfig config;
+    thermal_algorithm_init(&config);
+
+    std::vector<Sample> samples;
+    int labelled = 0;
+    for (const char *path : sessions) {
+        if (!load_session(path, config, samples, &labelled)) return 1;
+    }
+    size_t recorded = samples.size();
+
+    std::mt19937 rng(seed);
+    if (synthetic > 0) {
+        for (const SyntheticProfile &p : make_synthetic_profiles(synthetic, rng)) {
+            Sample s;
+            memcpy(s.profile, p.t, sizeof(s.profile));
+            // Both engines look for a tyre hotter than the road, so a
+            // cold band counts as no tyre
+            set_label(&s.label, p.tyre && p.hot, p.start, p.end, config);
+            samples.push_back(s);
+        }
+    }
+    if (samples.empty()) {
+        fprintf(stderr, "No profiles: give sessions and/or --synthetic N\n");
+        return 2;
+    }
+
+    if (eval_only) {
+        printf("\n%zu profiles, built-in model\n", samples.size());
+        print_score("region", evaluate(samples, -1, config, nullptr));
+        print_score("classifier", evaluate(samples, -1, config, &column_classifier_default_model));
+        return 0;
+    }
+
+    std::vector<ColumnSample> columns;
+    column_samples(samples, false, columns);
+    printf("\nTraining on %zu columns from %zu profiles\n", columns.size(),
+           samples.size() - (samples.size() + HOLDOUT_EVERY - 1) / HOLDOUT_EVERY);
+
+    FloatModel model;
+    train(model, columns, epochs, rng);
+    ColumnClassifierModel q = quantise(model);
+
+    // Gap limit from the training set
+    double best = -1;
+    for (int gap = 0; gap <= MAX_GAP_TRIED; gap++) {
+        ColumnClassifierModel trial = q;
+        trial.max_gap = gap;
+        double s = evaluate(samples, 0, config, &trial).span_score();
+        printf("  max_gap %d    span score %.3f\n", gap, s);
+        if (s > best) {
+            best = s;
+            q.max_gap = gap;
+        }
+    }
+
+    printf("\nHeld out (every %dth profile):\n", HOLDOUT_EVERY);
+    Score region = evaluate(samples, 1, config, nullptr);
+    Score classifier = evaluate(samples, 1, config, &q);
+    print_score("region", region);
+    print_score("classifier", classifier);
+
+    if (out) {
+        std::string trained_on;
+        if (recorded) {
+            trained_on = std::to_string(recorded) + " recorded frames (" + std::to_string(labelled) + " labelled)";
+        }
+        if (synthetic) {
+            if (!trained_on.empty()) trained_on += " and ";
+            trained_on += std::to_string(synthetic) + " synthetic profiles (seed " + std::to_string(seed) + ")";
+        }
+        if (!write_model(out, q, trained_on, classifier)) return 1;
+        printf("\nWrote %s\n", out);
+    }
+    return 0;
+}
@@ -7,6 +7,7 @@
 #include "hardware/i2c.h"
 #include "hardware/irq.h"
 #include "hardware/gpio.h"
+#include "pico/time.h"
 #include <string.h>
 #include <math.h>
 
@@ -18,7 +19,56 @@
 // Internal state
 static I2CSlaveState state;
 static uint8_t register_map[256];  // Full register space
-static const float *current_frame = NULL;  // Pointer to current frame data
+static FrameBuffer *volatile current_frame = NULL;  // Latest frame (holds a reference)
+static FrameBuffer *stream_frame = NULL;   // Frame being streamed to the master (IRQ only)
+
+// Status and temperatures (0x10-0x2D) as the master sees them. The main
+// loop fills register_map, then copies the block into the back page and
+// swaps; a read transaction latches the front page on its first byte, so
+// a burst never mixes two updates.
+#define STATUS_BLOCK_BYTES (REG_LATERAL_GRADIENT_H + 1 - REG_STATUS_START)
+static uint8_t status_pages[2][STATUS_BLOCK_BYTES];
+static volatile uint8_t status_front;
+static uint8_t status_latch[STATUS_BLOCK_BYTES];  // IRQ only
+
+// Consumer access statistics (REG_ACCESS_*). Counters are written by the
+// IRQ, apart from the publish counts, and saturate at 0xFFFF.
+typedef enum {
+    SOURCE_FRAME,               // i2c_slave_update
+    SOURCE_HISTOGRAMS,          // i2c_slave_update_histograms
+    SOURCE_SHADOW,              // i2c_slave_update_shadow
+    SOURCE_COUNT,
+    SOURCE_NONE = SOURCE_COUNT  // Written by the master, or static
+} DataSource;
+
+typedef struct {
+    uint16_t reads[I2C_ACCESS_BLOCKS];
+    uint16_t repeats[I2C_ACCESS_BLOCKS];
+    uint16_t lengths[I2C_ACCESS_LENGTH_BINS];
+    uint16_t latency[SOURCE_COUNT][I2C_ACCESS_LATENCY_BINS];
+    uint16_t published;         // Frames published
+    uint16_t missed;            // Frames replaced before any read of them
+    uint16_t writes;            // Transactions that only wrote
+    uint16_t max_length;
+    uint16_t max_latency_ms;    // Frame data
+} AccessStats;
+
+static const uint8_t block_source[I2C_ACCESS_BLOCKS] = {
+    [I2C_BLOCK_CONFIG] = SOURCE_NONE,
+    [I2C_BLOCK_STATUS] = SOURCE_FRAME,
+    [I2C_BLOCK_TEMPERATURE] = SOURCE_FRAME,
+    [I2C_BLOCK_RAW] = SOURCE_FRAME,
+    [I2C_BLOCK_FRAME] = SOURCE_FRAME,
+    [I2C_BLOCK_HISTOGRAM] = SOURCE_HISTOGRAMS,
+    [I2C_BLOCK_SHADOW] = SOURCE_SHADOW,
+    [I2C_BLOCK_SYSTEM] = SOURCE_NONE,
+};
+
+static AccessStats access;
+static volatile uint32_t publish_us[SOURCE_COUNT];
+static volatile uint32_t publish_seq[SOURCE_COUNT];  // 0 = never published
+static uint32_t block_read_seq[I2C_ACCESS_BLOCKS];   // publish_seq at the block's last read
+static volatile uint32_t frame_read_seq;             // publish_seq of the last frame read
 
 // Helper to convert float temp to int16 tenths
 static inline int16_t temp_to_int16_tenths(float temp) {
@@ -26,6 +76,153 @@ static inline int16_t temp_to_int16_tenths(float temp) {
     return (int16_t)(temp * 10.0f);
 }
 
+static inline void saturating_inc(uint16_t *counter) {
+    if (*counter < UINT16_MAX) (*counter)++;
+}
+
+// Bits needed for value, capped at bins - 1: 0, 1, 2-3, 4-7, ...
+static inline uint8_t log2_bin(uint32_t value, uint8_t bins) {
+    uint8_t bin = value ? (uint8_t)(32 - __builtin_clz(value)) : 0;
+    return bin < bins ? bin : bins - 1;
+}
+
+static uint8_t register_block(uint8_t reg) {
+    if (state.streaming) return I2C_BLOCK_FRAME;
+    if (reg < REG_STATUS_START) return I2C_BLOCK_CONFIG;
+    if (reg < REG_TEMP_DATA_START) return I2C_BLOCK_STATUS;
+    if (reg < REG_RAW_CH0_L) return I2C_BLOCK_TEMPERATURE;
+    if (reg < REG_HIST_FRAME_L) return I2C_BLOCK_RAW;
+    if (reg < REG_SHADOW_COMPARED_L) return I2C_BLOCK_HISTOGRAM;
+    if (reg < REG_RESET_REASON) return I2C_BLOCK_SHADOW;
+    return I2C_BLOCK_SYSTEM;
+}
+
+static inline bool in_status_block(uint8_t reg) {
+    return reg >= REG_STATUS_START && reg <= REG_LATERAL_GRADIENT_H;
+}
+
+// Make the status block written to register_map visible to the master
+// (main loop). The IRQ only copies from the front page, and preempts
+// this, so the back page is never being latched while it is written.
+static void publish_status_block(void) {
+    uint8_t back = status_front ^ 1;
+    memcpy(status_pages[back], &register_map[REG_STATUS_START], STATUS_BLOCK_BYTES);
+    status_front = back;
+}
+
+static void put_uint16(uint8_t reg, uint32_t value) {
+    if (value > 0xFFFF) value = 0xFFFF;
+    register_map[reg] = value & 0xFF;
+    register_map[reg + 1] = (value >> 8) & 0xFF;
+}
+
+// Copy the selected statistics page to REG_ACCESS_DATA
+static void fill_access_page(void) {
+    uint16_t summary[5] = {access.published, access.missed, access.writes, access.max_length,
+                           access.max_latency_ms};
+    const uint16_t *values = NULL;
+    uint8_t n = 0;
+
+    switch (register_map[REG_ACCESS_PAGE]) {
+        case I2C_ACCESS_PAGE_READS:
+            values = access.reads;
+            n = I2C_ACCESS_BLOCKS;
+            break;
+        case I2C_ACCESS_PAGE_REPEATS:
+            values = access.repeats;
+            n = I2C_ACCESS_BLOCKS;
+            break;
+        case I2C_ACCESS_PAGE_LENGTHS:
+            values = access.lengths;
+            n = I2C_ACCESS_LENGTH_BINS;
+            break;
+        case I2C_ACCESS_PAGE_LATENCY_FRAME:
+        case I2C_ACCESS_PAGE_LATENCY_HIST:
+        case I2C_ACCESS_PAGE_LATENCY_SHADOW:
+            values = access.latency[register_map[REG_ACCESS_PAGE] - I2C_ACCESS_PAGE_LATENCY_FRAME];
+            n = I2C_ACCESS_LATENCY_BINS;
+            break;
+        case I2C_ACCESS_PAGE_SUMMARY:
+            values = summary;
+            n = 5;
+            break;
+    }
+    for (uint8_t i = 0; i < I2C_ACCESS_PAGE_BYTES / 2; i++) {
+        put_uint16(REG_ACCESS_DATA + 2 * i, i < n ? values[i] : 0);
+    }
+}
+
+// First byte of a read transaction: count it against the block it starts
+// in, and time it against the last update of that block's data
+static void access_read_start(void) {
+    uint8_t block = register_block(state.current_register);
+    saturating_inc(&access.reads[block]);
+
+    if (state.current_register >= REG_ACCESS_PAGE && state.current_register < REG_CMD) {
+        fill_access_page();
+    }
+
+    uint8_t source = block_source[block];
+    if (source == SOURCE_NONE || publish_seq[source] == 0) return;
+
+    uint32_t seq = publish_seq[source];
+    if (block_read_seq[block] == seq) saturating_inc(&access.repeats[block]);
+    block_read_seq[block] = seq;
+
+    uint32_t latency_ms = (time_us_32() - publish_us[source]) / 1000;
+    saturating_inc(&access.latency[source][log2_bin(latency_ms, I2C_ACCESS_LATENCY_BINS)]);
+    if (source == SOURCE_FRAME) {
+        frame_read_seq = seq;
+        if (latency_ms > access.max_latency_ms) {
+            access.max_latency_ms = latency_ms > UINT16_MAX ? UINT16_MAX : (uint16_t)latency_ms;
+        }
+    }
+}
+
+// Stop condition: close off the transaction
+static void access_transaction_end(void) {
+    if (state.read_bytes > 0) {
+        saturating_inc(&access.lengths[log2_bin(state.read_bytes - 1u, I2C_ACCESS_LENGTH_BINS)]);
+        if (state.read_bytes > access.max_length) access.max_length = state.read_bytes;
+    } else if (state.wrote) {
+        saturating_inc(&access.writes);
+    }
+    state.read_bytes = 0;
+    state.wrote = false;
+}
+
+// Data of source was just updated (main loop)
+static void access_publish(DataSource source) {
+    if (source == SOURCE_FRAME) {
+        if (publish_seq[source] != 0 && frame_read_seq != publish_seq[source]) saturating_inc(&access.missed);
+        saturating_inc(&access.published);
+    }
+    publish_us[source] = time_us_32();
+    publish_seq[source] = publish_seq[source] + 1 ? publish_seq[source] + 1 : 1;
+}
+
+// Configuration registers and the statistics page select are writable;
+// false for any other register
+static bool write_config_register(uint8_t reg, uint8_t value) {
+    if (reg == REG_ACCESS_PAGE) {
+        register_map[reg] = value < I2C_ACCESS_PAGES ? value : 0;
+        return true;
+    }
+    if (reg < REG_CONFIG_START || reg > REG_DETECT_ENGINE) return false;
+
+    register_map[reg] = value;
+
+    // Handle special registers
+    if (reg == REG_I2C_ADDRESS) {
+        // I2C address change (requires restart)
+        state.slave_address = value & 0x7F;
+    } else if (reg == REG_OUTPUT_MODE) {
+        // Output mode change
+        state.output_mode = (OutputMode)value;
+    }
+    return true;
+}
+
 // I2C slave IRQ handler
 static void i2c_slave_handler(void) {
     uint32_t status = I2C_SLAVE_INST->hw->intr_stat;
@@ -34,25 +231,37 @@ static void i2c_slave_handler(void) {
         // Master is reading from us
         uint8_t value = 0;
 
-        if (state.current_register == REG_FRAME_DATA_START) {
-            // Streaming full frame data
-            if (current_frame && state.frame_read_offset < 768) {
+        if (state.read_bytes == 0) {
+            access_read_start();
+            memcpy(status_latch, status_pages[status_front], STATUS_BLOCK_BYTES);
+            state.status_latched = true;
+        }
+        if (state.read_bytes < UINT16_MAX) state.read_bytes++;
+
+        if (state.streaming) {
+            // Streaming full frame data (only when addressed directly, so
+            // a raw-channel burst from 0x30 runs through 0x40-0x4F)
+            if (stream_frame && state.frame_read_offset < 768) {
                 // Send as int16 tenths (2 bytes per pixel)
                 uint16_t idx = state.frame_read_offset / 2;
                 if (state.frame_read_offset % 2 == 0) {
                     // Low byte
-                    int16_t temp = temp_to_int16_tenths(current_frame[idx]);
+                    int16_t temp = temp_to_int16_tenths(stream_frame->pixels[idx]);
                     value = temp & 0xFF;
                 } else {
                     // High byte
-                    int16_t temp = temp_to_int16_tenths(current_frame[idx]);
+                    int16_t temp = temp_to_int16_tenths(stream_frame->pixels[idx]);
                     value = (temp >> 8) & 0xFF;
                 }
                 state.frame_read_offset++;
             }
         } else {
             // Regular register read
-            value = register_map[state.current_register];
+            if (state.status_latched && in_status_block(state.current_register)) {
+                value = status_latch[state.current_register - REG_STATUS_START];
+            } else {
+                value = register_map[state.current_register];
+            }
             state.current_register++;  // Auto-increment
         }
 
@@ -63,36 +272,35 @@ static void i2c_slave_handler(void) {
     if (status & I2C_IC_INTR_STAT_R_RX_FULL_BITS) {
         // Master is writing to us
         uint8_t value = (uint8_t)I2C_SLAVE_INST->hw->data_cmd;
+        state.wrote = true;
 
-        if (state.current_register == 0xFF) {
+        if (!state.pointer_set) {
             // First byte is register address
             state.current_register = value;
+            state.pointer_set = true;
+            state.streaming = (value == REG_FRAME_DATA_START);
 
-            // Reset frame read offset when accessing frame data
+            // Reset frame read offset when accessing frame data, and pin
+            // the current frame so a new one can't replace it mid-read
             if (value == REG_FRAME_DATA_START) {
                 state.frame_read_offset = 0;
+                frame_buffer_release(stream_frame);
+                stream_frame = current_frame;
+                frame_buffer_retain(stream_frame);
             }
         } else {
-            // Subsequent bytes are data writes
-            if (state.current_register >= REG_CONFIG_START &&
-                state.current_register <= REG_RESERVED_0F) {
-                // Configuration registers are writable
-                register_map[state.current_register] = value;
-
-                // Handle special registers
-                if (state.current_register == REG_I2C_ADDRESS) {
-                    // I2C address change (requires restart)
-                    state.slave_address = value & 0x7F;
-                } else if (state.current_register == REG_OUTPUT_MODE) {
-                    // Output mode change
-                    state.output_mode = (OutputMode)value;
-                }
-            } else if (state.current_register == REG_CMD) {
+            // Subsequent bytes are data writes: configuration registers
+            // are writable, the rest are read-only apart from REG_CMD
+            if (!write_config_register(state.current_register, value) &&
+                state.current_register == REG_CMD) {
                 // Command register
                 if (value == CMD_RESET) {
                     // Software reset (would need to implement)
                 } else if (value == CMD_CLEAR_WARNINGS) {
                     register_map[REG_WARNINGS] = 0;
+                    status_pages[status_front][REG_WARNINGS - REG_STATUS_START] = 0;
+                } else if (value == CMD_CLEAR_ACCESS_STATS) {
+                    memset(&access, 0, sizeof(access));
                 }
             }
 
@@ -102,7 +310,13 @@ static void i2c_slave_handler(void) {
 
     if (status & I2C_IC_INTR_STAT_R_STOP_DET_BITS) {
         // Stop condition - reset register pointer
+        access_transaction_end();
         state.current_register = 0xFF;
+        state.pointer_set = false;
+        state.streaming = false;
+        state.status_latched = false;
+        frame_buffer_release(stream_frame);
+        stream_frame = NULL;
         I2C_SLAVE_INST->hw->clr_stop_det;
     }
 }
@@ -126,6 +340,28 @@ void i2c_slave_init(uint8_t address) {
     register_map[REG_FALLBACK_MODE] = 0;  // Default: return 0 when no tyre detected
     register_map[REG_EMISSIVITY] = 95;    // Default: 0.95 emissivity
     register_map[REG_RAW_MODE] = 0;       // Default: tyre algorithm enabled
+    register_map[REG_FRAME_RATE] = 0;     // Default: adaptive refresh rate
+    register_map[REG_ZONE_CONVERSION] = 0;  // Default: convert the full frame
+    register_map[REG_IMAGE_BITRATE] = 0;    // Default: no serial images
+    register_map[REG_HIST_BINS] = 0;        // Default: no histograms
+    register_map[REG_HIST_MIN] = 20;        // 20°C ...
+    register_map[REG_HIST_BIN_WIDTH] = 50;  // ... in 5.0°C bins
+    register_map[REG_SHADOW_MODE] = 0;      // Default: no shadow evaluation
+    register_map[REG_SHADOW_MAD] = 30;      // Candidate starts as the production
+    register_map[REG_SHADOW_MIN_WIDTH] = 6; // defaults
+    register_map[REG_SHADOW_MAX_WIDTH] = 28;
+    register_map[REG_DETECT_ENGINE] = DETECT_ENGINE_REGION;
+    register_map[REG_ACCESS_PAGE] = I2C_ACCESS_PAGE_READS;
+    register_map[REG_ACCESS_PAGE_COUNT] = I2C_ACCESS_PAGES;
+    status_front = 0;
+    publish_status_block();
+
+    memset(&access, 0, sizeof(access));
+    memset(block_read_seq, 0, sizeof(block_read_seq));
+    for (int i = 0; i < SOURCE_COUNT; i++) {
+        publish_seq[i] = 0;
+    }
+    frame_read_seq = 0;
 
     // Initialize I2C1 pins
     gpio_set_function(I2C_SLAVE_SDA_PIN, GPIO_FUNC_I2C);
@@ -148,11 +384,15 @@ void i2c_slave_init(uint8_t address) {
     irq_set_enabled(I2C1_IRQ, true);
 }
 
-void i2c_slave_update(const FrameData *data, float fps, const float *frame) {
+void i2c_slave_update(const FrameData *data, float fps, FrameBuffer *frame) {
     if (!state.enabled) return;
 
-    // Store frame pointer for full frame access
+    // Keep a reference to the frame for full frame access. The IRQ runs on
+    // this core and retains before it reads, so a plain swap is safe.
+    frame_buffer_retain(frame);
+    FrameBuffer *previous = current_frame;
     current_frame = frame;
+    frame_buffer_release(previous);
 
     // Update status registers
     register_map[REG_FRAME_NUMBER_L] = data->frame_number & 0xFF;
@@ -211,7 +451,7 @@ void i2c_slave_update(const FrameData *data, float fps, const float *frame) {
             // Average 2 columns × 4 middle rows (rows 10-13)
             for (int row = 10; row < 14; row++) {
                 for (int col = col_start; col < col_start + 2; col++) {
-                    sum += frame[row * 32 + col];
+                    sum += frame->pixels[row * 32 + col];
                 }
             }
 
@@ -224,6 +464,9 @@ void i2c_slave_update(const FrameData *data, float fps, const float *frame) {
             register_map[reg_base + 1] = (temp >> 8) & 0xFF;
         }
     }
+
+    publish_status_block();
+    access_publish(SOURCE_FRAME);
 }
 
 OutputMode i2c_slave_get_output_mode(void) {
@@ -240,6 +483,20 @@ bool i2c_slave_output_enabled(OutputMode mode) {
     return (state.output_mode == mode);
 }
 
+bool i2c_slave_write_config(uint8_t reg, uint8_t value) {
+    return write_config_register(reg, value);
+}
+
+void i2c_slave_read_registers(uint8_t first, uint8_t count, uint8_t *out) {
+    // Serial reads of the statistics page see it current too
+    if (first + count > REG_ACCESS_DATA && first < REG_ACCESS_DATA + I2C_ACCESS_PAGE_BYTES) {
+        fill_access_page();
+    }
+    for (uint8_t i = 0; i < count; i++) {
+        out[i] = register_map[(uint8_t)(first + i)];
+    }
+}
+
 float i2c_slave_get_emissivity(void) {
     // Convert uint8 (0-100) to float (0.0-1.0)
     uint8_t emiss = register_map[REG_EMISSIVITY];
@@ -250,3 +507,125 @@ float i2c_slave_get_emissivity(void) {
 bool i2c_slave_get_raw_mode(void) {
     return (register_map[REG_RAW_MODE] != 0);
 }
+
+bool i2c_slave_get_zone_conversion(void) {
+    return (register_map[REG_ZONE_CONVERSION] != 0);
+}
+
+uint32_t i2c_slave_get_image_bitrate(void) {
+    return register_map[REG_IMAGE_BITRATE] * 100u;
+}
+
+void i2c_slave_get_histogram_config(ZoneHistogramConfig *config) {
+    uint8_t bins = register_map[REG_HIST_BINS];
+    config->bins = bins > ZONE_HIST_MAX_BINS ? ZONE_HIST_MAX_BINS : bins;
+    config->min_tenths = (int16_t)((int8_t)register_map[REG_HIST_MIN] * 10);
+    config->bin_width_tenths = register_map[REG_HIST_BIN_WIDTH];
+    if (config->bin_width_tenths == 0) config->bins = 0;
+}
+
+void i2c_slave_update_histograms(const ZoneHistograms *hist) {
+    if (!state.enabled) return;
+
+    register_map[REG_HIST_FRAME_L] = hist->frame_number & 0xFF;
+    register_map[REG_HIST_FRAME_H] = (hist->frame_number >> 8) & 0xFF;
+
+    for (int z = 0; z < ZONE_HIST_ZONES; z++) {
+        uint8_t *reg = &register_map[REG_HIST_COUNTS_START + z * ZONE_HIST_MAX_BINS * 2];
+        for (int b = 0; b < ZONE_HIST_MAX_BINS; b++) {
+            uint16_t count = (b < hist->config.bins) ? hist->counts[z][b] : 0;
+            reg[b * 2] = count & 0xFF;
+            reg[b * 2 + 1] = (count >> 8) & 0xFF;
+        }
+    }
+
+    access_publish(SOURCE_HISTOGRAMS);
+}
+
+void i2c_slave_clear_histograms(void) {
+    if (!state.enabled) return;
+
+    memset(&register_map[REG_HIST_FRAME_L], 0,
+           REG_HIST_COUNTS_START - REG_HIST_FRAME_L + ZONE_HIST_ZONES * ZONE_HIST_MAX_BINS * 2);
+}
+
+bool i2c_slave_get_shadow_config(ThermalConfig *candidate) {
+    thermal_algorithm_init(candidate);
+    candidate->mad_threshold = register_map[REG_SHADOW_MAD] / 10.0f;
+    candidate->min_tyre_width = register_map[REG_SHADOW_MIN_WIDTH];
+    candidate->max_tyre_width = register_map[REG_SHADOW_MAX_WIDTH];
+    candidate->engine = (register_map[REG_SHADOW_MODE] == 2) ? DETECT_ENGINE_CLASSIFIER : DETECT_ENGINE_REGION;
+    return register_map[REG_SHADOW_MODE] != 0;
+}
+
+uint8_t i2c_slave_get_detect_engine(void) {
+    return (register_map[REG_DETECT_ENGINE] == DETECT_ENGINE_CLASSIFIER) ? DETECT_ENGINE_CLASSIFIER
+                                                                         : DETECT_ENGINE_REGION;
+}
+
+static uint8_t to_percent(float fraction) {
+    if (!(fraction > 0.0f)) return 0;
+    return fraction >= 1.0f ? 100 : (uint8_t)(fraction * 100.0f + 0.5f);
+}
+
+static uint32_t to_uint_tenths(float value) {
+    if (!(value > 0.0f)) return 0;
+    return value >= 6553.5f ? 0xFFFF : (uint32_t)(value * 10.0f + 0.5f);
+}
+
+void i2c_slave_update_shadow(const ShadowStats *stats) {
+    if (!state.enabled) return;
+
+    put_uint16(REG_SHADOW_COMPARED_L, stats->compared);
+    put_uint16(REG_SHADOW_DROPPED_L, stats->dropped);
+    register_map[REG_SHADOW_AGREEMENT] = to_percent(stats->detection_agreement);
+    register_map[REG_SHADOW_IOU] = to_percent(stats->mean_iou);
+    put_uint16(REG_SHADOW_PROD_ONLY_L, stats->production_only);
+    put_uint16(REG_SHADOW_CAND_ONLY_L, stats->candidate_only);
+    put_uint16(REG_SHADOW_DELTA_L_L, to_uint_tenths(stats->zone_delta_mean[0]));
+    put_uint16(REG_SHADOW_DELTA_C_L, to_uint_tenths(stats->zone_delta_mean[1]));
+    put_uint16(REG_SHADOW_DELTA_R_L, to_uint_tenths(stats->zone_delta_mean[2]));
+    put_uint16(REG_SHADOW_DELTA_MAX_L, to_uint_tenths(stats->zone_delta_max));
+    register_map[REG_SHADOW_PROD_CONF] = to_percent(stats->production_confidence);
+    register_map[REG_SHADOW_CAND_CONF] = to_percent(stats->candidate_confidence);
+    put_uint16(REG_SHADOW_CORE1_US_L, stats->max_us);
+
+    access_publish(SOURCE_SHADOW);
+}
+
+void i2c_slave_get_config(uint8_t *regs) {
+    memcpy(regs, &register_map[REG_CONFIG_START], I2C_SLAVE_CONFIG_REGS);
+}
+
+void i2c_slave_restore_config(const uint8_t *regs) {
+    memcpy(&register_map[REG_CONFIG_START], regs, I2C_SLAVE_CONFIG_REGS);
+    state.slave_address = register_map[REG_I2C_ADDRESS] & 0x7F;
+    state.output_mode = (OutputMode)register_map[REG_OUTPUT_MODE];
+}
+
+void i2c_slave_set_reset_status(uint8_t reason, uint16_t watchdog_resets) {
+    register_map[REG_RESET_REASON] = reason;
+    register_map[REG_WATCHDOG_RESETS_L] = watchdog_resets & 0xFF;
+    register_map[REG_WATCHDOG_RESETS_H] = (watchdog_resets >> 8) & 0xFF;
+}
+
+uint8_t i2c_slave_get_frame_rate(void) {
+    return register_map[REG_FRAME_RATE];
+}
+
+void i2c_slave_set_rate_status(uint8_t rate, uint8_t mode) {
+    register_map[REG_REFRESH_RATE] = rate;
+    register_map[REG_RATE_MODE] = mode;
+    publish_status_block();
+}
+
+void i2c_slave_set_environment(float ta, float vdd) {
+    int16_t ta_tenths = temp_to_int16_tenths(ta);
+    uint16_t vdd_mv = isfinite(vdd) && vdd > 0.0f ? (uint16_t)(vdd * 1000.0f) : 0;
+
+    register_map[REG_SENSOR_TA_L] = ta_tenths & 0xFF;
+    register_map[REG_SENSOR_TA_H] = (ta_tenths >> 8) & 0xFF;
+    register_map[REG_SENSOR_VDD_L] = vdd_mv & 0xFF;
+    register_map[REG_SENSOR_VDD_H] = (vdd_mv >> 8) & 0xFF;
+    publish_status_block();
+}
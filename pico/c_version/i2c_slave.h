@@ -12,6 +12,9 @@
 #include <stdint.h>
 #include <stdbool.h>
 #include "thermal_algorithm.h"
+#include "frame_pool.h"
+#include "zone_histogram.h"
+#include "shadow_eval.h"
 
 // Default I2C slave address
 #define I2C_SLAVE_DEFAULT_ADDR 0x08
@@ -21,6 +24,7 @@ typedef enum {
     OUTPUT_MODE_USB_SERIAL = 0x00,  // USB serial (default)
     OUTPUT_MODE_I2C_SLAVE = 0x01,   // I2C slave/peripheral
     OUTPUT_MODE_CANBUS = 0x02,      // CAN bus (future)
+    OUTPUT_MODE_USB_BINARY = 0x03,  // USB serial, multiplexed binary channels (mux_protocol.h)
     OUTPUT_MODE_ALL = 0xFF          // All outputs enabled
 } OutputMode;
 
@@ -31,20 +35,20 @@ typedef enum {
 #define REG_CONFIG_START        0x00
 #define REG_I2C_ADDRESS         0x00  // I2C slave address (7-bit)
 #define REG_OUTPUT_MODE         0x01  // Output mode select
-#define REG_FRAME_RATE          0x02  // Target frame rate (future)
+#define REG_FRAME_RATE          0x02  // Sensor refresh rate in Hz, 0=adaptive (default)
 #define REG_FALLBACK_MODE       0x03  // Fallback mode: 0=zero temps when no tyre, 1=copy centre temp
 #define REG_EMISSIVITY          0x04  // Emissivity × 100 (e.g., 95 = 0.95), default 95
 #define REG_RAW_MODE            0x05  // Raw mode: 0=tyre algorithm, 1=16-channel raw data
-#define REG_RESERVED_06         0x06
-#define REG_RESERVED_07         0x07
-#define REG_RESERVED_08         0x08
-#define REG_RESERVED_09         0x09
-#define REG_RESERVED_0A         0x0A
-#define REG_RESERVED_0B         0x0B
-#define REG_RESERVED_0C         0x0C
-#define REG_RESERVED_0D         0x0D
-#define REG_RESERVED_0E         0x0E
-#define REG_RESERVED_0F         0x0F
+#define REG_ZONE_CONVERSION     0x06  // 1=convert only zone pixels to temperature, 0=full frame (default)
+#define REG_IMAGE_BITRATE       0x07  // Serial image link budget in 100 bit/s, 0=off (default)
+#define REG_HIST_BINS           0x08  // Histogram bins per zone (max 16), 0=off (default)
+#define REG_HIST_MIN            0x09  // Histogram lower edge, int8 °C, default 20
+#define REG_HIST_BIN_WIDTH      0x0A  // Histogram bin width in tenths °C, default 50 (5.0°C)
+#define REG_SHADOW_MODE         0x0B  // 1=evaluate the candidate config on core 1, 2=same with the classifier engine, 0=off (default)
+#define REG_SHADOW_MAD          0x0C  // Candidate mad_threshold in tenths, default 30 (3.0)
+#define REG_SHADOW_MIN_WIDTH    0x0D  // Candidate min_tyre_width in pixels, default 6
+#define REG_SHADOW_MAX_WIDTH    0x0E  // Candidate max_tyre_width in pixels, default 28
+#define REG_DETECT_ENGINE       0x0F  // Span detection: 0=region growing (default), 1=column classifier
 
 // STATUS REGISTERS (0x10-0x1F) - Read Only
 #define REG_STATUS_START        0x10
@@ -58,12 +62,12 @@ typedef enum {
 #define REG_SPAN_START          0x17  // Tyre span start pixel
 #define REG_SPAN_END            0x18  // Tyre span end pixel
 #define REG_WARNINGS            0x19  // Warning flags
-#define REG_RESERVED_1A         0x1A
-#define REG_RESERVED_1B         0x1B
-#define REG_RESERVED_1C         0x1C
-#define REG_RESERVED_1D         0x1D
-#define REG_RESERVED_1E         0x1E
-#define REG_RESERVED_1F         0x1F
+#define REG_REFRESH_RATE        0x1A  // Current MLX90640 refresh rate code (0x05 = 16Hz)
+#define REG_RATE_MODE           0x1B  // Rate controller mode (RateMode)
+#define REG_SENSOR_TA_L         0x1C  // Sensor ambient temp (int16, tenths °C, low byte)
+#define REG_SENSOR_TA_H         0x1D  // Sensor ambient temp (high byte)
+#define REG_SENSOR_VDD_L        0x1E  // Sensor supply (uint16, mV, low byte)
+#define REG_SENSOR_VDD_H        0x1F  // Sensor supply (high byte)
 
 // TEMPERATURE DATA REGISTERS (0x20-0x3F) - Read Only
 #define REG_TEMP_DATA_START     0x20
@@ -89,14 +93,96 @@ typedef enum {
 // Channels 1-15 follow sequentially at 0x32-0x4F
 // Access via: 0x30 + (channel * 2) for low byte
 
-// FULL FRAME ACCESS (0x50+) - Read Only
+// FULL FRAME ACCESS - Read Only
 #define REG_FRAME_ACCESS        0x40  // Read pointer for full frame data
 #define REG_FRAME_DATA_START    0x41  // Start of streaming frame data
 
+// ZONE HISTOGRAMS (0x50-0xB1) - Read Only, active when REG_HIST_BINS > 0
+// Frame number, then 3 zones × 16 bins × uint16 counts (little-endian).
+// Zones are 32 bytes apart whatever the bin count; unused bins read 0.
+#define REG_HIST_FRAME_L        0x50  // Frame counter of the histograms (low byte)
+#define REG_HIST_FRAME_H        0x51  // Frame counter (high byte)
+#define REG_HIST_COUNTS_START   0x52  // Zone z, bin b at 0x52 + z * 32 + b * 2
+
+// SHADOW EVALUATION (0xC0-0xD5) - Read Only, active when REG_SHADOW_MODE is set
+// Agreement of the candidate config with production since it was last
+// changed or shadow mode was switched on (shadow_eval.h)
+#define REG_SHADOW_COMPARED_L   0xC0  // Span detections compared (uint16, low byte)
+#define REG_SHADOW_COMPARED_H   0xC1
+#define REG_SHADOW_DROPPED_L    0xC2  // Skipped while core 1 was busy (uint16)
+#define REG_SHADOW_DROPPED_H    0xC3
+#define REG_SHADOW_AGREEMENT    0xC4  // Both detected or both not (0-100%)
+#define REG_SHADOW_IOU          0xC5  // Mean span IoU (0-100%)
+#define REG_SHADOW_PROD_ONLY_L  0xC6  // Detected by production only (uint16)
+#define REG_SHADOW_PROD_ONLY_H  0xC7
+#define REG_SHADOW_CAND_ONLY_L  0xC8  // Detected by candidate only (uint16)
+#define REG_SHADOW_CAND_ONLY_H  0xC9
+#define REG_SHADOW_DELTA_L_L    0xCA  // Mean |zone median delta| left, uint16 tenths °C
+#define REG_SHADOW_DELTA_L_H    0xCB
+#define REG_SHADOW_DELTA_C_L    0xCC  // Centre
+#define REG_SHADOW_DELTA_C_H    0xCD
+#define REG_SHADOW_DELTA_R_L    0xCE  // Right
+#define REG_SHADOW_DELTA_R_H    0xCF
+#define REG_SHADOW_DELTA_MAX_L  0xD0  // Largest zone median delta, uint16 tenths °C
+#define REG_SHADOW_DELTA_MAX_H  0xD1
+#define REG_SHADOW_PROD_CONF    0xD2  // Mean production confidence (0-100%)
+#define REG_SHADOW_CAND_CONF    0xD3  // Mean candidate confidence (0-100%)
+#define REG_SHADOW_CORE1_US_L   0xD4  // Longest core 1 evaluation, uint16 µs
+#define REG_SHADOW_CORE1_US_H   0xD5
+
+// SYSTEM (0xD8-0xDA) - Read Only
+#define REG_RESET_REASON        0xD8  // Last reset (ResetReason in retained_state.h)
+#define REG_WATCHDOG_RESETS_L   0xD9  // Watchdog resets since power-on (uint16, low byte)
+#define REG_WATCHDOG_RESETS_H   0xDA
+
+// CONSUMER ACCESS STATISTICS (0xE0-0xF9) - Read Only apart from REG_ACCESS_PAGE
+// How masters read the slave, since startup or CMD_CLEAR_ACCESS_STATS.
+// Select a page, then read its 24 bytes (uint16 little-endian, saturating)
+// in a new transaction; each read starting in this block copies the page.
+#define REG_ACCESS_PAGE         0xE0  // Page shown at REG_ACCESS_DATA (R/W, I2CAccessPage)
+#define REG_ACCESS_PAGE_COUNT   0xE1  // Number of pages
+#define REG_ACCESS_DATA         0xE2  // Page data, 0xE2-0xF9
+#define I2C_ACCESS_PAGE_BYTES   24
+
+// Register blocks, by the register a read transaction starts at
+typedef enum {
+    I2C_BLOCK_CONFIG = 0,           // 0x00-0x0F
+    I2C_BLOCK_STATUS = 1,           // 0x10-0x1F
+    I2C_BLOCK_TEMPERATURE = 2,      // 0x20-0x2F
+    I2C_BLOCK_RAW = 3,              // 0x30-0x4F, apart from 0x41
+    I2C_BLOCK_FRAME = 4,            // Full frame stream (0x41)
+    I2C_BLOCK_HISTOGRAM = 5,        // 0x50-0xBF
+    I2C_BLOCK_SHADOW = 6,           // 0xC0-0xD7
+    I2C_BLOCK_SYSTEM = 7,           // 0xD8-0xFF, including these statistics
+    I2C_ACCESS_BLOCKS = 8
+} I2CRegisterBlock;
+
+// Publish-to-read latency: ms between an update of the block's data and
+// the first byte of a read. Bin 0 is under 1ms, bin b covers
+// 2^(b-1) to 2^b ms, bin 11 is 1024ms and over.
+#define I2C_ACCESS_LATENCY_BINS 12
+
+// Read transaction lengths: 1, 2, 3-4, 5-8, ... 33-64, 65+ bytes
+#define I2C_ACCESS_LENGTH_BINS 8
+
+typedef enum {
+    I2C_ACCESS_PAGE_READS = 0,          // Read transactions per I2CRegisterBlock
+    I2C_ACCESS_PAGE_REPEATS = 1,        // Reads of data already read since its last update
+    I2C_ACCESS_PAGE_LENGTHS = 2,        // Read transaction length bins
+    I2C_ACCESS_PAGE_LATENCY_FRAME = 3,  // Latency bins, status/temperature/raw/frame reads
+    I2C_ACCESS_PAGE_LATENCY_HIST = 4,   // Latency bins, histogram reads
+    I2C_ACCESS_PAGE_LATENCY_SHADOW = 5, // Latency bins, shadow statistics reads
+    I2C_ACCESS_PAGE_SUMMARY = 6,        // Frames published, frames never read, write
+                                        // transactions, longest read (bytes), longest
+                                        // frame latency (ms)
+    I2C_ACCESS_PAGES = 7
+} I2CAccessPage;
+
 // Special commands
 #define REG_CMD                 0xFF  // Command register
 #define CMD_RESET               0x01  // Software reset
 #define CMD_CLEAR_WARNINGS      0x02  // Clear warning flags
+#define CMD_CLEAR_ACCESS_STATS  0x03  // Restart the consumer access statistics
 #define CMD_FRAME_REQUEST       0x10  // Request new frame capture
 
 // I2C slave state
@@ -104,15 +190,21 @@ typedef struct {
     uint8_t slave_address;      // Current I2C slave address
     OutputMode output_mode;     // Current output mode
     uint8_t current_register;   // Current register pointer
+    bool pointer_set;           // Register address received in this transaction
     uint16_t frame_read_offset; // Offset for full frame reads
+    bool streaming;             // Pointer was set to REG_FRAME_DATA_START
+    bool wrote;                 // Bytes written in the current transaction
+    uint16_t read_bytes;        // Bytes read in the current transaction
+    bool status_latched;        // Status and temperatures latched for this read
     bool enabled;               // I2C slave enabled
 } I2CSlaveState;
 
 // Initialize I2C slave mode
 void i2c_slave_init(uint8_t address);
 
-// Update I2C slave registers with latest frame data
-void i2c_slave_update(const FrameData *data, float fps, const float *frame);
+// Update I2C slave registers with latest frame data. The slave keeps its
+// own reference to frame for the full frame window until the next update.
+void i2c_slave_update(const FrameData *data, float fps, FrameBuffer *frame);
 
 // Get current output mode
 OutputMode i2c_slave_get_output_mode(void);
@@ -123,10 +215,60 @@ void i2c_slave_set_output_mode(OutputMode mode);
 // Check if output mode is enabled
 bool i2c_slave_output_enabled(OutputMode mode);
 
+// Write a configuration register (REG_CONFIG_START..REG_DETECT_ENGINE, or
+// REG_ACCESS_PAGE) as an I2C master would; false for any other register
+bool i2c_slave_write_config(uint8_t reg, uint8_t value);
+
+// Copy count registers starting at first (wrapping at 0xFF)
+void i2c_slave_read_registers(uint8_t first, uint8_t count, uint8_t *out);
+
 // Get emissivity value (as float 0.0-1.0)
 float i2c_slave_get_emissivity(void);
 
 // Get raw mode setting
 bool i2c_slave_get_raw_mode(void);
 
+// Get zone-only temperature conversion setting
+bool i2c_slave_get_zone_conversion(void);
+
+// Get serial image link budget in bits/s (0 = images off)
+uint32_t i2c_slave_get_image_bitrate(void);
+
+// Get histogram configuration (bins = 0 when histograms are off)
+void i2c_slave_get_histogram_config(ZoneHistogramConfig *config);
+
+// Update the histogram registers
+void i2c_slave_update_histograms(const ZoneHistograms *hist);
+
+// Zero the histogram registers (frame number and counts)
+void i2c_slave_clear_histograms(void);
+
+// Get the candidate config for shadow evaluation; false when it's off
+bool i2c_slave_get_shadow_config(ThermalConfig *candidate);
+
+// Get the span detection engine (DETECT_ENGINE_*)
+uint8_t i2c_slave_get_detect_engine(void);
+
+// Update the shadow evaluation registers
+void i2c_slave_update_shadow(const ShadowStats *stats);
+
+// Copy the configuration registers (REG_CONFIG_START..0x0F) out, or back
+// in after i2c_slave_init() to carry them across a watchdog reset
+#define I2C_SLAVE_CONFIG_REGS 16
+void i2c_slave_get_config(uint8_t *regs);
+void i2c_slave_restore_config(const uint8_t *regs);
+
+// Report why the firmware last started and how many watchdog resets
+// there have been since power-on
+void i2c_slave_set_reset_status(uint8_t reason, uint16_t watchdog_resets);
+
+// Get requested sensor refresh rate in Hz (0 = adaptive)
+uint8_t i2c_slave_get_frame_rate(void);
+
+// Report the current sensor refresh rate code and rate controller mode
+void i2c_slave_set_rate_status(uint8_t rate, uint8_t mode);
+
+// Report the sensor's (smoothed) ambient temperature and supply voltage
+void i2c_slave_set_environment(float ta, float vdd);
+
 #endif // I2C_SLAVE_H
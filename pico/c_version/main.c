@@ -10,6 +10,8 @@
 #include "pico/stdlib.h"
 #include "pico/time.h"
 #include "hardware/i2c.h"
+#include "hardware/watchdog.h"
+#include "hardware/structs/systick.h"
 
 // MLX90640 library (use official Melexis library)
 // Note: You'll need to download MLX90640_API.c and MLX90640_API.h from:
@@ -20,10 +22,39 @@
 #include "thermal_algorithm.h"
 #include "communication.h"
 #include "i2c_slave.h"
+#include "rate_controller.h"
+#include "frame_pool.h"
+#include "pipeline.h"
+#include "pixel_health.h"
+#include "frame_codec.h"
+#include "zone_histogram.h"
+#include "shadow_eval.h"
+#include "retained_state.h"
+#include "serial_mux.h"
+#include "diagnostics.h"
 
 #define MLX90640_ADDR 0x33
+#define MLX90640_DEVICE_ID_ADDR 0x2407  // 3 EEPROM words, the calibration cache key
 #define COMPACT_OUTPUT 1  // 1 for CSV, 0 for JSON
 
+// Stage rates. Span detection is the expensive part of the algorithm and
+// the tyre doesn't move across the sensor quickly, so it runs at about
+// SPAN_DETECT_HZ whatever the sensor rate; zone statistics use the latest
+// span on every subpage. Serial output every Nth frame.
+#define SPAN_DETECT_HZ 2
+#define SERIAL_OUTPUT_DIVIDER 1
+
+// Zone conversion (REG_ZONE_CONVERSION): columns converted either side of
+// the last detected span, so a tyre drifting across the sensor between
+// span detections is still covered by fresh temperatures
+#define ZONE_MARGIN 2
+
+#define REFLECTED_TEMP 23.15f
+
+// Serial images (REG_IMAGE_BITRATE): upper bound on images per second, the
+// link budget decides the actual rate and quality below it
+#define IMAGE_MAX_FPS 4
+
 // LED pin for status indication
 #define LED_PIN PICO_DEFAULT_LED_PIN
 
@@ -34,19 +65,369 @@ static uint32_t total_frames = 0;
 // MLX90640 parameters
 static paramsMLX90640 mlx_params;
 static uint16_t mlx_frame_raw[834];  // Raw frame data from sensor
-static float mlx_frame[768];  // Calculated temperatures
+static FrameBuffer *frame = NULL;  // Latest calculated temperatures (pipeline's reference)
 static uint16_t eeData[832];  // EEPROM data - moved to static to avoid stack overflow
+static envMLX90640 mlx_env;   // Ta, Vdd, gain and CP, updated once per subpage
+static float ir_signal[SENSOR_PIXELS];  // Normalised IR signal, profile rows only
+
+// Weight of each new subpage in the environment terms. Ta and Vdd drift
+// over seconds, so light smoothing removes their per-subpage ADC noise,
+// which would otherwise shift every pixel in the frame together.
+#define ENV_SMOOTHING 0.25f
+
+// Adaptive sensor refresh rate
+static RateController rate_ctrl;
+
+// Serial image link budget and encoded packet
+static FrameCodecRate image_rate;
+static uint8_t image_packet[FRAME_CODEC_MAX_BYTES];
+
+// Per-subpage state shared by the pipeline stages
+typedef struct {
+    FrameBuffer *frame;
+    FrameData result;
+    ThermalConfig config;
+    float profile[SENSOR_WIDTH];         // Middle-row profile (detection + zones)
+    const float *span_profile;           // Profile the last span detection ran on
+    float temp_profile[SENSOR_WIDTH];    // All-row column average (JSON output)
+    ZoneHistograms histograms;           // config.bins = 0 when off
+    bool histograms_published;           // Histogram registers hold counts
+    float fps;
+    float emissivity;
+    bool raw_mode;
+    bool zone_conversion;                // Only zone pixels were converted
+    uint64_t t_start;
+    uint64_t t_sensor;
+} PipelineContext;
+
+static PipelineContext ctx;
+
+// Span detection cost in CPU cycles (SysTick), for comparing the engines
+// on target. Min/max restart with each print.
+typedef struct {
+    uint32_t last;
+    uint32_t min;
+    uint32_t max;
+} DetectCycles;
+
+static DetectCycles detect_cycles = {0, UINT32_MAX, 0};
+
+static void detect_cycles_init(void) {
+    // 24-bit down-counter on the processor clock, free running
+    systick_hw->rvr = 0x00FFFFFF;
+    systick_hw->cvr = 0;
+    systick_hw->csr = 0x5;  // ENABLE | CLKSOURCE
+}
+
+static void detect_span(PipelineContext *c, const float *profile) {
+    c->config.engine = i2c_slave_get_detect_engine();
+
+    uint32_t start = systick_hw->cvr;
+    thermal_algorithm_detect(profile, &c->result.detection, &c->config);
+    uint32_t cycles = (start - systick_hw->cvr) & 0x00FFFFFF;
+
+    detect_cycles.last = cycles;
+    if (cycles < detect_cycles.min) detect_cycles.min = cycles;
+    if (cycles > detect_cycles.max) detect_cycles.max = cycles;
+}
+
+//------------------------------------------------------------------------------
+// Pipeline stages
+
+enum {
+    STAGE_PROFILE,
+    STAGE_SPAN,
+    STAGE_ZONES,
+    STAGE_SHADOW,
+    STAGE_RATE,
+    STAGE_COLUMNS,
+    STAGE_I2C,
+    STAGE_SERIAL,
+    STAGE_IMAGE,
+    STAGE_COUNT
+};
+
+static void stage_profile(void *arg) {
+    PipelineContext *c = arg;
+    if (c->raw_mode) return;
+    thermal_algorithm_profile(c->frame->pixels, c->profile);
+}
+
+static void stage_span(void *arg) {
+    PipelineContext *c = arg;
+    if (c->raw_mode) return;
+
+    if (!c->zone_conversion) {
+        c->span_profile = c->profile;
+        detect_span(c, c->profile);
+        return;
+    }
+
+    // Average the IR signal down the profile rows and convert just the 32
+    // column values. The signal maps to temperature by the same function
+    // for every pixel, but through a fourth root, so a column whose rows
+    // differ converts slightly above its temperature average: this
+    // approximates the temperature profile (host/bench_zone_signal
+    // measures the span agreement). EEPROM-broken and flagged pixels are
+    // left out, as BadPixelsCorrection replaces them in the temperatures.
+    static float signal_profile[SENSOR_WIDTH];
+    thermal_algorithm_profile_skip(ir_signal, pixel_health_bad_pixels(), signal_profile);
+    for (int col = 0; col < SENSOR_WIDTH; col++) {
+        signal_profile[col] = MLX90640_SignalToTemperature(signal_profile[col], &mlx_params, &mlx_env,
+                                                           c->emissivity, REFLECTED_TEMP);
+    }
+    c->span_profile = signal_profile;
+    detect_span(c, signal_profile);
+}
+
+static void stage_zones(void *arg) {
+    PipelineContext *c = arg;
+
+    if (!c->raw_mode) {
+        thermal_algorithm_zones(c->profile, &c->result);
+
+        // Histograms over the same zones, from the profile-row pixels
+        ZoneHistogramConfig hist_config;
+        i2c_slave_get_histogram_config(&hist_config);
+        zone_histogram_build(c->frame->pixels, &c->result.detection, &hist_config,
+                             c->result.frame_number, &c->histograms);
+    } else {
+        // Raw mode - clear result data
+        memset(&c->result, 0, sizeof(c->result));
+        c->result.frame_number = total_frames;
+        c->histograms.config.bins = 0;
+    }
+
+    // FPS for output covers sensor read, calculation and analysis
+    uint64_t frame_time_us = time_us_64() - c->t_start;
+    c->fps = (frame_time_us > 0) ? (1000000.0f / frame_time_us) : 0.0f;
+}
+
+// Runs with span detection (same divider): hands the same profiles and
+// the production result to core 1 to evaluate the candidate config
+static void stage_shadow(void *arg) {
+    PipelineContext *c = arg;
+    static bool was_enabled = false;
+
+    ThermalConfig candidate;
+    bool enabled = i2c_slave_get_shadow_config(&candidate) && !c->raw_mode;
+    if (enabled && !was_enabled) {
+        shadow_eval_reset();
+    }
+    was_enabled = enabled;
+    if (!enabled) return;
+
+    shadow_eval_post(c->span_profile, c->profile, &c->result, &candidate);
+
+    ShadowStats stats;
+    shadow_eval_get_stats(&stats);
+    i2c_slave_update_shadow(&stats);
+}
+
+static void stage_rate(void *arg);
+
+static void stage_columns(void *arg) {
+    PipelineContext *c = arg;
+
+    // Create temperature profile by averaging 24 rows into single 32-pixel row
+    // This gives us a horizontal temperature profile across the sensor
+    for (int col = 0; col < 32; col++) {
+        float sum = 0.0f;
+        for (int row = 0; row < 24; row++) {
+            sum += c->frame->pixels[row * 32 + col];
+        }
+        c->temp_profile[col] = sum / 24.0f;
+    }
+}
+
+static void stage_i2c(void *arg) {
+    PipelineContext *c = arg;
+    i2c_slave_update(&c->result, c->fps, c->frame);
+    if (c->histograms.config.bins > 0) {
+        i2c_slave_update_histograms(&c->histograms);
+        c->histograms_published = true;
+    } else if (c->histograms_published) {
+        // Switched off (or raw mode): don't leave the last counts readable
+        i2c_slave_clear_histograms();
+        c->histograms_published = false;
+    }
+}
+
+static void stage_serial(void *arg) {
+    PipelineContext *c = arg;
+
+    // Output results (conditional based on output mode)
+    if (serial_mux_active()) {
+        send_binary_frame(&c->result, c->fps);
+        if (c->histograms.config.bins > 0) {
+            send_binary_histograms(&c->histograms);
+        }
+    } else if (i2c_slave_output_enabled(OUTPUT_MODE_USB_SERIAL)) {
+        #if COMPACT_OUTPUT
+            send_serial_compact(&c->result, c->fps);
+            if (c->histograms.config.bins > 0) {
+                send_serial_histograms(&c->histograms);
+            }
+        #else
+            send_serial_json(&c->result, c->fps, c->temp_profile, &c->histograms);
+        #endif
+    }
+}
+
+static void stage_image(void *arg) {
+    PipelineContext *c = arg;
+
+    uint32_t bitrate = i2c_slave_get_image_bitrate();
+    if (bitrate != image_rate.bitrate) {
+        frame_codec_rate_init(&image_rate, bitrate, IMAGE_MAX_FPS);
+    }
+    bool binary = serial_mux_active();
+    if (bitrate == 0 || !(binary || i2c_slave_output_enabled(OUTPUT_MODE_USB_SERIAL))) return;
+    if (!frame_codec_rate_ready(&image_rate, c->t_sensor)) return;
+
+    const TyreDetection *det = c->raw_mode ? NULL : &c->result.detection;
+    uint16_t len = frame_codec_encode(c->frame->pixels, c->result.frame_number, image_rate.quality,
+                                      det, image_packet, sizeof(image_packet));
+    uint16_t sent = 0;
+    if (len > 0) {
+        sent = binary ? send_binary_image(image_packet, len) : send_serial_image(image_packet, len);
+    }
+    frame_codec_rate_sent(&image_rate, sent * 8u, c->t_sensor);
+}
+
+static PipelineStage stages[STAGE_COUNT] = {
+    [STAGE_PROFILE] = {"profile", stage_profile, 1, 0},
+    [STAGE_SPAN]    = {"span", stage_span, 8, STAGE_BIT(STAGE_PROFILE)},
+    [STAGE_ZONES]   = {"zones", stage_zones, 1, STAGE_BIT(STAGE_PROFILE) | STAGE_BIT(STAGE_SPAN)},
+    [STAGE_SHADOW]  = {"shadow", stage_shadow, 8, STAGE_BIT(STAGE_SPAN) | STAGE_BIT(STAGE_ZONES)},
+    [STAGE_RATE]    = {"rate", stage_rate, 1, STAGE_BIT(STAGE_ZONES)},
+    [STAGE_COLUMNS] = {"columns", stage_columns, COMPACT_OUTPUT ? 0 : SERIAL_OUTPUT_DIVIDER, 0},
+    [STAGE_I2C]     = {"i2c", stage_i2c, 1, STAGE_BIT(STAGE_ZONES)},
+    [STAGE_SERIAL]  = {"serial", stage_serial, SERIAL_OUTPUT_DIVIDER,
+                       STAGE_BIT(STAGE_ZONES) | (COMPACT_OUTPUT ? 0 : STAGE_BIT(STAGE_COLUMNS))},
+    [STAGE_IMAGE]   = {"image", stage_image, 1, STAGE_BIT(STAGE_ZONES)},
+};
+
+static Pipeline pipeline;
+
+// Keep span detection near SPAN_DETECT_HZ at the current sensor rate. The
+// shadow stage shares the divider so it sees every fresh detection.
+static void update_span_divider(void) {
+    float subpage_hz = rate_controller_rate_hz(rate_controller_get_rate(&rate_ctrl));
+    uint16_t divider = (uint16_t)(subpage_hz / SPAN_DETECT_HZ);
+    pipeline_set_divider(&pipeline, STAGE_SPAN, divider > 0 ? divider : 1);
+    pipeline_set_divider(&pipeline, STAGE_SHADOW, divider > 0 ? divider : 1);
+}
+
+static void report_detect_cycles(void) {
+    if (detect_cycles.max == 0) return;
+    diag_detect_cycles(ctx.config.engine, detect_cycles.last, detect_cycles.min, detect_cycles.max);
+    detect_cycles.min = UINT32_MAX;
+    detect_cycles.max = 0;
+}
+
+static void stage_rate(void *arg) {
+    PipelineContext *c = arg;
+
+    // Adapt the sensor refresh rate to how fast the scene is changing.
+    // The change is staged and written after the pipeline tick.
+    rate_controller_set_fixed(&rate_ctrl, i2c_slave_get_frame_rate());
+    uint8_t old_rate = rate_controller_get_rate(&rate_ctrl);
+    if (rate_controller_update(&rate_ctrl, c->raw_mode ? NULL : &c->result, c->t_sensor)) {
+        if (rate_controller_apply(&rate_ctrl, MLX90640_ADDR) == 0) {
+            diag_rate_change(old_rate, rate_controller_get_rate(&rate_ctrl));
+            update_span_divider();
+        }
+    }
+    i2c_slave_set_rate_status(rate_controller_get_rate(&rate_ctrl),
+                              (uint8_t)rate_controller_get_mode(&rate_ctrl));
+}
 
-void setup_mlx90640(void) {
+// Convert the subpage just read. In zone mode only the profile rows of the
+// current span (plus ZONE_MARGIN) get full temperatures; the IR signal of
+// the profile rows is kept for span detection. Everything else carries
+// over from the last full conversion. Returns true if only zones were
+// converted.
+static bool convert_subpage(float *pixels, float emissivity) {
+    static uint8_t zone_subpages = 0;
+
+    // Full-frame sinks (raw channels, JSON column profile) need every pixel
+    bool zone_requested = i2c_slave_get_zone_conversion() && !i2c_slave_get_raw_mode() && COMPACT_OUTPUT;
+    if (!zone_requested) {
+        zone_subpages = 0;
+    } else {
+        MLX90640_GetSignalRegion(mlx_frame_raw, &mlx_params, &mlx_env, emissivity,
+                                 PROFILE_FIRST_ROW, PROFILE_LAST_ROW, ir_signal);
+        // Convert both subpages in full once so the carried-over pixels and
+        // the signal rows start out fresh
+        if (zone_subpages < 2) {
+            zone_subpages++;
+            zone_requested = false;
+        }
+    }
+
+    if (!zone_requested) {
+        MLX90640_CalculateToEnv(mlx_frame_raw, &mlx_params, &mlx_env, emissivity, REFLECTED_TEMP, pixels);
+        return false;
+    }
+
+    const TyreDetection *det = &ctx.result.detection;
+    int first_col = 0;
+    int last_col = SENSOR_WIDTH - 1;
+    if (det->detected) {
+        first_col = det->span_start > ZONE_MARGIN ? det->span_start - ZONE_MARGIN : 0;
+        last_col = det->span_end + ZONE_MARGIN < SENSOR_WIDTH ? det->span_end + ZONE_MARGIN : SENSOR_WIDTH - 1;
+    }
+    MLX90640_CalculateToRegion(mlx_frame_raw, &mlx_params, &mlx_env, emissivity, REFLECTED_TEMP,
+                               PROFILE_FIRST_ROW, PROFILE_LAST_ROW, first_col, last_col, pixels);
+    return true;
+}
+
+static uint64_t device_serial(const uint16_t *id) {
+    return ((uint64_t)id[0] << 32) | ((uint64_t)id[1] << 16) | id[2];
+}
+
+// Warm restart: the sensor kept running through the reset. If it is the
+// same one (device ID), reuse the retained calibration and environment
+// terms and carry on at the retained refresh rate.
+static bool resume_mlx90640(const RetainedRuntime *resume) {
+    uint16_t id[3];
+    if (MLX90640_I2CRead(MLX90640_ADDR, MLX90640_DEVICE_ID_ADDR, 3, id) != 0) return false;
+    if (!retained_state_load_calibration(device_serial(id), &mlx_params)) return false;
+
+    mlx_env = resume->env;
+    pixel_health_init(&mlx_params);
+    pixel_health_restore_flagged(&resume->pixels);
+
+    // The control register shadow was lost; this syncs it from the sensor
+    MLX90640_SetRefreshRate(MLX90640_ADDR, resume->rate_ctrl.rate);
+    MLX90640_ApplyControlRegister(MLX90640_ADDR);
+    return true;
+}
+
+// Returns true if it resumed from the retained state
+bool setup_mlx90640(const RetainedRuntime *resume) {
     printf("\n========================================\n");
     printf("Thermal Tyre Driver - C Version\n");
     printf("========================================\n\n");
 
     printf("Initializing I2C...\n");
     fflush(stdout);
+    MLX90640_I2CRecoverBus();  // The reset may have cut a transfer short
     MLX90640_I2CInit();
     printf("I2C initialized OK\n");
     fflush(stdout);
+
+    if (resume) {
+        if (resume_mlx90640(resume)) {
+            printf("Resumed after watchdog reset %u (frame %lu)\n",
+                   retained_state_watchdog_resets(), (unsigned long)resume->total_frames);
+            return true;
+        }
+        printf("Retained state doesn't match the sensor, cold start\n");
+        retained_state_discard();
+        watchdog_disable();  // Re-enabled before the main loop
+    }
     sleep_ms(100);
 
     printf("Detecting MLX90640 sensor at 0x%02X...\n", MLX90640_ADDR);
@@ -82,57 +463,130 @@ void setup_mlx90640(void) {
         }
     }
 
+    retained_state_save_calibration(device_serial(&eeData[MLX90640_DEVICE_ID_ADDR - 0x2400]), &mlx_params);
+
+    MLX90640_InitEnvironment(&mlx_env, ENV_SMOOTHING);
+    pixel_health_init(&mlx_params);
+
     printf("Setting refresh rate to 16Hz...\n");
-    MLX90640_SetRefreshRate(MLX90640_ADDR, 0x05);  // 16Hz
+    MLX90640_SetRefreshRate(MLX90640_ADDR, MLX_RATE_16HZ);
+    MLX90640_ApplyControlRegister(MLX90640_ADDR);
 
     printf("Waiting for sensor to stabilize...\n");
     sleep_ms(2000);  // Give sensor time to stabilize after power-on
 
     printf("Sensor initialized successfully!\n");
     printf("Expected performance: 5-10Hz frame rate\n\n");
+    return false;
+}
+
+// Host commands, then the queued binary output. Runs on every pass of the
+// loop, including the ones that skip the subpage, so the diagnostics of a
+// failing sensor still reach the host.
+static void service_serial_mux(void) {
+    serial_mux_poll();
+    serial_mux_flush(SERIAL_MUX_FLUSH_BYTES);
+}
+
+// Everything needed to resume warm after a watchdog reset
+static void save_retained_state(void) {
+    static RetainedRuntime snapshot;
+
+    snapshot.total_frames = total_frames;
+    snapshot.algorithm_frame = thermal_algorithm_get_frame_number();
+    snapshot.result = ctx.result;
+    snapshot.rate_ctrl = rate_ctrl;
+    snapshot.env = mlx_env;
+    pixel_health_get_flagged(&snapshot.pixels);
+    i2c_slave_get_config(snapshot.config_regs);
+    retained_state_save_runtime(&snapshot);
 }
 
 int main(void) {
+    // After a watchdog reset with intact retained state, skip the boot
+    // delays and resume. Startup talks to the sensor, so keep the
+    // watchdog running through it.
+    ResetReason reset_reason = retained_state_boot();
+    const RetainedRuntime *resume = retained_state_runtime();
+    if (resume) {
+        watchdog_enable(WATCHDOG_TIMEOUT_MS, true);
+    }
+
     // Initialize GPIO FIRST - for debugging
     gpio_init(LED_PIN);
     gpio_set_dir(LED_PIN, GPIO_OUT);
 
-    // Rapid blink to show we're alive
-    for (int i = 0; i < 10; i++) {
-        gpio_put(LED_PIN, 1);
-        sleep_ms(50);
+    if (!resume) {
+        // Rapid blink to show we're alive
+        for (int i = 0; i < 10; i++) {
+            gpio_put(LED_PIN, 1);
+            sleep_ms(50);
+            gpio_put(LED_PIN, 0);
+            sleep_ms(50);
+        }
+
+        // LED off before stdio_init
         gpio_put(LED_PIN, 0);
-        sleep_ms(50);
+        sleep_ms(500);
     }
 
-    // LED off before stdio_init
-    gpio_put(LED_PIN, 0);
-    sleep_ms(500);
-
     // Initialize communication
     communication_init();
 
     // Wait for USB serial to enumerate (increased for stability)
-    sleep_ms(5000);
+    if (!resume) {
+        sleep_ms(5000);
+    }
 
     gpio_put(LED_PIN, 1);
     printf("=== USB Serial initialized! ===\n");
     fflush(stdout);
 
     // Initialize MLX90640
-    setup_mlx90640();
+    if (!setup_mlx90640(resume)) {
+        resume = NULL;
+        reset_reason = retained_state_reason();
+    }
 
     // Initialize thermal algorithm
-    ThermalConfig config;
-    thermal_algorithm_init(&config);
+    thermal_algorithm_init(&ctx.config);
 
     // Initialize I2C slave mode (GP26=SDA, GP27=SCL, address 0x08)
     printf("Initializing I2C slave mode at address 0x08...\n");
     i2c_slave_init(I2C_SLAVE_DEFAULT_ADDR);
     printf("I2C slave mode enabled on GP26/GP27\n");
+    if (resume) {
+        i2c_slave_restore_config(resume->config_regs);
+    }
+    i2c_slave_set_reset_status((uint8_t)reset_reason, retained_state_watchdog_resets());
+
+    frame_pool_init();
+
+    // Core 1 waits for shadow evaluation jobs (REG_SHADOW_MODE)
+    shadow_eval_init();
+    detect_cycles_init();
+    serial_mux_init();
+
+    // Start at full rate; the controller backs off once the scene is quiet
+    rate_controller_init(&rate_ctrl, MLX_RATE_16HZ);
+
+    // Warm restart: carry on with the retained tracking state. The retained
+    // block is overwritten from the first subpage, so copy it all now.
+    if (resume) {
+        rate_ctrl = resume->rate_ctrl;
+        rate_controller_resume(&rate_ctrl);
+        ctx.result = resume->result;
+        total_frames = resume->total_frames;
+        thermal_algorithm_set_frame_number(resume->algorithm_frame);
+    }
 
-    FrameData result;
-    memset(&result, 0, sizeof(result));
+    if (!pipeline_init(&pipeline, stages, STAGE_COUNT)) {
+        printf("ERROR: Pipeline stage table is not in dependency order\n");
+        while (1) {
+            sleep_ms(1000);
+        }
+    }
+    update_span_divider();
 
     printf("========================================\n");
     printf("Starting thermal sensing loop...\n");
@@ -142,6 +596,9 @@ int main(void) {
 
     gpio_put(LED_PIN, 0);  // LED off - ready
 
+    // Fed once per subpage; a hang anywhere in the loop resets the chip
+    watchdog_enable(WATCHDOG_TIMEOUT_MS, true);
+
     last_frame_time = time_us_64();
 
     while (1) {
@@ -161,77 +618,111 @@ int main(void) {
         uint64_t t_sensor = time_us_64();
 
         if (status < 0) {
-            printf("ERROR: Frame read failed (code %d)\n", status);
-            fflush(stdout);
+            diag_error(MUX_ERROR_FRAME_READ, status);
+            service_serial_mux();
             sleep_ms(100);
             continue;
         }
 
-        // Calculate temperatures from raw data
-        float emissivity = i2c_slave_get_emissivity();
-        float tr = 23.15f;  // Reflected temperature
-        MLX90640_CalculateTo(mlx_frame_raw, &mlx_params, emissivity, tr, mlx_frame);
-
-        uint64_t t_calc = time_us_64();
+        // Drop the subpage that was being measured across a rate change
+        if (rate_controller_discard_subpage(&rate_ctrl)) {
+            service_serial_mux();
+            watchdog_update();
+            continue;
+        }
 
-        // Process with thermal algorithm (skip if raw mode enabled)
-        if (!i2c_slave_get_raw_mode()) {
-            thermal_algorithm_process(mlx_frame, &result, &config);
+        // Each frame gets its own pool buffer so sinks can keep older ones.
+        // CalculateTo only writes the subpage just read, so the other half
+        // is carried forward from the previous frame.
+        FrameBuffer *next = frame_pool_acquire();
+        if (!next) {
+            FramePoolStats pool_stats;
+            frame_pool_get_stats(&pool_stats);
+            diag_error(MUX_ERROR_FRAME_POOL, (int32_t)pool_stats.exhausted);
+            service_serial_mux();
+            continue;
+        }
+        if (frame) {
+            memcpy(next->pixels, frame->pixels, sizeof(next->pixels));
         } else {
-            // Raw mode - clear result data
-            memset(&result, 0, sizeof(result));
-            result.frame_number = total_frames;
+            memset(next->pixels, 0, sizeof(next->pixels));
         }
+        next->frame_number = total_frames;
+        next->timestamp_us = t_sensor;
 
-        uint64_t t_algo = time_us_64();
+        // Calculate temperatures from raw data
+        float emissivity = i2c_slave_get_emissivity();
+        MLX90640_UpdateEnvironment(mlx_frame_raw, &mlx_params, &mlx_env);
+        bool zone_conversion = convert_subpage(next->pixels, emissivity);
+        i2c_slave_set_environment(mlx_env.ta, mlx_env.vdd);
+
+        // Track per-pixel noise and patch EEPROM + runtime-flagged pixels.
+        // Pixel statistics need the whole subpage, so pause in zone mode.
+        if (!zone_conversion && pixel_health_update(next->pixels, mlx_frame_raw[833], mlx_env.mode != 0)) {
+            PixelHealthStats health;
+            pixel_health_get_stats(&health);
+            diag_pixel_health(&health);
+        }
+        MLX90640_BadPixelsCorrection(pixel_health_bad_pixels(), next->pixels, mlx_env.mode ? 1 : 0, &mlx_params);
 
-        // Calculate FPS for output
-        uint64_t frame_time_us = t_algo - t_start;
-        float fps = (frame_time_us > 0) ? (1000000.0f / frame_time_us) : 0.0f;
+        frame_buffer_release(frame);
+        frame = next;
 
-        // Create temperature profile by averaging 24 rows into single 32-pixel row
-        // This gives us a horizontal temperature profile across the sensor
-        static float temp_profile[32];
-        for (int col = 0; col < 32; col++) {
-            float sum = 0.0f;
-            for (int row = 0; row < 24; row++) {
-                sum += mlx_frame[row * 32 + col];
-            }
-            temp_profile[col] = sum / 24.0f;
+        uint64_t t_calc = time_us_64();
+
+        // Run the due pipeline stages for this subpage
+        ctx.frame = frame;
+        ctx.raw_mode = i2c_slave_get_raw_mode();
+        ctx.zone_conversion = zone_conversion;
+        ctx.emissivity = emissivity;
+        ctx.t_start = t_start;
+        ctx.t_sensor = t_sensor;
+        pipeline_tick(&pipeline, &ctx);
+
+        // Subpage boundary: write configuration staged by the stages (and
+        // the I2C master) in a single control register write
+        if (MLX90640_ApplyControlRegister(MLX90640_ADDR) < 0) {
+            diag_error(MUX_ERROR_CONTROL_WRITE, 0);
         }
 
-        // Update I2C slave registers
-        i2c_slave_update(&result, fps, mlx_frame);
+        service_serial_mux();
 
-        // Output results (conditional based on output mode)
-        if (i2c_slave_output_enabled(OUTPUT_MODE_USB_SERIAL)) {
-            #if COMPACT_OUTPUT
-                send_serial_compact(&result, fps);
-            #else
-                send_serial_json(&result, fps, temp_profile);
-            #endif
-        }
+        // The subpage went through: keep its state for a warm restart and
+        // feed the watchdog. Failed reads and an exhausted frame pool skip
+        // this, so if they persist the watchdog resets the chip.
+        save_retained_state();
+        watchdog_update();
 
         uint64_t t_end = time_us_64();
 
         // Calculate total frame time for statistics
         uint64_t total_frame_time_us = t_end - t_start;
         float frame_time_ms = total_frame_time_us / 1000.0f;
-        float actual_fps = (total_frame_time_us > 0) ? (1000000.0f / total_frame_time_us) : 0.0f;
 
         total_frames++;
 
         // Print timing every 10 frames
         if (total_frames % 10 == 0) {
-            float sensor_ms = (t_sensor - t_start) / 1000.0f;
-            float calc_ms = (t_calc - t_sensor) / 1000.0f;
-            float algo_ms = (t_algo - t_calc) / 1000.0f;
-            float comm_ms = (t_end - t_algo) / 1000.0f;
-
-            printf("[Frame %lu] Total: %.1fms (%.1f fps) | "
-                   "Sensor: %.1fms | Calc: %.1fms | Algo: %.1fms | Comm: %.1fms\n",
-                   total_frames, frame_time_ms, actual_fps,
-                   sensor_ms, calc_ms, algo_ms, comm_ms);
+            uint32_t algo_us = pipeline_elapsed_us(&pipeline, STAGE_BIT(STAGE_PROFILE) |
+                                                   STAGE_BIT(STAGE_SPAN) | STAGE_BIT(STAGE_ZONES));
+            uint32_t comm_us = (uint32_t)(t_end - t_calc);
+            comm_us = comm_us > algo_us ? comm_us - algo_us : 0;
+
+            diag_frame_timing(total_frames, (uint32_t)total_frame_time_us, (uint32_t)(t_sensor - t_start),
+                              (uint32_t)(t_calc - t_sensor), algo_us, comm_us);
+        }
+
+        // Per-stage run counts and timing
+        if (total_frames % 50 == 0) {
+            diag_pipeline(&pipeline);
+            report_detect_cycles();
+            ThermalConfig candidate;
+            if (i2c_slave_get_shadow_config(&candidate)) {
+                ShadowStats shadow;
+                shadow_eval_get_stats(&shadow);
+                diag_shadow(&shadow);
+            }
+            diag_drops();
         }
 
         // Blink LED on every frame
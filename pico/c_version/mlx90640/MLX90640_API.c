@@ -17,6 +17,7 @@
 #include <MLX90640_I2C_Driver.h>
 #include <MLX90640_API.h>
 #include <math.h>
+#include <string.h>
 
 static void ExtractVDDParameters(uint16_t *eeData, paramsMLX90640 *mlx90640);
 static void ExtractPTATParameters(uint16_t *eeData, paramsMLX90640 *mlx90640);
@@ -37,6 +38,24 @@ static float GetMedian(float *values, int n);
 static int IsPixelBad(uint16_t pixel,paramsMLX90640 *params);
 static int ValidateFrameData(uint16_t *frameData);
 static int ValidateAuxData(uint16_t *auxData);
+static float GetTaFromVdd(uint16_t *frameData, const paramsMLX90640 *params, float vdd);
+static int GetFrameDataShadowed(uint8_t slaveAddr, uint16_t *frameData);
+static int SyncControlRegister(uint8_t slaveAddr);
+static int StageControlBits(uint16_t mask, uint16_t bits);
+
+// Shadow of MLX90640_CTRL_REG. value mirrors the sensor; Set* calls stage
+// field changes in stagedMask/stagedBits, written together by
+// MLX90640_ApplyControlRegister() at the next subpage boundary.
+static struct
+{
+    uint16_t value;
+    uint16_t stagedMask;
+    uint16_t stagedBits;
+    uint8_t slaveAddr;
+    uint8_t valid;
+} ctrlShadow;
+
+static ctrlStatsMLX90640 ctrlStats;
   
 int MLX90640_DumpEE(uint8_t slaveAddr, uint16_t *eeData)
 {
@@ -112,9 +131,27 @@ int MLX90640_TriggerMeasurement(uint8_t slaveAddr)
 }
     
 int MLX90640_GetFrameData(uint8_t slaveAddr, uint16_t *frameData)
+{
+    int result;
+    
+    result = GetFrameDataShadowed(slaveAddr, frameData);
+    if(result < 0)
+    {
+        // The sensor may have been reset; read the control register again
+        ctrlShadow.valid = 0;
+        return result;
+    }
+    
+    // Subpage boundary: write any staged configuration in one go. A failed
+    // write stays staged for the next subpage.
+    MLX90640_ApplyControlRegister(slaveAddr);
+    
+    return result;
+}
+
+static int GetFrameDataShadowed(uint8_t slaveAddr, uint16_t *frameData)
 {
     uint16_t dataReady = 0;
-    uint16_t controlRegister1;
     uint16_t statusRegister;
     int error = 1;
     uint16_t data[64];
@@ -149,8 +186,16 @@ int MLX90640_GetFrameData(uint8_t slaveAddr, uint16_t *frameData)
         return error;
     }     
         
-    error = MLX90640_I2CRead(slaveAddr, MLX90640_CTRL_REG, 1, &controlRegister1);
-    frameData[832] = controlRegister1;
+    // The control register only changes when we write it
+    if(ctrlShadow.valid && ctrlShadow.slaveAddr == slaveAddr)
+    {
+        ctrlStats.readsSkipped++;
+    }
+    else
+    {
+        error = SyncControlRegister(slaveAddr);
+    }
+    frameData[832] = ctrlShadow.value;
     //frameData[833] = statusRegister & 0x0001;
     frameData[833] = MLX90640_GET_FRAME(statusRegister);
     
@@ -254,36 +299,119 @@ int MLX90640_ExtractParameters(uint16_t *eeData, paramsMLX90640 *mlx90640)
 
 //------------------------------------------------------------------------------
 
-int MLX90640_SetResolution(uint8_t slaveAddr, uint8_t resolution)
+static int SyncControlRegister(uint8_t slaveAddr)
 {
     uint16_t controlRegister1;
-    uint16_t value;
     int error;
     
-    //value = (resolution & 0x03) << 10;
-    value = ((uint16_t)resolution << MLX90640_CTRL_RESOLUTION_SHIFT);
-    value &= ~MLX90640_CTRL_RESOLUTION_MASK;
-    
     error = MLX90640_I2CRead(slaveAddr, MLX90640_CTRL_REG, 1, &controlRegister1);
+    ctrlStats.reads++;
+    if(error != MLX90640_NO_ERROR)
+    {
+        ctrlShadow.valid = 0;
+        return error;
+    }
     
-    if(error == MLX90640_NO_ERROR)
+    // Staged changes are kept and applied on top of the fresh value
+    ctrlShadow.value = controlRegister1;
+    ctrlShadow.slaveAddr = slaveAddr;
+    ctrlShadow.valid = 1;
+    
+    return MLX90640_NO_ERROR;
+}
+
+//------------------------------------------------------------------------------
+
+static int GetControlRegister(uint8_t slaveAddr, uint16_t *controlRegister1)
+{
+    int error = MLX90640_NO_ERROR;
+    
+    if(!ctrlShadow.valid || ctrlShadow.slaveAddr != slaveAddr)
     {
-        value = (controlRegister1 & MLX90640_CTRL_RESOLUTION_MASK) | value;
-        error = MLX90640_I2CWrite(slaveAddr, MLX90640_CTRL_REG, value);        
-    }    
+        error = SyncControlRegister(slaveAddr);
+    }
+    *controlRegister1 = ctrlShadow.value;
     
     return error;
 }
 
 //------------------------------------------------------------------------------
 
+static int StageControlBits(uint16_t mask, uint16_t bits)
+{
+    ctrlShadow.stagedMask |= mask;
+    ctrlShadow.stagedBits = (ctrlShadow.stagedBits & ~mask) | (bits & mask);
+    ctrlStats.changes++;
+    
+    return MLX90640_NO_ERROR;
+}
+
+//------------------------------------------------------------------------------
+
+int MLX90640_ApplyControlRegister(uint8_t slaveAddr)
+{
+    uint16_t controlRegister1;
+    uint16_t value;
+    int error;
+    
+    if(ctrlShadow.stagedMask == 0)
+    {
+        return 0;
+    }
+    
+    error = GetControlRegister(slaveAddr, &controlRegister1);
+    if(error != MLX90640_NO_ERROR)
+    {
+        return error;
+    }
+    
+    value = (controlRegister1 & ~ctrlShadow.stagedMask) | ctrlShadow.stagedBits;
+    if(value == controlRegister1)
+    {
+        ctrlShadow.stagedMask = 0;
+        return 0;
+    }
+    
+    error = MLX90640_I2CWrite(slaveAddr, MLX90640_CTRL_REG, value);
+    ctrlStats.writes++;
+    if(error != MLX90640_NO_ERROR)
+    {
+        ctrlShadow.valid = 0;
+        return error;
+    }
+    
+    ctrlShadow.value = value;
+    ctrlShadow.stagedMask = 0;
+    
+    return 1;
+}
+
+//------------------------------------------------------------------------------
+
+void MLX90640_GetControlStats(ctrlStatsMLX90640 *stats)
+{
+    *stats = ctrlStats;
+}
+
+//------------------------------------------------------------------------------
+
+int MLX90640_SetResolution(uint8_t slaveAddr, uint8_t resolution)
+{
+    (void)slaveAddr;
+    
+    //value = (resolution & 0x03) << 10;
+    return StageControlBits((uint16_t)~MLX90640_CTRL_RESOLUTION_MASK, (uint16_t)resolution << MLX90640_CTRL_RESOLUTION_SHIFT);
+}
+
+//------------------------------------------------------------------------------
+
 int MLX90640_GetCurResolution(uint8_t slaveAddr)
 {
     uint16_t controlRegister1;
     int resolutionRAM;
     int error;
     
-    error = MLX90640_I2CRead(slaveAddr, MLX90640_CTRL_REG, 1, &controlRegister1);
+    error = GetControlRegister(slaveAddr, &controlRegister1);
     if(error != MLX90640_NO_ERROR)
     {
         return error;
@@ -297,22 +425,10 @@ int MLX90640_GetCurResolution(uint8_t slaveAddr)
 
 int MLX90640_SetRefreshRate(uint8_t slaveAddr, uint8_t refreshRate)
 {
-    uint16_t controlRegister1;
-    uint16_t value;
-    int error;
+    (void)slaveAddr;
     
     //value = (refreshRate & 0x07)<<7;
-    value = ((uint16_t)refreshRate << MLX90640_CTRL_REFRESH_SHIFT);
-    value &= ~MLX90640_CTRL_REFRESH_MASK;
-    
-    error = MLX90640_I2CRead(slaveAddr, MLX90640_CTRL_REG, 1, &controlRegister1);
-    if(error == MLX90640_NO_ERROR)
-    {
-        value = (controlRegister1 & MLX90640_CTRL_REFRESH_MASK) | value;
-        error = MLX90640_I2CWrite(slaveAddr, MLX90640_CTRL_REG, value);
-    }    
-    
-    return error;
+    return StageControlBits((uint16_t)~MLX90640_CTRL_REFRESH_MASK, (uint16_t)refreshRate << MLX90640_CTRL_REFRESH_SHIFT);
 }
 
 //------------------------------------------------------------------------------
@@ -323,7 +439,7 @@ int MLX90640_GetRefreshRate(uint8_t slaveAddr)
     int refreshRate;
     int error;
     
-    error = MLX90640_I2CRead(slaveAddr, MLX90640_CTRL_REG, 1, &controlRegister1);
+    error = GetControlRegister(slaveAddr, &controlRegister1);
     if(error != MLX90640_NO_ERROR)
     {
         return error;
@@ -337,38 +453,18 @@ int MLX90640_GetRefreshRate(uint8_t slaveAddr)
 
 int MLX90640_SetInterleavedMode(uint8_t slaveAddr)
 {
-    uint16_t controlRegister1;
-    uint16_t value;
-    int error;
-    
-    error = MLX90640_I2CRead(slaveAddr, MLX90640_CTRL_REG, 1, &controlRegister1);
+    (void)slaveAddr;
     
-    if(error == 0)
-    {
-        value = (controlRegister1 & ~MLX90640_CTRL_MEAS_MODE_MASK);
-        error = MLX90640_I2CWrite(slaveAddr, MLX90640_CTRL_REG, value);        
-    }    
-    
-    return error;
+    return StageControlBits(MLX90640_CTRL_MEAS_MODE_MASK, 0);
 }
 
 //------------------------------------------------------------------------------
 
 int MLX90640_SetChessMode(uint8_t slaveAddr)
 {
-    uint16_t controlRegister1;
-    uint16_t value;
-    int error;
-        
-    error = MLX90640_I2CRead(slaveAddr, MLX90640_CTRL_REG, 1, &controlRegister1);
-    
-    if(error == 0)
-    {
-        value = (controlRegister1 | MLX90640_CTRL_MEAS_MODE_MASK);
-        error = MLX90640_I2CWrite(slaveAddr, MLX90640_CTRL_REG, value);        
-    }    
+    (void)slaveAddr;
     
-    return error;
+    return StageControlBits(MLX90640_CTRL_MEAS_MODE_MASK, MLX90640_CTRL_MEAS_MODE_MASK);
 }
 
 //------------------------------------------------------------------------------
@@ -379,7 +475,7 @@ int MLX90640_GetCurMode(uint8_t slaveAddr)
     int modeRAM;
     int error;
     
-    error = MLX90640_I2CRead(slaveAddr, MLX90640_CTRL_REG, 1, &controlRegister1);
+    error = GetControlRegister(slaveAddr, &controlRegister1);
     if(error != 0)
     {
         return error;
@@ -391,17 +487,179 @@ int MLX90640_GetCurMode(uint8_t slaveAddr)
 
 //------------------------------------------------------------------------------
 
-void MLX90640_CalculateTo(uint16_t *frameData, const paramsMLX90640 *params, float emissivity, float tr, float *result)
+void MLX90640_InitEnvironment(envMLX90640 *env, float smoothing)
+{
+    env->smoothing = smoothing;
+    env->valid = 0;
+}
+
+//------------------------------------------------------------------------------
+
+static float SmoothTerm(float previous, float sample, float smoothing)
+{
+    return previous + smoothing * (sample - previous);
+}
+
+static float GetCP(uint16_t *frameData, const paramsMLX90640 *params, const envMLX90640 *env, uint8_t mode, int subPage)
+{
+    float cp;
+    float offset;
+    
+    cp = (int16_t)frameData[subPage == 0 ? 776 : 808] * env->gain;
+    
+    offset = params->cpOffset[subPage];
+    if(subPage == 1 && mode != params->calibrationModeEE)
+    {
+        offset = offset + params->ilChessC[0];
+    }
+    
+    return cp - offset * (1 + params->cpKta * env->taDelta) * (1 + params->cpKv * env->vddDelta);
+}
+
+void MLX90640_UpdateEnvironment(uint16_t *frameData, const paramsMLX90640 *params, envMLX90640 *env)
 {
     float vdd;
     float ta;
-    float ta4;
+    float gain;
+    uint8_t mode;
+    uint16_t subPage;
+    
+    subPage = frameData[833];
+    mode = (frameData[832] & MLX90640_CTRL_MEAS_MODE_MASK) >> 5;
+    
+    vdd = MLX90640_GetVdd(frameData, params);
+    ta = GetTaFromVdd(frameData, params, vdd);
+    gain = (float)params->gainEE / (int16_t)frameData[778];
+    
+    if(env->valid == 0)
+    {
+        // Calibration constants only change with the EEPROM
+        env->ktaScale = 1.0f / POW2F(params->ktaScale);
+        env->kvScale = 1.0f / POW2F(params->kvScale);
+        env->alphaScale = (float)SCALEALPHA * POW2F(params->alphaScale);
+        
+        env->alphaCorrR[0] = 1 / (1 + params->ksTo[0] * 40);
+        env->alphaCorrR[1] = 1 ;
+        env->alphaCorrR[2] = (1 + params->ksTo[1] * params->ct[2]);
+        env->alphaCorrR[3] = env->alphaCorrR[2] * (1 + params->ksTo[2] * (params->ct[3] - params->ct[2]));
+        
+        env->vdd = vdd;
+        env->ta = ta;
+        env->gain = gain;
+    }
+    else
+    {
+        env->vdd = SmoothTerm(env->vdd, vdd, env->smoothing);
+        env->ta = SmoothTerm(env->ta, ta, env->smoothing);
+        env->gain = SmoothTerm(env->gain, gain, env->smoothing);
+    }
+    
+    env->taDelta = env->ta - 25.0f;
+    env->vddDelta = env->vdd - 3.3f;
+    env->ksTaFactor = 1 + params->KsTa * env->taDelta;
+    
+    env->ta4 = env->ta + 273.15f;
+    env->ta4 = env->ta4 * env->ta4;
+    env->ta4 = env->ta4 * env->ta4;
+    
+    // kta and kv take 32 and 4 distinct values, so their offset
+    // corrections are worked out here rather than per pixel
+    for(int split = 0; split < 4; split++)
+    {
+        float kv = params->kv[split] * env->kvScale;
+        env->kvFactor[split] = 1 + kv * env->vddDelta;
+        for(int code = 0; code < 8; code++)
+        {
+            float kta = params->ktaTable[split][code] * env->ktaScale;
+            env->ktaFactor[split][code] = 1 + kta * env->taDelta;
+        }
+    }
+    
+    // Each subpage measures its own CP pixel
+    if(env->valid == 0 || mode != env->mode)
+    {
+        env->irDataCP[0] = GetCP(frameData, params, env, mode, 0);
+        env->irDataCP[1] = GetCP(frameData, params, env, mode, 1);
+    }
+    else
+    {
+        env->irDataCP[subPage] = SmoothTerm(env->irDataCP[subPage], GetCP(frameData, params, env, mode, subPage), env->smoothing);
+    }
+    
+    env->mode = mode;
+    env->valid = 1;
+}
+
+//------------------------------------------------------------------------------
+
+// Offset, kta and kv from the row/column terms and pixel codes that
+// ExtractParameters() keeps. These match what the Melexis 768-entry tables
+// held exactly, for a few integer operations per pixel.
+
+static inline int PixelSplit(int pixelNumber)
+{
+    return 2 * ((pixelNumber >> 5) & 1) + (pixelNumber & 1);
+}
+
+static inline int16_t PixelOffset(const paramsMLX90640 *params, int pixelNumber)
+{
+    return (int16_t)(params->offsetRow[pixelNumber >> 5] + params->offsetColumn[pixelNumber & 31] +
+                     params->offsetDelta[pixelNumber] * (1 << params->offsetRemScale));
+}
+
+static inline uint8_t PixelKtaCode(const paramsMLX90640 *params, int pixelNumber)
+{
+    return (params->ktaCode[pixelNumber >> 1] >> ((pixelNumber & 1) * 4)) & 0x0F;
+}
+
+static inline int8_t PixelKta(const paramsMLX90640 *params, int pixelNumber)
+{
+    return params->ktaTable[PixelSplit(pixelNumber)][PixelKtaCode(params, pixelNumber)];
+}
+
+int16_t MLX90640_GetPixelOffset(const paramsMLX90640 *params, int pixelNumber)
+{
+    return PixelOffset(params, pixelNumber);
+}
+
+int8_t MLX90640_GetPixelKta(const paramsMLX90640 *params, int pixelNumber)
+{
+    return PixelKta(params, pixelNumber);
+}
+
+int8_t MLX90640_GetPixelKv(const paramsMLX90640 *params, int pixelNumber)
+{
+    return params->kv[PixelSplit(pixelNumber)];
+}
+
+//------------------------------------------------------------------------------
+
+void MLX90640_CalculateTo(uint16_t *frameData, const paramsMLX90640 *params, float emissivity, float tr, float *result)
+{
+    envMLX90640 env;
+    
+    MLX90640_InitEnvironment(&env, 1.0f);
+    MLX90640_UpdateEnvironment(frameData, params, &env);
+    MLX90640_CalculateToEnv(frameData, params, &env, emissivity, tr, result);
+}
+
+//------------------------------------------------------------------------------
+
+void MLX90640_CalculateToEnv(uint16_t *frameData, const paramsMLX90640 *params, const envMLX90640 *env, float emissivity, float tr, float *result)
+{
+    MLX90640_CalculateToRegion(frameData, params, env, emissivity, tr, 0, MLX90640_LINE_NUM - 1, 0, MLX90640_COLUMN_NUM - 1, result);
+}
+
+//------------------------------------------------------------------------------
+
+void MLX90640_CalculateToRegion(uint16_t *frameData, const paramsMLX90640 *params, const envMLX90640 *env, float emissivity, float tr, int firstLine, int lastLine, int firstColumn, int lastColumn, float *result)
+{
     float tr4;
     float taTr;
-    float gain;
-    float irDataCP[2];
     float irData;
+    float irDataCP;
     float alphaCompensated;
+    float alphaKsTo1;
     uint8_t mode;
     int8_t ilPattern;
     int8_t chessPattern;
@@ -409,121 +667,186 @@ void MLX90640_CalculateTo(uint16_t *frameData, const paramsMLX90640 *params, flo
     int8_t conversionPattern;
     float Sx;
     float To;
-    float alphaCorrR[4];
     int8_t range;
     uint16_t subPage;
-    float ktaScale;
-    float kvScale;
-    float alphaScale;
-    float kta;
-    float kv;
+    int split;
+    int pixelNumber;
     
     subPage = frameData[833];
-    vdd = MLX90640_GetVdd(frameData, params);
-    ta = MLX90640_GetTa(frameData, params);
+    mode = env->mode;
     
-    ta4 = (ta + 273.15);
-    ta4 = ta4 * ta4;
-    ta4 = ta4 * ta4;
-    tr4 = (tr + 273.15);
+    tr4 = (tr + 273.15f);
     tr4 = tr4 * tr4;
     tr4 = tr4 * tr4;
-    taTr = tr4 - (tr4-ta4)/emissivity;
+    taTr = tr4 - (tr4-env->ta4)/emissivity;
     
-    ktaScale = POW2(params->ktaScale);
-    kvScale = POW2(params->kvScale);
-    alphaScale = POW2(params->alphaScale);
-    
-    alphaCorrR[0] = 1 / (1 + params->ksTo[0] * 40);
-    alphaCorrR[1] = 1 ;
-    alphaCorrR[2] = (1 + params->ksTo[1] * params->ct[2]);
-    alphaCorrR[3] = alphaCorrR[2] * (1 + params->ksTo[2] * (params->ct[3] - params->ct[2]));
-    
-//------------------------- Gain calculation -----------------------------------    
+    irDataCP = params->tgc * env->irDataCP[subPage];
+    alphaKsTo1 = 1 - params->ksTo[1] * 273.15f;
     
-    gain = (float)params->gainEE / (int16_t)frameData[778]; 
-  
 //------------------------- To calculation -------------------------------------    
-    mode = (frameData[832] & MLX90640_CTRL_MEAS_MODE_MASK) >> 5;
-    
-    irDataCP[0] = (int16_t)frameData[776] * gain;
-    irDataCP[1] = (int16_t)frameData[808] * gain;
     
-    irDataCP[0] = irDataCP[0] - params->cpOffset[0] * (1 + params->cpKta * (ta - 25)) * (1 + params->cpKv * (vdd - 3.3));
-    if( mode ==  params->calibrationModeEE)
+    for( int line = firstLine; line <= lastLine; line++)
     {
-        irDataCP[1] = irDataCP[1] - params->cpOffset[1] * (1 + params->cpKta * (ta - 25)) * (1 + params->cpKv * (vdd - 3.3));
-    }
-    else
-    {
-      irDataCP[1] = irDataCP[1] - (params->cpOffset[1] + params->ilChessC[0]) * (1 + params->cpKta * (ta - 25)) * (1 + params->cpKv * (vdd - 3.3));
-    }
-
-    for( int pixelNumber = 0; pixelNumber < 768; pixelNumber++)
-    {
-        ilPattern = pixelNumber / 32 - (pixelNumber / 64) * 2; 
-        chessPattern = ilPattern ^ (pixelNumber - (pixelNumber/2)*2); 
-        conversionPattern = ((pixelNumber + 2) / 4 - (pixelNumber + 3) / 4 + (pixelNumber + 1) / 4 - pixelNumber / 4) * (1 - 2 * ilPattern);
-        
-        if(mode == 0)
-        {
-          pattern = ilPattern; 
-        }
-        else 
+        for( int column = firstColumn; column <= lastColumn; column++)
         {
-          pattern = chessPattern; 
-        }               
-        
-        if(pattern == frameData[833])
-        {    
-            irData = (int16_t)frameData[pixelNumber] * gain;
+            pixelNumber = line * MLX90640_LINE_SIZE + column;
+            ilPattern = line & 1; 
+            chessPattern = ilPattern ^ (column & 1); 
+            conversionPattern = ((pixelNumber + 2) / 4 - (pixelNumber + 3) / 4 + (pixelNumber + 1) / 4 - pixelNumber / 4) * (1 - 2 * ilPattern);
             
-            kta = params->kta[pixelNumber]/ktaScale;
-            kv = params->kv[pixelNumber]/kvScale;
-            irData = irData - params->offset[pixelNumber]*(1 + kta*(ta - 25))*(1 + kv*(vdd - 3.3));
-            
-            if(mode !=  params->calibrationModeEE)
-            {
-              irData = irData + params->ilChessC[2] * (2 * ilPattern - 1) - params->ilChessC[1] * conversionPattern; 
-            }                       
-    
-            irData = irData - params->tgc * irDataCP[subPage];
-            irData = irData / emissivity;
-            
-            alphaCompensated = SCALEALPHA*alphaScale/params->alpha[pixelNumber];
-            alphaCompensated = alphaCompensated*(1 + params->KsTa * (ta - 25));
-                        
-            Sx = alphaCompensated * alphaCompensated * alphaCompensated * (irData + alphaCompensated * taTr);
-            Sx = sqrt(sqrt(Sx)) * params->ksTo[1];            
-            
-            To = sqrt(sqrt(irData/(alphaCompensated * (1 - params->ksTo[1] * 273.15) + Sx) + taTr)) - 273.15;                     
-                    
-            if(To < params->ct[1])
-            {
-                range = 0;
-            }
-            else if(To < params->ct[2])   
+            if(mode == 0)
             {
-                range = 1;            
-            }   
-            else if(To < params->ct[3])
-            {
-                range = 2;            
+              pattern = ilPattern; 
             }
-            else
+            else 
             {
-                range = 3;            
-            }      
+              pattern = chessPattern; 
+            }               
             
-            To = sqrt(sqrt(irData / (alphaCompensated * alphaCorrR[range] * (1 + params->ksTo[range] * (To - params->ct[range]))) + taTr)) - 273.15;
+            if(pattern == frameData[833])
+            {    
+                irData = (int16_t)frameData[pixelNumber] * env->gain;
+                
+                split = 2 * ilPattern + (column & 1);
+                irData = irData - PixelOffset(params, pixelNumber)*env->ktaFactor[split][PixelKtaCode(params, pixelNumber)]*env->kvFactor[split];
+                
+                if(mode !=  params->calibrationModeEE)
+                {
+                  irData = irData + params->ilChessC[2] * (2 * ilPattern - 1) - params->ilChessC[1] * conversionPattern; 
+                }                       
+        
+                irData = irData - irDataCP;
+                irData = irData / emissivity;
+                
+                alphaCompensated = env->alphaScale/params->alpha[pixelNumber];
+                alphaCompensated = alphaCompensated*env->ksTaFactor;
+                            
+                Sx = alphaCompensated * alphaCompensated * alphaCompensated * (irData + alphaCompensated * taTr);
+                Sx = sqrtf(sqrtf(Sx)) * params->ksTo[1];            
+                
+                To = sqrtf(sqrtf(irData/(alphaCompensated * alphaKsTo1 + Sx) + taTr)) - 273.15f;                     
                         
-            result[pixelNumber] = To;
+                if(To < params->ct[1])
+                {
+                    range = 0;
+                }
+                else if(To < params->ct[2])   
+                {
+                    range = 1;            
+                }   
+                else if(To < params->ct[3])
+                {
+                    range = 2;            
+                }
+                else
+                {
+                    range = 3;            
+                }      
+                
+                To = sqrtf(sqrtf(irData / (alphaCompensated * env->alphaCorrR[range] * (1 + params->ksTo[range] * (To - params->ct[range]))) + taTr)) - 273.15f;
+                            
+                result[pixelNumber] = To;
+            }
+        }
+    }
+}
+
+//------------------------------------------------------------------------------
+
+// Compensated IR signal divided by emissivity and the pixel's sensitivity.
+// Every pixel maps to the same temperature for the same signal, so this is
+// a monotonic, pixel-independent stand-in for To without the fourth roots.
+void MLX90640_GetSignalRegion(uint16_t *frameData, const paramsMLX90640 *params, const envMLX90640 *env, float emissivity, int firstLine, int lastLine, float *result)
+{
+    float irData;
+    float irDataCP;
+    float alphaCompensated;
+    uint8_t mode;
+    int8_t ilPattern;
+    int8_t chessPattern;
+    int8_t pattern;
+    int8_t conversionPattern;
+    uint16_t subPage;
+    int split;
+    int pixelNumber;
+    
+    subPage = frameData[833];
+    mode = env->mode;
+    irDataCP = params->tgc * env->irDataCP[subPage];
+    
+    for( int line = firstLine; line <= lastLine; line++)
+    {
+        for( int column = 0; column < MLX90640_COLUMN_NUM; column++)
+        {
+            pixelNumber = line * MLX90640_LINE_SIZE + column;
+            ilPattern = line & 1; 
+            chessPattern = ilPattern ^ (column & 1); 
+            conversionPattern = ((pixelNumber + 2) / 4 - (pixelNumber + 3) / 4 + (pixelNumber + 1) / 4 - pixelNumber / 4) * (1 - 2 * ilPattern);
+            pattern = (mode == 0) ? ilPattern : chessPattern;
+            
+            if(pattern == frameData[833])
+            {    
+                irData = (int16_t)frameData[pixelNumber] * env->gain;
+                
+                split = 2 * ilPattern + (column & 1);
+                irData = irData - PixelOffset(params, pixelNumber)*env->ktaFactor[split][PixelKtaCode(params, pixelNumber)]*env->kvFactor[split];
+                
+                if(mode !=  params->calibrationModeEE)
+                {
+                  irData = irData + params->ilChessC[2] * (2 * ilPattern - 1) - params->ilChessC[1] * conversionPattern; 
+                }                       
+        
+                irData = (irData - irDataCP) / emissivity;
+                alphaCompensated = env->alphaScale/params->alpha[pixelNumber] * env->ksTaFactor;
+                
+                result[pixelNumber] = irData / alphaCompensated;
+            }
         }
     }
 }
 
 //------------------------------------------------------------------------------
 
+// Same To formula as MLX90640_CalculateToRegion() written in terms of the
+// normalised signal: Sx / alphaCompensated = ksTo[1] * (signal + taTr)^(1/4)
+float MLX90640_SignalToTemperature(float signal, const paramsMLX90640 *params, const envMLX90640 *env, float emissivity, float tr)
+{
+    float tr4;
+    float taTr;
+    float Sx;
+    float To;
+    int8_t range;
+    
+    tr4 = (tr + 273.15f);
+    tr4 = tr4 * tr4;
+    tr4 = tr4 * tr4;
+    taTr = tr4 - (tr4-env->ta4)/emissivity;
+    
+    Sx = sqrtf(sqrtf(signal + taTr)) * params->ksTo[1];
+    To = sqrtf(sqrtf(signal/(1 - params->ksTo[1] * 273.15f + Sx) + taTr)) - 273.15f;
+    
+    if(To < params->ct[1])
+    {
+        range = 0;
+    }
+    else if(To < params->ct[2])   
+    {
+        range = 1;            
+    }   
+    else if(To < params->ct[3])
+    {
+        range = 2;            
+    }
+    else
+    {
+        range = 3;            
+    }      
+    
+    return sqrtf(sqrtf(signal / (env->alphaCorrR[range] * (1 + params->ksTo[range] * (To - params->ct[range]))) + taTr)) - 273.15f;
+}
+
+//------------------------------------------------------------------------------
+
 void MLX90640_GetImage(uint16_t *frameData, const paramsMLX90640 *params, float *result)
 {
     float vdd;
@@ -591,9 +914,9 @@ void MLX90640_GetImage(uint16_t *frameData, const paramsMLX90640 *params, float
         {    
             irData = (int16_t)frameData[pixelNumber] * gain;
             
-            kta = params->kta[pixelNumber]/ktaScale;
-            kv = params->kv[pixelNumber]/kvScale;
-            irData = irData - params->offset[pixelNumber]*(1 + kta*(ta - 25))*(1 + kv*(vdd - 3.3));
+            kta = PixelKta(params, pixelNumber)/ktaScale;
+            kv = MLX90640_GetPixelKv(params, pixelNumber)/kvScale;
+            irData = irData - PixelOffset(params, pixelNumber)*(1 + kta*(ta - 25))*(1 + kv*(vdd - 3.3));
 
             if(mode !=  params->calibrationModeEE)
             {
@@ -621,7 +944,7 @@ float MLX90640_GetVdd(uint16_t *frameData, const paramsMLX90640 *params)
     uint16_t resolutionRAM;  
     
     resolutionRAM = (frameData[832] & ~MLX90640_CTRL_RESOLUTION_MASK) >> MLX90640_CTRL_RESOLUTION_SHIFT;   
-    resolutionCorrection = POW2(params->resolutionEE) / POW2(resolutionRAM);
+    resolutionCorrection = POW2F((int)params->resolutionEE - (int)resolutionRAM);
     vdd = (resolutionCorrection * (int16_t)frameData[810] - params->vdd25) / params->kVdd + 3.3;
     
     return vdd;
@@ -630,19 +953,23 @@ float MLX90640_GetVdd(uint16_t *frameData, const paramsMLX90640 *params)
 //------------------------------------------------------------------------------
 
 float MLX90640_GetTa(uint16_t *frameData, const paramsMLX90640 *params)
+{
+    return GetTaFromVdd(frameData, params, MLX90640_GetVdd(frameData, params));
+}
+
+//------------------------------------------------------------------------------
+
+static float GetTaFromVdd(uint16_t *frameData, const paramsMLX90640 *params, float vdd)
 {
     int16_t ptat;
     float ptatArt;
-    float vdd;
     float ta;
     
-    vdd = MLX90640_GetVdd(frameData, params);
-    
     ptat = (int16_t)frameData[800];
     
-    ptatArt = (ptat / (ptat * params->alphaPTAT + (int16_t)frameData[768])) * POW2(18);
+    ptatArt = (ptat / (ptat * params->alphaPTAT + (int16_t)frameData[768])) * POW2F(18);
     
-    ta = (ptatArt / (1 + params->KvPTAT * (vdd - 3.3)) - params->vPTAT25);
+    ta = (ptatArt / (1 + params->KvPTAT * (vdd - 3.3f)) - params->vPTAT25);
     ta = ta / params->KtPTAT + 25;
     
     return ta;
@@ -1019,20 +1346,26 @@ static void ExtractOffsetParameters(uint16_t *eeData, paramsMLX90640 *mlx90640)
         }
     }
 
+    // offset = offsetRef + row + column + delta * 2^occRemScale, summed in
+    // int16 as the Melexis code does; PixelOffset() adds the terms back up
     for(int i = 0; i < MLX90640_LINE_NUM; i++)
     {
-        for(int j = 0; j < MLX90640_COLUMN_NUM; j ++)
+        mlx90640->offsetRow[i] = (int16_t)(offsetRef + (occRow[i] << occRowScale));
+    }
+    for(int j = 0; j < MLX90640_COLUMN_NUM; j++)
+    {
+        mlx90640->offsetColumn[j] = (int16_t)(occColumn[j] << occColumnScale);
+    }
+    
+    for(p = 0; p < MLX90640_PIXEL_NUM; p++)
+    {
+        mlx90640->offsetDelta[p] = (eeData[64 + p] & MLX90640_MSBITS_6_MASK) >> 10;
+        if (mlx90640->offsetDelta[p] > 31)
         {
-            p = 32 * i +j;
-            mlx90640->offset[p] = (eeData[64 + p] & MLX90640_MSBITS_6_MASK) >> 10;
-            if (mlx90640->offset[p] > 31)
-            {
-                mlx90640->offset[p] = mlx90640->offset[p] - 64;
-            }
-            mlx90640->offset[p] = mlx90640->offset[p]*(1 << occRemScale);
-            mlx90640->offset[p] = (offsetRef + (occRow[i] << occRowScale) + (occColumn[j] << occColumnScale) + mlx90640->offset[p]);
+            mlx90640->offsetDelta[p] = mlx90640->offsetDelta[p] - 64;
         }
     }
+    mlx90640->offsetRemScale = occRemScale;
 }
 
 //------------------------------------------------------------------------------
@@ -1044,7 +1377,9 @@ static void ExtractKtaPixelParameters(uint16_t *eeData, paramsMLX90640 *mlx90640
     uint8_t ktaScale1;
     uint8_t ktaScale2;
     uint8_t split;
-    float ktaTemp[768];
+    uint8_t code;
+    uint8_t used[4][8];
+    float ktaTemp[4][8];
     float temp;
     
     KtaRC[0] = (int8_t)MLX90640_MS_BYTE(eeData[54]);;
@@ -1055,30 +1390,37 @@ static void ExtractKtaPixelParameters(uint16_t *eeData, paramsMLX90640 *mlx90640
     ktaScale1 = MLX90640_NIBBLE2(eeData[56]) + 8;
     ktaScale2 = MLX90640_NIBBLE1(eeData[56]);
 
-    for(int i = 0; i < MLX90640_LINE_NUM; i++)
+    // A pixel's kta depends only on its row/column parity (split) and its
+    // 3-bit code, so work on the 32 combinations and keep a code per pixel
+    memset(used, 0, sizeof(used));
+    memset(mlx90640->ktaCode, 0, sizeof(mlx90640->ktaCode));
+    for(p = 0; p < MLX90640_PIXEL_NUM; p++)
     {
-        for(int j = 0; j < MLX90640_COLUMN_NUM; j ++)
-        {
-            p = 32 * i +j;
-            split = 2*(p/32 - (p/64)*2) + p%2;
-            ktaTemp[p] = (eeData[64 + p] & 0x000E) >> 1;
-            if (ktaTemp[p] > 3)
-            {
-                ktaTemp[p] = ktaTemp[p] - 8;
-            }
-            ktaTemp[p] = ktaTemp[p] * (1 << ktaScale2);
-            ktaTemp[p] = KtaRC[split] + ktaTemp[p];
-            ktaTemp[p] = ktaTemp[p] / POW2(ktaScale1);
-            
-        }
+        split = 2*(p/32 - (p/64)*2) + p%2;
+        code = (eeData[64 + p] & 0x000E) >> 1;
+        used[split][code] = 1;
+        mlx90640->ktaCode[p >> 1] |= code << ((p & 1) * 4);
     }
     
-    temp = fabs(ktaTemp[0]);
-    for(int i = 1; i < MLX90640_PIXEL_NUM; i++)
+    temp = 0;
+    for(split = 0; split < 4; split++)
     {
-        if (fabs(ktaTemp[i]) > temp)
+        for(code = 0; code < 8; code++)
         {
-            temp = fabs(ktaTemp[i]);
+            ktaTemp[split][code] = code;
+            if (ktaTemp[split][code] > 3)
+            {
+                ktaTemp[split][code] = ktaTemp[split][code] - 8;
+            }
+            ktaTemp[split][code] = ktaTemp[split][code] * (1 << ktaScale2);
+            ktaTemp[split][code] = KtaRC[split] + ktaTemp[split][code];
+            ktaTemp[split][code] = ktaTemp[split][code] / POW2(ktaScale1);
+            
+            // Scale to the largest kta any pixel uses
+            if (used[split][code] && fabs(ktaTemp[split][code]) > temp)
+            {
+                temp = fabs(ktaTemp[split][code]);
+            }
         }
     }
     
@@ -1089,18 +1431,24 @@ static void ExtractKtaPixelParameters(uint16_t *eeData, paramsMLX90640 *mlx90640
         ktaScale1 = ktaScale1 + 1;
     }    
      
-    for(int i = 0; i < MLX90640_PIXEL_NUM; i++)
+    for(split = 0; split < 4; split++)
     {
-        temp = ktaTemp[i] * POW2(ktaScale1);
-        if (temp < 0)
+        for(code = 0; code < 8; code++)
         {
-            mlx90640->kta[i] = (temp - 0.5);
+            temp = ktaTemp[split][code] * POW2(ktaScale1);
+            if (!used[split][code])
+            {
+                mlx90640->ktaTable[split][code] = 0;
+            }
+            else if (temp < 0)
+            {
+                mlx90640->ktaTable[split][code] = (temp - 0.5);
+            }
+            else
+            {
+                mlx90640->ktaTable[split][code] = (temp + 0.5);
+            }        
         }
-        else
-        {
-            mlx90640->kta[i] = (temp + 0.5);
-        }        
-        
     } 
     
     mlx90640->ktaScale = ktaScale1;           
@@ -1111,15 +1459,13 @@ static void ExtractKtaPixelParameters(uint16_t *eeData, paramsMLX90640 *mlx90640
 
 static void ExtractKvPixelParameters(uint16_t *eeData, paramsMLX90640 *mlx90640)
 {
-    int p = 0;
     int8_t KvT[4];
     int8_t KvRoCo;
     int8_t KvRoCe;
     int8_t KvReCo;
     int8_t KvReCe;
     uint8_t kvScale;
-    uint8_t split;
-    float kvTemp[768];
+    float kvTemp[4];
     float temp;
 
     KvRoCo = MLX90640_NIBBLE4(eeData[52]);
@@ -1152,24 +1498,19 @@ static void ExtractKvPixelParameters(uint16_t *eeData, paramsMLX90640 *mlx90640)
   
     kvScale = MLX90640_NIBBLE3(eeData[56]);
 
-
-    for(int i = 0; i < MLX90640_LINE_NUM; i++)
+    // kv depends only on the row/column parity, and every parity has pixels
+    for(int split = 0; split < 4; split++)
     {
-        for(int j = 0; j < MLX90640_COLUMN_NUM; j ++)
-        {
-            p = 32 * i +j;
-            split = 2*(p/32 - (p/64)*2) + p%2;
-            kvTemp[p] = KvT[split];
-            kvTemp[p] = kvTemp[p] / POW2(kvScale);
-        }
+        kvTemp[split] = KvT[split];
+        kvTemp[split] = kvTemp[split] / POW2(kvScale);
     }
     
     temp = fabs(kvTemp[0]);
-    for(int i = 1; i < MLX90640_PIXEL_NUM; i++)
+    for(int split = 1; split < 4; split++)
     {
-        if (fabs(kvTemp[i]) > temp)
+        if (fabs(kvTemp[split]) > temp)
         {
-            temp = fabs(kvTemp[i]);
+            temp = fabs(kvTemp[split]);
         }
     }
     
@@ -1180,16 +1521,16 @@ static void ExtractKvPixelParameters(uint16_t *eeData, paramsMLX90640 *mlx90640)
         kvScale = kvScale + 1;
     }    
      
-    for(int i = 0; i < MLX90640_PIXEL_NUM; i++)
+    for(int split = 0; split < 4; split++)
     {
-        temp = kvTemp[i] * POW2(kvScale);
+        temp = kvTemp[split] * POW2(kvScale);
         if (temp < 0)
         {
-            mlx90640->kv[i] = (temp - 0.5);
+            mlx90640->kv[split] = (temp - 0.5);
         }
         else
         {
-            mlx90640->kv[i] = (temp + 0.5);
+            mlx90640->kv[split] = (temp + 0.5);
         }        
         
     } 
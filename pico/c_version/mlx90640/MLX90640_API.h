@@ -74,6 +74,7 @@
 #define MLX90640_NIBBLE4(reg16) ((reg16 & MLX90640_NIBBLE4_MASK) >> 12)
 
 #define POW2(x) pow(2, (double)x) 
+#define POW2F(x) ldexpf(1.0f, (x))
 
 #define SCALEALPHA 0.000001
     
@@ -96,10 +97,17 @@ typedef struct
         int16_t ct[5];
         uint16_t alpha[768];    
         uint8_t alphaScale;
-        int16_t offset[768];    
-        int8_t kta[768];
+        // Offset, kta and kv are kept in the EEPROM's own structure rather
+        // than as 768-entry tables: MLX90640_GetPixelOffset/Kta/Kv() give
+        // the same values the Melexis tables held
+        int16_t offsetRow[24];      // offsetRef + row term
+        int16_t offsetColumn[32];   // Column term
+        int8_t offsetDelta[768];    // Per-pixel term, before the remainder scale
+        uint8_t offsetRemScale;
+        int8_t ktaTable[4][8];      // kta per row/column parity and pixel code
+        uint8_t ktaCode[384];       // 3-bit pixel codes, two pixels per byte
         uint8_t ktaScale;    
-        int8_t kv[768];
+        int8_t kv[4];               // kv per row/column parity
         uint8_t kvScale;
         float cpAlpha[2];
         int16_t cpOffset[2];
@@ -107,6 +115,37 @@ typedef struct
         uint16_t brokenPixels[5];
         uint16_t outlierPixels[5];  
     } paramsMLX90640;
+
+    // Slowly varying terms shared by every pixel of a subpage, updated once
+    // per subpage by MLX90640_UpdateEnvironment()
+    typedef struct
+    {
+        float vdd;
+        float ta;
+        float gain;
+        float irDataCP[2];      // Compensated CP per subpage
+        float taDelta;          // Ta - 25
+        float vddDelta;         // Vdd - 3.3
+        float ta4;              // (Ta + 273.15)^4
+        float ksTaFactor;       // 1 + KsTa * (Ta - 25)
+        float ktaScale;         // 1 / 2^ktaScale
+        float kvScale;          // 1 / 2^kvScale
+        float alphaScale;       // SCALEALPHA * 2^alphaScale
+        float alphaCorrR[4];
+        float ktaFactor[4][8];  // 1 + kta * taDelta per ktaTable entry
+        float kvFactor[4];      // 1 + kv * vddDelta per row/column parity
+        float smoothing;        // Weight of each new sample (1 = no smoothing)
+        uint8_t mode;
+        uint8_t valid;
+    } envMLX90640;
+    
+    typedef struct
+    {
+        uint32_t reads;         // Control register reads from the sensor
+        uint32_t readsSkipped;  // Per-subpage reads served from the shadow
+        uint32_t writes;        // Control register writes
+        uint32_t changes;       // Set* calls staged
+    } ctrlStatsMLX90640;
     
     int MLX90640_DumpEE(uint8_t slaveAddr, uint16_t *eeData);
     int MLX90640_SynchFrame(uint8_t slaveAddr);
@@ -116,7 +155,21 @@ typedef struct
     float MLX90640_GetVdd(uint16_t *frameData, const paramsMLX90640 *params);
     float MLX90640_GetTa(uint16_t *frameData, const paramsMLX90640 *params);
     void MLX90640_GetImage(uint16_t *frameData, const paramsMLX90640 *params, float *result);
+    int16_t MLX90640_GetPixelOffset(const paramsMLX90640 *params, int pixelNumber);
+    int8_t MLX90640_GetPixelKta(const paramsMLX90640 *params, int pixelNumber);
+    int8_t MLX90640_GetPixelKv(const paramsMLX90640 *params, int pixelNumber);
     void MLX90640_CalculateTo(uint16_t *frameData, const paramsMLX90640 *params, float emissivity, float tr, float *result);
+    void MLX90640_InitEnvironment(envMLX90640 *env, float smoothing);
+    void MLX90640_UpdateEnvironment(uint16_t *frameData, const paramsMLX90640 *params, envMLX90640 *env);
+    void MLX90640_CalculateToEnv(uint16_t *frameData, const paramsMLX90640 *params, const envMLX90640 *env, float emissivity, float tr, float *result);
+    void MLX90640_CalculateToRegion(uint16_t *frameData, const paramsMLX90640 *params, const envMLX90640 *env, float emissivity, float tr, int firstLine, int lastLine, int firstColumn, int lastColumn, float *result);
+    void MLX90640_GetSignalRegion(uint16_t *frameData, const paramsMLX90640 *params, const envMLX90640 *env, float emissivity, int firstLine, int lastLine, float *result);
+    float MLX90640_SignalToTemperature(float signal, const paramsMLX90640 *params, const envMLX90640 *env, float emissivity, float tr);
+    // Set* calls stage changes in a shadow of the control register; they are
+    // written together by MLX90640_ApplyControlRegister() (returns 1 if it
+    // wrote) or at the end of the next MLX90640_GetFrameData()
+    int MLX90640_ApplyControlRegister(uint8_t slaveAddr);
+    void MLX90640_GetControlStats(ctrlStatsMLX90640 *stats);
     int MLX90640_SetResolution(uint8_t slaveAddr, uint8_t resolution);
     int MLX90640_GetCurResolution(uint8_t slaveAddr);
     int MLX90640_SetRefreshRate(uint8_t slaveAddr, uint8_t refreshRate);   
@@ -23,6 +23,39 @@ void MLX90640_I2CInit(void) {
     gpio_pull_up(I2C_SCL_PIN);
 }
 
+// Free a bus left mid-transfer by a reset: a sensor still driving SDA low
+// lets go once it has clocked out its byte, so pulse SCL up to 9 times
+// and then send a STOP. Call before MLX90640_I2CInit().
+void MLX90640_I2CRecoverBus(void) {
+    gpio_init(I2C_SDA_PIN);
+    gpio_init(I2C_SCL_PIN);
+    gpio_pull_up(I2C_SDA_PIN);
+    gpio_pull_up(I2C_SCL_PIN);
+    gpio_set_dir(I2C_SDA_PIN, GPIO_IN);
+
+    // Open drain: drive low, or release to the pull-up
+    gpio_put(I2C_SCL_PIN, 0);
+    gpio_set_dir(I2C_SCL_PIN, GPIO_IN);
+    sleep_us(5);
+
+    for (int i = 0; i < 9 && !gpio_get(I2C_SDA_PIN); i++) {
+        gpio_set_dir(I2C_SCL_PIN, GPIO_OUT);
+        sleep_us(5);
+        gpio_set_dir(I2C_SCL_PIN, GPIO_IN);
+        sleep_us(5);
+    }
+
+    // STOP: SDA rises while SCL is high
+    gpio_put(I2C_SDA_PIN, 0);
+    gpio_set_dir(I2C_SCL_PIN, GPIO_OUT);
+    gpio_set_dir(I2C_SDA_PIN, GPIO_OUT);
+    sleep_us(5);
+    gpio_set_dir(I2C_SCL_PIN, GPIO_IN);
+    sleep_us(5);
+    gpio_set_dir(I2C_SDA_PIN, GPIO_IN);
+    sleep_us(5);
+}
+
 int MLX90640_I2CRead(uint8_t slaveAddr, uint16_t startAddress, uint16_t nWordsRead, uint16_t *data) {
     // For large reads (like EEPROM dump), split into chunks to avoid timeout
     // MLX90640 EEPROM is 832 words, which is 1664 bytes - too large for one transaction
@@ -92,6 +125,22 @@ int MLX90640_I2CWrite(uint8_t slaveAddr, uint16_t writeAddress, uint16_t data) {
     return 0;
 }
 
+// I2C general call reset (address 0x00, command 0x06), used by
+// MLX90640_TriggerMeasurement(). Resets every device on the bus that
+// honours it.
+int MLX90640_I2CGeneralReset(void) {
+    uint8_t cmd = 0x06;
+
+    int result = i2c_write_blocking(i2c, 0x00, &cmd, 1, false);
+    if (result < 0) {
+        return -1;
+    }
+
+    sleep_us(50);
+
+    return 0;
+}
+
 void MLX90640_I2CFreqSet(int freq) {
     i2c_set_baudrate(i2c, freq);
 }
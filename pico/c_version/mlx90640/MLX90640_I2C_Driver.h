@@ -13,8 +13,10 @@ extern "C" {
 #endif
 
 void MLX90640_I2CInit(void);
+void MLX90640_I2CRecoverBus(void);
 int MLX90640_I2CRead(uint8_t slaveAddr, uint16_t startAddress, uint16_t nWordsRead, uint16_t *data);
 int MLX90640_I2CWrite(uint8_t slaveAddr, uint16_t writeAddress, uint16_t data);
+int MLX90640_I2CGeneralReset(void);
 void MLX90640_I2CFreqSet(int freq);
 
 #ifdef __cplusplus
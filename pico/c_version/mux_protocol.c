@@ -0,0 +1,119 @@
+/**
+ * mux_protocol.c
+ * Binary multiplexed serial protocol (firmware and host)
+ */
+
+#include "mux_protocol.h"
+#include <math.h>
+#include <string.h>
+
+uint16_t mux_crc16(const uint8_t *data, uint16_t len, uint16_t crc) {
+    for (uint16_t i = 0; i < len; i++) {
+        crc ^= (uint16_t)data[i] << 8;
+        for (int b = 0; b < 8; b++) {
+            crc = (crc & 0x8000) ? (uint16_t)((crc << 1) ^ 0x1021) : (uint16_t)(crc << 1);
+        }
+    }
+    return crc;
+}
+
+uint16_t mux_frame_encode(uint8_t channel, uint8_t type, uint8_t seq, const uint8_t *payload,
+                          uint16_t len, uint8_t *out, uint16_t max_len) {
+    if (len > MUX_MAX_PAYLOAD || len + MUX_OVERHEAD > max_len) return 0;
+
+    out[0] = MUX_SYNC;
+    out[1] = channel;
+    out[2] = type;
+    out[3] = seq;
+    mux_put_u16(out + 4, len);
+    if (len > 0) memcpy(out + MUX_HEADER_BYTES, payload, len);
+    mux_put_u16(out + MUX_HEADER_BYTES + len, mux_crc16(out + 1, MUX_HEADER_BYTES - 1 + len, 0xFFFF));
+    return len + MUX_OVERHEAD;
+}
+
+int32_t mux_frame_check(const uint8_t *buf, uint32_t avail, MuxMessage *msg) {
+    if (avail == 0) return 0;
+    if (buf[0] != MUX_SYNC) return -1;
+    if (avail >= 2 && buf[1] >= MUX_CHANNELS) return -1;
+    if (avail < MUX_HEADER_BYTES) return 0;
+
+    uint16_t len = mux_get_u16(buf + 4);
+    if (len > MUX_MAX_PAYLOAD) return -1;
+    uint32_t total = (uint32_t)len + MUX_OVERHEAD;
+    if (avail < total) return 0;
+
+    uint16_t crc = mux_crc16(buf + 1, MUX_HEADER_BYTES - 1 + len, 0xFFFF);
+    if (crc != mux_get_u16(buf + MUX_HEADER_BYTES + len)) return -1;
+
+    msg->channel = buf[1];
+    msg->type = buf[2];
+    msg->seq = buf[3];
+    msg->len = len;
+    msg->payload = buf + MUX_HEADER_BYTES;
+    return (int32_t)total;
+}
+
+static int16_t to_tenths(float value) {
+    if (!isfinite(value)) return 0;
+    float t = value * 10.0f;
+    if (t > 32767.0f) return 32767;
+    if (t < -32767.0f) return -32767;
+    return (int16_t)t;
+}
+
+static uint8_t to_percent(float value) {
+    if (!(value > 0.0f)) return 0;
+    return value >= 1.0f ? 100 : (uint8_t)(value * 100.0f + 0.5f);
+}
+
+static void pack_zone(const ZoneAnalysis *zone, uint8_t *out) {
+    mux_put_u16(out, (uint16_t)to_tenths(zone->avg));
+    mux_put_u16(out + 2, (uint16_t)to_tenths(zone->median));
+    mux_put_u16(out + 4, (uint16_t)to_tenths(zone->mad));
+    mux_put_u16(out + 6, (uint16_t)to_tenths(zone->min));
+    mux_put_u16(out + 8, (uint16_t)to_tenths(zone->max));
+}
+
+static void unpack_zone(const uint8_t *in, ZoneAnalysis *zone) {
+    zone->avg = (int16_t)mux_get_u16(in) / 10.0f;
+    zone->median = (int16_t)mux_get_u16(in + 2) / 10.0f;
+    zone->mad = (int16_t)mux_get_u16(in + 4) / 10.0f;
+    zone->min = (int16_t)mux_get_u16(in + 6) / 10.0f;
+    zone->max = (int16_t)mux_get_u16(in + 8) / 10.0f;
+    zone->range = zone->max - zone->min;
+    zone->count = 0;
+}
+
+void mux_pack_frame(const FrameData *data, float fps, uint8_t *out) {
+    mux_put_u32(out, data->frame_number);
+    mux_put_u16(out + 4, (uint16_t)(isfinite(fps) && fps > 0.0f ? fps * 10.0f : 0.0f));
+    pack_zone(&data->left, out + 6);
+    pack_zone(&data->centre, out + 16);
+    pack_zone(&data->right, out + 26);
+    mux_put_u16(out + 36, (uint16_t)to_tenths(data->lateral_gradient));
+    out[38] = data->detection.span_start;
+    out[39] = data->detection.span_end;
+    out[40] = data->detection.tyre_width;
+    out[41] = to_percent(data->detection.confidence);
+    out[42] = data->detection.detected ? 1 : 0;
+    out[43] = data->warnings;
+}
+
+bool mux_unpack_frame(const uint8_t *data, uint16_t len, FrameData *frame, float *fps) {
+    if (len < MUX_FRAME_BYTES) return false;
+
+    memset(frame, 0, sizeof(*frame));
+    frame->frame_number = mux_get_u32(data);
+    *fps = mux_get_u16(data + 4) / 10.0f;
+    unpack_zone(data + 6, &frame->left);
+    unpack_zone(data + 16, &frame->centre);
+    unpack_zone(data + 26, &frame->right);
+    frame->lateral_gradient = (int16_t)mux_get_u16(data + 36) / 10.0f;
+    frame->detection.span_start = data[38];
+    frame->detection.span_end = data[39];
+    frame->detection.tyre_width = data[40];
+    frame->detection.confidence = data[41] / 100.0f;
+    frame->detection.detected = data[42] != 0;
+    frame->warnings = data[43];
+    return true;
+}
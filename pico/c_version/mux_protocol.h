@@ -0,0 +1,137 @@
+/**
+ * mux_protocol.h
+ * Binary multiplexed serial protocol (firmware and host)
+ *
+ * In OUTPUT_MODE_USB_BINARY the USB serial stream carries framed
+ * messages on four logical channels instead of text. Diagnostics travel
+ * as small binary events and the host formats them, so they no longer
+ * get mixed into the data. Frame layout (little-endian):
+ *
+ *   offset  size  field
+ *   0       1     MUX_SYNC (0xA5, never in the ASCII text around frames)
+ *   1       1     channel (MuxChannel)
+ *   2       1     message type, per channel
+ *   3       1     sequence number, per channel (host counts gaps)
+ *   4       2     payload length (<= MUX_MAX_PAYLOAD)
+ *   6       n     payload
+ *   6+n     2     CRC-16/CCITT-FALSE of bytes 1..5+n
+ *
+ * Bytes outside a valid frame are text (the startup banner, output from
+ * before the mode switch). The host passes them through as lines.
+ *
+ * Commands from the host use the same framing on MUX_CHANNEL_COMMAND,
+ * and the reply has type | MUX_RESPONSE with the command's sequence.
+ */
+
+#ifndef MUX_PROTOCOL_H
+#define MUX_PROTOCOL_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "thermal_algorithm.h"
+
+#define MUX_SYNC 0xA5
+#define MUX_PROTOCOL_VERSION 1
+#define MUX_HEADER_BYTES 6
+#define MUX_CRC_BYTES 2
+#define MUX_OVERHEAD (MUX_HEADER_BYTES + MUX_CRC_BYTES)
+#define MUX_MAX_PAYLOAD 1280    // One frame_codec packet plus headroom
+#define MUX_MAX_FRAME (MUX_MAX_PAYLOAD + MUX_OVERHEAD)
+
+// Channels. Queued output is sent in MuxChannel priority order:
+// command responses, then data, diagnostics and trace.
+typedef enum {
+    MUX_CHANNEL_DATA = 0,
+    MUX_CHANNEL_DIAG = 1,
+    MUX_CHANNEL_TRACE = 2,
+    MUX_CHANNEL_COMMAND = 3,
+    MUX_CHANNELS = 4
+} MuxChannel;
+
+// MUX_CHANNEL_DATA
+#define MUX_DATA_FRAME 0x01         // MUX_FRAME_BYTES, mux_pack_frame()
+#define MUX_DATA_IMAGE 0x02         // frame_codec packet
+#define MUX_DATA_HISTOGRAMS 0x03    // zone_histogram_pack() packet
+
+// MUX_CHANNEL_DIAG events
+#define MUX_DIAG_FRAME_TIMING 0x01  // u32 frame, u32 total/sensor/calc/algo/comm µs
+#define MUX_DIAG_ERROR 0x02         // u8 MuxError, i32 value
+#define MUX_DIAG_RATE_CHANGE 0x03   // u8 old rate code, u8 new rate code
+#define MUX_DIAG_PIXEL_HEALTH 0x04  // u16 flagged, stuck, noisy, dead
+#define MUX_DIAG_DETECT_CYCLES 0x05 // u8 engine, u32 last, min, max
+#define MUX_DIAG_SHADOW 0x06        // MUX_SHADOW_BYTES: u16 compared, dropped; u8 agreement %,
+                                    // IoU %; u16 production only, candidate only, zone
+                                    // delta L/C/R and max (tenths °C); u8 production and
+                                    // candidate confidence %; u32 last and max core 1 µs
+#define MUX_DIAG_DROPS 0x07         // u32 dropped messages per channel
+
+// MUX_CHANNEL_TRACE
+#define MUX_TRACE_PIPELINE 0x01     // u8 stages, then per stage: u8 name length,
+                                    // name, u32 runs, u16 divider, u32 avg µs, u32 max µs
+
+// MUX_CHANNEL_COMMAND
+#define MUX_CMD_PING 0x01           // -> u8 firmware version, u8 protocol version
+#define MUX_CMD_READ_REGS 0x02      // u8 first, u8 count -> u8 first, register bytes
+                                    // (count clamped to MUX_READ_REGS_MAX)
+#define MUX_CMD_WRITE_REG 0x03      // u8 register, u8 value -> u8 register, u8 value, u8 status
+#define MUX_RESPONSE 0x80
+
+// Most registers one MUX_CMD_READ_REGS reply returns, so the reply fits
+// the firmware's 256-byte command queue
+#define MUX_READ_REGS_MAX 247
+
+// MUX_DIAG_ERROR codes
+typedef enum {
+    MUX_ERROR_FRAME_READ = 1,       // value: MLX90640_GetFrameData status
+    MUX_ERROR_FRAME_POOL = 2,       // value: exhausted count
+    MUX_ERROR_CONTROL_WRITE = 3
+} MuxError;
+
+#define MUX_FRAME_BYTES 44
+#define MUX_SHADOW_BYTES 28
+
+typedef struct {
+    uint8_t channel;
+    uint8_t type;
+    uint8_t seq;
+    uint16_t len;
+    const uint8_t *payload;
+} MuxMessage;
+
+// CRC-16/CCITT-FALSE (poly 0x1021, init 0xFFFF)
+uint16_t mux_crc16(const uint8_t *data, uint16_t len, uint16_t crc);
+
+// Frame a message. Returns the frame length, or 0 if it exceeds max_len.
+uint16_t mux_frame_encode(uint8_t channel, uint8_t type, uint8_t seq, const uint8_t *payload,
+                          uint16_t len, uint8_t *out, uint16_t max_len);
+
+// Check for a frame at the start of buf. Returns its length with msg
+// filled in, 0 if more bytes are needed, or -1 if buf doesn't start with
+// a valid frame (skip a byte and look again).
+int32_t mux_frame_check(const uint8_t *buf, uint32_t avail, MuxMessage *msg);
+
+// MUX_DATA_FRAME payload: frame number, fps and every FrameData field
+// except the zone pixel counts, temperatures as int16 tenths
+void mux_pack_frame(const FrameData *data, float fps, uint8_t *out);
+bool mux_unpack_frame(const uint8_t *data, uint16_t len, FrameData *frame, float *fps);
+
+// Little-endian field helpers
+static inline void mux_put_u16(uint8_t *p, uint16_t v) {
+    p[0] = v & 0xFF;
+    p[1] = v >> 8;
+}
+
+static inline void mux_put_u32(uint8_t *p, uint32_t v) {
+    mux_put_u16(p, v & 0xFFFF);
+    mux_put_u16(p + 2, v >> 16);
+}
+
+static inline uint16_t mux_get_u16(const uint8_t *p) {
+    return (uint16_t)(p[0] | (p[1] << 8));
+}
+
+static inline uint32_t mux_get_u32(const uint8_t *p) {
+    return mux_get_u16(p) | ((uint32_t)mux_get_u16(p + 2) << 16);
+}
+
+#endif // MUX_PROTOCOL_H
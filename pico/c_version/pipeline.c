@@ -0,0 +1,109 @@
+/**
+ * pipeline.c
+ * Static multi-rate task graph for the per-subpage frame pipeline
+ */
+
+#include "pipeline.h"
+#include <stdio.h>
+#include <string.h>
+#include "pico/time.h"
+#include "mux_protocol.h"
+
+bool pipeline_init(Pipeline *pipe, PipelineStage *stages, uint8_t count) {
+    if (count > PIPELINE_MAX_STAGES) return false;
+
+    for (uint8_t i = 0; i < count; i++) {
+        // Dependencies must come earlier in the table
+        if (stages[i].deps >> i) return false;
+
+        stages[i].runs = 0;
+        stages[i].last_us = 0;
+        stages[i].max_us = 0;
+        stages[i].total_us = 0;
+    }
+
+    pipe->stages = stages;
+    pipe->count = count;
+    pipe->tick = 0;
+    pipe->ready = 0;
+    pipe->ran = 0;
+    return true;
+}
+
+uint32_t pipeline_tick(Pipeline *pipe, void *ctx) {
+    uint32_t ran = 0;
+
+    for (uint8_t i = 0; i < pipe->count; i++) {
+        PipelineStage *stage = &pipe->stages[i];
+
+        if (stage->divider == 0 || pipe->tick % stage->divider != 0) continue;
+        if ((stage->deps & pipe->ready) != stage->deps) continue;
+
+        uint32_t t0 = time_us_32();
+        stage->run(ctx);
+        uint32_t elapsed = time_us_32() - t0;
+
+        stage->runs++;
+        stage->last_us = elapsed;
+        stage->total_us += elapsed;
+        if (elapsed > stage->max_us) stage->max_us = elapsed;
+
+        ran |= STAGE_BIT(i);
+        pipe->ready |= STAGE_BIT(i);  // Later stages may use it this tick
+    }
+
+    pipe->ran = ran;
+    pipe->tick++;
+    return ran;
+}
+
+void pipeline_set_divider(Pipeline *pipe, uint8_t stage, uint16_t divider) {
+    if (stage < pipe->count) pipe->stages[stage].divider = divider;
+}
+
+uint32_t pipeline_elapsed_us(const Pipeline *pipe, uint32_t mask) {
+    uint32_t total = 0;
+    mask &= pipe->ran;
+
+    for (uint8_t i = 0; i < pipe->count; i++) {
+        if (mask & STAGE_BIT(i)) total += pipe->stages[i].last_us;
+    }
+    return total;
+}
+
+void pipeline_print_stats(Pipeline *pipe) {
+    // [Pipeline] name: runs (1/divider) avg/max ms | ...
+    printf("[Pipeline]");
+    for (uint8_t i = 0; i < pipe->count; i++) {
+        PipelineStage *stage = &pipe->stages[i];
+        float avg_ms = stage->runs ? (stage->total_us / (float)stage->runs) / 1000.0f : 0.0f;
+
+        printf("%s %s: %lu (1/%u) %.2f/%.2fms", i ? " |" : "", stage->name,
+               (unsigned long)stage->runs, stage->divider, avg_ms, stage->max_us / 1000.0f);
+        stage->max_us = 0;
+    }
+    printf("\n");
+}
+
+uint16_t pipeline_pack_stats(Pipeline *pipe, uint8_t *out, uint16_t max_len) {
+    if (max_len < 1) return 0;
+    uint16_t n = 1;
+    out[0] = pipe->count;
+
+    for (uint8_t i = 0; i < pipe->count; i++) {
+        PipelineStage *stage = &pipe->stages[i];
+        uint8_t name_len = (uint8_t)strlen(stage->name);
+        if (n + 1u + name_len + 14u > max_len) return 0;
+
+        out[n++] = name_len;
+        memcpy(out + n, stage->name, name_len);
+        n += name_len;
+        mux_put_u32(out + n, stage->runs);
+        mux_put_u16(out + n + 4, stage->divider);
+        mux_put_u32(out + n + 6, stage->runs ? (uint32_t)(stage->total_us / stage->runs) : 0);
+        mux_put_u32(out + n + 10, stage->max_us);
+        n += 14;
+        stage->max_us = 0;
+    }
+    return n;
+}
@@ -0,0 +1,65 @@
+/**
+ * pipeline.h
+ * Static multi-rate task graph for the per-subpage frame pipeline
+ *
+ * Stages are listed in dependency order in a fixed table. Every tick (one
+ * sensor subpage) each stage whose divider is due runs, provided all of
+ * its dependencies have produced output at least once. Expensive stages
+ * (span detection) use a larger divider and their last output is reused
+ * by the cheap stages that run every tick.
+ */
+
+#ifndef PIPELINE_H
+#define PIPELINE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define PIPELINE_MAX_STAGES 16
+#define STAGE_BIT(id) (1u << (id))
+
+typedef void (*PipelineStageFn)(void *ctx);
+
+typedef struct {
+    const char *name;
+    PipelineStageFn run;
+    uint16_t divider;       // Run every Nth tick (0 = disabled)
+    uint32_t deps;          // STAGE_BIT() mask of stages whose output this reads
+
+    // Telemetry (owned by pipeline.c)
+    uint32_t runs;
+    uint32_t last_us;
+    uint32_t max_us;
+    uint64_t total_us;
+} PipelineStage;
+
+typedef struct {
+    PipelineStage *stages;
+    uint8_t count;
+    uint32_t tick;
+    uint32_t ready;         // Stages that have produced output
+    uint32_t ran;           // Stages that ran on the last tick
+} Pipeline;
+
+// Set up a pipeline over a static stage table. Returns false if a stage
+// depends on itself or on a later stage (the table must be topological).
+bool pipeline_init(Pipeline *pipe, PipelineStage *stages, uint8_t count);
+
+// Run every due stage once, in table order. Returns the STAGE_BIT() mask
+// of stages that ran.
+uint32_t pipeline_tick(Pipeline *pipe, void *ctx);
+
+// Change a stage's divider; it next runs when the tick count is a multiple
+void pipeline_set_divider(Pipeline *pipe, uint8_t stage, uint16_t divider);
+
+// Sum of last-run times of the stages in mask that ran on the last tick
+uint32_t pipeline_elapsed_us(const Pipeline *pipe, uint32_t mask);
+
+// Print per-stage run counts and timing, then reset max times
+void pipeline_print_stats(Pipeline *pipe);
+
+// The same statistics packed for the binary serial link (MUX_TRACE_PIPELINE),
+// then reset max times. Returns the packed length, or 0 if out is too small.
+uint16_t pipeline_pack_stats(Pipeline *pipe, uint8_t *out, uint16_t max_len);
+
+#endif // PIPELINE_H
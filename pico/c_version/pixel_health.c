@@ -0,0 +1,359 @@
+/**
+ * pixel_health.c
+ * Online stuck/noisy/dead pixel detection
+ */
+
+#include "pixel_health.h"
+#include <stdlib.h>
+#include <string.h>
+
+// Pixel values are tracked in hundredths of a degree, Q4 fixed point
+#define VALUE_SCALE 1600.0f
+
+// Largest per-sample deviation used in the variance update (centi-°C),
+// keeps the products inside 32 bits
+#define DELTA_LIMIT 4096
+#define INCR_LIMIT (DELTA_LIMIT << 4)
+
+// Readings outside this range count as invalid (°C)
+#define VALID_MIN -40.0f
+#define VALID_MAX 300.0f
+
+// Consecutive invalid readings before a pixel is called dead
+#define DEAD_STREAK 8
+
+// Ratios against the sensor-wide median residual variance, about 0.8x
+// the sensor noise variance (the scene cancels out of the residual, and
+// the local median includes the pixel itself). A live pixel's reading
+// varies at least by the noise whatever the scene does, so one varying by
+// under 1/32 of the median is stuck. A residual over 25x the median
+// (~4.5x the noise) is noisy.
+#define STUCK_RATIO 32
+#define NOISY_RATIO 25
+
+// Floor for the median (0.01 °C²) so a very quiet sensor flags nothing
+#define MIN_MEDIAN_VAR (100 << 4)
+
+// Each subpage updates the residual of one pixel in RESIDUAL_PHASES (by
+// column pair), so a pixel's residual window of RESIDUAL_WINDOW samples
+// spans as many subpages as the reading's PIXEL_HEALTH_WINDOW
+#define RESIDUAL_PHASES 4
+#define RESIDUAL_WINDOW_SHIFT (PIXEL_HEALTH_WINDOW_SHIFT - 2)
+#define RESIDUAL_WINDOW (1 << RESIDUAL_WINDOW_SHIFT)
+
+// Residuals are clamped to the int16 Q4 mean (±20 °C)
+#define RESIDUAL_LIMIT INT16_MAX
+
+// Marks an invalid reading in the centi-°C frame
+#define INVALID_CENTI INT16_MIN
+
+// Evaluations a pixel must fail before it is flagged; it is cleared again
+// after passing as many
+#define STRIKES_TO_FLAG 2
+#define MAX_STRIKES 3
+
+// Every 7th pixel (coprime with the row length) for the median
+#define MEDIAN_STRIDE 7
+
+typedef struct {
+    int32_t mean;               // centi-°C, Q4
+    uint32_t var;               // centi-°C², Q4
+} PixelStat;
+
+typedef struct {
+    int16_t mean;               // centi-°C, Q4
+    uint16_t var;               // centi-°C², saturating
+} ResidualStat;
+
+static PixelStat pixel_stats[SENSOR_PIXELS];       // Reading
+static ResidualStat residual_stats[SENSOR_PIXELS]; // Reading minus the local median
+static int16_t centi[SENSOR_PIXELS];               // Latest reading (centi-°C)
+static uint8_t invalid_streak[SENSOR_PIXELS];
+static uint8_t strikes[SENSOR_PIXELS];
+static uint8_t pixel_flags[SENSOR_PIXELS];
+
+static uint16_t samples[2];     // Per subpage, capped at the window
+static uint16_t residual_samples[2];
+static uint8_t residual_phase[2];
+static uint16_t since_eval;
+
+// EEPROM broken + outlier (5 each), runtime flagged, terminator
+static uint16_t bad_pixels[10 + PIXEL_HEALTH_MAX_FLAGGED + 1];
+static uint8_t eeprom_count;
+
+static PixelHealthStats health;
+
+static int compare_u32(const void *a, const void *b) {
+    uint32_t ua = *(const uint32_t *)a;
+    uint32_t ub = *(const uint32_t *)b;
+    return (ua > ub) - (ua < ub);
+}
+
+static bool in_eeprom_list(uint16_t pixel) {
+    for (uint8_t i = 0; i < eeprom_count; i++) {
+        if (bad_pixels[i] == pixel) return true;
+    }
+    return false;
+}
+
+void pixel_health_init(const paramsMLX90640 *params) {
+    memset(pixel_stats, 0, sizeof(pixel_stats));
+    memset(residual_stats, 0, sizeof(residual_stats));
+    memset(invalid_streak, 0, sizeof(invalid_streak));
+    memset(strikes, 0, sizeof(strikes));
+    memset(pixel_flags, 0, sizeof(pixel_flags));
+    memset(&health, 0, sizeof(health));
+    samples[0] = samples[1] = 0;
+    residual_samples[0] = residual_samples[1] = 0;
+    residual_phase[0] = residual_phase[1] = 0;
+    since_eval = 0;
+
+    eeprom_count = 0;
+    for (int i = 0; i < 5; i++) {
+        if (params->brokenPixels[i] != 0xFFFF) bad_pixels[eeprom_count++] = params->brokenPixels[i];
+    }
+    for (int i = 0; i < 5; i++) {
+        if (params->outlierPixels[i] != 0xFFFF) bad_pixels[eeprom_count++] = params->outlierPixels[i];
+    }
+    bad_pixels[eeprom_count] = 0xFFFF;
+}
+
+// Running mean/variance with weight 1/n, n capped at the window: exact
+// Welford statistics while warming up, then an exponential window
+static inline void update_stat(PixelStat *s, int32_t x, uint16_t n) {
+    int32_t diff = x - s->mean;
+    int32_t incr = (n == PIXEL_HEALTH_WINDOW) ? (diff >> PIXEL_HEALTH_WINDOW_SHIFT) : diff / n;
+    s->mean += incr;
+
+    int32_t d0 = diff >> 4;
+    if (d0 > DELTA_LIMIT) d0 = DELTA_LIMIT;
+    if (d0 < -DELTA_LIMIT) d0 = -DELTA_LIMIT;
+    if (incr > INCR_LIMIT) incr = INCR_LIMIT;
+    if (incr < -INCR_LIMIT) incr = -INCR_LIMIT;
+
+    // var = (1 - 1/n) * (var + diff * diff / n)
+    int32_t prod = d0 * incr;
+    uint32_t var = s->var + (prod > 0 ? (uint32_t)prod : 0);
+    var -= (n == PIXEL_HEALTH_WINDOW) ? (var >> PIXEL_HEALTH_WINDOW_SHIFT) : var / n;
+    s->var = var;
+}
+
+// The same update for a residual (centi-°C, Q4) in the compact form
+static inline void update_residual(ResidualStat *s, int32_t x, uint16_t n) {
+    if (x > RESIDUAL_LIMIT) x = RESIDUAL_LIMIT;
+    if (x < -RESIDUAL_LIMIT) x = -RESIDUAL_LIMIT;
+
+    int32_t diff = x - s->mean;
+    int32_t incr = (n == RESIDUAL_WINDOW) ? (diff >> RESIDUAL_WINDOW_SHIFT) : diff / n;
+    s->mean += incr;
+
+    int32_t prod = ((diff >> 4) * incr) >> 4;
+    uint32_t var = s->var + (prod > 0 ? (uint32_t)prod : 0);
+    var -= (n == RESIDUAL_WINDOW) ? (var >> RESIDUAL_WINDOW_SHIFT) : var / n;
+    s->var = var > UINT16_MAX ? UINT16_MAX : (uint16_t)var;
+}
+
+static inline int32_t min32(int32_t a, int32_t b) { return a < b ? a : b; }
+static inline int32_t max32(int32_t a, int32_t b) { return a > b ? a : b; }
+
+// Median of five without sorting: the median of e and the middle two of
+// a-d's pair minima and maxima
+static inline int32_t median5(int32_t a, int32_t b, int32_t c, int32_t d, int32_t e) {
+    int32_t f = max32(min32(a, b), min32(c, d));
+    int32_t g = min32(max32(a, b), max32(c, d));
+    return max32(min32(e, f), min32(max32(e, f), g));
+}
+
+// Reading minus the median of itself and its neighbours two pixels left,
+// right, up and down (centi-°C). Those are in the same subpage in both
+// chess and interleaved mode, so they were read at the same time as the
+// pixel. A tyre edge runs along a column, so at most one neighbour is
+// across it; the pixel and two neighbours still agree with one of the
+// others faulty and the median stays with them. A neighbour off the edge
+// of the array is replaced by the opposite one, an invalid one by the
+// pixel.
+static inline int32_t local_residual(int row, int col) {
+    const int16_t *p = centi + row * SENSOR_WIDTH + col;
+    int32_t x = *p;
+    int32_t left = (col >= 2) ? p[-2] : p[2];
+    int32_t right = (col + 2 < SENSOR_WIDTH) ? p[2] : p[-2];
+    int32_t up = (row >= 2) ? p[-2 * SENSOR_WIDTH] : p[2 * SENSOR_WIDTH];
+    int32_t down = (row + 2 < SENSOR_HEIGHT) ? p[2 * SENSOR_WIDTH] : p[-2 * SENSOR_WIDTH];
+
+    if (left == INVALID_CENTI) left = x;
+    if (right == INVALID_CENTI) right = x;
+    if (up == INVALID_CENTI) up = x;
+    if (down == INVALID_CENTI) down = x;
+    return x - median5(left, right, up, down, x);
+}
+
+static inline void update_pixel(uint16_t idx, float value, uint16_t n) {
+    if (!(value > VALID_MIN && value < VALID_MAX)) {  // Also catches NaN
+        if (invalid_streak[idx] < 255) invalid_streak[idx]++;
+        centi[idx] = INVALID_CENTI;
+        return;
+    }
+    invalid_streak[idx] = 0;
+
+    int32_t x = (int32_t)(value * VALUE_SCALE);
+    centi[idx] = (int16_t)(x >> 4);
+    update_stat(&pixel_stats[idx], x, n);
+}
+
+// Rebuild the runtime part of the correction list from pixel_flags.
+// Returns true if it changed.
+static bool rebuild_list(void) {
+    bool changed = false;
+    uint8_t n = eeprom_count;
+    health.flagged = 0;
+    health.dropped = 0;
+
+    for (uint16_t p = 0; p < SENSOR_PIXELS; p++) {
+        if (!pixel_flags[p] || in_eeprom_list(p)) continue;
+
+        health.flagged++;
+        if (n >= eeprom_count + PIXEL_HEALTH_MAX_FLAGGED) {
+            health.dropped++;
+            continue;
+        }
+        if (bad_pixels[n] != p) changed = true;
+        bad_pixels[n++] = p;
+    }
+    if (bad_pixels[n] != 0xFFFF) changed = true;
+    bad_pixels[n] = 0xFFFF;
+
+    return changed;
+}
+
+static bool evaluate(void) {
+    static uint32_t sample_var[SENSOR_PIXELS / MEDIAN_STRIDE + 1];
+    uint16_t count = 0;
+
+    for (uint16_t p = 0; p < SENSOR_PIXELS; p += MEDIAN_STRIDE) {
+        sample_var[count++] = residual_stats[p].var;
+    }
+    qsort(sample_var, count, sizeof(uint32_t), compare_u32);
+
+    uint32_t median = sample_var[count / 2] << 4;
+    if (median < MIN_MEDIAN_VAR) median = MIN_MEDIAN_VAR;
+
+    health.evaluations++;
+    health.median_var = median;
+    health.stuck = health.noisy = health.dead = 0;
+
+    for (uint16_t p = 0; p < SENSOR_PIXELS; p++) {
+        uint8_t fault = 0;
+        if (invalid_streak[p] >= DEAD_STREAK) {
+            fault = PIXEL_FLAG_DEAD;
+        } else if (pixel_stats[p].var < median / STUCK_RATIO) {
+            fault = PIXEL_FLAG_STUCK;
+        } else if (((uint32_t)residual_stats[p].var << 4) / NOISY_RATIO > median) {
+            fault = PIXEL_FLAG_NOISY;
+        }
+
+        if (fault) {
+            if (strikes[p] < MAX_STRIKES) strikes[p]++;
+            if (strikes[p] >= STRIKES_TO_FLAG) pixel_flags[p] = fault;
+        } else if (strikes[p] > 0) {
+            strikes[p]--;
+            if (strikes[p] == 0) pixel_flags[p] = 0;
+        }
+
+        if (pixel_flags[p] & PIXEL_FLAG_STUCK) health.stuck++;
+        if (pixel_flags[p] & PIXEL_FLAG_NOISY) health.noisy++;
+        if (pixel_flags[p] & PIXEL_FLAG_DEAD) health.dead++;
+    }
+
+    return rebuild_list();
+}
+
+bool pixel_health_update(const float *frame, int subpage, bool chess_mode) {
+    subpage &= 1;
+    if (samples[subpage] < PIXEL_HEALTH_WINDOW) samples[subpage]++;
+    uint16_t n = samples[subpage];
+
+    uint8_t phase = residual_phase[subpage];
+    residual_phase[subpage] = (phase + 1) & (RESIDUAL_PHASES - 1);
+    if (phase == 0 && residual_samples[subpage] < RESIDUAL_WINDOW) residual_samples[subpage]++;
+    uint16_t rn = residual_samples[subpage];
+
+    int first = 0;
+    int step = 1;
+    for (int row = 0; row < SENSOR_HEIGHT; row++) {
+        if (chess_mode) {
+            first = (row ^ subpage) & 1;
+            step = 2;
+        } else if ((row & 1) != subpage) {
+            continue;
+        }
+
+        for (int col = first; col < SENSOR_WIDTH; col += step) {
+            uint16_t idx = row * SENSOR_WIDTH + col;
+            update_pixel(idx, frame[idx], n);
+        }
+    }
+
+    // Residuals once the whole subpage is in centi, for this phase's
+    // column pairs only
+    for (int row = 0; row < SENSOR_HEIGHT; row++) {
+        if (chess_mode) {
+            first = (row ^ subpage) & 1;
+        } else if ((row & 1) != subpage) {
+            continue;
+        }
+
+        for (int pair = 2 * phase; pair < SENSOR_WIDTH; pair += 2 * RESIDUAL_PHASES) {
+            for (int col = pair; col < pair + 2; col++) {
+                if (chess_mode && (col & 1) != first) continue;
+                uint16_t idx = row * SENSOR_WIDTH + col;
+                if (centi[idx] == INVALID_CENTI) continue;
+                update_residual(&residual_stats[idx], local_residual(row, col) << 4, rn);
+            }
+        }
+    }
+
+    // Only judge once both subpages have a full window
+    if (++since_eval < PIXEL_HEALTH_EVAL_INTERVAL) return false;
+    if (samples[0] < PIXEL_HEALTH_WINDOW || samples[1] < PIXEL_HEALTH_WINDOW) return false;
+    if (residual_samples[0] < RESIDUAL_WINDOW || residual_samples[1] < RESIDUAL_WINDOW) return false;
+
+    since_eval = 0;
+    return evaluate();
+}
+
+uint16_t *pixel_health_bad_pixels(void) {
+    return bad_pixels;
+}
+
+uint8_t pixel_health_flags(uint16_t pixel) {
+    return (pixel < SENSOR_PIXELS) ? pixel_flags[pixel] : 0;
+}
+
+void pixel_health_get_stats(PixelHealthStats *stats) {
+    *stats = health;
+}
+
+void pixel_health_get_flagged(PixelHealthFlagged *flagged) {
+    flagged->count = 0;
+    for (uint8_t i = eeprom_count; bad_pixels[i] != 0xFFFF; i++) {
+        uint16_t p = bad_pixels[i];
+        flagged->pixel[flagged->count] = p;
+        flagged->flags[flagged->count] = pixel_flags[p];
+        flagged->count++;
+    }
+}
+
+void pixel_health_restore_flagged(const PixelHealthFlagged *flagged) {
+    uint8_t count = flagged->count < PIXEL_HEALTH_MAX_FLAGGED ? flagged->count : PIXEL_HEALTH_MAX_FLAGGED;
+    for (uint8_t i = 0; i < count; i++) {
+        uint16_t p = flagged->pixel[i];
+        if (p >= SENSOR_PIXELS || !flagged->flags[i]) continue;
+
+        pixel_flags[p] = flagged->flags[i];
+        strikes[p] = STRIKES_TO_FLAG;
+        if (pixel_flags[p] & PIXEL_FLAG_STUCK) health.stuck++;
+        if (pixel_flags[p] & PIXEL_FLAG_NOISY) health.noisy++;
+        if (pixel_flags[p] & PIXEL_FLAG_DEAD) health.dead++;
+    }
+    rebuild_list();
+}
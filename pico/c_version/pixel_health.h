@@ -0,0 +1,83 @@
+/**
+ * pixel_health.h
+ * Online stuck/noisy/dead pixel detection
+ *
+ * Keeps a running mean and variance per pixel in fixed point, updated
+ * only for the pixels of the subpage just converted: one of the reading,
+ * and one of its residual against the median of itself and its
+ * same-subpage neighbours, for a rotating quarter of the pixels. The
+ * scene (a tyre heating, its edge moving) changes a pixel and its
+ * neighbours together, so the residual only varies by sensor
+ * noise and faults. Every so often the variances are compared with the
+ * sensor-wide median residual variance: a stuck pixel's reading barely
+ * varies at all, a noisy one's residual varies far too much, and a dead
+ * one keeps reading out of range. Flagged pixels are added to the EEPROM
+ * broken/outlier list passed to MLX90640_BadPixelsCorrection().
+ */
+
+#ifndef PIXEL_HEALTH_H
+#define PIXEL_HEALTH_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "thermal_algorithm.h"
+#include "mlx90640/MLX90640_API.h"
+
+// Statistics window in subpages per pixel (power of two)
+#define PIXEL_HEALTH_WINDOW_SHIFT 6
+#define PIXEL_HEALTH_WINDOW (1 << PIXEL_HEALTH_WINDOW_SHIFT)
+
+// Subpages between evaluations
+#define PIXEL_HEALTH_EVAL_INTERVAL 128
+
+// Runtime-flagged pixels added to the correction list at most
+#define PIXEL_HEALTH_MAX_FLAGGED 16
+
+// Reasons a pixel was flagged
+#define PIXEL_FLAG_STUCK  0x01
+#define PIXEL_FLAG_NOISY  0x02
+#define PIXEL_FLAG_DEAD   0x04
+
+// Runtime-flagged pixels in the correction list, kept across a watchdog
+// reset (retained_state.h) so a restart doesn't wait for the window
+typedef struct {
+    uint16_t pixel[PIXEL_HEALTH_MAX_FLAGGED];
+    uint8_t flags[PIXEL_HEALTH_MAX_FLAGGED];
+    uint8_t count;
+} PixelHealthFlagged;
+
+typedef struct {
+    uint32_t evaluations;
+    uint32_t median_var;        // Median residual variance at the last evaluation (centi-°C², Q4)
+    uint16_t flagged;           // Pixels currently flagged at runtime
+    uint16_t stuck;
+    uint16_t noisy;
+    uint16_t dead;
+    uint16_t dropped;           // Flagged but over PIXEL_HEALTH_MAX_FLAGGED
+} PixelHealthStats;
+
+// Reset all statistics and build the correction list from the EEPROM lists
+void pixel_health_init(const paramsMLX90640 *params);
+
+// Update statistics for the pixels of subpage that were just converted.
+// chess_mode selects the chess (true) or interleaved subpage pattern.
+// Returns true if an evaluation changed the correction list.
+bool pixel_health_update(const float *frame, int subpage, bool chess_mode);
+
+// 0xFFFF-terminated pixel list for MLX90640_BadPixelsCorrection():
+// EEPROM broken/outlier pixels followed by runtime-flagged ones
+uint16_t *pixel_health_bad_pixels(void);
+
+// Flags for one pixel (PIXEL_FLAG_*)
+uint8_t pixel_health_flags(uint16_t pixel);
+
+void pixel_health_get_stats(PixelHealthStats *stats);
+
+// Runtime-flagged pixels of the correction list
+void pixel_health_get_flagged(PixelHealthFlagged *flagged);
+
+// Flag pixels again after pixel_health_init(), as if each had just
+// reached STRIKES_TO_FLAG, and rebuild the correction list
+void pixel_health_restore_flagged(const PixelHealthFlagged *flagged);
+
+#endif // PIXEL_HEALTH_H
@@ -0,0 +1,203 @@
+/**
+ * rate_controller.c
+ * Scene-adaptive MLX90640 refresh rate
+ */
+
+#include "rate_controller.h"
+#include "mlx90640/MLX90640_API.h"
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Rate code for each adaptive level
+static const uint8_t level_rates[RATE_LEVELS] = {
+    MLX_RATE_2HZ, MLX_RATE_4HZ, MLX_RATE_8HZ, MLX_RATE_16HZ
+};
+
+static void rate_controller_default_config(RateControllerConfig *config) {
+    // Level 0 needs no activity; a tyre heating at 0.5°C/s (or a span edge
+    // drifting a pixel per second) is enough to leave cruise
+    static const float temp_rate[RATE_LEVELS] = {0.0f, 0.5f, 1.5f, 4.0f};
+    static const float span_rate[RATE_LEVELS] = {0.0f, 1.0f, 3.0f, 8.0f};
+
+    memcpy(config->temp_rate, temp_rate, sizeof(temp_rate));
+    memcpy(config->span_rate, span_rate, sizeof(span_rate));
+    config->release_factor = 0.6f;
+    config->release_hold_ms = 3000;
+    config->smoothing_s = 0.5f;
+}
+
+void rate_controller_init(RateController *rc, uint8_t initial_rate) {
+    memset(rc, 0, sizeof(*rc));
+    rate_controller_default_config(&rc->config);
+
+    rc->rate = initial_rate;
+    rc->pending = initial_rate;
+    rc->level = RATE_LEVELS - 1;
+    for (int i = 0; i < RATE_LEVELS; i++) {
+        if (level_rates[i] == initial_rate) rc->level = i;
+    }
+    rc->mode = (rc->level == 0) ? RATE_MODE_CRUISE : RATE_MODE_ATTACK;
+}
+
+void rate_controller_resume(RateController *rc) {
+    // The timer restarts from zero with the chip
+    rc->have_prev = false;
+    rc->prev_us = 0;
+    rc->quiet_since_us = 0;
+
+    // A change that was staged but never written is lost with the control
+    // register shadow, so the sensor still runs at rc->rate
+    rc->pending = rc->rate;
+    rc->discard = 0;
+}
+
+float rate_controller_rate_hz(uint8_t rate) {
+    // Code 0 = 0.5Hz, each step doubles
+    return 0.5f * (float)(1 << rate);
+}
+
+void rate_controller_set_fixed(RateController *rc, uint8_t rate_hz) {
+    if (rate_hz == 0) {
+        if (rc->fixed) {
+            rc->fixed = false;
+            rc->have_prev = false;  // Restart activity tracking
+            rc->mode = (rc->level == 0) ? RATE_MODE_CRUISE : RATE_MODE_ATTACK;
+        }
+        return;
+    }
+
+    // Smallest supported rate >= requested (codes 1-7 = 1-64Hz)
+    uint8_t rate = 1;
+    while (rate < 7 && rate_controller_rate_hz(rate) < rate_hz) rate++;
+
+    rc->fixed = true;
+    rc->mode = RATE_MODE_FIXED;
+    rc->pending = rate;
+}
+
+// Level required to keep up with the given activity
+static uint8_t required_level(const RateControllerConfig *config, float temp_rate,
+                              float span_rate, float scale) {
+    uint8_t level = 0;
+    for (uint8_t i = 1; i < RATE_LEVELS; i++) {
+        if (temp_rate >= config->temp_rate[i] * scale ||
+            span_rate >= config->span_rate[i] * scale) {
+            level = i;
+        }
+    }
+    return level;
+}
+
+bool rate_controller_update(RateController *rc, const FrameData *data, uint64_t now_us) {
+    if (rc->fixed) return rc->pending != rc->rate;
+
+    uint8_t attack_level;
+    uint8_t release_level;
+
+    if (!data) {
+        // Nothing to judge the scene by - run flat out
+        attack_level = RATE_LEVELS - 1;
+        release_level = attack_level;
+        rc->have_prev = false;
+    } else {
+        const ZoneAnalysis *zones[3] = {&data->left, &data->centre, &data->right};
+        float temp_rate = 0.0f;
+        float span_rate = 0.0f;
+
+        float dt = rc->have_prev ? (now_us - rc->prev_us) / 1000000.0f : 0.0f;
+        float alpha = dt / (rc->config.smoothing_s + dt);
+
+        for (int z = 0; z < 3; z++) {
+            float avg = zones[z]->avg;
+            if (zones[z]->count == 0 || !isfinite(avg)) continue;
+
+            if (!rc->have_prev) {
+                rc->zone_filtered[z] = avg;
+                continue;
+            }
+
+            // Derivative of the low-passed average: sensor noise at 16Hz
+            // would otherwise look like several °C/s of activity
+            float filtered = rc->zone_filtered[z] + alpha * (avg - rc->zone_filtered[z]);
+            float rate = fabsf(filtered - rc->zone_filtered[z]) / dt;
+            rc->zone_filtered[z] = filtered;
+            if (rate > temp_rate) temp_rate = rate;
+        }
+
+        bool detected = data->detection.detected;
+        if (rc->have_prev && dt > 0.0f) {
+            if (detected != rc->prev_detected) {
+                span_rate = rc->config.span_rate[RATE_LEVELS - 1];  // Tyre appeared/lost
+            } else if (detected) {
+                int moved = abs((int)data->detection.span_start - rc->prev_span_start) +
+                            abs((int)data->detection.span_end - rc->prev_span_end);
+                span_rate = moved / dt;
+            }
+        }
+
+        rc->prev_detected = detected;
+        rc->prev_span_start = data->detection.span_start;
+        rc->prev_span_end = data->detection.span_end;
+
+        if (!rc->have_prev) {
+            rc->have_prev = true;
+            rc->prev_us = now_us;
+            rc->quiet_since_us = now_us;
+            return false;
+        }
+        rc->prev_us = now_us;
+
+        attack_level = required_level(&rc->config, temp_rate, span_rate, 1.0f);
+        release_level = required_level(&rc->config, temp_rate, span_rate, rc->config.release_factor);
+    }
+
+    if (attack_level > rc->level) {
+        // Fast attack: jump straight to the level the scene needs
+        rc->level = attack_level;
+        rc->quiet_since_us = now_us;
+        rc->mode = RATE_MODE_ATTACK;
+    } else if (release_level < rc->level) {
+        // Slow release: one level per quiet hold period
+        rc->mode = RATE_MODE_RELEASE;
+        if (now_us - rc->quiet_since_us >= (uint64_t)rc->config.release_hold_ms * 1000) {
+            rc->level--;
+            rc->quiet_since_us = now_us;
+            if (rc->level == 0) rc->mode = RATE_MODE_CRUISE;
+        }
+    } else {
+        rc->quiet_since_us = now_us;
+        rc->mode = (rc->level == 0) ? RATE_MODE_CRUISE : RATE_MODE_ATTACK;
+    }
+
+    rc->pending = level_rates[rc->level];
+    return rc->pending != rc->rate;
+}
+
+int rate_controller_apply(RateController *rc, uint8_t slave_addr) {
+    if (rc->pending == rc->rate) return MLX90640_NO_ERROR;
+
+    int error = MLX90640_SetRefreshRate(slave_addr, rc->pending);
+    if (error != MLX90640_NO_ERROR) return error;
+
+    // The subpage being measured now started at the old rate; it is the
+    // only one that mixes the two, so drop it and carry on
+    rc->rate = rc->pending;
+    rc->discard = 1;
+    rc->rate_changes++;
+    return MLX90640_NO_ERROR;
+}
+
+bool rate_controller_discard_subpage(RateController *rc) {
+    if (rc->discard == 0) return false;
+    rc->discard--;
+    return true;
+}
+
+uint8_t rate_controller_get_rate(const RateController *rc) {
+    return rc->rate;
+}
+
+RateMode rate_controller_get_mode(const RateController *rc) {
+    return rc->mode;
+}
@@ -0,0 +1,99 @@
+/**
+ * rate_controller.h
+ * Scene-adaptive MLX90640 refresh rate
+ *
+ * Watches how fast zone temperatures and the tyre span are changing and
+ * picks the sensor refresh rate: the slowest rate when the scene is
+ * static (parked, long straights), the fastest under braking and
+ * cornering. Rises immediately (fast attack) and steps back down one
+ * rate at a time after a quiet hold period (slow release).
+ */
+
+#ifndef RATE_CONTROLLER_H
+#define RATE_CONTROLLER_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "thermal_algorithm.h"
+
+// MLX90640 refresh rate codes (control register bits 9:7)
+#define MLX_RATE_2HZ    0x02
+#define MLX_RATE_4HZ    0x03
+#define MLX_RATE_8HZ    0x04
+#define MLX_RATE_16HZ   0x05
+
+// Adaptive levels, slowest first
+#define RATE_LEVELS 4
+
+// Controller state, reported in REG_RATE_MODE
+typedef enum {
+    RATE_MODE_FIXED = 0,     // Rate set through REG_FRAME_RATE
+    RATE_MODE_CRUISE = 1,    // Adaptive, at the slowest rate
+    RATE_MODE_ATTACK = 2,    // Adaptive, raised and scene still active
+    RATE_MODE_RELEASE = 3    // Adaptive, raised but scene has gone quiet
+} RateMode;
+
+typedef struct {
+    // Activity needed to hold each level (index 0 is the floor)
+    float temp_rate[RATE_LEVELS];   // Zone temperature change, °C/s
+    float span_rate[RATE_LEVELS];   // Span edge movement, pixels/s
+    float release_factor;           // Thresholds are scaled by this when stepping down
+    uint32_t release_hold_ms;       // Quiet time before each step down
+    float smoothing_s;              // Time constant of the zone temperature filter
+} RateControllerConfig;
+
+typedef struct {
+    RateControllerConfig config;
+
+    uint8_t rate;               // Current MLX rate code
+    uint8_t pending;            // Rate requested but not yet written
+    uint8_t level;              // Current adaptive level
+    RateMode mode;
+    bool fixed;
+
+    // Activity tracking
+    bool have_prev;
+    uint64_t prev_us;
+    float zone_filtered[3];     // Left, centre, right
+    bool prev_detected;
+    uint8_t prev_span_start;
+    uint8_t prev_span_end;
+    uint64_t quiet_since_us;
+
+    // Subpages still in flight from before the last rate change
+    uint8_t discard;
+
+    uint32_t rate_changes;
+} RateController;
+
+// Initialize with the rate the sensor was configured with
+void rate_controller_init(RateController *rc, uint8_t initial_rate);
+
+// Continue from a controller kept across a watchdog reset. Level, mode and
+// rate carry on; timestamps from before the reset are dropped, so activity
+// tracking restarts on the next frame.
+void rate_controller_resume(RateController *rc);
+
+// Fix the rate to rate_hz (rounded up to a supported rate), or 0 to adapt
+void rate_controller_set_fixed(RateController *rc, uint8_t rate_hz);
+
+// Feed one analysed frame. data may be NULL when no analysis ran (raw
+// mode), which requests the fastest rate. Returns true if the refresh
+// rate should change; call rate_controller_apply() to write it.
+bool rate_controller_update(RateController *rc, const FrameData *data, uint64_t now_us);
+
+// Stage the pending rate in the control register shadow. It is written by
+// the next MLX90640_ApplyControlRegister(), which the caller makes before
+// the next subpage is read. Returns the MLX90640 error code.
+int rate_controller_apply(RateController *rc, uint8_t slave_addr);
+
+// True if the subpage just read straddled a rate change and should be dropped
+bool rate_controller_discard_subpage(RateController *rc);
+
+// Subpage rate in Hz for an MLX rate code
+float rate_controller_rate_hz(uint8_t rate);
+
+uint8_t rate_controller_get_rate(const RateController *rc);
+RateMode rate_controller_get_mode(const RateController *rc);
+
+#endif // RATE_CONTROLLER_H
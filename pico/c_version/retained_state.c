@@ -0,0 +1,162 @@
+/**
+ * retained_state.c
+ * State kept across watchdog resets for a fast, warm restart
+ */
+
+#include "retained_state.h"
+#include "pico/platform.h"
+#include "hardware/watchdog.h"
+#include <string.h>
+
+#define RETAINED_MAGIC 0x54545253u          // "TTRS"
+#define RETAINED_VERSION 1
+
+// Watchdog scratch registers used here (4-7 belong to the SDK)
+#define SCRATCH_MAGIC 0
+#define SCRATCH_COUNTERS 1      // watchdog_resets | fast_restarts << 16
+#define SCRATCH_CHECK 2         // ~counters
+
+typedef struct {
+    uint32_t magic;
+    uint16_t version;
+    uint16_t size;              // Payload size, catches layout changes
+    uint32_t checksum;          // FNV-1a of the payload
+} RetainedHeader;
+
+typedef struct {
+    RetainedHeader header;
+    struct {
+        uint64_t serial;        // Cache key: device ID, EEPROM 0x2407-0x2409
+        paramsMLX90640 params;
+    } calibration;
+} RetainedCalibration;
+
+typedef struct {
+    RetainedHeader header;
+    RetainedRuntime runtime;
+} RetainedRuntimeBlock;
+
+// Not zeroed by the C runtime, so they survive a watchdog reset
+static RetainedCalibration __uninitialized_ram(calibration_block);
+static RetainedRuntimeBlock __uninitialized_ram(runtime_block);
+
+static ResetReason reason = RESET_POWER_ON;
+static uint16_t watchdog_resets = 0;
+static uint8_t fast_restarts = 0;
+static uint32_t healthy_subpages = 0;
+
+static uint32_t fnv1a(const void *data, uint32_t len) {
+    const uint8_t *p = data;
+    uint32_t h = 0x811C9DC5u;
+    for (uint32_t i = 0; i < len; i++) {
+        h = (h ^ p[i]) * 0x01000193u;
+    }
+    return h;
+}
+
+static void seal(RetainedHeader *header, const void *payload, uint32_t size) {
+    header->magic = 0;
+    header->version = RETAINED_VERSION;
+    header->size = (uint16_t)size;
+    header->checksum = fnv1a(payload, size);
+    header->magic = RETAINED_MAGIC;
+}
+
+static bool intact(const RetainedHeader *header, const void *payload, uint32_t size) {
+    return header->magic == RETAINED_MAGIC && header->version == RETAINED_VERSION &&
+           header->size == size && header->checksum == fnv1a(payload, size);
+}
+
+static void write_counters(void) {
+    uint32_t counters = watchdog_resets | ((uint32_t)fast_restarts << 16);
+    watchdog_hw->scratch[SCRATCH_MAGIC] = RETAINED_MAGIC;
+    watchdog_hw->scratch[SCRATCH_COUNTERS] = counters;
+    watchdog_hw->scratch[SCRATCH_CHECK] = ~counters;
+}
+
+ResetReason retained_state_boot(void) {
+    watchdog_resets = 0;
+    fast_restarts = 0;
+    healthy_subpages = 0;
+
+    // Only a timeout of our own watchdog_enable() counts; a reboot for
+    // new firmware (watchdog_reboot) may have changed the layout
+    if (!watchdog_enable_caused_reboot()) {
+        reason = RESET_POWER_ON;
+        runtime_block.header.magic = 0;
+        calibration_block.header.magic = 0;
+        write_counters();
+        return reason;
+    }
+
+    uint32_t counters = watchdog_hw->scratch[SCRATCH_COUNTERS];
+    if (watchdog_hw->scratch[SCRATCH_MAGIC] == RETAINED_MAGIC &&
+        watchdog_hw->scratch[SCRATCH_CHECK] == ~counters) {
+        watchdog_resets = counters & 0xFFFF;
+        fast_restarts = (counters >> 16) & 0xFF;
+    }
+    if (watchdog_resets < 0xFFFF) watchdog_resets++;
+
+    bool usable = fast_restarts < RETAINED_MAX_FAST_RESTARTS &&
+                  intact(&runtime_block.header, &runtime_block.runtime, sizeof(runtime_block.runtime)) &&
+                  intact(&calibration_block.header, &calibration_block.calibration,
+                         sizeof(calibration_block.calibration));
+    if (usable) {
+        reason = RESET_WATCHDOG_WARM;
+        fast_restarts++;
+    } else {
+        reason = RESET_WATCHDOG_COLD;
+        fast_restarts = 0;
+        runtime_block.header.magic = 0;
+        calibration_block.header.magic = 0;
+    }
+    write_counters();
+    return reason;
+}
+
+ResetReason retained_state_reason(void) {
+    return reason;
+}
+
+uint16_t retained_state_watchdog_resets(void) {
+    return watchdog_resets;
+}
+
+const RetainedRuntime *retained_state_runtime(void) {
+    return reason == RESET_WATCHDOG_WARM ? &runtime_block.runtime : NULL;
+}
+
+void retained_state_discard(void) {
+    if (reason == RESET_WATCHDOG_WARM) reason = RESET_WATCHDOG_COLD;
+    fast_restarts = 0;
+    write_counters();
+    runtime_block.header.magic = 0;
+    calibration_block.header.magic = 0;
+}
+
+bool retained_state_load_calibration(uint64_t serial, paramsMLX90640 *params) {
+    if (reason != RESET_WATCHDOG_WARM || calibration_block.calibration.serial != serial) return false;
+    memcpy(params, &calibration_block.calibration.params, sizeof(*params));
+    return true;
+}
+
+void retained_state_save_calibration(uint64_t serial, const paramsMLX90640 *params) {
+    calibration_block.header.magic = 0;
+    calibration_block.calibration.serial = serial;
+    memcpy(&calibration_block.calibration.params, params, sizeof(*params));
+    seal(&calibration_block.header, &calibration_block.calibration,
+         sizeof(calibration_block.calibration));
+}
+
+void retained_state_save_runtime(const RetainedRuntime *runtime) {
+    // Invalidate first: a reset part way through leaves a bad block, not
+    // a mix of two subpages with a good checksum
+    runtime_block.header.magic = 0;
+    memcpy(&runtime_block.runtime, runtime, sizeof(*runtime));
+    seal(&runtime_block.header, &runtime_block.runtime, sizeof(runtime_block.runtime));
+
+    if (fast_restarts > 0 && ++healthy_subpages >= RETAINED_HEALTHY_SUBPAGES) {
+        fast_restarts = 0;
+        write_counters();
+    }
+}
@@ -0,0 +1,83 @@
+/**
+ * retained_state.h
+ * State kept across watchdog resets for a fast, warm restart
+ *
+ * A hang (an I2C lock-up, say) stops the main loop feeding the watchdog,
+ * and the chip resets. SRAM keeps its contents through that reset. Two
+ * blocks in uninitialised RAM (not zeroed at boot) each carry a checksum:
+ *
+ * - calibration: the sensor's device ID (the cache key) and the extracted
+ *   paramsMLX90640, saved once at startup;
+ * - runtime: frame counters, the last analysis, rate controller, sensor
+ *   environment terms, runtime-flagged pixels and the I2C config
+ *   registers, saved after every subpage.
+ *
+ * Reset counters live in watchdog scratch registers 0-3 (the SDK uses
+ * 4-7). After a watchdog reset with valid blocks, startup skips the boot
+ * delays, the EEPROM dump and parameter extraction, and output resumes
+ * from where it stopped within a few subpages. A power-on, bad checksum or
+ * RETAINED_MAX_FAST_RESTARTS fast restarts in a row (the retained state
+ * itself may be what hangs) go through the normal cold boot.
+ */
+
+#ifndef RETAINED_STATE_H
+#define RETAINED_STATE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "thermal_algorithm.h"
+#include "rate_controller.h"
+#include "pixel_health.h"
+#include "i2c_slave.h"
+#include "mlx90640/MLX90640_API.h"
+
+// Longest gap between watchdog feeds: a subpage at the slowest fixed rate
+// (1Hz) plus processing and serial output
+#define WATCHDOG_TIMEOUT_MS 3000
+
+// Consecutive fast restarts before falling back to a cold boot
+#define RETAINED_MAX_FAST_RESTARTS 3
+
+// Subpages after which a fast restart counts as having recovered
+#define RETAINED_HEALTHY_SUBPAGES 64
+
+// Reported in REG_RESET_REASON
+typedef enum {
+    RESET_POWER_ON = 0,         // Power-on or external reset, cold boot
+    RESET_WATCHDOG_WARM = 1,    // Watchdog, resumed from retained state
+    RESET_WATCHDOG_COLD = 2     // Watchdog, retained state unusable
+} ResetReason;
+
+typedef struct {
+    uint32_t total_frames;              // main.c subpage counter
+    uint32_t algorithm_frame;           // thermal_algorithm frame counter
+    FrameData result;                   // Last analysis (span is the tracker state)
+    RateController rate_ctrl;
+    envMLX90640 env;                    // Smoothed Ta, Vdd and gain terms
+    PixelHealthFlagged pixels;
+    uint8_t config_regs[I2C_SLAVE_CONFIG_REGS];
+} RetainedRuntime;
+
+// Classify this boot and update the reset counters. Call first thing.
+ResetReason retained_state_boot(void);
+
+ResetReason retained_state_reason(void);
+uint16_t retained_state_watchdog_resets(void);
+
+// Runtime state to resume from, or NULL unless this is a warm restart
+const RetainedRuntime *retained_state_runtime(void);
+
+// Give up on the retained state (e.g. a different sensor is fitted):
+// startup goes cold and the reason becomes RESET_WATCHDOG_COLD
+void retained_state_discard(void);
+
+// Copy the retained calibration if it belongs to the sensor with this
+// device ID. Only on a warm restart.
+bool retained_state_load_calibration(uint64_t serial, paramsMLX90640 *params);
+void retained_state_save_calibration(uint64_t serial, const paramsMLX90640 *params);
+
+// Save after each subpage; also clears the fast restart count once the
+// firmware has run RETAINED_HEALTHY_SUBPAGES since starting
+void retained_state_save_runtime(const RetainedRuntime *runtime);
+
+#endif // RETAINED_STATE_H
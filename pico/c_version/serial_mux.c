@@ -0,0 +1,185 @@
+/**
+ * serial_mux.c
+ * Prioritised channel queues and host commands on the USB serial link
+ */
+
+#include "serial_mux.h"
+#include "i2c_slave.h"
+#include "pico/stdlib.h"
+#include <stdio.h>
+#include <string.h>
+
+// Queue sizes: room for an image and a few frames of data, and a few
+// periodic reports on the other channels
+#define DATA_QUEUE_BYTES 4096
+#define DIAG_QUEUE_BYTES 1024
+#define TRACE_QUEUE_BYTES 1024
+#define COMMAND_QUEUE_BYTES 256
+
+// Longest command frame accepted from the host
+#define COMMAND_MAX_FRAME 64
+
+typedef struct {
+    uint8_t *buf;
+    uint16_t size;
+    uint16_t head;              // Next byte to send
+    uint16_t used;
+    uint8_t seq;                // Next sequence number
+    uint32_t dropped;
+} MuxQueue;
+
+static uint8_t data_buf[DATA_QUEUE_BYTES];
+static uint8_t diag_buf[DIAG_QUEUE_BYTES];
+static uint8_t trace_buf[TRACE_QUEUE_BYTES];
+static uint8_t command_buf[COMMAND_QUEUE_BYTES];
+
+_Static_assert(1 + MUX_READ_REGS_MAX + MUX_OVERHEAD <= COMMAND_QUEUE_BYTES,
+               "a full register read reply must fit the command queue");
+
+static MuxQueue queues[MUX_CHANNELS];
+
+// Flush order
+static const uint8_t priority[MUX_CHANNELS] = {
+    MUX_CHANNEL_COMMAND, MUX_CHANNEL_DATA, MUX_CHANNEL_DIAG, MUX_CHANNEL_TRACE
+};
+
+static uint8_t frame[MUX_MAX_FRAME];    // Framing scratch
+
+static uint8_t rx[COMMAND_MAX_FRAME];   // Command bytes from the host
+static uint16_t rx_len = 0;
+
+void serial_mux_init(void) {
+    memset(queues, 0, sizeof(queues));
+    queues[MUX_CHANNEL_DATA].buf = data_buf;
+    queues[MUX_CHANNEL_DATA].size = sizeof(data_buf);
+    queues[MUX_CHANNEL_DIAG].buf = diag_buf;
+    queues[MUX_CHANNEL_DIAG].size = sizeof(diag_buf);
+    queues[MUX_CHANNEL_TRACE].buf = trace_buf;
+    queues[MUX_CHANNEL_TRACE].size = sizeof(trace_buf);
+    queues[MUX_CHANNEL_COMMAND].buf = command_buf;
+    queues[MUX_CHANNEL_COMMAND].size = sizeof(command_buf);
+    rx_len = 0;
+}
+
+bool serial_mux_active(void) {
+    return i2c_slave_get_output_mode() == OUTPUT_MODE_USB_BINARY;
+}
+
+static bool enqueue(MuxQueue *q, uint8_t channel, uint8_t type, uint8_t seq,
+                    const uint8_t *payload, uint16_t len) {
+    uint16_t n = mux_frame_encode(channel, type, seq, payload, len, frame, sizeof(frame));
+    if (n == 0 || n > q->size - q->used) {
+        q->dropped++;
+        return false;
+    }
+
+    uint16_t tail = (q->head + q->used) % q->size;
+    uint16_t first = (n < q->size - tail) ? n : q->size - tail;
+    memcpy(q->buf + tail, frame, first);
+    memcpy(q->buf, frame + first, n - first);
+    q->used += n;
+    return true;
+}
+
+bool serial_mux_send(MuxChannel channel, uint8_t type, const uint8_t *payload, uint16_t len) {
+    if (channel >= MUX_CHANNELS) return false;
+    MuxQueue *q = &queues[channel];
+    if (!enqueue(q, channel, type, q->seq, payload, len)) return false;
+    q->seq++;
+    return true;
+}
+
+static uint8_t peek(const MuxQueue *q, uint16_t offset) {
+    return q->buf[(q->head + offset) % q->size];
+}
+
+void serial_mux_flush(uint32_t max_bytes) {
+    uint32_t sent = 0;
+
+    for (int p = 0; p < MUX_CHANNELS; p++) {
+        MuxQueue *q = &queues[priority[p]];
+        while (q->used > 0) {
+            uint16_t n = (uint16_t)(peek(q, 4) | (peek(q, 5) << 8)) + MUX_OVERHEAD;
+            // Lower priorities wait too, so the order holds
+            if (sent + n > max_bytes) goto done;
+
+            uint16_t first = (n < q->size - q->head) ? n : q->size - q->head;
+            fwrite(q->buf + q->head, 1, first, stdout);
+            if (n > first) fwrite(q->buf, 1, n - first, stdout);
+            q->head = (q->head + n) % q->size;
+            q->used -= n;
+            sent += n;
+        }
+    }
+done:
+    if (sent > 0) fflush(stdout);
+}
+
+static void respond(const MuxMessage *cmd, const uint8_t *payload, uint16_t len) {
+    enqueue(&queues[MUX_CHANNEL_COMMAND], MUX_CHANNEL_COMMAND, cmd->type | MUX_RESPONSE, cmd->seq,
+            payload, len);
+}
+
+static void run_command(const MuxMessage *cmd) {
+    uint8_t reply[2 + 255];
+
+    switch (cmd->type) {
+        case MUX_CMD_PING:
+            i2c_slave_read_registers(REG_FIRMWARE_VERSION, 1, reply);
+            reply[1] = MUX_PROTOCOL_VERSION;
+            respond(cmd, reply, 2);
+            break;
+
+        case MUX_CMD_READ_REGS: {
+            if (cmd->len < 2) break;
+            // A longer reply would never fit the queue and be dropped
+            uint8_t count = cmd->payload[1];
+            if (count > MUX_READ_REGS_MAX) count = MUX_READ_REGS_MAX;
+            reply[0] = cmd->payload[0];
+            i2c_slave_read_registers(cmd->payload[0], count, reply + 1);
+            respond(cmd, reply, 1 + count);
+            break;
+        }
+
+        case MUX_CMD_WRITE_REG:
+            if (cmd->len < 2) break;
+            reply[0] = cmd->payload[0];
+            reply[1] = cmd->payload[1];
+            reply[2] = i2c_slave_write_config(cmd->payload[0], cmd->payload[1]) ? 0 : 1;
+            respond(cmd, reply, 3);
+            break;
+
+        default:
+            break;
+    }
+}
+
+void serial_mux_poll(void) {
+    int c;
+    while ((c = getchar_timeout_us(0)) != PICO_ERROR_TIMEOUT) {
+        if (rx_len == 0 && c != MUX_SYNC) continue;
+        rx[rx_len++] = (uint8_t)c;
+
+        // Frames too long for the buffer, or not commands, are resynced past
+        while (rx_len > 0) {
+            MuxMessage msg;
+            int32_t n = mux_frame_check(rx, rx_len, &msg);
+            if (n == 0 && rx_len < sizeof(rx)) break;
+            if (n > 0 && msg.channel == MUX_CHANNEL_COMMAND) run_command(&msg);
+
+            // Drop the frame, or the sync byte of a bad one, and rescan
+            uint16_t skip = (n > 0) ? (uint16_t)n : 1;
+            memmove(rx, rx + skip, rx_len - skip);
+            rx_len -= skip;
+            while (rx_len > 0 && rx[0] != MUX_SYNC) {
+                memmove(rx, rx + 1, --rx_len);
+            }
+        }
+    }
+}
+
+void serial_mux_get_drops(uint32_t drops[MUX_CHANNELS]) {
+    for (int i = 0; i < MUX_CHANNELS; i++) {
+        drops[i] = queues[i].dropped;
+    }
+}
@@ -0,0 +1,45 @@
+/**
+ * serial_mux.h
+ * Prioritised channel queues and host commands on the USB serial link
+ *
+ * Messages are framed (mux_protocol.h) into a queue per channel as they
+ * are produced. serial_mux_flush() runs once per subpage. It writes the
+ * queues in priority order (command responses, data, diagnostics,
+ * trace) up to a byte budget. Whatever doesn't fit waits for the next
+ * subpage. When a queue is full, new messages on that channel are
+ * dropped and counted, so a slow host loses trace before it loses data.
+ *
+ * serial_mux_poll() reads host commands from USB. It runs in every
+ * output mode, so a host can switch a text-mode device to binary with
+ * MUX_CMD_WRITE_REG.
+ */
+
+#ifndef SERIAL_MUX_H
+#define SERIAL_MUX_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "mux_protocol.h"
+
+// Bytes written per flush: ~64 KB/s at 16 subpages/s, well within USB
+// full speed, and under 20ms on a 3 Mbaud UART bridge
+#define SERIAL_MUX_FLUSH_BYTES 4096
+
+void serial_mux_init(void);
+
+// True in OUTPUT_MODE_USB_BINARY
+bool serial_mux_active(void);
+
+// Queue a message. False if the channel's queue is full (dropped).
+bool serial_mux_send(MuxChannel channel, uint8_t type, const uint8_t *payload, uint16_t len);
+
+// Write queued messages in priority order, at most max_bytes
+void serial_mux_flush(uint32_t max_bytes);
+
+// Read commands from the host (non-blocking) and queue the responses
+void serial_mux_poll(void);
+
+// Messages dropped per channel since startup
+void serial_mux_get_drops(uint32_t drops[MUX_CHANNELS]);
+
+#endif // SERIAL_MUX_H
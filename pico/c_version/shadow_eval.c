@@ -0,0 +1,180 @@
+/**
+ * shadow_eval.c
+ * Shadow evaluation of a candidate detector config on core 1
+ */
+
+#include "shadow_eval.h"
+#include "pico/multicore.h"
+#include "pico/critical_section.h"
+#include "pico/time.h"
+#include <math.h>
+#include <string.h>
+
+// Job handed to core 1. Core 0 only writes it while busy is false.
+typedef struct {
+    float span_profile[SENSOR_WIDTH];
+    float zone_profile[SENSOR_WIDTH];
+    FrameData production;
+    ThermalConfig candidate;
+    uint32_t generation;            // Statistics generation the job belongs to
+} ShadowJob;
+
+// Running sums behind ShadowStats
+typedef struct {
+    uint32_t compared;
+    uint32_t dropped;
+    uint32_t both_detected;
+    uint32_t production_only;
+    uint32_t candidate_only;
+    float iou_sum;
+    float zone_delta_sum[3];
+    float zone_delta_max;
+    float production_confidence_sum;
+    float candidate_confidence_sum;
+    uint32_t last_us;
+    uint32_t max_us;
+} ShadowSums;
+
+static ShadowJob job;
+static ShadowSums sums;
+static volatile bool busy = false;
+static uint32_t generation = 0;
+static ThermalConfig last_candidate;
+static bool have_candidate = false;
+static critical_section_t shadow_lock;
+
+static float span_iou(const TyreDetection *a, const TyreDetection *b) {
+    if (!a->detected || !b->detected) return 0.0f;
+
+    int first = a->span_start > b->span_start ? a->span_start : b->span_start;
+    int last = a->span_end < b->span_end ? a->span_end : b->span_end;
+    int overlap = last >= first ? last - first + 1 : 0;
+    int joined = a->tyre_width + b->tyre_width - overlap;
+    return joined > 0 ? (float)overlap / joined : 0.0f;
+}
+
+static void accumulate(const FrameData *production, const FrameData *candidate, uint32_t elapsed) {
+    const TyreDetection *p = &production->detection;
+    const TyreDetection *c = &candidate->detection;
+
+    sums.compared++;
+    sums.production_confidence_sum += p->confidence;
+    sums.candidate_confidence_sum += c->confidence;
+    sums.last_us = elapsed;
+    if (elapsed > sums.max_us) sums.max_us = elapsed;
+
+    if (p->detected && c->detected) {
+        sums.both_detected++;
+        sums.iou_sum += span_iou(p, c);
+
+        const ZoneAnalysis *pz[3] = {&production->left, &production->centre, &production->right};
+        const ZoneAnalysis *cz[3] = {&candidate->left, &candidate->centre, &candidate->right};
+        for (int z = 0; z < 3; z++) {
+            float delta = fabsf(cz[z]->median - pz[z]->median);
+            if (!isfinite(delta)) continue;
+            sums.zone_delta_sum[z] += delta;
+            if (delta > sums.zone_delta_max) sums.zone_delta_max = delta;
+        }
+    } else if (p->detected) {
+        sums.production_only++;
+    } else if (c->detected) {
+        sums.candidate_only++;
+    }
+}
+
+static void core1_main(void) {
+    while (1) {
+        multicore_fifo_pop_blocking();
+
+        uint32_t t0 = time_us_32();
+        FrameData candidate;
+        memset(&candidate, 0, sizeof(candidate));
+        thermal_algorithm_detect(job.span_profile, &candidate.detection, &job.candidate);
+        thermal_algorithm_zone_stats(job.zone_profile, &candidate);
+        uint32_t elapsed = time_us_32() - t0;
+
+        critical_section_enter_blocking(&shadow_lock);
+        if (job.generation == generation) {
+            accumulate(&job.production, &candidate, elapsed);
+        }
+        busy = false;
+        critical_section_exit(&shadow_lock);
+    }
+}
+
+void shadow_eval_init(void) {
+    critical_section_init(&shadow_lock);
+    memset(&sums, 0, sizeof(sums));
+    busy = false;
+    have_candidate = false;
+    multicore_launch_core1(core1_main);
+}
+
+static bool same_config(const ThermalConfig *a, const ThermalConfig *b) {
+    // Only the fields detection reads
+    return a->mad_threshold == b->mad_threshold &&
+           a->min_tyre_width == b->min_tyre_width &&
+           a->max_tyre_width == b->max_tyre_width &&
+           a->engine == b->engine;
+}
+
+bool shadow_eval_post(const float *span_profile, const float *zone_profile,
+                      const FrameData *production, const ThermalConfig *candidate) {
+    if (!have_candidate || !same_config(candidate, &last_candidate)) {
+        last_candidate = *candidate;
+        have_candidate = true;
+        shadow_eval_reset();
+    }
+
+    critical_section_enter_blocking(&shadow_lock);
+    if (busy) {
+        sums.dropped++;
+        critical_section_exit(&shadow_lock);
+        return false;
+    }
+    critical_section_exit(&shadow_lock);
+
+    // Core 1 is idle until the FIFO push, so the job can be filled unlocked
+    memcpy(job.span_profile, span_profile, sizeof(job.span_profile));
+    memcpy(job.zone_profile, zone_profile, sizeof(job.zone_profile));
+    job.production = *production;
+    job.candidate = *candidate;
+    job.generation = generation;
+    busy = true;
+    multicore_fifo_push_blocking(job.generation);
+    return true;
+}
+
+void shadow_eval_reset(void) {
+    critical_section_enter_blocking(&shadow_lock);
+    memset(&sums, 0, sizeof(sums));
+    generation++;
+    critical_section_exit(&shadow_lock);
+}
+
+void shadow_eval_get_stats(ShadowStats *stats) {
+    critical_section_enter_blocking(&shadow_lock);
+    ShadowSums s = sums;
+    critical_section_exit(&shadow_lock);
+
+    memset(stats, 0, sizeof(*stats));
+    stats->compared = s.compared;
+    stats->dropped = s.dropped;
+    stats->both_detected = s.both_detected;
+    stats->production_only = s.production_only;
+    stats->candidate_only = s.candidate_only;
+    stats->last_us = s.last_us;
+    stats->max_us = s.max_us;
+    stats->zone_delta_max = s.zone_delta_max;
+    if (s.compared == 0) return;
+
+    uint32_t disagree = s.production_only + s.candidate_only;
+    uint32_t either = s.both_detected + disagree;
+    stats->detection_agreement = (float)(s.compared - disagree) / s.compared;
+    stats->mean_iou = either ? s.iou_sum / either : 0.0f;
+    for (int z = 0; z < 3; z++) {
+        stats->zone_delta_mean[z] = s.both_detected ? s.zone_delta_sum[z] / s.both_detected : 0.0f;
+    }
+    stats->production_confidence = s.production_confidence_sum / s.compared;
+    stats->candidate_confidence = s.candidate_confidence_sum / s.compared;
+}
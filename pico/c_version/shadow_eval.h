@@ -0,0 +1,57 @@
+/**
+ * shadow_eval.h
+ * Shadow evaluation of a candidate detector config on core 1
+ *
+ * Core 0 runs production detection as before. Each time span detection
+ * runs, it also hands the same profiles and the production result to
+ * core 1, which is otherwise idle. Core 1 re-runs detection and zone
+ * statistics with a candidate ThermalConfig and accumulates how closely
+ * the two agree: detection agreement, span IoU, zone median deltas and
+ * confidence. Nothing the candidate produces reaches the outputs.
+ *
+ * Core 0 only copies the job (~300 bytes) and never waits for core 1. If
+ * core 1 is still busy with the previous job, the new one is dropped and
+ * counted. Changing the candidate config resets the statistics, and a
+ * result still in flight for the old config is discarded.
+ */
+
+#ifndef SHADOW_EVAL_H
+#define SHADOW_EVAL_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "thermal_algorithm.h"
+
+typedef struct {
+    uint32_t compared;              // Span detections evaluated by both configs
+    uint32_t dropped;               // Jobs skipped because core 1 was busy
+    uint32_t both_detected;
+    uint32_t production_only;       // Detected by production, missed by candidate
+    uint32_t candidate_only;        // Detected by candidate only
+    float detection_agreement;      // Frames where both agree on detected, 0-1
+    float mean_iou;                 // Span IoU, frames where either detected (0 if one missed)
+    float zone_delta_mean[3];       // Mean |candidate - production| zone median, °C (both detected)
+    float zone_delta_max;           // Largest of those, °C
+    float production_confidence;    // Mean confidence of each config
+    float candidate_confidence;
+    uint32_t last_us;               // Core 1 time per evaluation
+    uint32_t max_us;
+} ShadowStats;
+
+// Launch the core 1 worker. Call once, before the first post.
+void shadow_eval_init(void);
+
+// Hand a span detection to core 1. span_profile is the profile detection
+// ran on and zone_profile the one zones use (they differ in zone
+// conversion mode); production holds the production detection and zones.
+// Returns false if the job was dropped because core 1 was busy.
+bool shadow_eval_post(const float *span_profile, const float *zone_profile,
+                      const FrameData *production, const ThermalConfig *candidate);
+
+// Clear the statistics (the next post also does when the candidate changes)
+void shadow_eval_reset(void);
+
+// Snapshot of the statistics
+void shadow_eval_get_stats(ShadowStats *stats);
+
+#endif // SHADOW_EVAL_H
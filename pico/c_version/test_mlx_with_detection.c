@@ -12,6 +12,7 @@
 
 #include "mlx90640/MLX90640_API.h"
 #include "mlx90640/MLX90640_I2C_Driver.h"
+#include "column_mask.h"
 
 #define MLX90640_ADDR 0x33
 #define LED_PIN PICO_DEFAULT_LED_PIN
@@ -240,55 +241,18 @@ static void grow_region(const float *profile, float median_temp, float mad_globa
 
     float k = fmaxf(config.k_floor, config.k_multiplier * local_mad);
 
-    // Grow left
-    int left = centre;
-    int fail_count = 0;
-    for (int i = centre - 1; i >= 0; i--) {
-        float temp = profile[i];
-
-        // Dual criteria
-        int within_k = fabsf(temp - centre_temp) <= k;
-        int global_ok;
-        if (inverted) {
-            global_ok = (temp <= median_temp - delta);
-        } else {
-            global_ok = (temp >= median_temp + delta);
-        }
-
-        if (within_k || global_ok) {
-            left = i;
-            fail_count = 0;
-        } else {
-            fail_count++;
-            if (fail_count > config.max_fail_count) break;
-        }
-    }
-
-    // Grow right
-    int right = centre;
-    fail_count = 0;
-    for (int i = centre + 1; i < SENSOR_WIDTH; i++) {
-        float temp = profile[i];
-
-        int within_k = fabsf(temp - centre_temp) <= k;
-        int global_ok;
-        if (inverted) {
-            global_ok = (temp <= median_temp - delta);
-        } else {
-            global_ok = (temp >= median_temp + delta);
-        }
-
-        if (within_k || global_ok) {
-            right = i;
-            fail_count = 0;
-        } else {
-            fail_count++;
-            if (fail_count > config.max_fail_count) break;
-        }
+    // Dual criteria: near the centre temperature, or clearly off the
+    // global median in the tyre's direction
+    uint32_t within_k = column_mask_within(profile, centre_temp, k);
+    uint32_t global_ok;
+    if (inverted) {
+        global_ok = column_mask_at_most(profile, median_temp - delta);
+    } else {
+        global_ok = column_mask_at_least(profile, median_temp + delta);
     }
 
-    *left_out = left;
-    *right_out = right;
+    // Grow both ways, bridging up to max_fail_count failing columns
+    column_mask_span(within_k | global_ok, centre, config.max_fail_count, left_out, right_out);
 }
 
 // Apply geometry constraints
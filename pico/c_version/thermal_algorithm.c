@@ -4,10 +4,14 @@
  */
 
 #include "thermal_algorithm.h"
+#include "column_mask.h"
+#include "column_classifier.h"
 #include <math.h>
 #include <string.h>
 #include <stdlib.h>
 
+_Static_assert(SENSOR_WIDTH == COLUMN_MASK_BITS, "profile columns must fit a column mask");
+
 // Static frame counter
 static uint32_t frame_counter = 0;
 
@@ -24,9 +28,18 @@ void thermal_algorithm_init(ThermalConfig *config) {
     config->min_tyre_width = 6;
     config->max_tyre_width = 28;
     config->ema_alpha = 0.3f;
+    config->engine = DETECT_ENGINE_REGION;
     frame_counter = 0;
 }
 
+uint32_t thermal_algorithm_get_frame_number(void) {
+    return frame_counter;
+}
+
+void thermal_algorithm_set_frame_number(uint32_t frame_number) {
+    frame_counter = frame_number;
+}
+
 float fast_mean(const float *data, uint16_t len) {
     if (len == 0) return 0.0f;
 
@@ -54,8 +67,9 @@ float fast_median(float *data, uint16_t len) {
 float fast_mad(const float *data, uint16_t len, float median) {
     if (len < 2) return 0.0f;
 
-    // Use static buffer instead of malloc to avoid heap issues
-    static float deviations[SENSOR_WIDTH];
+    // Scratch on the stack (no heap, and no static so both cores can run
+    // the algorithm at once - see shadow_eval.h)
+    float deviations[SENSOR_WIDTH];
     if (len > SENSOR_WIDTH) return 0.0f;
 
     for (uint16_t i = 0; i < len; i++) {
@@ -69,12 +83,12 @@ float fast_mad(const float *data, uint16_t len, float median) {
 
 // Extract middle rows from 24x32 sensor
 static void extract_middle_rows(const float *frame, float *profile) {
-    // Extract rows 10-13 (middle 4 rows) and average them
+    // Extract the middle 4 rows and average them
     for (int col = 0; col < SENSOR_WIDTH; col++) {
         float sum = 0.0f;
         int count = 0;
 
-        for (int row = 10; row <= 13; row++) {
+        for (int row = PROFILE_FIRST_ROW; row <= PROFILE_LAST_ROW; row++) {
             int idx = row * SENSOR_WIDTH + col;
             if (frame[idx] > -270.0f) {  // Valid temperature
                 sum += frame[idx];
@@ -92,8 +106,8 @@ static void detect_tyre_span(const float *profile, TyreDetection *detection, The
     float profile_median = 0.0f;
     float profile_mad = 0.0f;
 
-    // Use static buffer instead of malloc
-    static float temp_profile[SENSOR_WIDTH];
+    // Stack buffer instead of malloc
+    float temp_profile[SENSOR_WIDTH];
     memcpy(temp_profile, profile, SENSOR_WIDTH * sizeof(float));
     profile_median = fast_median(temp_profile, SENSOR_WIDTH);
     profile_mad = fast_mad(profile, SENSOR_WIDTH, profile_median);
@@ -112,26 +126,9 @@ static void detect_tyre_span(const float *profile, TyreDetection *detection, The
     // Grow region from seed
     float threshold = profile_median + (config->mad_threshold * profile_mad);
 
-    int start = seed_idx;
-    int end = seed_idx;
-
-    // Grow left
-    for (int i = seed_idx - 1; i >= 0; i--) {
-        if (profile[i] > threshold) {
-            start = i;
-        } else {
-            break;
-        }
-    }
-
-    // Grow right
-    for (int i = seed_idx + 1; i < SENSOR_WIDTH; i++) {
-        if (profile[i] > threshold) {
-            end = i;
-        } else {
-            break;
-        }
-    }
+    int start;
+    int end;
+    column_mask_span(column_mask_above(profile, threshold), seed_idx, 0, &start, &end);
 
     int width = end - start + 1;
 
@@ -168,8 +165,8 @@ static void analyze_zone(const float *profile, int start, int end, ZoneAnalysis
         return;
     }
 
-    // Use static buffer instead of malloc
-    static float zone_data[SENSOR_WIDTH];
+    // Stack buffer instead of malloc
+    float zone_data[SENSOR_WIDTH];
 
     for (int i = 0; i < len; i++) {
         zone_data[i] = profile[start + i];
@@ -191,38 +188,83 @@ static void analyze_zone(const float *profile, int start, int end, ZoneAnalysis
     result->range = result->max - result->min;
 }
 
-void thermal_algorithm_process(const float *frame, FrameData *result, ThermalConfig *config) {
-    frame_counter++;
-    result->frame_number = frame_counter;
-    result->warnings = 0;
-
-    // Extract horizontal profile from middle rows
-    float profile[SENSOR_WIDTH];
+void thermal_algorithm_profile(const float *frame, float *profile) {
     extract_middle_rows(frame, profile);
+}
 
-    // Detect tyre span
-    detect_tyre_span(profile, &result->detection, config);
+void thermal_algorithm_profile_skip(const float *values, const uint16_t *skip, float *profile) {
+    // Bit r set: profile row PROFILE_FIRST_ROW + r of the column is listed
+    uint8_t skipped[SENSOR_WIDTH] = {0};
+    for (; *skip != 0xFFFF; skip++) {
+        int row = *skip / SENSOR_WIDTH;
+        if (row >= PROFILE_FIRST_ROW && row <= PROFILE_LAST_ROW) {
+            skipped[*skip % SENSOR_WIDTH] |= 1 << (row - PROFILE_FIRST_ROW);
+        }
+    }
 
-    // Split tyre into three zones
-    if (result->detection.detected) {
-        int tyre_start = result->detection.span_start;
-        int tyre_end = result->detection.span_end;
-        int tyre_width = result->detection.tyre_width;
+    const uint8_t all = (1 << (PROFILE_LAST_ROW - PROFILE_FIRST_ROW + 1)) - 1;
+    for (int col = 0; col < SENSOR_WIDTH; col++) {
+        uint8_t mask = (skipped[col] == all) ? 0 : skipped[col];
+        float sum = 0.0f;
+        int count = 0;
 
-        int third = tyre_width / 3;
+        for (int row = PROFILE_FIRST_ROW; row <= PROFILE_LAST_ROW; row++) {
+            if (mask & (1 << (row - PROFILE_FIRST_ROW))) continue;
+            sum += values[row * SENSOR_WIDTH + col];
+            count++;
+        }
+        profile[col] = sum / count;
+    }
+}
 
-        int left_start = tyre_start;
-        int left_end = tyre_start + third - 1;
+void thermal_algorithm_detect(const float *profile, TyreDetection *detection, ThermalConfig *config) {
+    if (config->engine == DETECT_ENGINE_CLASSIFIER) {
+        column_classifier_detect(profile, detection, config, &column_classifier_default_model);
+    } else {
+        detect_tyre_span(profile, detection, config);
+    }
+}
 
-        int centre_start = left_end + 1;
-        int centre_end = tyre_end - third;
+void thermal_algorithm_zone_bounds(const TyreDetection *detection, int bounds[3][2]) {
+    if (detection->detected) {
+        // Split tyre into three zones
+        int tyre_start = detection->span_start;
+        int tyre_end = detection->span_end;
+        int third = detection->tyre_width / 3;
+
+        bounds[0][0] = tyre_start;
+        bounds[0][1] = tyre_start + third - 1;
+        bounds[1][0] = bounds[0][1] + 1;
+        bounds[1][1] = tyre_end - third;
+        bounds[2][0] = bounds[1][1] + 1;
+        bounds[2][1] = tyre_end;
+    } else {
+        // No tyre detected - full profile in the centre zone
+        bounds[0][0] = 0;
+        bounds[0][1] = -1;
+        bounds[1][0] = 0;
+        bounds[1][1] = SENSOR_WIDTH - 1;
+        bounds[2][0] = 0;
+        bounds[2][1] = -1;
+    }
+}
 
-        int right_start = centre_end + 1;
-        int right_end = tyre_end;
+void thermal_algorithm_zones(const float *profile, FrameData *result) {
+    frame_counter++;
+    result->frame_number = frame_counter;
+    thermal_algorithm_zone_stats(profile, result);
+}
 
-        analyze_zone(profile, left_start, left_end, &result->left);
-        analyze_zone(profile, centre_start, centre_end, &result->centre);
-        analyze_zone(profile, right_start, right_end, &result->right);
+void thermal_algorithm_zone_stats(const float *profile, FrameData *result) {
+    result->warnings = 0;
+
+    int bounds[3][2];
+    thermal_algorithm_zone_bounds(&result->detection, bounds);
+
+    if (result->detection.detected) {
+        analyze_zone(profile, bounds[0][0], bounds[0][1], &result->left);
+        analyze_zone(profile, bounds[1][0], bounds[1][1], &result->centre);
+        analyze_zone(profile, bounds[2][0], bounds[2][1], &result->right);
 
         // Calculate lateral gradient (left to right)
         result->lateral_gradient = result->right.avg - result->left.avg;
@@ -236,10 +278,21 @@ void thermal_algorithm_process(const float *frame, FrameData *result, ThermalCon
             result->warnings |= 0x02;  // High variance warning
         }
     } else {
-        // No tyre detected - analyze full profile
-        analyze_zone(profile, 0, SENSOR_WIDTH - 1, &result->centre);
+        analyze_zone(profile, bounds[1][0], bounds[1][1], &result->centre);
         memset(&result->left, 0, sizeof(ZoneAnalysis));
         memset(&result->right, 0, sizeof(ZoneAnalysis));
         result->lateral_gradient = 0.0f;
     }
 }
+
+void thermal_algorithm_process(const float *frame, FrameData *result, ThermalConfig *config) {
+    // Extract horizontal profile from middle rows
+    float profile[SENSOR_WIDTH];
+    thermal_algorithm_profile(frame, profile);
+
+    // Detect tyre span
+    thermal_algorithm_detect(profile, &result->detection, config);
+
+    // Zone statistics within the span
+    thermal_algorithm_zones(profile, result);
+}
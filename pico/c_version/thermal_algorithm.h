@@ -13,6 +13,14 @@
 #define SENSOR_HEIGHT 24
 #define SENSOR_PIXELS 768
 
+// Rows averaged into the horizontal profile used for detection and zones
+#define PROFILE_FIRST_ROW 10
+#define PROFILE_LAST_ROW 13
+
+// Span detection engines (ThermalConfig.engine)
+#define DETECT_ENGINE_REGION 0       // Region growing above median + k * MAD
+#define DETECT_ENGINE_CLASSIFIER 1   // Per-column int8 classifier (column_classifier.h)
+
 // Configuration
 typedef struct {
     float mad_threshold;
@@ -20,6 +28,7 @@ typedef struct {
     uint8_t min_tyre_width;
     uint8_t max_tyre_width;
     float ema_alpha;
+    uint8_t engine;
 } ThermalConfig;
 
 // Detection result
@@ -59,6 +68,31 @@ void thermal_algorithm_init(ThermalConfig *config);
 // Process a frame and extract tyre data
 void thermal_algorithm_process(const float *frame, FrameData *result, ThermalConfig *config);
 
+// Individual stages of thermal_algorithm_process, for callers that run
+// them at different rates. Zones use the detection already in result.
+void thermal_algorithm_profile(const float *frame, float *profile);
+
+// Column averages of any per-pixel value over the profile rows, leaving
+// out the pixels of a 0xFFFF-terminated list (e.g. bad pixels). A column
+// with every profile row listed averages them all.
+void thermal_algorithm_profile_skip(const float *values, const uint16_t *skip, float *profile);
+void thermal_algorithm_detect(const float *profile, TyreDetection *detection, ThermalConfig *config);
+void thermal_algorithm_zones(const float *profile, FrameData *result);
+
+// thermal_algorithm_zones without numbering the frame, for a second
+// evaluation of the same frame (shadow_eval). The algorithm keeps no
+// other state, so it may run on both cores at once.
+void thermal_algorithm_zone_stats(const float *profile, FrameData *result);
+
+// Column range [first, last] of each zone (left, centre, right) for a
+// detection. Empty zones have first > last.
+void thermal_algorithm_zone_bounds(const TyreDetection *detection, int bounds[3][2]);
+
+// Frame counter behind FrameData.frame_number, for carrying it across a
+// watchdog reset
+uint32_t thermal_algorithm_get_frame_number(void);
+void thermal_algorithm_set_frame_number(uint32_t frame_number);
+
 // Fast median calculation (destructive to input array)
 float fast_median(float *data, uint16_t len);
 
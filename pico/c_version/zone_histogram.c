@@ -0,0 +1,101 @@
+/**
+ * zone_histogram.c
+ * Per-zone temperature histograms
+ */
+
+#include "zone_histogram.h"
+#include <math.h>
+#include <string.h>
+
+void zone_histogram_build(const float *frame, const TyreDetection *detection,
+                          const ZoneHistogramConfig *config, uint32_t frame_number,
+                          ZoneHistograms *out) {
+    memset(out, 0, sizeof(*out));
+    out->frame_number = frame_number;
+    out->config = *config;
+
+    int bins = config->bins;
+    if (bins > ZONE_HIST_MAX_BINS) bins = ZONE_HIST_MAX_BINS;
+    out->config.bins = (uint8_t)bins;
+    if (bins == 0 || config->bin_width_tenths == 0) {
+        out->config.bins = 0;
+        return;
+    }
+
+    // Bin index = (t - min) / width, with both in °C
+    float min_c = config->min_tenths / 10.0f;
+    float scale = 10.0f / config->bin_width_tenths;
+    float last = (float)(bins - 1);
+
+    int bounds[ZONE_HIST_ZONES][2];
+    thermal_algorithm_zone_bounds(detection, bounds);
+
+    for (int z = 0; z < ZONE_HIST_ZONES; z++) {
+        uint16_t *counts = out->counts[z];
+        for (int row = PROFILE_FIRST_ROW; row <= PROFILE_LAST_ROW; row++) {
+            const float *pixels = &frame[row * SENSOR_WIDTH];
+            for (int col = bounds[z][0]; col <= bounds[z][1]; col++) {
+                float pos = (pixels[col] - min_c) * scale;
+                if (!isfinite(pos)) continue;
+                // Clamp before converting so out-of-range values land in the end bins
+                if (pos < 0.0f) pos = 0.0f;
+                if (pos > last) pos = last;
+                counts[(int)pos]++;
+            }
+        }
+    }
+}
+
+uint16_t zone_histogram_pack(const ZoneHistograms *hist, uint8_t *out, uint16_t max_len) {
+    int bins = hist->config.bins;
+    if (bins > ZONE_HIST_MAX_BINS) return 0;
+
+    uint16_t len = ZONE_HIST_HEADER_BYTES + ZONE_HIST_ZONES * bins * 2;
+    if (len > max_len) return 0;
+
+    out[0] = ZONE_HIST_VERSION;
+    out[1] = (uint8_t)bins;
+    out[2] = (uint16_t)hist->config.min_tenths & 0xFF;
+    out[3] = ((uint16_t)hist->config.min_tenths >> 8) & 0xFF;
+    out[4] = hist->config.bin_width_tenths;
+    out[5] = ZONE_HIST_ZONES;
+    out[6] = hist->frame_number & 0xFF;
+    out[7] = (hist->frame_number >> 8) & 0xFF;
+    out[8] = (hist->frame_number >> 16) & 0xFF;
+    out[9] = (hist->frame_number >> 24) & 0xFF;
+
+    uint8_t *p = out + ZONE_HIST_HEADER_BYTES;
+    for (int z = 0; z < ZONE_HIST_ZONES; z++) {
+        for (int b = 0; b < bins; b++) {
+            *p++ = hist->counts[z][b] & 0xFF;
+            *p++ = (hist->counts[z][b] >> 8) & 0xFF;
+        }
+    }
+    return len;
+}
+
+bool zone_histogram_unpack(const uint8_t *data, uint16_t len, ZoneHistograms *hist) {
+    if (len < ZONE_HIST_HEADER_BYTES || data[0] != ZONE_HIST_VERSION) return false;
+
+    int bins = data[1];
+    if (bins > ZONE_HIST_MAX_BINS || data[5] != ZONE_HIST_ZONES ||
+        len != ZONE_HIST_HEADER_BYTES + ZONE_HIST_ZONES * bins * 2) {
+        return false;
+    }
+
+    memset(hist, 0, sizeof(*hist));
+    hist->config.bins = (uint8_t)bins;
+    hist->config.min_tenths = (int16_t)(data[2] | (data[3] << 8));
+    hist->config.bin_width_tenths = data[4];
+    hist->frame_number = (uint32_t)data[6] | ((uint32_t)data[7] << 8) |
+                         ((uint32_t)data[8] << 16) | ((uint32_t)data[9] << 24);
+
+    const uint8_t *p = data + ZONE_HIST_HEADER_BYTES;
+    for (int z = 0; z < ZONE_HIST_ZONES; z++) {
+        for (int b = 0; b < bins; b++) {
+            hist->counts[z][b] = (uint16_t)(p[0] | (p[1] << 8));
+            p += 2;
+        }
+    }
+    return true;
+}
@@ -0,0 +1,55 @@
+/**
+ * zone_histogram.h
+ * Per-zone temperature histograms
+ *
+ * Bins the profile-row pixels (PROFILE_FIRST_ROW..PROFILE_LAST_ROW) of
+ * each zone into fixed-width bins, so graining or blistering shows up as
+ * the shape of the distribution without sending whole frames. These rows
+ * are the ones zone conversion always converts, so histograms stay fresh
+ * in that mode too. Temperatures below the first bin or above the last
+ * are counted in the end bins: every zone pixel is counted once.
+ *
+ * The packed form (zone_histogram_pack) is the payload of the HST: serial
+ * lines; the same file builds on the host for decoding.
+ */
+
+#ifndef ZONE_HISTOGRAM_H
+#define ZONE_HISTOGRAM_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "thermal_algorithm.h"
+
+#define ZONE_HIST_ZONES 3
+#define ZONE_HIST_MAX_BINS 16
+#define ZONE_HIST_VERSION 1
+#define ZONE_HIST_HEADER_BYTES 10
+#define ZONE_HIST_MAX_BYTES (ZONE_HIST_HEADER_BYTES + ZONE_HIST_ZONES * ZONE_HIST_MAX_BINS * 2)
+
+typedef struct {
+    int16_t min_tenths;         // Lower edge of bin 0 (tenths °C)
+    uint8_t bin_width_tenths;   // Bin width (tenths °C)
+    uint8_t bins;               // Bins per zone, 0 = histograms off
+} ZoneHistogramConfig;
+
+typedef struct {
+    uint32_t frame_number;
+    ZoneHistogramConfig config;
+    uint16_t counts[ZONE_HIST_ZONES][ZONE_HIST_MAX_BINS];   // Left, centre, right
+} ZoneHistograms;
+
+// Count the zone pixels of a frame for the zones of detection
+void zone_histogram_build(const float *frame, const TyreDetection *detection,
+                          const ZoneHistogramConfig *config, uint32_t frame_number,
+                          ZoneHistograms *out);
+
+// Pack into the wire format (little-endian):
+//   version, bins, min_tenths (int16), bin_width_tenths, zones,
+//   frame_number (uint32), then zones × bins uint16 counts
+// Returns the packet length, or 0 if it exceeds max_len.
+uint16_t zone_histogram_pack(const ZoneHistograms *hist, uint8_t *out, uint16_t max_len);
+
+// Returns false if the packet is malformed
+bool zone_histogram_unpack(const uint8_t *data, uint16_t len, ZoneHistograms *hist);
+
+#endif // ZONE_HISTOGRAM_H
@@ -1,180 +1,242 @@
 """
 Example I2C controller (master) code
-Reads thermal data from Pico acting as I2C peripheral
-
-Run this on a Raspberry Pi or other controller to read data from the Pico
+Reads thermal data from a Pico running the C firmware as an I2C peripheral
+
+Run this on a Raspberry Pi or other controller to read data from the Pico.
+Register addresses follow c_version/i2c_slave.h. The status block
+(0x10-0x1F) and temperature block (0x20-0x2D) are contiguous and the
+Pico auto-increments its register pointer, so one write-then-read burst
+returns everything for a frame. The 16 raw channels (0x30-0x4F, raw mode)
+are a second burst.
 """
 
+import struct
 import time
+from dataclasses import dataclass
+from typing import Optional, Tuple
+
 import board
 import busio
-import struct
+
+# Configuration registers (read/write)
+REG_I2C_ADDRESS = 0x00
+REG_OUTPUT_MODE = 0x01
+REG_FRAME_RATE = 0x02
+REG_FALLBACK_MODE = 0x03
+REG_EMISSIVITY = 0x04
+REG_RAW_MODE = 0x05
+
+# Status block start, temperature block, raw channels
+REG_STATUS_START = 0x10
+REG_FRAME_NUMBER_L = 0x11
+REG_RAW_CH0_L = 0x30
+REG_CMD = 0xFF
+CMD_CLEAR_WARNINGS = 0x02
+
+DEFAULT_ADDRESS = 0x08
+
+# 0x10-0x2D: version, frame, fps, detected, confidence, width, span start/end,
+# warnings, refresh rate code, rate mode, Ta (tenths), Vdd (mV), then
+# medians L/C/R, averages L/C/R and lateral gradient (int16 tenths)
+_BLOCK = struct.Struct("<BHBBBBBBBBBhH7h")
+_RAW_CHANNELS = struct.Struct("<16h")
+_FRAME_NUMBER = struct.Struct("<H")
+
+assert _BLOCK.size == 0x2E - REG_STATUS_START
+
+RATE_MODES = ("fixed", "cruise", "attack", "release")
+
+
+@dataclass
+class TyreStatus:
+    """One frame's status and zone temperatures (°C)"""
+
+    firmware_version: int
+    frame_number: int           # Low 16 bits of the firmware frame counter
+    fps: int
+    detected: bool
+    confidence: float           # 0.0 - 1.0
+    tyre_width: int
+    span_start: int
+    span_end: int
+    warnings: int               # Bit flags (0x01 gradient, 0x02 variance)
+    refresh_rate_hz: float      # Sensor subpage rate
+    rate_mode: str
+    sensor_ta: float
+    sensor_vdd: float           # Volts
+    left_median: float
+    centre_median: float
+    right_median: float
+    left_avg: float
+    centre_avg: float
+    right_avg: float
+    lateral_gradient: float
+
+    @classmethod
+    def unpack(cls, block: bytes) -> "TyreStatus":
+        (version, frame, fps, detected, confidence, width, start, end, warnings,
+         rate_code, rate_mode, ta, vdd, *temps) = _BLOCK.unpack(block)
+        left_med, centre_med, right_med, left_avg, centre_avg, right_avg, gradient = temps
+        return cls(
+            firmware_version=version,
+            frame_number=frame,
+            fps=fps,
+            detected=bool(detected),
+            confidence=confidence / 100.0,
+            tyre_width=width,
+            span_start=start,
+            span_end=end,
+            warnings=warnings,
+            refresh_rate_hz=0.5 * (1 << rate_code),
+            rate_mode=RATE_MODES[rate_mode] if rate_mode < len(RATE_MODES) else str(rate_mode),
+            sensor_ta=ta / 10.0,
+            sensor_vdd=vdd / 1000.0,
+            left_median=left_med / 10.0,
+            centre_median=centre_med / 10.0,
+            right_median=right_med / 10.0,
+            left_avg=left_avg / 10.0,
+            centre_avg=centre_avg / 10.0,
+            right_avg=right_avg / 10.0,
+            lateral_gradient=gradient / 10.0,
+        )
+
+    @property
+    def medians(self) -> Tuple[float, float, float]:
+        return (self.left_median, self.centre_median, self.right_median)
+
+    @property
+    def span(self) -> Tuple[int, int, int]:
+        return (self.span_start, self.span_end, self.tyre_width)
 
 
 class TyreDataReader:
-    """Read thermal tyre data from Pico via I2C"""
-
-    # Register addresses (must match I2CPeripheralExtended)
-    REG_TEMP_LEFT = 0x00
-    REG_TEMP_CENTRE = 0x02
-    REG_TEMP_RIGHT = 0x04
-    REG_CONFIDENCE = 0x06
-    REG_WARNINGS = 0x07
-    REG_SPAN_START = 0x08
-    REG_SPAN_END = 0x09
-    REG_WIDTH = 0x0A
-    REG_GRADIENT = 0x0B
-    REG_FRAME_COUNT = 0x0D
-
-    def __init__(self, i2c_bus, device_address=0x42):
+    """Read thermal tyre data from a Pico via I2C with burst reads"""
+
+    def __init__(self, i2c_bus, device_address=DEFAULT_ADDRESS):
         """
         Initialize reader
 
         Args:
-            i2c_bus: I2C bus instance
-            device_address: Address of Pico I2C peripheral
+            i2c_bus: busio.I2C instance
+            device_address: Address of Pico I2C peripheral (REG_I2C_ADDRESS)
         """
         self.i2c = i2c_bus
         self.address = device_address
-
-    def _read_register(self, register, num_bytes=1):
-        """Read bytes from a register"""
-        result = bytearray(num_bytes)
+        self.transactions = 0
+        self._block = bytearray(_BLOCK.size)
+        self._raw = bytearray(_RAW_CHANNELS.size)
+        self._frame = bytearray(_FRAME_NUMBER.size)
+
+    def _burst(self, register: int, buffer: bytearray) -> None:
+        """Set the register pointer and read len(buffer) bytes (one transaction)"""
+        while not self.i2c.try_lock():
+            pass
         try:
-            # Write register address
-            self.i2c.writeto(self.address, bytes([register]))
-            # Read data
-            self.i2c.readfrom_into(self.address, result)
-            return result
-        except Exception as e:
-            print(f"I2C read error: {e}")
-            return None
-
-    def _read_int16(self, register):
-        """Read signed 16-bit integer from register"""
-        data = self._read_register(register, 2)
-        if data:
-            return struct.unpack('<h', data)[0]
-        return None
-
-    def _read_uint8(self, register):
-        """Read unsigned 8-bit integer from register"""
-        data = self._read_register(register, 1)
-        if data:
-            return data[0]
-        return None
-
-    def read_temperatures(self):
-        """
-        Read left, centre, right temperatures
+            self.i2c.writeto_then_readfrom(self.address, bytes([register]), buffer)
+        finally:
+            self.i2c.unlock()
+        self.transactions += 1
+
+    def _write(self, register: int, value: int) -> None:
+        while not self.i2c.try_lock():
+            pass
+        try:
+            self.i2c.writeto(self.address, bytes([register, value & 0xFF]))
+        finally:
+            self.i2c.unlock()
+        self.transactions += 1
 
-        Returns:
-            Tuple of (left, centre, right) in degrees C, or None on error
-        """
-        left = self._read_int16(self.REG_TEMP_LEFT)
-        centre = self._read_int16(self.REG_TEMP_CENTRE)
-        right = self._read_int16(self.REG_TEMP_RIGHT)
+    def read(self) -> TyreStatus:
+        """Read the status and temperature blocks in one burst"""
+        self._burst(REG_STATUS_START, self._block)
+        return TyreStatus.unpack(self._block)
 
-        if left is not None and centre is not None and right is not None:
-            return (left / 10.0, centre / 10.0, right / 10.0)
-        return None
+    def read_frame_number(self) -> int:
+        """Read just the 16-bit frame counter"""
+        self._burst(REG_FRAME_NUMBER_L, self._frame)
+        return _FRAME_NUMBER.unpack(self._frame)[0]
 
-    def read_confidence(self):
-        """Read detection confidence (0.0 - 1.0)"""
-        conf = self._read_uint8(self.REG_CONFIDENCE)
-        return conf / 100.0 if conf is not None else None
+    def read_raw_channels(self) -> Tuple[float, ...]:
+        """Read the 16 raw channel temperatures (°C, valid in raw mode)"""
+        self._burst(REG_RAW_CH0_L, self._raw)
+        return tuple(v / 10.0 for v in _RAW_CHANNELS.unpack(self._raw))
 
-    def read_warnings_count(self):
-        """Read number of warnings"""
-        return self._read_uint8(self.REG_WARNINGS)
+    def set_raw_mode(self, enabled: bool) -> None:
+        self._write(REG_RAW_MODE, 1 if enabled else 0)
 
-    def read_span(self):
-        """
-        Read detected tyre span
+    def set_emissivity(self, emissivity: float) -> None:
+        self._write(REG_EMISSIVITY, int(round(emissivity * 100)))
 
-        Returns:
-            Tuple of (start, end, width) or None
-        """
-        start = self._read_uint8(self.REG_SPAN_START)
-        end = self._read_uint8(self.REG_SPAN_END)
-        width = self._read_uint8(self.REG_WIDTH)
-
-        if start is not None and end is not None and width is not None:
-            return (start, end, width)
-        return None
-
-    def read_gradient(self):
-        """Read lateral temperature gradient in degrees C"""
-        grad = self._read_int16(self.REG_GRADIENT)
-        return grad / 10.0 if grad is not None else None
-
-    def read_frame_count(self):
-        """Read frame counter"""
-        data = self._read_register(self.REG_FRAME_COUNT, 2)
-        if data:
-            return struct.unpack('<H', data)[0]
-        return None
-
-    def read_all(self):
+    def clear_warnings(self) -> None:
+        self._write(REG_CMD, CMD_CLEAR_WARNINGS)
+
+    def wait_for_frame(self, last_frame: Optional[int], timeout: float = 1.0,
+                       retry_interval: float = 0.005) -> Optional[TyreStatus]:
         """
-        Read all data at once
+        Burst-read until the frame number differs from last_frame
+
+        Polls are spaced by the Pico's reported rate, so a steady stream
+        costs one burst per frame plus the odd retry.
 
         Returns:
-            Dictionary with all available data
+            The new frame's status, or None on timeout
         """
-        temps = self.read_temperatures()
-        confidence = self.read_confidence()
-        warnings = self.read_warnings_count()
-        span = self.read_span()
-        gradient = self.read_gradient()
-        frame_count = self.read_frame_count()
-
-        return {
-            "temperatures": temps,
-            "confidence": confidence,
-            "warnings_count": warnings,
-            "span": span,
-            "gradient": gradient,
-            "frame_count": frame_count
-        }
+        deadline = time.monotonic() + timeout
+        while True:
+            status = self.read()
+            if status.frame_number != last_frame:
+                return status
+            if time.monotonic() >= deadline:
+                return None
+            time.sleep(retry_interval)
 
 
 def main():
     """Example usage"""
     print("I2C Controller - Reading from Pico thermal sensor")
 
-    # Initialize I2C bus
-    i2c = busio.I2C(board.SCL, board.SDA)
-
-    # Create reader
-    reader = TyreDataReader(i2c, device_address=0x42)
+    i2c = busio.I2C(board.SCL, board.SDA, frequency=400000)
+    reader = TyreDataReader(i2c)
 
     print("Reading thermal data...")
 
+    last_frame = None
+    frames = 0
     while True:
         try:
-            # Read all data
-            data = reader.read_all()
-
-            if data["temperatures"]:
-                left, centre, right = data["temperatures"]
-                print(
-                    f"Frame {data['frame_count']}: "
-                    f"L={left:.1f}C C={centre:.1f}C R={right:.1f}C "
-                    f"conf={data['confidence']:.0%} "
-                    f"grad={data['gradient']:.1f}C "
-                    f"warn={data['warnings_count']}"
-                )
-            else:
-                print("No data available")
-
-            time.sleep(0.5)
+            t_poll = time.monotonic()
+            status = reader.wait_for_frame(last_frame)
+            if status is None:
+                print("No new frame (is the Pico running?)")
+                continue
+
+            if last_frame is not None:
+                frames += (status.frame_number - last_frame) & 0xFFFF
+            last_frame = status.frame_number
+
+            left, centre, right = status.medians
+            print(
+                f"Frame {status.frame_number}: "
+                f"L={left:.1f}C C={centre:.1f}C R={right:.1f}C "
+                f"conf={status.confidence:.0%} "
+                f"grad={status.lateral_gradient:.1f}C "
+                f"warn=0x{status.warnings:02X} "
+                f"({reader.transactions} bus transactions)"
+            )
+
+            # Sleep most of a frame period, then let wait_for_frame catch
+            # the change with short retries
+            if status.fps > 0:
+                period = 1.0 / status.fps
+                remaining = period * 0.8 - (time.monotonic() - t_poll)
+                if remaining > 0:
+                    time.sleep(remaining)
 
         except KeyboardInterrupt:
-            print("\nStopping...")
+            print(f"\nStopping after {frames} frames, {reader.transactions} bus transactions")
             break
-        except Exception as e:
-            print(f"Error: {e}")
+        except OSError as e:
+            print(f"I2C error: {e}")
             time.sleep(1.0)
 
 
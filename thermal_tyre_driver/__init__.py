@@ -12,7 +12,11 @@ from .driver import (
     TyreSection,
     DetectionInfo,
     I2CMux,
+    BackgroundReader,
 )
+from .scheduler import MuxScheduler
+from .records import decode_raw_frame, encode_raw_frame
+from .shm_snapshot import SnapshotReader
 
 __all__ = [
     "SensorConfig",
@@ -22,5 +26,10 @@ __all__ = [
     "TyreSection",
     "DetectionInfo",
     "I2CMux",
+    "MuxScheduler",
+    "BackgroundReader",
+    "encode_raw_frame",
+    "decode_raw_frame",
+    "SnapshotReader",
     "__version__",
 ]
@@ -10,10 +10,14 @@ import adafruit_mlx90640
 import numpy as np
 from scipy import ndimage
 from collections import deque
-from typing import Tuple, Dict, List, Optional
+from typing import BinaryIO, Tuple, Dict, Iterator, List, Optional
 from dataclasses import dataclass, field, asdict
 from datetime import datetime
 import json
+import threading
+import time
+
+from .records import encode_raw_frame, write_raw_frame
 
 __all__ = [
     "SensorConfig",
@@ -23,6 +27,7 @@ __all__ = [
     "TyreSection",
     "DetectionInfo",
     "I2CMux",
+    "BackgroundReader",
 ]
 
 
@@ -110,8 +115,14 @@ class TyreThermalData:
     # Warnings
     warnings: List[str] = field(default_factory=list)
 
-    def to_dict(self) -> Dict:
-        """Convert to dictionary for JSON serialization"""
+    def to_dict(self, include_raw_frame: bool = True) -> Dict:
+        """
+        Convert to dictionary for JSON serialization
+
+        Args:
+            include_raw_frame: Convert raw_frame to nested lists. Pass False
+                when the frame is exported separately with to_binary().
+        """
         return {
             "timestamp": self.timestamp.isoformat(),
             "sensor_id": self.sensor_id,
@@ -120,14 +131,49 @@ class TyreThermalData:
             "detection": self.detection.to_dict(),
             "temperature_profile": self.temperature_profile.tolist(),
             "raw_frame": (
-                self.raw_frame.tolist() if self.raw_frame is not None else None
+                self.raw_frame.tolist()
+                if include_raw_frame and self.raw_frame is not None
+                else None
             ),
             "warnings": self.warnings,
         }
 
-    def to_json(self) -> str:
+    def to_json(self, include_raw_frame: bool = True) -> str:
         """Convert to JSON string"""
-        return json.dumps(self.to_dict(), indent=2)
+        return json.dumps(self.to_dict(include_raw_frame), indent=2)
+
+    def raw_frame_buffer(self) -> memoryview:
+        """
+        Zero-copy view of the raw frame (float64 °C, row-major)
+
+        Returns:
+            memoryview over the frame's memory, usable with any buffer
+            protocol consumer (numpy, sockets, file.write)
+        """
+        if self.raw_frame is None:
+            raise ValueError("No raw frame (enable SensorConfig.include_raw_frame)")
+        return memoryview(np.ascontiguousarray(self.raw_frame))
+
+    def to_binary(self) -> bytes:
+        """Serialise the raw frame as a compact binary record (see records.py)"""
+        if self.raw_frame is None:
+            raise ValueError("No raw frame (enable SensorConfig.include_raw_frame)")
+        return encode_raw_frame(
+            self.raw_frame, self.frame_number, self.timestamp, self.sensor_id
+        )
+
+    def write_binary(self, fp: BinaryIO) -> int:
+        """
+        Write the raw frame record to a binary stream
+
+        Returns:
+            Number of bytes written
+        """
+        if self.raw_frame is None:
+            raise ValueError("No raw frame (enable SensorConfig.include_raw_frame)")
+        return write_raw_frame(
+            fp, self.raw_frame, self.frame_number, self.timestamp, self.sensor_id
+        )
 
 
 @dataclass
@@ -291,6 +337,12 @@ class TyreThermalSensor:
         self.confidence_history = deque(maxlen=10)
         self._mad_cache = {}
 
+        # Subpage acquisition state (see poll_subpage)
+        self._subpage_raw = [0] * 834
+        self._subpage_frame = [0.0] * 768
+        self._subpages_seen = 0
+        self.subpage_count = 0
+
     def _init_sensor(self):
         """Initialize MLX90640 sensor"""
         try:
@@ -309,9 +361,11 @@ class TyreThermalSensor:
                 16: adafruit_mlx90640.RefreshRate.REFRESH_16_HZ,
                 32: adafruit_mlx90640.RefreshRate.REFRESH_32_HZ,
             }
-            self.mlx.refresh_rate = refresh_rate_map.get(
-                self.config.refresh_rate, adafruit_mlx90640.RefreshRate.REFRESH_4_HZ
-            )
+            if self.config.refresh_rate not in refresh_rate_map:
+                self.refresh_hz = 4
+            else:
+                self.refresh_hz = self.config.refresh_rate
+            self.mlx.refresh_rate = refresh_rate_map[self.refresh_hz]
 
         except Exception as e:
             raise RuntimeError(
@@ -336,6 +390,10 @@ class TyreThermalSensor:
 
         self.frame_count += 1
 
+        return self._process_frame(frame_2d)
+
+    def _process_frame(self, frame_2d: np.ndarray) -> TyreThermalData:
+        """Run detection and section analysis on a complete frame"""
         # Perform detection
         left, right, detection_info, profile = self._detect_tyre_span(frame_2d)
 
@@ -359,6 +417,57 @@ class TyreThermalSensor:
 
         return data
 
+    @property
+    def subpage_period(self) -> float:
+        """Seconds between subpages at the configured refresh rate"""
+        return 1.0 / self.refresh_hz
+
+    def poll_subpage(self) -> Optional[TyreThermalData]:
+        """
+        Read one subpage if the sensor has one ready, without blocking
+
+        The MLX90640 delivers each frame as two subpages. This checks the
+        status register once; if new data is flagged, the subpage is read,
+        converted into the frame buffer and, when both halves have arrived,
+        analysed. Used by MuxScheduler so the bus is never held waiting on
+        one sensor's integration time.
+
+        Returns:
+            TyreThermalData when a frame completes, otherwise None
+        """
+        # Select mux channel if needed
+        if self.mux and self.mux_channel is not None:
+            self.mux.select_channel(self.mux_channel)
+
+        # adafruit_mlx90640 has no public subpage API, so this mirrors
+        # MLX90640._GetFrameData without its busy-wait on data ready
+        mlx = self.mlx
+        raw = self._subpage_raw
+        status = [0]
+        mlx._I2CReadWords(0x8000, status)
+        if not status[0] & 0x0008:
+            return None
+
+        mlx._I2CWriteWord(0x8000, 0x0030)
+        mlx._I2CReadWords(0x0400, raw, end=832)
+        control = [0]
+        mlx._I2CReadWords(0x800D, control)
+        raw[832] = control[0]
+        raw[833] = status[0] & 0x0001
+
+        tr = mlx._GetTa(raw) - adafruit_mlx90640.OPENAIR_TA_SHIFT
+        mlx._CalculateTo(raw, 0.95, tr, self._subpage_frame)
+        self.subpage_count += 1
+
+        self._subpages_seen |= 1 << raw[833]
+        if self._subpages_seen != 0b11:
+            return None
+        self._subpages_seen = 0
+
+        self.frame_count += 1
+        frame_2d = np.array(self._subpage_frame).reshape(24, 32)
+        return self._process_frame(frame_2d)
+
     def _read_frame(self) -> Optional[np.ndarray]:
         """Read a frame from the sensor"""
         frame = [0.0] * 768
@@ -773,3 +882,209 @@ class TyreThermalSensor:
         self.persistence_buffer.clear()
         self.confidence_history.clear()
         self._mad_cache.clear()
+        self._subpages_seen = 0
+
+
+# ---- Background Acquisition ----
+class BackgroundReader:
+    """
+    Acquires and analyses frames for one sensor on background threads
+
+    An acquisition thread reads frames into a pair of buffers (the I2C
+    transfers block outside the GIL) while an analysis thread turns the
+    most recently completed buffer into TyreThermalData. The application
+    picks up the freshest result without waiting on the sensor.
+
+    Example usage:
+        with BackgroundReader(sensor) as reader:
+            for data in reader:
+                print(data.analysis.centre.avg)
+
+    Only one reader should drive a given I2C bus; for several sensors on a
+    multiplexer use MuxScheduler instead.
+    """
+
+    def __init__(self, sensor: TyreThermalSensor, error_backoff: float = 0.1):
+        """
+        Initialize background reader
+
+        Args:
+            sensor: Sensor to acquire from
+            error_backoff: Delay after a failed frame read (s)
+        """
+        self.sensor = sensor
+        self.error_backoff = error_backoff
+
+        # Double buffer: acquisition fills _buffers[_back] while the other
+        # holds the last complete frame until analysis copies it out
+        self._buffers = [[0.0] * 768, [0.0] * 768]
+        self._back = 0
+        self._ready = None
+
+        self._latest = None
+        self._latest_seq = 0
+        self._cond = threading.Condition()
+        self._running = False
+        self._threads = []
+
+        # Counters
+        self.frames_acquired = 0
+        self.frames_analysed = 0
+        self.frames_dropped = 0  # Acquired but overwritten before analysis
+        self.results_dropped = 0  # Analysed but superseded before being read
+        self.read_errors = 0
+        self.analysis_errors = 0
+        self._consumed_seq = 0
+
+    def start(self):
+        """Start the acquisition and analysis threads"""
+        if self._running:
+            return
+
+        self._running = True
+        self._threads = [
+            threading.Thread(
+                target=self._acquire_loop,
+                name=f"{self.sensor.sensor_id}-acquire",
+                daemon=True,
+            ),
+            threading.Thread(
+                target=self._analyse_loop,
+                name=f"{self.sensor.sensor_id}-analyse",
+                daemon=True,
+            ),
+        ]
+        for thread in self._threads:
+            thread.start()
+
+    def stop(self, timeout: Optional[float] = None):
+        """
+        Stop the background threads
+
+        Args:
+            timeout: Maximum time to wait for each thread (s)
+        """
+        with self._cond:
+            self._running = False
+            self._cond.notify_all()
+
+        for thread in self._threads:
+            thread.join(timeout)
+        self._threads = []
+
+    def __enter__(self) -> "BackgroundReader":
+        self.start()
+        return self
+
+    def __exit__(self, exc_type, exc, tb):
+        self.stop()
+
+    def _acquire_loop(self):
+        """Read frames into the back buffer and hand them to analysis"""
+        sensor = self.sensor
+
+        while self._running:
+            buffer = self._buffers[self._back]
+            try:
+                if sensor.mux and sensor.mux_channel is not None:
+                    sensor.mux.select_channel(sensor.mux_channel)
+                sensor.mlx.getFrame(buffer)
+            except Exception as e:
+                print(f"Error reading frame from {sensor.sensor_id}: {e}")
+                self.read_errors += 1
+                time.sleep(self.error_backoff)
+                continue
+
+            with self._cond:
+                self.frames_acquired += 1
+                if self._ready is not None:
+                    self.frames_dropped += 1
+                self._ready = self._back
+                self._back ^= 1
+                self._cond.notify_all()
+
+    def _analyse_loop(self):
+        """Analyse the most recent complete frame and publish the result"""
+        sensor = self.sensor
+
+        while True:
+            with self._cond:
+                while self._running and self._ready is None:
+                    self._cond.wait()
+                if not self._running:
+                    return
+
+                # Copy out under the lock so the buffer can be refilled
+                frame_2d = np.array(self._buffers[self._ready]).reshape(24, 32)
+                self._ready = None
+
+            sensor.frame_count += 1
+            try:
+                data = sensor._process_frame(frame_2d)
+            except Exception as e:
+                print(f"Error analysing frame from {sensor.sensor_id}: {e}")
+                with self._cond:
+                    self.analysis_errors += 1
+                continue
+
+            with self._cond:
+                self.frames_analysed += 1
+                self._latest = data
+                self._latest_seq += 1
+                self._cond.notify_all()
+
+    def read_latest(
+        self, wait: bool = False, timeout: Optional[float] = None
+    ) -> Optional[TyreThermalData]:
+        """
+        Get the most recent analysis result
+
+        Args:
+            wait: Block until a result newer than the last one read is available
+            timeout: Maximum time to block when waiting (s)
+
+        Returns:
+            Latest TyreThermalData, or None if nothing is available yet
+        """
+        with self._cond:
+            if wait:
+                self._cond.wait_for(
+                    lambda: self._latest_seq > self._consumed_seq
+                    or not self._running,
+                    timeout,
+                )
+
+            if self._latest_seq > self._consumed_seq:
+                self.results_dropped += self._latest_seq - self._consumed_seq - 1
+                self._consumed_seq = self._latest_seq
+
+            return self._latest
+
+    def __iter__(self) -> Iterator[TyreThermalData]:
+        """Yield each new result, skipping any superseded while the caller was busy"""
+        while self._running:
+            with self._cond:
+                self._cond.wait_for(
+                    lambda: self._latest_seq > self._consumed_seq
+                    or not self._running
+                )
+                if self._latest_seq == self._consumed_seq:
+                    return
+
+            data = self.read_latest()
+            if data is not None:
+                yield data
+
+    def get_stats(self) -> Dict:
+        """Get acquisition and drop counters"""
+        with self._cond:
+            return {
+                "sensor_id": self.sensor.sensor_id,
+                "running": self._running,
+                "frames_acquired": self.frames_acquired,
+                "frames_analysed": self.frames_analysed,
+                "frames_dropped": self.frames_dropped,
+                "results_dropped": self.results_dropped,
+                "read_errors": self.read_errors,
+                "analysis_errors": self.analysis_errors,
+            }
@@ -0,0 +1,192 @@
+"""
+Binary frame records
+Compact serialisation of raw thermal frames without per-pixel Python objects
+
+Record layout (little-endian):
+
+    offset  size  field
+    0       2     magic b"TT"
+    2       1     format version (1)
+    3       1     record type (RECORD_RAW_FRAME)
+    4       4     frame number (uint32)
+    8       8     timestamp (int64, microseconds since Unix epoch)
+    16      1     width in pixels
+    17      1     height in pixels
+    18      1     sensor id length in bytes (0 for none)
+    19      1     reserved
+    20      2     payload length in bytes (uint16)
+    22      2     reserved
+    24      n     sensor id (UTF-8)
+    24+n    ...   pixels, int16 tenths of °C, row-major
+
+The pixel payload uses the same encoding as the firmware's I2C full-frame
+window (REG_FRAME_DATA_START): int16 tenths, low byte first, non-finite
+values sent as 0.
+"""
+
+import struct
+from datetime import datetime, timezone
+from typing import BinaryIO, Dict, Tuple
+
+import numpy as np
+
+__all__ = [
+    "RECORD_MAGIC",
+    "RECORD_VERSION",
+    "RECORD_RAW_FRAME",
+    "HEADER_SIZE",
+    "frame_to_tenths",
+    "encode_raw_frame",
+    "write_raw_frame",
+    "decode_raw_frame",
+]
+
+RECORD_MAGIC = b"TT"
+RECORD_VERSION = 1
+RECORD_RAW_FRAME = 0x01
+
+_HEADER = struct.Struct("<2sBBIqBBBxH2x")
+HEADER_SIZE = _HEADER.size
+
+_EPOCH = datetime(1970, 1, 1, tzinfo=timezone.utc)
+
+
+def frame_to_tenths(frame: np.ndarray) -> np.ndarray:
+    """
+    Convert a temperature frame to int16 tenths of a degree
+
+    Matches the firmware's temp_to_int16_tenths(): values are truncated
+    towards zero and non-finite values become 0.
+
+    Args:
+        frame: Temperatures in °C (any shape)
+
+    Returns:
+        Little-endian int16 array with the same shape
+    """
+    scaled = np.nan_to_num(
+        np.asarray(frame, dtype=np.float32) * 10.0, nan=0.0, posinf=0.0, neginf=0.0
+    )
+    np.clip(scaled, -32768, 32767, out=scaled)
+    return scaled.astype("<i2")
+
+
+def _timestamp_us(timestamp: datetime) -> int:
+    if timestamp.tzinfo is None:
+        timestamp = timestamp.astimezone()
+    delta = timestamp - _EPOCH
+    return (delta.days * 86400 + delta.seconds) * 1000000 + delta.microseconds
+
+
+def _header(
+    frame_number: int, timestamp: datetime, sensor_id: str, pixels: np.ndarray
+) -> bytes:
+    sensor_bytes = sensor_id.encode("utf-8")
+    if len(sensor_bytes) > 255:
+        raise ValueError(f"Sensor id too long for record: {sensor_id!r}")
+
+    height, width = pixels.shape
+    return (
+        _HEADER.pack(
+            RECORD_MAGIC,
+            RECORD_VERSION,
+            RECORD_RAW_FRAME,
+            frame_number & 0xFFFFFFFF,
+            _timestamp_us(timestamp),
+            width,
+            height,
+            len(sensor_bytes),
+            pixels.nbytes,
+        )
+        + sensor_bytes
+    )
+
+
+def encode_raw_frame(
+    frame: np.ndarray, frame_number: int, timestamp: datetime, sensor_id: str = ""
+) -> bytes:
+    """
+    Serialise a raw frame as a binary record
+
+    Args:
+        frame: 24x32 temperature frame in °C
+        frame_number: Sequential frame count
+        timestamp: Capture time
+        sensor_id: Sensor identifier (may be empty)
+
+    Returns:
+        Complete record as bytes
+    """
+    pixels = frame_to_tenths(frame)
+    return _header(frame_number, timestamp, sensor_id, pixels) + pixels.tobytes()
+
+
+def write_raw_frame(
+    fp: BinaryIO,
+    frame: np.ndarray,
+    frame_number: int,
+    timestamp: datetime,
+    sensor_id: str = "",
+) -> int:
+    """
+    Write a raw frame record to a binary stream
+
+    The pixel payload is written straight from the array buffer, avoiding
+    the intermediate bytes object that encode_raw_frame() builds.
+
+    Returns:
+        Number of bytes written
+    """
+    pixels = frame_to_tenths(frame)
+    header = _header(frame_number, timestamp, sensor_id, pixels)
+    fp.write(header)
+    fp.write(memoryview(pixels).cast("B"))
+    return len(header) + pixels.nbytes
+
+
+def decode_raw_frame(buffer) -> Tuple[Dict, np.ndarray]:
+    """
+    Decode a binary raw frame record
+
+    Args:
+        buffer: Any object supporting the buffer protocol
+
+    Returns:
+        Tuple of (header fields, frame). The frame is a read-only int16
+        view into buffer (tenths of °C); divide by 10 for degrees.
+    """
+    view = memoryview(buffer)
+    (
+        magic,
+        version,
+        record_type,
+        frame_number,
+        timestamp_us,
+        width,
+        height,
+        id_len,
+        payload_len,
+    ) = _HEADER.unpack_from(view)
+
+    if magic != RECORD_MAGIC:
+        raise ValueError(f"Bad record magic: {magic!r}")
+    if version != RECORD_VERSION:
+        raise ValueError(f"Unsupported record version: {version}")
+    if record_type != RECORD_RAW_FRAME:
+        raise ValueError(f"Not a raw frame record: type 0x{record_type:02X}")
+    if payload_len != width * height * 2:
+        raise ValueError(f"Payload length {payload_len} does not match {width}x{height}")
+
+    sensor_id = bytes(view[HEADER_SIZE : HEADER_SIZE + id_len]).decode("utf-8")
+    pixels = np.frombuffer(
+        view, dtype="<i2", count=width * height, offset=HEADER_SIZE + id_len
+    ).reshape(height, width)
+
+    header = {
+        "frame_number": frame_number,
+        "timestamp_us": timestamp_us,
+        "sensor_id": sensor_id,
+        "width": width,
+        "height": height,
+    }
+    return header, pixels
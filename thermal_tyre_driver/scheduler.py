@@ -0,0 +1,124 @@
+"""
+Mux-aware polling scheduler
+Interleaves subpage reads from several sensors sharing one I2C bus
+"""
+
+import time
+from typing import Dict, Iterable, Iterator, List
+
+from .driver import TyreThermalData, TyreThermalSensor
+
+__all__ = ["MuxScheduler"]
+
+
+class MuxScheduler:
+    """
+    Reads multiple TyreThermalSensor instances on a shared bus
+
+    Calling sensor.read() in turn leaves the bus idle while each sensor
+    integrates its next subpage. The scheduler instead tracks when each
+    sensor's next subpage is due, switches the mux to whichever sensor
+    should have data ready, and returns frames as they complete.
+
+    Example usage:
+        scheduler = MuxScheduler(sensors.values())
+        for data in scheduler:
+            print(data.sensor_id, data.analysis.centre.avg)
+    """
+
+    def __init__(
+        self,
+        sensors: Iterable[TyreThermalSensor],
+        poll_interval: float = 0.002,
+        early_margin: float = 0.1,
+    ):
+        """
+        Initialize scheduler
+
+        Args:
+            sensors: Sensors to interleave (typically on one mux)
+            poll_interval: Delay before re-polling a sensor that was not ready (s)
+            early_margin: Fraction of a subpage period to poll ahead of the
+                expected ready time
+        """
+        self.sensors = list(sensors)
+        if not self.sensors:
+            raise ValueError("MuxScheduler needs at least one sensor")
+
+        self.poll_interval = poll_interval
+        self.early_margin = early_margin
+
+        now = time.monotonic()
+        self._due = {sensor.sensor_id: now for sensor in self.sensors}
+        self._stats = {
+            sensor.sensor_id: {"subpages": 0, "frames": 0, "empty_polls": 0}
+            for sensor in self.sensors
+        }
+        self._start_time = now
+
+    def poll(self) -> List[TyreThermalData]:
+        """
+        Service every sensor whose next subpage is due
+
+        Returns:
+            Frames completed during this pass (possibly empty)
+        """
+        results = []
+        now = time.monotonic()
+
+        for sensor in sorted(self.sensors, key=lambda s: self._due[s.sensor_id]):
+            sensor_id = sensor.sensor_id
+            if self._due[sensor_id] > now:
+                continue
+
+            stats = self._stats[sensor_id]
+            subpages_before = sensor.subpage_count
+
+            try:
+                data = sensor.poll_subpage()
+            except Exception as e:
+                print(f"Error polling {sensor_id}: {e}")
+                self._due[sensor_id] = time.monotonic() + self.poll_interval
+                continue
+
+            now = time.monotonic()
+            if sensor.subpage_count == subpages_before:
+                # Not ready yet - check back shortly
+                stats["empty_polls"] += 1
+                self._due[sensor_id] = now + self.poll_interval
+                continue
+
+            # Subpage consumed; the next one lands one period later
+            stats["subpages"] += 1
+            period = sensor.subpage_period
+            self._due[sensor_id] = now + period * (1.0 - self.early_margin)
+
+            if data is not None:
+                stats["frames"] += 1
+                results.append(data)
+
+        return results
+
+    def __iter__(self) -> Iterator[TyreThermalData]:
+        """Yield frames from all sensors as they complete"""
+        while True:
+            for data in self.poll():
+                yield data
+
+            wait = min(self._due.values()) - time.monotonic()
+            if wait > 0:
+                time.sleep(wait)
+
+    def get_stats(self) -> Dict:
+        """Get per-sensor and aggregate scheduler statistics"""
+        elapsed = max(time.monotonic() - self._start_time, 1e-9)
+        total_frames = sum(s["frames"] for s in self._stats.values())
+
+        return {
+            "sensors": {
+                sensor_id: dict(stats, fps=stats["frames"] / elapsed)
+                for sensor_id, stats in self._stats.items()
+            },
+            "total_frames": total_frames,
+            "aggregate_fps": total_frames / elapsed,
+        }
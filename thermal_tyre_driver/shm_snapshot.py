@@ -0,0 +1,322 @@
+"""
+Shared-memory snapshot reader
+Latest frame records from the host aggregation daemon without a serial port
+
+thermal_tyre_daemon publishes every record it decodes into a POSIX shared
+memory segment (/dev/shm/thermal_tyre unless started with --shm). This
+module maps it read-only and exposes the records as numpy structured
+arrays viewing the mapping directly, so reading costs no copies and no
+work on the daemon's side however many readers are attached.
+
+Segment layout (little-endian, see pico/c_version/host/snapshot_shm.h):
+
+    header    64 bytes      HEADER_DTYPE
+    devices   device_count  device_dtype(ring_depth): name, head, connected,
+                            then a ring of ring_depth RECORD_DTYPE records
+
+Each ring record carries a sequence number: 2k+1 while the daemon writes
+record k, 2k+2 once it is complete. A record handed out by latest() stays
+intact until the daemon has published ring_depth - 1 more records for
+that device (about half a second at 16Hz); valid() tells whether it still
+is. wait() blocks on the header's generation counter with a futex and
+releases the GIL while it does.
+"""
+
+import ctypes
+import mmap
+import os
+import platform
+import time
+from typing import List, Optional, Tuple
+
+import numpy as np
+
+__all__ = [
+    "SNAPSHOT_NAME",
+    "SNAPSHOT_MAGIC",
+    "SNAPSHOT_VERSION",
+    "ZONE_DTYPE",
+    "RECORD_DTYPE",
+    "HEADER_DTYPE",
+    "device_dtype",
+    "SnapshotReader",
+]
+
+SNAPSHOT_NAME = "/thermal_tyre"
+SNAPSHOT_MAGIC = 0x4D535454  # "TTSM"
+SNAPSHOT_VERSION = 1
+
+ZONE_DTYPE = np.dtype(
+    [
+        ("avg", "<f4"),
+        ("median", "<f4"),
+        ("mad", "<f4"),
+        ("min", "<f4"),
+        ("max", "<f4"),
+        ("range", "<f4"),
+        ("count", "<u4"),
+    ]
+)
+
+RECORD_DTYPE = np.dtype(
+    [
+        ("seq", "<u4"),
+        ("fields", "<u4"),
+        ("host_ns", "<u8"),
+        ("frame_number", "<u4"),
+        ("fps", "<f4"),
+        ("confidence", "<f4"),
+        ("lateral_gradient", "<f4"),
+        ("detected", "u1"),
+        ("span_start", "u1"),
+        ("span_end", "u1"),
+        ("tyre_width", "u1"),
+        ("warnings", "u1"),
+        ("reserved", "u1", (3,)),
+        ("left", ZONE_DTYPE),
+        ("centre", ZONE_DTYPE),
+        ("right", ZONE_DTYPE),
+        ("profile", "<f4", (32,)),
+        ("pad", "u1", (4,)),
+    ]
+)
+
+HEADER_DTYPE = np.dtype(
+    [
+        ("magic", "<u4"),
+        ("version", "<u2"),
+        ("header_size", "<u2"),
+        ("device_count", "<u4"),
+        ("ring_depth", "<u4"),
+        ("device_size", "<u4"),
+        ("record_size", "<u4"),
+        ("generation", "<u4"),
+        ("live", "<u4"),
+        ("start_ns", "<u8"),
+        ("daemon_pid", "<u4"),
+        ("reserved", "u1", (20,)),
+    ]
+)
+
+assert RECORD_DTYPE.itemsize == 256
+assert HEADER_DTYPE.itemsize == 64
+
+# futex(2) syscall numbers; other architectures fall back to polling
+_SYS_FUTEX = {
+    "x86_64": 202,
+    "aarch64": 98,
+    "riscv64": 98,
+    "armv7l": 240,
+    "armv6l": 240,
+    "i686": 240,
+}.get(platform.machine())
+_FUTEX_WAIT = 0
+_POLL_INTERVAL = 0.002
+
+
+class _Timespec(ctypes.Structure):
+    _fields_ = [("tv_sec", ctypes.c_long), ("tv_nsec", ctypes.c_long)]
+
+
+def device_dtype(ring_depth: int) -> np.dtype:
+    """Per-device block: name, head, connected flag and the record ring."""
+    return np.dtype(
+        [
+            ("name", "S32"),
+            ("head", "<u8"),
+            ("connected", "<u4"),
+            ("reserved", "u1", (20,)),
+            ("ring", RECORD_DTYPE, (ring_depth,)),
+        ]
+    )
+
+
+def _seq_for(k: int) -> int:
+    return (2 * k + 2) & 0xFFFFFFFF
+
+
+class SnapshotReader:
+    """
+    Read-only view of the daemon's snapshot segment
+
+    Example:
+        with SnapshotReader() as snap:
+            generation = snap.generation
+            while True:
+                generation = snap.wait(generation, timeout=1.0)
+                for i, name in enumerate(snap.names):
+                    seq, record = snap.latest(i)
+                    if record is not None:
+                        print(name, record["frame_number"], record["centre"]["avg"])
+
+    Records from latest() are zero-copy views into the segment; copy them
+    (or check valid()) if they are kept for longer than a few frames.
+    If the daemon restarts it creates a fresh segment: when live turns
+    False, close this reader and open a new one.
+    """
+
+    def __init__(self, name: str = SNAPSHOT_NAME):
+        path = os.path.join("/dev/shm", name.lstrip("/"))
+        fd = os.open(path, os.O_RDONLY)
+        try:
+            size = os.fstat(fd).st_size
+            if size < HEADER_DTYPE.itemsize:
+                raise ValueError(f"{path}: segment too small ({size} bytes)")
+            self._mmap = mmap.mmap(fd, size, mmap.MAP_SHARED, mmap.PROT_READ)
+        finally:
+            os.close(fd)
+
+        header = np.ndarray((), dtype=HEADER_DTYPE, buffer=self._mmap)
+        if int(header["magic"]) != SNAPSHOT_MAGIC:
+            raise ValueError(f"{path}: not a thermal tyre snapshot (or still being created)")
+        if int(header["version"]) != SNAPSHOT_VERSION:
+            raise ValueError(f"{path}: snapshot version {int(header['version'])}, expected {SNAPSHOT_VERSION}")
+
+        depth = int(header["ring_depth"])
+        dev_dtype = device_dtype(depth)
+        count = int(header["device_count"])
+        if (
+            int(header["record_size"]) != RECORD_DTYPE.itemsize
+            or int(header["device_size"]) != dev_dtype.itemsize
+            or int(header["header_size"]) + count * dev_dtype.itemsize > size
+        ):
+            raise ValueError(f"{path}: unexpected segment layout")
+
+        self._header = header
+        self._generation = np.ndarray(
+            (), dtype="<u4", buffer=self._mmap, offset=HEADER_DTYPE.fields["generation"][1]
+        )
+        self.ring_depth = depth
+        self.devices = np.ndarray(
+            (count,), dtype=dev_dtype, buffer=self._mmap, offset=int(header["header_size"])
+        )
+        # Zero-copy (devices, ring_depth) view of every record slot
+        self.ring = self.devices["ring"]
+        self.names: List[str] = [n.decode("utf-8", "replace") for n in self.devices["name"]]
+
+        self._libc = ctypes.CDLL(None, use_errno=True) if _SYS_FUTEX is not None else None
+
+    def __enter__(self) -> "SnapshotReader":
+        return self
+
+    def __exit__(self, *exc) -> None:
+        self.close()
+
+    def close(self) -> None:
+        """Unmap the segment (deferred while views handed out are alive)."""
+        if self._mmap is None:
+            return
+        for attr in ("_header", "_generation", "devices", "ring"):
+            setattr(self, attr, None)
+        try:
+            self._mmap.close()
+        except BufferError:
+            pass  # Caller still holds record views; unmapped when they go
+        self._mmap = None
+
+    @property
+    def generation(self) -> int:
+        """Counter bumped by the daemon after each batch of records."""
+        return int(self._generation)
+
+    @property
+    def live(self) -> bool:
+        """False once the daemon that created the segment has shut down."""
+        return bool(self._header["live"])
+
+    def index(self, name: str) -> int:
+        """Device index for a daemon device name (e.g. "FL")."""
+        return self.names.index(name)
+
+    def connected(self, device: int) -> bool:
+        return bool(self.devices[device]["connected"])
+
+    def latest(self, device: int) -> Tuple[int, Optional[np.ndarray]]:
+        """
+        Newest complete record for a device
+
+        Returns:
+            (seq, record): record is a zero-copy 0-d RECORD_DTYPE view, or
+            None if the device has not produced a record yet
+        """
+        dev = self.devices[device]
+        for _ in range(self.ring_depth):
+            head = int(dev["head"])
+            if head == 0:
+                return 0, None
+            k = head - 1
+            record = self.ring[device, k % self.ring_depth, ...]
+            seq = _seq_for(k)
+            if int(record["seq"]) == seq:
+                return seq, record
+            # The daemon moved on while we looked; the new head is complete
+        return 0, None
+
+    def valid(self, device: int, seq: int) -> bool:
+        """True while the record returned with seq has not been overwritten."""
+        if seq == 0:
+            return False
+        slot = ((seq >> 1) - 1) % self.ring_depth
+        return int(self.ring[device, slot]["seq"]) == seq
+
+    def snapshot(self, out: Optional[np.ndarray] = None) -> np.ndarray:
+        """
+        Consistent copy of every device's newest record
+
+        Args:
+            out: Optional (device_count,) RECORD_DTYPE array to fill,
+                 avoiding an allocation per call
+
+        Returns:
+            Array of records; devices without one have seq == 0
+        """
+        if out is None:
+            out = np.zeros(len(self.names), dtype=RECORD_DTYPE)
+        for i in range(len(self.names)):
+            while True:
+                seq, record = self.latest(i)
+                if record is None:
+                    out[i] = np.zeros((), dtype=RECORD_DTYPE)
+                    break
+                out[i] = record
+                if self.valid(i, seq):
+                    break
+        return out
+
+    def wait(self, generation: int, timeout: Optional[float] = None) -> int:
+        """
+        Block until the daemon publishes after generation
+
+        Args:
+            generation: Last value seen (from .generation or a previous wait)
+            timeout: Seconds to wait at most, None for no limit
+
+        Returns:
+            The current generation (unchanged if the wait timed out)
+        """
+        deadline = None if timeout is None else time.monotonic() + timeout
+        while True:
+            current = self.generation
+            if current != (generation & 0xFFFFFFFF):
+                return current
+            remaining = None if deadline is None else deadline - time.monotonic()
+            if remaining is not None and remaining <= 0:
+                return current
+            if self._libc is None:
+                time.sleep(_POLL_INTERVAL if remaining is None else min(_POLL_INTERVAL, remaining))
+                continue
+
+            ts = None
+            if remaining is not None:
+                ts = _Timespec(int(remaining), int((remaining % 1.0) * 1e9))
+            # Returns on a wake, on timeout, or at once if the word has
+            # already changed; the loop re-checks in every case
+            self._libc.syscall(
+                ctypes.c_long(_SYS_FUTEX),
+                ctypes.c_void_p(self._generation.ctypes.data),
+                ctypes.c_int(_FUTEX_WAIT),
+                ctypes.c_uint32(current),
+                ctypes.byref(ts) if ts is not None else None,
+                None,
+                ctypes.c_int(0),
+            )